@@ -0,0 +1,54 @@
+# SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+#
+# SPDX-License-Identifier: MIT
+
+set(LZ4_PATH "" CACHE STRING "Custom LZ4 install path")
+
+set(_LZ4_NO_DEFAULT_PATH OFF)
+if(LZ4_PATH)
+    set(_LZ4_NO_DEFAULT_PATH ON)
+endif()
+
+set(LZ4_NO_DEFAULT_PATH ${_LZ4_NO_DEFAULT_PATH} CACHE BOOL "Disable searching LZ4 in default path")
+unset(_LZ4_NO_DEFAULT_PATH)
+
+set(LZ4_NO_DEFAULT_PATH_CMD)
+if(LZ4_NO_DEFAULT_PATH)
+    set(LZ4_NO_DEFAULT_PATH_CMD NO_DEFAULT_PATH)
+endif()
+
+
+# Search for the LZ4 include directory and library
+find_path(LZ4_INCLUDE_DIR lz4.h
+          HINTS ${LZ4_NO_DEFAULT_PATH_CMD}
+          PATH_SUFFIXES include
+          PATHS ${LZ4_PATH}
+          DOC "Where the LZ4 headers can be found")
+
+find_library(LZ4_LIBRARY lz4
+             HINTS ${LZ4_NO_DEFAULT_PATH_CMD}
+             PATH_SUFFIXES lib lib64
+             PATHS ${LZ4_PATH}
+             DOC "Where the LZ4 library can be found")
+
+set(LZ4_INCLUDE_DIRS "${LZ4_INCLUDE_DIR}")
+set(LZ4_LIBRARIES "${LZ4_LIBRARY}")
+
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(LZ4
+                                  REQUIRED_VARS LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+if(LZ4_FOUND AND NOT TARGET LZ4::LZ4)
+    add_library(LZ4::LZ4 UNKNOWN IMPORTED)
+    set_target_properties(LZ4::LZ4 PROPERTIES
+                          IMPORTED_LOCATION "${LZ4_LIBRARY}"
+                          INTERFACE_INCLUDE_DIRECTORIES "${LZ4_INCLUDE_DIR}")
+endif()
+
+
+mark_as_advanced(LZ4_PATH
+                 LZ4_NO_DEFAULT_PATH
+                 LZ4_INCLUDE_DIR
+                 LZ4_LIBRARY)
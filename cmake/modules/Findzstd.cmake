@@ -0,0 +1,54 @@
+# SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+#
+# SPDX-License-Identifier: MIT
+
+set(zstd_PATH "" CACHE STRING "Custom zstd install path")
+
+set(_zstd_NO_DEFAULT_PATH OFF)
+if(zstd_PATH)
+    set(_zstd_NO_DEFAULT_PATH ON)
+endif()
+
+set(zstd_NO_DEFAULT_PATH ${_zstd_NO_DEFAULT_PATH} CACHE BOOL "Disable searching zstd in default path")
+unset(_zstd_NO_DEFAULT_PATH)
+
+set(zstd_NO_DEFAULT_PATH_CMD)
+if(zstd_NO_DEFAULT_PATH)
+    set(zstd_NO_DEFAULT_PATH_CMD NO_DEFAULT_PATH)
+endif()
+
+
+# Search for the zstd include directory and library
+find_path(zstd_INCLUDE_DIR zstd.h
+          HINTS ${zstd_NO_DEFAULT_PATH_CMD}
+          PATH_SUFFIXES include
+          PATHS ${zstd_PATH}
+          DOC "Where the zstd headers can be found")
+
+find_library(zstd_LIBRARY zstd
+             HINTS ${zstd_NO_DEFAULT_PATH_CMD}
+             PATH_SUFFIXES lib lib64
+             PATHS ${zstd_PATH}
+             DOC "Where the zstd library can be found")
+
+set(zstd_INCLUDE_DIRS "${zstd_INCLUDE_DIR}")
+set(zstd_LIBRARIES "${zstd_LIBRARY}")
+
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(zstd
+                                  REQUIRED_VARS zstd_LIBRARY zstd_INCLUDE_DIR)
+
+if(zstd_FOUND AND NOT TARGET zstd::zstd)
+    add_library(zstd::zstd UNKNOWN IMPORTED)
+    set_target_properties(zstd::zstd PROPERTIES
+                          IMPORTED_LOCATION "${zstd_LIBRARY}"
+                          INTERFACE_INCLUDE_DIRECTORIES "${zstd_INCLUDE_DIR}")
+endif()
+
+
+mark_as_advanced(zstd_PATH
+                 zstd_NO_DEFAULT_PATH
+                 zstd_INCLUDE_DIR
+                 zstd_LIBRARY)
@@ -14,13 +14,13 @@ macro(define_option DO_VAR DO_DESCRIPTION)
     set(DO_VALUE 0)
     if(${DO_VAR})
         set(DO_VALUE 1)
-    endif()
 
-    foreach(REQUIREMENT IN ITEMS ${DO_REQUIRES})
-        if(NOT ${REQUIREMENT})
-            message(FATAL_ERROR "${DO_DESCRIPTION} requires ${REQUIREMENT}")
-        endif()
-    endforeach()
+        foreach(REQUIREMENT IN ITEMS ${DO_REQUIRES})
+            if(NOT ${REQUIREMENT})
+                message(FATAL_ERROR "${DO_DESCRIPTION} requires ${REQUIREMENT}")
+            endif()
+        endforeach()
+    endif()
 
     if(DEFINED DO_TARGET)
         set(DO_INHERITANCE_OPTIONS PUBLIC PRIVATE INTERFACE)
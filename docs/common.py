@@ -90,6 +90,9 @@ cppreference_mapping = {
 
     'std::endian': 'types/endian',
 
+    'std::fstream': 'io/basic_fstream',
+    'std::stringstream': 'io/basic_stringstream',
+
     'std::tuple': 'utility/tuple'
 }
 
@@ -102,8 +105,11 @@ extern_mapping = {
     'Boost PFR':
         'https://www.boost.org/doc/libs/master/doc/html/boost_pfr.html',
     'ICU': 'https://icu.unicode.org/',
+    'LZ4': 'https://lz4.org/',
+    'zstd': 'https://facebook.github.io/zstd/',
 
     'Doxygen': 'https://www.doxygen.nl',
+    'Google Benchmark': 'https://github.com/google/benchmark',
     'Python': 'https://www.python.org'
 }
 
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/AsyncBinaryStream.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t messageCount = 10'000;
+
+using Stream = scppl::AsyncBinaryStream<std::endian::big>;
+
+auto writeMessages(Stream& stream, std::vector<char> const& payload)
+    -> scppl::Task<>
+{
+    auto length = static_cast<uint32_t>(std::ranges::size(payload));
+    for (std::size_t i = 0; i < messageCount; ++i)
+    {
+        co_await stream.write(static_cast<uint16_t>(i), length);
+        co_await stream.writeRaw(payload);
+    }
+}
+
+// A straight-line parser for messages with a type and a length prefix
+auto readMessages(Stream& stream)
+    -> scppl::Task<std::size_t>
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < messageCount; ++i)
+    {
+        auto [type, length] = co_await stream.read<uint16_t, uint32_t>();
+        auto payload = co_await stream.readRaw(length);
+
+        benchmark::DoNotOptimize(type);
+        total += std::ranges::size(payload);
+    }
+
+    co_return total;
+}
+
+}
+
+static void AsyncSocketPairMessages(benchmark::State& state)
+{
+    std::array<int, 2> sockets{};
+    ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0,
+                 std::ranges::data(sockets));
+
+    std::vector<char> payload(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+    {
+        scppl::Reactor reactor{};
+        Stream writer(reactor, sockets[0]);
+        Stream reader(reactor, sockets[1]);
+
+        reactor.spawn(writeMessages(writer, payload));
+        benchmark::DoNotOptimize(reactor.run(readMessages(reader)));
+    }
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 messageCount));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 messageCount *
+                                                 (6 + state.range(0))));
+}
+
+BENCHMARK(AsyncSocketPairMessages)->Arg(16)->Arg(1024)->Arg(64 << 10);
+#endif
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <random>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BatchFileStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+constexpr std::size_t blockLength = 4096;
+constexpr std::size_t blockCount = 16384;
+constexpr std::size_t readCount = 256;
+
+auto benchmarkPath()
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / "scppl_benchmark_batch";
+}
+
+void prepareFile()
+{
+    if (std::filesystem::exists(benchmarkPath()) &&
+        std::filesystem::file_size(benchmarkPath()) ==
+            blockLength * blockCount)
+    {
+        return;
+    }
+
+    std::vector<char> block(blockLength, 'x');
+    scppl::FileStream<> file(benchmarkPath(), std::ios::out | std::ios::trunc);
+    for (std::size_t i = 0; i < blockCount; ++i)
+        file.write(std::ranges::data(block), blockLength);
+}
+
+// Random block offsets, the same for every benchmark
+auto randomOffsets()
+    -> std::vector<std::size_t>
+{
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<std::size_t> distribution(0, blockCount - 1);
+
+    std::vector<std::size_t> offsets(readCount);
+    for (std::size_t& offset : offsets)
+        offset = distribution(generator) * blockLength;
+
+    return offsets;
+}
+
+struct Free
+{
+    void operator()(char* data) const { std::free(data); }
+};
+
+}
+
+// Queue depth 1, every read waits for the previous one
+static void FileStreamRandomReads(benchmark::State& state)
+{
+    prepareFile();
+    auto offsets = randomOffsets();
+
+    std::unique_ptr<scppl::FileStream<>> file{};
+    try
+    {
+        file = std::make_unique<scppl::FileStream<>>(
+            benchmarkPath(), std::ios::in,
+            scppl::FileStreamOptions{.direct = true});
+    }
+    catch (std::system_error const&)
+    {
+        state.SkipWithError("O_DIRECT is not supported");
+        return;
+    }
+
+    std::vector<char> block(blockLength);
+    for (auto _ : state)
+    {
+        for (std::size_t offset : offsets)
+        {
+            benchmark::DoNotOptimize(file->readAt(std::ranges::data(block),
+                                                  blockLength, offset));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 readCount));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 readCount * blockLength));
+}
+
+// All reads in one batch, with `range(0)` of them in flight
+template<scppl::BatchBackend tBackend>
+static void BatchRandomReads(benchmark::State& state)
+{
+    prepareFile();
+    auto offsets = randomOffsets();
+
+    std::unique_ptr<scppl::BatchFileStream<>> file{};
+    try
+    {
+        file = std::make_unique<scppl::BatchFileStream<>>(
+            benchmarkPath(), std::ios::in,
+            scppl::FileStreamOptions{.direct = true},
+            scppl::BatchFileOptions{
+                .queueDepth = static_cast<std::size_t>(state.range(0)),
+                .threads = static_cast<std::size_t>(state.range(0)),
+                .backend = tBackend});
+    }
+    catch (std::system_error const&)
+    {
+        state.SkipWithError("O_DIRECT or io_uring is not supported");
+        return;
+    }
+
+    std::unique_ptr<char, Free> memory(static_cast<char*>(
+        std::aligned_alloc(blockLength, readCount * blockLength)));
+    std::array<std::span<char>, 1> buffers{
+        std::span(memory.get(), readCount * blockLength)};
+    file->registerBuffers(buffers);
+
+    std::vector<scppl::FileRequest<char>> requests{};
+    for (std::size_t i = 0; i < readCount; ++i)
+    {
+        requests.push_back({.data = memory.get() + i * blockLength,
+                            .length = blockLength,
+                            .offset = offsets[i],
+                            .buffer = 0});
+    }
+
+    for (auto _ : state)
+    {
+        file->readBatch(requests);
+        benchmark::DoNotOptimize(std::ranges::data(requests));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 readCount));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 readCount * blockLength));
+}
+
+// The reads wait for the device, so the wall clock is what matters
+BENCHMARK(FileStreamRandomReads)->UseRealTime();
+BENCHMARK(BatchRandomReads<scppl::BatchBackend::IoUring>)
+    ->Arg(1)->Arg(8)->Arg(32)->Arg(64)->UseRealTime();
+BENCHMARK(BatchRandomReads<scppl::BatchBackend::ThreadPool>)
+    ->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+#endif
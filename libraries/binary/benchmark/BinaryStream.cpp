@@ -0,0 +1,326 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+namespace {
+
+auto makeFloats(std::size_t count)
+    -> std::vector<char>
+{
+    std::vector<float> values(count, 0.5F);
+
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+    stream.writeArray<float>(values);
+
+    return bufferStream.release();
+}
+
+constexpr std::size_t frameCount = 10'000;
+
+auto makeFrames(std::size_t length)
+    -> std::vector<char>
+{
+    std::vector<char> payload(length, 'x');
+
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+    for (std::size_t i = 0; i < frameCount; ++i)
+        stream.writeFrame(payload);
+
+    return bufferStream.release();
+}
+
+// Tagged records, a `uint8_t` tag followed by two values
+auto makeTagged()
+    -> std::string
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    for (std::size_t i = 0; i < frameCount; ++i)
+        stream.write(static_cast<uint8_t>(i % 4), static_cast<uint32_t>(i),
+                     0.5);
+
+    return stringstream.str();
+}
+
+// Records of which only the `uint32_t` in the middle is needed
+auto makeSparse()
+    -> std::string
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    for (std::size_t i = 0; i < frameCount; ++i)
+    {
+        stream.write(0.5, static_cast<uint64_t>(i), static_cast<uint32_t>(i),
+                     0.5, 0.5);
+    }
+
+    return stringstream.str();
+}
+
+// Newline-separated records of `range(0)` characters
+auto makeLines(std::size_t length)
+    -> std::string
+{
+    std::string lines{};
+    for (std::size_t i = 0; i < frameCount; ++i)
+        lines.append(length, 'x').push_back('\n');
+
+    return lines;
+}
+
+void setBytes(benchmark::State& state)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 state.range(0) *
+                                                 sizeof(float)));
+}
+
+}
+
+static void RawRead(benchmark::State& state)
+{
+    auto data = makeFloats(static_cast<std::size_t>(state.range(0)));
+    std::vector<char> values(std::ranges::size(data));
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        spanStream.read(std::ranges::data(values), std::ranges::size(values));
+        benchmark::DoNotOptimize(std::ranges::data(values));
+    }
+
+    setBytes(state);
+}
+
+static void ReadSingleLoop(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    auto data = makeFloats(count);
+    std::vector<float> values(count);
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+        for (float& value : values)
+            value = stream.readSingle<float>();
+
+        benchmark::DoNotOptimize(std::ranges::data(values));
+    }
+
+    setBytes(state);
+}
+
+static void ReadArray(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    auto data = makeFloats(count);
+    std::vector<float> values(count);
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+        stream.readArray<float>(values);
+
+        benchmark::DoNotOptimize(std::ranges::data(values));
+    }
+
+    setBytes(state);
+}
+
+static void WriteArray(benchmark::State& state)
+{
+    std::vector<float> values(static_cast<std::size_t>(state.range(0)), 0.5F);
+    for (auto _ : state)
+    {
+        scppl::BufferStream<> bufferStream{};
+        scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+        stream.writeArray<float>(values);
+
+        benchmark::DoNotOptimize(bufferStream.release());
+    }
+
+    setBytes(state);
+}
+
+// Length-prefixed messages the way they are read without `readFrame()`
+static void ReadSingleReadRawFrames(benchmark::State& state)
+{
+    auto data = makeFrames(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            auto length = stream.readSingle<uint32_t>();
+            benchmark::DoNotOptimize(stream.readRaw(length));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+static void ReadFrames(benchmark::State& state)
+{
+    auto data = makeFrames(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+        for (std::size_t i = 0; i < frameCount; ++i)
+            benchmark::DoNotOptimize(stream.readFrame());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+// Looking at the tag before choosing a decoder, by seeking back
+static void ReadSeekBackTags(benchmark::State& state)
+{
+    std::stringstream stringstream(makeTagged());
+    for (auto _ : state)
+    {
+        scppl::BinaryStream<std::endian::big> stream(stringstream);
+        stream.toBegin();
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            std::size_t position = stream.tellInput();
+            benchmark::DoNotOptimize(stream.readSingle<uint8_t>());
+            stream.seekInput(position, std::ios::beg);
+
+            benchmark::DoNotOptimize(
+                stream.read<uint8_t, uint32_t, double>());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+static void PeekTags(benchmark::State& state)
+{
+    std::stringstream stringstream(makeTagged());
+    for (auto _ : state)
+    {
+        scppl::BinaryStream<std::endian::big> stream(stringstream);
+        stream.toBegin();
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            benchmark::DoNotOptimize(stream.peekSingle<uint8_t>());
+            benchmark::DoNotOptimize(
+                stream.read<uint8_t, uint32_t, double>());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+// Skipping the other fields by reading and discarding them
+static void ReadDiscardSparse(benchmark::State& state)
+{
+    std::stringstream stringstream(makeSparse());
+    for (auto _ : state)
+    {
+        scppl::BinaryStream<std::endian::big> stream(stringstream);
+        stream.toBegin();
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            benchmark::DoNotOptimize(stream.read<double, uint64_t>());
+            benchmark::DoNotOptimize(stream.readSingle<uint32_t>());
+            benchmark::DoNotOptimize(stream.readRaw(2 * sizeof(double)));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+static void SkipSparse(benchmark::State& state)
+{
+    std::stringstream stringstream(makeSparse());
+    for (auto _ : state)
+    {
+        scppl::BinaryStream<std::endian::big> stream(stringstream);
+        stream.toBegin();
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            stream.skip<double, uint64_t>();
+            benchmark::DoNotOptimize(stream.readSingle<uint32_t>());
+            stream.skip<double>(2);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 frameCount));
+}
+
+// Searching for the end of a line one value at a time
+static void ReadSingleLines(benchmark::State& state)
+{
+    auto data = makeLines(static_cast<std::size_t>(state.range(0)));
+    std::string line{};
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream{std::span<char const>(data)};
+        scppl::SpanBinaryStream<> stream(spanStream);
+        for (std::size_t i = 0; i < frameCount; ++i)
+        {
+            line.clear();
+            for (char c = stream.readSingle<char>(); c != '\n';
+                 c = stream.readSingle<char>())
+            {
+                line.push_back(c);
+            }
+
+            benchmark::DoNotOptimize(std::ranges::data(line));
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 std::ranges::size(data)));
+}
+
+static void ReadUntilLines(benchmark::State& state)
+{
+    auto data = makeLines(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream{std::span<char const>(data)};
+        scppl::SpanBinaryStream<> stream(spanStream);
+        for (std::size_t i = 0; i < frameCount; ++i)
+            benchmark::DoNotOptimize(stream.readUntil('\n'));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 std::ranges::size(data)));
+}
+
+BENCHMARK(RawRead)->Arg(1 << 20);
+BENCHMARK(ReadSingleLoop)->Arg(1 << 20);
+BENCHMARK(ReadArray)->Arg(1 << 20);
+BENCHMARK(WriteArray)->Arg(1 << 20);
+BENCHMARK(ReadSingleReadRawFrames)->Arg(64)->Arg(4096);
+BENCHMARK(ReadFrames)->Arg(64)->Arg(4096);
+BENCHMARK(ReadSeekBackTags);
+BENCHMARK(PeekTags);
+BENCHMARK(ReadDiscardSparse);
+BENCHMARK(SkipSparse);
+BENCHMARK(ReadSingleLines)->Arg(16)->Arg(256);
+BENCHMARK(ReadUntilLines)->Arg(16)->Arg(256);
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BlockCache.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+constexpr std::size_t fileLength = std::size_t{64} << 20;
+constexpr std::size_t recordLength = 64;
+
+auto filePath() -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / "scppl_benchmark_cache";
+}
+
+void prepareFile()
+{
+    std::vector<char> data(fileLength, 'c');
+
+    scppl::FileStream<> file(filePath(), std::ios::out | std::ios::trunc);
+    file.write(data.data(), data.size());
+}
+
+}
+
+// Random records straight from the file, every read refills the buffer
+static void UncachedRandomRead(benchmark::State& state)
+{
+    prepareFile();
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(
+        0, fileLength / recordLength - 1);
+
+    scppl::FileStream<> file(filePath(), std::ios::in, {.bufferSize = 4096});
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (auto _ : state)
+    {
+        stream.seek(pick(random) * recordLength, std::ios::beg);
+        benchmark::DoNotOptimize(stream.peekRaw(recordLength).data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordLength));
+    std::filesystem::remove(filePath());
+}
+
+// The same reads through a cache of `state.range(0)` MiB
+static void CachedRandomRead(benchmark::State& state)
+{
+    prepareFile();
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(
+        0, fileLength / recordLength - 1);
+
+    scppl::FileStream<> file(filePath(), std::ios::in);
+    scppl::BlockCache<> cache({
+        .capacity = static_cast<std::size_t>(state.range(0)) << 20,
+        .blockSize = 4096
+    });
+    scppl::CachedStream cached(file, cache, 1);
+    scppl::CachedBinaryStream<scppl::FileStream<>,
+                              std::endian::little> stream(cached);
+    for (auto _ : state)
+    {
+        stream.seek(pick(random) * recordLength, std::ios::beg);
+        benchmark::DoNotOptimize(stream.peekRaw(recordLength).data());
+    }
+
+    auto stats = cache.stats();
+    state.counters["hit_rate"] = static_cast<double>(stats.hits) /
+                                 static_cast<double>(stats.hits +
+                                                     stats.misses);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordLength));
+    std::filesystem::remove(filePath());
+}
+
+BENCHMARK(UncachedRandomRead);
+BENCHMARK(CachedRandomRead)->Arg(16)->Arg(128);
+#endif
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <ios>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BlockFile.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+constexpr std::size_t recordCount = 200000;
+
+auto benchmarkPath(char const* name)
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+auto makeKey(std::size_t index)
+    -> std::string
+{
+    char key[16]{};
+    std::snprintf(key, sizeof(key), "key%08zu", index);
+
+    return key;
+}
+
+// The same records as plain frames, read front-to-back, and as a block file
+void prepareFiles()
+{
+    std::string value(64, 'v');
+
+    scppl::FileStream<> plainFile(benchmarkPath("scppl_benchmark_plain"),
+                                  std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> plain(plainFile);
+
+    scppl::FileStream<> blockFile(benchmarkPath("scppl_benchmark_blocks"),
+                                  std::ios::out | std::ios::trunc);
+    scppl::BlockFileWriter<scppl::FileStream<>> writer(blockFile);
+
+    for (std::size_t i = 0; i < recordCount; ++i)
+    {
+        std::string key = makeKey(i);
+        plain.writeFrame<scppl::FramePrefix::Varint>(
+            std::span<char const>(key));
+        plain.writeFrame<scppl::FramePrefix::Varint>(
+            std::span<char const>(value));
+        writer.add(std::span<char const>(key), std::span<char const>(value));
+    }
+}
+
+void finish()
+{
+    std::filesystem::remove(benchmarkPath("scppl_benchmark_plain"));
+    std::filesystem::remove(benchmarkPath("scppl_benchmark_blocks"));
+}
+
+}
+
+// Open the file and read records until the one near the end is found
+static void ScanForRecord(benchmark::State& state)
+{
+    prepareFiles();
+    std::string wanted = makeKey(recordCount - 10);
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath("scppl_benchmark_plain"),
+                                 std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        while (true)
+        {
+            auto key = stream.readFrame<scppl::FramePrefix::Varint>();
+            if (stream.eof())
+                break;
+
+            auto value = stream.readFrame<scppl::FramePrefix::Varint>();
+            if (std::string_view(key.data(), key.size()) == wanted)
+            {
+                benchmark::DoNotOptimize(value.data());
+                break;
+            }
+        }
+    }
+
+    finish();
+}
+
+// Open the file, read the footer and index, and read only the right block
+static void BlockFileFind(benchmark::State& state)
+{
+    prepareFiles();
+    std::string wanted = makeKey(recordCount - 10);
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath("scppl_benchmark_blocks"),
+                                 std::ios::in);
+        scppl::BlockFileReader<scppl::FileStream<>> reader(file);
+        benchmark::DoNotOptimize(reader.find(std::span<char const>(wanted)));
+    }
+
+    finish();
+}
+
+// Lookups in a file that is already open, the index stays loaded
+static void BlockFileFindOpen(benchmark::State& state)
+{
+    prepareFiles();
+    std::string wanted = makeKey(recordCount - 10);
+    {
+        scppl::FileStream<> file(benchmarkPath("scppl_benchmark_blocks"),
+                                 std::ios::in);
+        scppl::BlockFileReader<scppl::FileStream<>> reader(file);
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(reader.find(
+                std::span<char const>(wanted)));
+        }
+    }
+
+    finish();
+}
+
+BENCHMARK(ScanForRecord);
+BENCHMARK(BlockFileFind);
+BENCHMARK(BlockFileFindOpen);
+#endif
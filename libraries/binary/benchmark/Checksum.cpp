@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/ChecksumStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+namespace {
+
+auto makeData(std::size_t length)
+    -> std::vector<char>
+{
+    std::vector<char> data(length);
+    for (std::size_t i = 0; i < length; ++i)
+        data[i] = static_cast<char>(i * 31 + i / 97);
+
+    return data;
+}
+
+constexpr std::size_t recordCount = 100000;
+
+}
+
+static void Crc32cSoftware(benchmark::State& state)
+{
+    std::vector<char> data = makeData(static_cast<std::size_t>(
+        state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            scppl::crc32cSoftware(std::span<char const>(data)));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+}
+
+static void Crc32cHardware(benchmark::State& state)
+{
+    std::vector<char> data = makeData(static_cast<std::size_t>(
+        state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            scppl::crc32cHardware(std::span<char const>(data)));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+}
+
+static void XxHash64(benchmark::State& state)
+{
+    std::vector<char> data = makeData(static_cast<std::size_t>(
+        state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(scppl::xxHash64(std::span<char const>(data)));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+}
+
+// Write records, then calculate the checksum over the written buffer
+static void WriteThenChecksum(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        scppl::BufferStream<> buffer{};
+        scppl::BinaryStream<std::endian::little, true,
+                            scppl::BufferStream<>> stream(buffer);
+        for (std::size_t i = 0; i < recordCount; ++i)
+            stream.write(std::uint64_t{i}, std::uint32_t{7}, double{1.5});
+
+        benchmark::DoNotOptimize(scppl::crc32c(buffer.data()));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordCount));
+}
+
+// The same records, with the checksum calculated while writing
+static void WriteWithChecksum(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        scppl::BufferStream<> buffer{};
+        scppl::ChecksumStream checksummed(buffer);
+        scppl::ChecksumBinaryStream<scppl::BufferStream<>,
+                                    std::endian::little> stream(checksummed);
+        for (std::size_t i = 0; i < recordCount; ++i)
+            stream.write(std::uint64_t{i}, std::uint32_t{7}, double{1.5});
+
+        benchmark::DoNotOptimize(checksummed.value());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordCount));
+}
+
+BENCHMARK(Crc32cSoftware)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(Crc32cHardware)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(XxHash64)->Arg(64)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(WriteThenChecksum)->Unit(benchmark::kMicrosecond);
+BENCHMARK(WriteWithChecksum)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/CoalescingStream.hpp"
+
+namespace {
+
+// An unbuffered sink doing a `write` system call for every write
+class DescriptorSink
+{
+public:
+    DescriptorSink() :
+        mDescriptor(::open("/dev/null", O_WRONLY | O_CLOEXEC))
+    {
+        //
+    }
+
+    DescriptorSink(DescriptorSink const&) = delete;
+    DescriptorSink(DescriptorSink&&) = delete;
+
+    ~DescriptorSink()
+    {
+        ::close(mDescriptor);
+    }
+
+    auto operator=(DescriptorSink const&) -> DescriptorSink& = delete;
+    auto operator=(DescriptorSink&&) -> DescriptorSink& = delete;
+
+    void write(char const* data, std::size_t length)
+    {
+        benchmark::DoNotOptimize(::write(mDescriptor, data, length));
+        ++mCalls;
+    }
+
+    auto calls() const -> std::size_t { return mCalls; }
+
+private:
+    int mDescriptor{-1};
+    std::size_t mCalls{};
+};
+
+template<typename BinaryStreamT>
+void writeRecords(BinaryStreamT& stream, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        stream.write(static_cast<uint32_t>(i), static_cast<uint64_t>(i), 0.5);
+}
+
+void finish(benchmark::State& state, DescriptorSink const& sink)
+{
+    auto records = static_cast<double>(state.iterations() * state.range(0));
+    state.counters["syscalls/record"] =
+        static_cast<double>(sink.calls()) / records;
+    state.SetItemsProcessed(static_cast<int64_t>(records));
+}
+
+}
+
+static void UnbufferedWrite(benchmark::State& state)
+{
+    DescriptorSink sink{};
+    for (auto _ : state)
+    {
+        scppl::BinaryOutputStream<std::endian::little, true, DescriptorSink>
+            stream(sink);
+        writeRecords(stream, static_cast<std::size_t>(state.range(0)));
+    }
+
+    finish(state, sink);
+}
+
+static void CoalescedWrite(benchmark::State& state)
+{
+    DescriptorSink sink{};
+    for (auto _ : state)
+    {
+        scppl::CoalescingStream<DescriptorSink> coalescing(sink);
+        scppl::CoalescingBinaryStream<DescriptorSink, std::endian::little>
+            stream(coalescing);
+        writeRecords(stream, static_cast<std::size_t>(state.range(0)));
+    }
+
+    finish(state, sink);
+}
+
+BENCHMARK(UnbufferedWrite)->Arg(1 << 16);
+BENCHMARK(CoalescedWrite)->Arg(1 << 16);
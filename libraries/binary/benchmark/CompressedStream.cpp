@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/CompressedStream.hpp"
+#include "scppl/binary/Compression.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+namespace {
+
+constexpr std::size_t dataLength = std::size_t{16} << 20;
+constexpr std::size_t recordLength = 64;
+
+// Log-like lines, which compress about 5 times with the built-in codec
+auto makeData()
+    -> std::vector<char>
+{
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> pick(0, 9999);
+
+    std::vector<char> data{};
+    data.reserve(dataLength);
+    for (std::size_t i = 0; std::ranges::size(data) < dataLength; ++i)
+    {
+        std::string line = "2022-01-01T00:00:" + std::to_string(i % 60) +
+                           " INFO request=" + std::to_string(pick(random)) +
+                           " status=200 path=/api/items/" +
+                           std::to_string(pick(random) % 100) + "\n";
+        data.insert(std::ranges::end(data), std::ranges::begin(line),
+                    std::ranges::end(line));
+    }
+
+    data.resize(dataLength);
+
+    return data;
+}
+
+}
+
+static void LzCompress(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    std::span<char const> block = std::span<char const>(data).first(
+        std::size_t{1} << 16);
+
+    std::vector<std::uint32_t> table(scppl::lzHashLength);
+    std::vector<char> output(scppl::lzCompressBound(block.size()));
+    std::size_t length = 0;
+    for (auto _ : state)
+    {
+        length = scppl::lzCompress(block, std::span<char>(output),
+                                   std::span(table));
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 block.size()));
+    state.counters["ratio"] = static_cast<double>(block.size()) /
+                              static_cast<double>(length);
+}
+
+static void LzDecompress(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    std::span<char const> block = std::span<char const>(data).first(
+        std::size_t{1} << 16);
+
+    std::vector<std::uint32_t> table(scppl::lzHashLength);
+    std::vector<char> compressed(scppl::lzCompressBound(block.size()));
+    compressed.resize(scppl::lzCompress(block, std::span<char>(compressed),
+                                        std::span(table)));
+
+    std::vector<char> output(block.size());
+    for (auto _ : state)
+    {
+        scppl::lzDecompress(std::span<char const>(compressed),
+                            std::span<char>(output));
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 block.size()));
+}
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+auto filePath() -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() /
+           "scppl_benchmark_compressed";
+}
+
+void writeCompressed(std::vector<char> const& data)
+{
+    scppl::FileStream<> file(filePath(), std::ios::out | std::ios::trunc);
+    scppl::CompressedStreamWriter<scppl::FileStream<>> writer(file);
+    writer.write(data.data(), data.size());
+}
+
+}
+
+// Write the data to a file as is
+static void WriteUncompressed(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(filePath(), std::ios::out | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+    state.counters["written"] = static_cast<double>(data.size());
+    std::filesystem::remove(filePath());
+}
+
+// The same data compressed in blocks, fewer bytes reach the file
+static void WriteCompressed(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    for (auto _ : state)
+        writeCompressed(data);
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+    state.counters["written"] = static_cast<double>(
+        std::filesystem::file_size(filePath()));
+    std::filesystem::remove(filePath());
+}
+
+// Read all data back, decompressing every block
+static void ReadCompressed(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    writeCompressed(data);
+
+    std::vector<char> read(data.size());
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(filePath(), std::ios::in);
+        scppl::CompressedStreamReader<scppl::FileStream<>> reader(file);
+        benchmark::DoNotOptimize(reader.read(read.data(), read.size()));
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 data.size()));
+    std::filesystem::remove(filePath());
+}
+
+// Random records, every seek to another block decompresses it
+static void CompressedRandomRead(benchmark::State& state)
+{
+    std::vector<char> data = makeData();
+    writeCompressed(data);
+
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(
+        0, dataLength / recordLength - 1);
+
+    scppl::FileStream<> file(filePath(), std::ios::in);
+    scppl::CompressedStreamReader<scppl::FileStream<>> reader(file);
+    scppl::CompressedBinaryInputStream<scppl::FileStream<>,
+                                       std::endian::little> stream(reader);
+    for (auto _ : state)
+    {
+        stream.toBegin(pick(random) * recordLength);
+        benchmark::DoNotOptimize(stream.peekRaw(recordLength).data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordLength));
+    std::filesystem::remove(filePath());
+}
+#endif
+
+BENCHMARK(LzCompress);
+BENCHMARK(LzDecompress);
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+BENCHMARK(WriteUncompressed)->Unit(benchmark::kMillisecond);
+BENCHMARK(WriteCompressed)->Unit(benchmark::kMillisecond);
+BENCHMARK(ReadCompressed)->Unit(benchmark::kMillisecond);
+BENCHMARK(CompressedRandomRead)->Unit(benchmark::kMicrosecond);
+#endif
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/DynamicEndianBinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordCount = 1 << 16;
+
+// A byte order mark like TIFF, followed by records of a `uint32_t`, a
+// `uint16_t` and a `double`
+auto makeRecords()
+    -> std::vector<char>
+{
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+    stream.write('M');
+    for (std::size_t i = 0; i < recordCount; ++i)
+        stream.write(static_cast<uint32_t>(i), static_cast<uint16_t>(i), 0.5);
+
+    return bufferStream.release();
+}
+
+using DynamicStream = scppl::DynamicEndianBinaryStream<true,
+                                                       scppl::SpanStream<>>;
+
+// Reads the byte order mark, so the endian is only known at runtime
+template<typename BinaryStreamT>
+auto open(scppl::SpanStream<>& spanStream)
+    -> BinaryStreamT
+{
+    BinaryStreamT stream(spanStream);
+    if constexpr(std::is_same_v<BinaryStreamT, DynamicStream>)
+    {
+        stream.setEndian((stream.template readSingle<char>() == 'M')
+                             ? std::endian::big : std::endian::little);
+    }
+    else
+    {
+        stream.template readSingle<char>();
+    }
+
+    return stream;
+}
+
+void setItems(benchmark::State& state, std::size_t count)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 count));
+}
+
+}
+
+// One field per call, the worst case for checking the endian every call
+template<typename BinaryStreamT>
+static void ReadSingleFields(benchmark::State& state)
+{
+    auto data = makeRecords();
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        auto stream = open<BinaryStreamT>(spanStream);
+        for (std::size_t i = 0; i < recordCount; ++i)
+        {
+            benchmark::DoNotOptimize(stream.template readSingle<uint32_t>());
+            benchmark::DoNotOptimize(stream.template readSingle<uint16_t>());
+            benchmark::DoNotOptimize(stream.template readSingle<double>());
+        }
+    }
+
+    setItems(state, recordCount);
+}
+
+template<typename BinaryStreamT>
+static void ReadRecords(benchmark::State& state)
+{
+    auto data = makeRecords();
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        auto stream = open<BinaryStreamT>(spanStream);
+        for (std::size_t i = 0; i < recordCount; ++i)
+        {
+            benchmark::DoNotOptimize(
+                stream.template read<uint32_t, uint16_t, double>());
+        }
+    }
+
+    setItems(state, recordCount);
+}
+
+template<typename BinaryStreamT>
+static void ReadArrayRecords(benchmark::State& state)
+{
+    auto data = makeRecords();
+    std::vector<uint32_t> values(std::ranges::size(data) / sizeof(uint32_t));
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(data);
+        auto stream = open<BinaryStreamT>(spanStream);
+        stream.template readArray<uint32_t>(std::span<uint32_t>(values));
+
+        benchmark::DoNotOptimize(std::ranges::data(values));
+    }
+
+    setItems(state, std::ranges::size(values));
+}
+
+using StaticStream = scppl::SpanBinaryStream<std::endian::big>;
+
+BENCHMARK(ReadSingleFields<StaticStream>);
+BENCHMARK(ReadSingleFields<DynamicStream>);
+BENCHMARK(ReadRecords<StaticStream>);
+BENCHMARK(ReadRecords<DynamicStream>);
+BENCHMARK(ReadArrayRecords<StaticStream>);
+BENCHMARK(ReadArrayRecords<DynamicStream>);
@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/CopyRange.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordLength = scppl::lengthOf<uint32_t, uint64_t,
+                                                     double>();
+
+auto benchmarkPath()
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / "scppl_benchmark_file";
+}
+
+template<typename BinaryStreamT>
+void writeRecords(BinaryStreamT& stream, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        stream.write(static_cast<uint32_t>(i), static_cast<uint64_t>(i), 0.5);
+}
+
+template<typename BinaryStreamT>
+void readRecords(BinaryStreamT& stream, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        benchmark::DoNotOptimize(stream.template read<uint32_t, uint64_t,
+                                                      double>());
+}
+
+template<typename BinaryStreamT>
+void readRecordRange(BinaryStreamT& stream)
+{
+    for (auto record : stream.template records<uint32_t, uint64_t, double>())
+        benchmark::DoNotOptimize(record);
+}
+
+void prepareFile(std::size_t count)
+{
+    std::ofstream file(benchmarkPath(), std::ios::binary | std::ios::trunc);
+    scppl::BinaryOutputStream<std::endian::little> stream(file);
+    writeRecords(stream, count);
+}
+
+void finish(benchmark::State& state)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 state.range(0) *
+                                                 recordLength));
+    std::filesystem::remove(benchmarkPath());
+}
+
+}
+
+static void FStreamWrite(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::ofstream file(benchmarkPath(), std::ios::binary | std::ios::trunc);
+        scppl::BinaryOutputStream<std::endian::little> stream(file);
+        writeRecords(stream, count);
+    }
+
+    finish(state);
+}
+
+static void FileStreamWrite(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(),
+                                 std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        writeRecords(stream, count);
+    }
+
+    finish(state);
+}
+
+static void FStreamRead(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    prepareFile(count);
+    for (auto _ : state)
+    {
+        std::ifstream file(benchmarkPath(), std::ios::binary);
+        scppl::BinaryInputStream<std::endian::little> stream(file);
+        readRecords(stream, count);
+    }
+
+    finish(state);
+}
+
+static void FileStreamRead(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    prepareFile(count);
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        readRecords(stream, count);
+    }
+
+    finish(state);
+}
+
+static void FStreamRecords(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::ifstream file(benchmarkPath(), std::ios::binary);
+        scppl::BinaryInputStream<std::endian::little> stream(file);
+        readRecordRange(stream);
+    }
+
+    finish(state);
+}
+
+static void FileStreamRecords(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        readRecordRange(stream);
+    }
+
+    finish(state);
+}
+
+static void FileStreamReadAt(benchmark::State& state)
+{
+    constexpr std::size_t count = 1 << 16;
+
+    // One stream shared by all threads, like an index lookup service
+    static scppl::FileStream<> file = []() -> scppl::FileStream<>
+    {
+        prepareFile(count);
+        return scppl::FileStream<>(benchmarkPath(), std::ios::in);
+    }();
+    static scppl::FileBinaryStream<std::endian::little> stream(file);
+
+    std::minstd_rand random(static_cast<unsigned>(state.thread_index()));
+    for (auto _ : state)
+    {
+        std::size_t offset = (random() % count) * recordLength;
+        benchmark::DoNotOptimize(stream.readAt<uint32_t, uint64_t,
+                                               double>(offset));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void FileStreamConcatenatedWrite(benchmark::State& state)
+{
+    std::vector<char> payload(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(),
+                                 std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            auto header = scppl::Binary<std::endian::little>::pack(
+                static_cast<uint32_t>(i), static_cast<uint64_t>(i));
+            std::vector<char> frame(std::ranges::begin(header),
+                                    std::ranges::end(header));
+            frame.insert(std::ranges::end(frame), std::ranges::begin(payload),
+                         std::ranges::end(payload));
+            stream.writeRaw(frame);
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 64 *
+                                                 state.range(0)));
+    std::filesystem::remove(benchmarkPath());
+}
+
+static void FileStreamGatherWrite(benchmark::State& state)
+{
+    std::vector<char> payload(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(),
+                                 std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            auto header = scppl::Binary<std::endian::little>::pack(
+                static_cast<uint32_t>(i), static_cast<uint64_t>(i));
+            stream.writeGather(header, payload);
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 64 *
+                                                 state.range(0)));
+    std::filesystem::remove(benchmarkPath());
+}
+
+static void FileStreamCopyVectors(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    prepareFile(count);
+    std::filesystem::path copyPath = benchmarkPath().concat(".copy");
+    for (auto _ : state)
+    {
+        scppl::FileStream<> input(benchmarkPath(), std::ios::in);
+        scppl::FileBinaryStream<> source(input);
+        scppl::FileStream<> output(copyPath, std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<> destination(output);
+
+        for (std::size_t done = 0; done < count * recordLength;
+             done += scppl::copyBufferSize)
+        {
+            destination.writeRaw(source.readRaw(
+                std::min(scppl::copyBufferSize, count * recordLength - done)));
+        }
+    }
+
+    finish(state);
+    std::filesystem::remove(copyPath);
+}
+
+static void FileStreamCopyRange(benchmark::State& state)
+{
+    auto count = static_cast<std::size_t>(state.range(0));
+    prepareFile(count);
+    std::filesystem::path copyPath = benchmarkPath().concat(".copy");
+    for (auto _ : state)
+    {
+        scppl::FileStream<> input(benchmarkPath(), std::ios::in);
+        scppl::FileBinaryStream<> source(input);
+        scppl::FileStream<> output(copyPath, std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<> destination(output);
+
+        scppl::copyRange(source, destination, count * recordLength);
+    }
+
+    finish(state);
+    std::filesystem::remove(copyPath);
+}
+
+BENCHMARK(FStreamWrite)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FileStreamWrite)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FStreamRead)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FileStreamRead)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FStreamRecords)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FileStreamRecords)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(FileStreamReadAt)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(FileStreamConcatenatedWrite)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(FileStreamGatherWrite)->Arg(1 << 12)->Arg(1 << 22);
+BENCHMARK(FileStreamCopyVectors)->Arg(1 << 22);
+BENCHMARK(FileStreamCopyRange)->Arg(1 << 22);
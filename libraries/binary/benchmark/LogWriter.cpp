@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/LogWriter.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+constexpr std::size_t recordLength = 64;
+constexpr std::size_t recordsPerWriter = 256;
+
+// tmpfs, where `fdatasync` is nearly free, and the disk of the temporary
+// directory, where it is not
+auto benchmarkPath(bool memory)
+    -> std::filesystem::path
+{
+    std::filesystem::path directory =
+        memory ? std::filesystem::path("/dev/shm")
+               : std::filesystem::temp_directory_path();
+
+    return directory / "scppl_benchmark_log";
+}
+
+void finish(benchmark::State& state, std::size_t writers, bool memory)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 writers * recordsPerWriter));
+    std::filesystem::remove(benchmarkPath(memory));
+}
+
+}
+
+// One `fdatasync` per record, what group commit is compared against
+static void SyncEveryRecord(benchmark::State& state, bool memory)
+{
+    std::filesystem::remove(benchmarkPath(memory));
+    std::vector<char> payload(recordLength, 'x');
+    scppl::FileStream<> file(benchmarkPath(memory),
+                             std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < recordsPerWriter; ++i)
+        {
+            auto header = scppl::Binary<std::endian::little>::pack(
+                uint32_t{0}, static_cast<uint32_t>(recordLength));
+            stream.writeGather(header, payload);
+            file.sync();
+        }
+    }
+
+    finish(state, 1, memory);
+}
+
+// Concurrent writers each appending and committing one record at a time
+static void GroupCommit(benchmark::State& state, bool memory)
+{
+    std::filesystem::remove(benchmarkPath(memory));
+    auto writers = static_cast<std::size_t>(state.range(1));
+    std::vector<char> payload(recordLength, 'x');
+    scppl::LogWriter<> log(benchmarkPath(memory),
+                           {.commitWindow = std::chrono::microseconds(
+                                state.range(0))});
+    for (auto _ : state)
+    {
+        std::vector<std::thread> threads{};
+        for (std::size_t writer = 0; writer < writers; ++writer)
+        {
+            threads.emplace_back([&log, &payload]() {
+                for (std::size_t i = 0; i < recordsPerWriter; ++i)
+                    log.commit(log.append(std::span<char const>(payload)));
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    finish(state, writers, memory);
+}
+
+BENCHMARK_CAPTURE(SyncEveryRecord, tmpfs, true)->UseRealTime();
+BENCHMARK_CAPTURE(SyncEveryRecord, disk, false)->UseRealTime();
+BENCHMARK_CAPTURE(GroupCommit, tmpfs, true)
+    ->ArgsProduct({{0, 50, 500}, {1, 8, 64}})->UseRealTime();
+BENCHMARK_CAPTURE(GroupCommit, disk, false)
+    ->ArgsProduct({{0, 50, 500}, {1, 8, 64}})->UseRealTime();
+#endif
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <random>
+#include <span>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/OffsetIndex.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+constexpr std::size_t recordCount = 1000000;
+
+auto benchmarkPath(char const* name)
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+auto recordsPath() -> std::filesystem::path
+{
+    return benchmarkPath("scppl_benchmark_records");
+}
+
+auto sidecarPath() -> std::filesystem::path
+{
+    return benchmarkPath("scppl_benchmark_records.idx");
+}
+
+// Records of 10 to 90 bytes, as frames or as lines
+void prepareRecords(bool lines)
+{
+    std::mt19937 random(42);
+    std::uniform_int_distribution<std::size_t> length(10, 90);
+
+    scppl::FileStream<> file(recordsPath(), std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (std::size_t i = 0; i < recordCount; ++i)
+    {
+        std::string record(length(random), 'r');
+        if (lines)
+        {
+            record.back() = '\n';
+            stream.writeRaw(record);
+        }
+        else
+        {
+            stream.writeFrame<scppl::FramePrefix::Varint>(
+                std::span<char const>(record));
+        }
+    }
+}
+
+void finish(benchmark::State& state)
+{
+    state.counters["sidecar_bytes_per_record"] = static_cast<double>(
+        std::filesystem::file_size(sidecarPath())) / recordCount;
+
+    std::filesystem::remove(recordsPath());
+    std::filesystem::remove(sidecarPath());
+}
+
+}
+
+static void BuildFrameIndex(benchmark::State& state)
+{
+    prepareRecords(false);
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(recordsPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        benchmark::DoNotOptimize(
+            scppl::buildOffsetIndex<scppl::FramePrefix::Varint>(
+                stream, sidecarPath()));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordCount));
+    finish(state);
+}
+
+static void BuildDelimitedIndex(benchmark::State& state)
+{
+    prepareRecords(true);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scppl::buildDelimitedOffsetIndex(
+            recordsPath(), '\n', sidecarPath(),
+            {.threads = static_cast<std::size_t>(state.range(0))}));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordCount));
+    finish(state);
+}
+
+// Read record N by reading every record before it
+static void ScanToRecord(benchmark::State& state)
+{
+    prepareRecords(false);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(0, recordCount - 1);
+    {
+        scppl::FileStream<> file(recordsPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        scppl::buildOffsetIndex<scppl::FramePrefix::Varint>(stream,
+                                                            sidecarPath());
+    }
+
+    scppl::FileStream<> file(recordsPath(), std::ios::in);
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (auto _ : state)
+    {
+        stream.seek(0, std::ios::beg);
+        std::size_t wanted = pick(random);
+        for (std::size_t i = 0; i < wanted; ++i)
+            stream.readFrame<scppl::FramePrefix::Varint>();
+
+        benchmark::DoNotOptimize(
+            stream.readFrame<scppl::FramePrefix::Varint>().data());
+    }
+
+    finish(state);
+}
+
+// Read record N by looking up its offset in the mapped sidecar
+static void SeekWithIndex(benchmark::State& state)
+{
+    prepareRecords(false);
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(0, recordCount - 1);
+    {
+        scppl::FileStream<> file(recordsPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        scppl::buildOffsetIndex<scppl::FramePrefix::Varint>(stream,
+                                                            sidecarPath());
+    }
+
+    // A small buffer, every seek refills it
+    scppl::OffsetIndex index(sidecarPath());
+    scppl::FileStream<> file(recordsPath(), std::ios::in, {.bufferSize = 4096});
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (auto _ : state)
+    {
+        stream.seek(index[pick(random)], std::ios::beg);
+        benchmark::DoNotOptimize(
+            stream.readFrame<scppl::FramePrefix::Varint>().data());
+    }
+
+    finish(state);
+}
+
+BENCHMARK(BuildFrameIndex)->Unit(benchmark::kMillisecond);
+BENCHMARK(BuildDelimitedIndex)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(ScanToRecord)->Unit(benchmark::kMicrosecond);
+BENCHMARK(SeekWithIndex)->Unit(benchmark::kMicrosecond);
+#endif
@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/ReadAheadStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordLength = scppl::lengthOf<uint32_t, uint64_t,
+                                                     double>();
+
+auto benchmarkPath()
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() /
+           "scppl_benchmark_read_ahead";
+}
+
+void prepareFile(std::size_t count)
+{
+    scppl::FileStream<> file(benchmarkPath(), std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    for (std::size_t i = 0; i < count; ++i)
+        stream.write(static_cast<uint32_t>(i), static_cast<uint64_t>(i), 0.5);
+}
+
+// Write the file back and drop it from the page cache
+void dropCache()
+{
+    int descriptor = ::open(benchmarkPath().c_str(), O_RDONLY);
+    ::fdatasync(descriptor);
+    ::posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(descriptor);
+}
+
+// A source that takes 1 µs per KiB, like a device without a page cache
+class SlowSource
+{
+public:
+    using Byte = char;
+
+    explicit SlowSource(scppl::FileStream<>& file) :
+        mFile(file)
+    {
+        //
+    }
+
+    auto read(char* data, std::size_t length)
+        -> std::size_t
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(length >> 10));
+
+        return mFile.read(data, length);
+    }
+
+private:
+    scppl::FileStream<>& mFile;
+};
+
+// Some work per record, like decoding it into an application type
+template<typename BinaryStreamT>
+void decodeRecords(BinaryStreamT& stream)
+{
+    for (auto [id, value, weight] :
+         stream.template records<uint32_t, uint64_t, double>())
+    {
+        double result = weight;
+        for (std::size_t i = 0; i < 16; ++i)
+            result = result * 1.0001 + static_cast<double>(id ^ value);
+
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void finish(benchmark::State& state)
+{
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 state.range(0) *
+                                                 recordLength));
+    std::filesystem::remove(benchmarkPath());
+}
+
+}
+
+static void FileStreamColdDecode(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        dropCache();
+        state.ResumeTiming();
+
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        decodeRecords(stream);
+    }
+
+    finish(state);
+}
+
+static void ReadAheadColdDecode(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        dropCache();
+        state.ResumeTiming();
+
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        scppl::ReadAheadStream<scppl::FileStream<>> readAhead(
+            file, {.depth = static_cast<std::size_t>(state.range(1))});
+        scppl::ReadAheadBinaryStream<scppl::FileStream<>, std::endian::little>
+            stream(readAhead);
+        decodeRecords(stream);
+    }
+
+    finish(state);
+}
+
+static void SlowSourceDecode(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        SlowSource source(file);
+        scppl::BinaryStream<std::endian::little, true, SlowSource>
+            stream(source);
+        decodeRecords(stream);
+    }
+
+    finish(state);
+}
+
+static void ReadAheadSlowSourceDecode(benchmark::State& state)
+{
+    prepareFile(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(), std::ios::in);
+        SlowSource source(file);
+        scppl::ReadAheadStream<SlowSource> readAhead(
+            source, {.depth = static_cast<std::size_t>(state.range(1))});
+        scppl::ReadAheadBinaryStream<SlowSource, std::endian::little>
+            stream(readAhead);
+        decodeRecords(stream);
+    }
+
+    finish(state);
+}
+
+BENCHMARK(FileStreamColdDecode)->Arg(1 << 20)->UseRealTime();
+BENCHMARK(ReadAheadColdDecode)->Args({1 << 20, 2})->Args({1 << 20, 4})
+    ->UseRealTime();
+BENCHMARK(SlowSourceDecode)->Arg(1 << 20)->UseRealTime();
+BENCHMARK(ReadAheadSlowSourceDecode)->Args({1 << 20, 2})->Args({1 << 20, 4})
+    ->UseRealTime();
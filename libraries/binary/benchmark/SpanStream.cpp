@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordLength = scppl::lengthOf<uint16_t, uint32_t,
+                                                     uint64_t>();
+
+auto makePacket(std::size_t records)
+    -> std::vector<char>
+{
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+    for (std::size_t i = 0; i < records; ++i)
+    {
+        stream.write(static_cast<uint16_t>(i), static_cast<uint32_t>(i),
+                     static_cast<uint64_t>(i));
+    }
+
+    return bufferStream.release();
+}
+
+template<typename BinaryStreamT>
+void decodePacket(BinaryStreamT& stream, std::size_t records)
+{
+    for (std::size_t i = 0; i < records; ++i)
+        benchmark::DoNotOptimize(stream.template read<uint16_t, uint32_t,
+                                                      uint64_t>());
+}
+
+}
+
+static void StringStreamDecode(benchmark::State& state)
+{
+    auto records = static_cast<std::size_t>(state.range(0));
+    auto packet = makePacket(records);
+    for (auto _ : state)
+    {
+        std::istringstream stringstream(
+            std::string(std::ranges::begin(packet), std::ranges::end(packet)));
+        scppl::BinaryInputStream<std::endian::big> stream(stringstream);
+        decodePacket(stream, records);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 std::ranges::size(packet)));
+}
+
+static void SpanStreamDecode(benchmark::State& state)
+{
+    auto records = static_cast<std::size_t>(state.range(0));
+    auto packet = makePacket(records);
+    for (auto _ : state)
+    {
+        scppl::SpanStream<> spanStream(packet);
+        scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+        decodePacket(stream, records);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 std::ranges::size(packet)));
+}
+
+static void StringStreamEncode(benchmark::State& state)
+{
+    auto records = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::ostringstream stringstream{};
+        scppl::BinaryOutputStream<std::endian::big> stream(stringstream);
+        for (std::size_t i = 0; i < records; ++i)
+            stream.write(uint16_t{1}, uint32_t{2}, uint64_t{3});
+
+        benchmark::DoNotOptimize(stringstream.str());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 records * recordLength));
+}
+
+static void BufferStreamEncode(benchmark::State& state)
+{
+    auto records = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        scppl::BufferStream<> bufferStream{};
+        scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+        for (std::size_t i = 0; i < records; ++i)
+            stream.write(uint16_t{1}, uint32_t{2}, uint64_t{3});
+
+        benchmark::DoNotOptimize(bufferStream.release());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 records * recordLength));
+}
+
+BENCHMARK(StringStreamDecode)->Arg(16)->Arg(1024);
+BENCHMARK(SpanStreamDecode)->Arg(16)->Arg(1024);
+BENCHMARK(StringStreamEncode)->Arg(16)->Arg(1024);
+BENCHMARK(BufferStreamEncode)->Arg(16)->Arg(1024);
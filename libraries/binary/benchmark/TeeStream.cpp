@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+#include "scppl/binary/TeeStream.hpp"
+#include "scppl/binary/WriteBehindStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordCount = 100'000;
+
+// A sink that takes a while for every write, like a replication connection
+class SlowSink
+{
+public:
+    void write(char const* /* data */, std::size_t /* length */)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+};
+
+template<typename BinaryStreamT>
+void writeRecords(BinaryStreamT& stream, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        stream.write(static_cast<uint32_t>(i), static_cast<uint64_t>(i), 0.5);
+}
+
+void setItems(benchmark::State& state)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                                 recordCount));
+}
+
+}
+
+// Packing every record once per destination
+static void TwoBinaryStreams(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        scppl::BufferStream<> first{};
+        scppl::BufferStream<> second{};
+        scppl::BufferBinaryStream<std::endian::big> firstStream(first);
+        scppl::BufferBinaryStream<std::endian::big> secondStream(second);
+        writeRecords(firstStream, recordCount);
+        writeRecords(secondStream, recordCount);
+
+        benchmark::DoNotOptimize(first.release());
+        benchmark::DoNotOptimize(second.release());
+    }
+
+    setItems(state);
+}
+
+static void TeeBinaryStream(benchmark::State& state)
+{
+    using Buffer = scppl::BufferStream<>;
+    for (auto _ : state)
+    {
+        Buffer first{};
+        Buffer second{};
+        {
+            scppl::TeeStream tee(first, second);
+            scppl::TeeBinaryStream<std::endian::big, Buffer, Buffer>
+                stream(tee);
+            writeRecords(stream, recordCount);
+        }
+
+        benchmark::DoNotOptimize(first.release());
+        benchmark::DoNotOptimize(second.release());
+    }
+
+    setItems(state);
+}
+
+// A slow sink written on the same thread, every full buffer waits for it
+static void TeeSlowSink(benchmark::State& state)
+{
+    using Buffer = scppl::BufferStream<>;
+    for (auto _ : state)
+    {
+        Buffer local{};
+        SlowSink remote{};
+        {
+            scppl::TeeStream tee(local, remote);
+            scppl::TeeBinaryStream<std::endian::big, Buffer, SlowSink>
+                stream(tee);
+            writeRecords(stream, recordCount);
+        }
+
+        benchmark::DoNotOptimize(local.release());
+    }
+
+    setItems(state);
+}
+
+// The slow sink written on a background thread
+static void TeeWriteBehindSlowSink(benchmark::State& state)
+{
+    using Buffer = scppl::BufferStream<>;
+    using Behind = scppl::WriteBehindStream<SlowSink>;
+    for (auto _ : state)
+    {
+        Buffer local{};
+        SlowSink remote{};
+        Behind behind(remote, {.bufferSize = std::size_t{1} << 16,
+                               .depth = 64});
+        {
+            scppl::TeeStream tee(local, behind);
+            scppl::TeeBinaryStream<std::endian::big, Buffer, Behind>
+                stream(tee);
+            writeRecords(stream, recordCount);
+        }
+
+        // Only until the records are handed off, not until they are written
+        state.PauseTiming();
+        behind.sync();
+        benchmark::DoNotOptimize(local.release());
+        state.ResumeTiming();
+    }
+
+    setItems(state);
+}
+
+BENCHMARK(TwoBinaryStreams);
+BENCHMARK(TeeBinaryStream);
+BENCHMARK(TeeSlowSink)->UseRealTime();
+BENCHMARK(TeeWriteBehindSlowSink)->UseRealTime();
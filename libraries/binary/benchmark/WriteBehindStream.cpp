@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+
+#include <benchmark/benchmark.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/WriteBehindStream.hpp"
+
+namespace {
+
+constexpr std::size_t recordLength = scppl::lengthOf<uint32_t, uint64_t,
+                                                     double>();
+
+// A small buffer with `fdatasync` after every flush, so the disk stalls often
+constexpr scppl::FileStreamOptions fileOptions{
+    .bufferSize = std::size_t{1} << 16,
+    .sync = scppl::FileSync::OnFlush
+};
+
+auto benchmarkPath()
+    -> std::filesystem::path
+{
+    return std::filesystem::temp_directory_path() /
+           "scppl_benchmark_write_behind";
+}
+
+// Write latencies in power of two buckets of nanoseconds
+class LatencyHistogram
+{
+public:
+    void add(std::chrono::nanoseconds latency)
+    {
+        auto count = static_cast<uint64_t>(latency.count());
+        ++mBuckets[static_cast<std::size_t>(std::bit_width(count))];
+        ++mCount;
+        mMax = std::max(mMax, count);
+    }
+
+    // The upper bound of the bucket holding the given percentile
+    auto percentile(double fraction) const
+        -> double
+    {
+        auto target = static_cast<uint64_t>(fraction *
+                                            static_cast<double>(mCount));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < std::ranges::size(mBuckets); ++i)
+        {
+            seen += mBuckets[i];
+            if (seen > target)
+                return static_cast<double>(uint64_t{1} << i);
+        }
+
+        return 0.0;
+    }
+
+    void report(benchmark::State& state) const
+    {
+        state.counters["p50_ns"] = percentile(0.50);
+        state.counters["p99_ns"] = percentile(0.99);
+        state.counters["p999_ns"] = percentile(0.999);
+        state.counters["p9999_ns"] = percentile(0.9999);
+        state.counters["max_ns"] = static_cast<double>(mMax);
+    }
+
+private:
+    std::array<uint64_t, 65> mBuckets{};
+    uint64_t mCount{};
+    uint64_t mMax{};
+};
+
+template<typename BinaryStreamT>
+void writeRecords(BinaryStreamT& stream, std::size_t count,
+                  LatencyHistogram& histogram)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stream.write(static_cast<uint32_t>(i), static_cast<uint64_t>(i), 0.5);
+        histogram.add(std::chrono::steady_clock::now() - start);
+    }
+}
+
+void finish(benchmark::State& state, LatencyHistogram const& histogram)
+{
+    histogram.report(state);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() *
+                                                 state.range(0) *
+                                                 recordLength));
+    std::filesystem::remove(benchmarkPath());
+}
+
+}
+
+static void FileStreamWriteLatency(benchmark::State& state)
+{
+    LatencyHistogram histogram{};
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(),
+                                 std::ios::out | std::ios::trunc, fileOptions);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        writeRecords(stream, static_cast<std::size_t>(state.range(0)),
+                     histogram);
+    }
+
+    finish(state, histogram);
+}
+
+static void WriteBehindWriteLatency(benchmark::State& state)
+{
+    LatencyHistogram histogram{};
+    for (auto _ : state)
+    {
+        scppl::FileStream<> file(benchmarkPath(),
+                                 std::ios::out | std::ios::trunc, fileOptions);
+        scppl::WriteBehindStream<scppl::FileStream<>> writeBehind(
+            file, {.bufferSize = std::size_t{1} << 16,
+                   .depth = static_cast<std::size_t>(state.range(1))});
+        scppl::WriteBehindBinaryStream<scppl::FileStream<>,
+                                       std::endian::little> stream(writeBehind);
+        writeRecords(stream, static_cast<std::size_t>(state.range(0)),
+                     histogram);
+        writeBehind.sync();
+    }
+
+    finish(state, histogram);
+}
+
+BENCHMARK(FileStreamWriteLatency)->Arg(1 << 18)->UseRealTime();
+BENCHMARK(WriteBehindWriteLatency)->Args({1 << 18, 4})->Args({1 << 18, 64})
+    ->UseRealTime();
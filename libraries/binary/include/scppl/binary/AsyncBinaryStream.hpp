@@ -0,0 +1,408 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_ASYNCBINARYSTREAM_HPP_
+#define SCPPL_BINARY_ASYNCBINARYSTREAM_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Reactor.hpp"
+#include "scppl/binary/Task.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+/// Options for an `AsyncBinaryStream`.
+struct AsyncStreamOptions
+{
+    /// The size of the read buffer in bytes, it grows for larger reads.
+    std::size_t bufferSize = std::size_t{1} << 16;
+};
+
+/**
+ * @brief A binary stream on a file descriptor with awaitable reads and writes.
+ *
+ * @details Every read and write returns a @ref scppl::Task, which suspends
+ *          the awaiting coroutine while the file descriptor is not ready
+ *          instead of blocking the thread. This allows protocol parsers to be
+ *          written as straight-line coroutines:
+ *
+ *          @code{.cpp}
+ *          auto [type, length] = co_await stream.read<uint16_t, uint32_t>();
+ *          auto payload = co_await stream.readRaw(length);
+ *          @endcode
+ *
+ *          Pipes, sockets and other descriptors supported by `epoll` are put
+ *          in non-blocking mode and waited for with the
+ *          @ref scppl::Reactor. Regular files are always ready for `epoll`
+ *          but may still block, they are read and written with `pread` and
+ *          `pwrite` on the helper thread of the reactor instead, with separate
+ *          read and write positions starting at the current offset of the
+ *          descriptor.
+ *
+ *          Reads go through a buffer, so small values do not need a system
+ *          call each. Writes are not buffered, a finished write has been
+ *          handed to the operating system. The file descriptor is not owned
+ *          by the stream and must outlive it, and only one read and one write
+ *          may be in progress at the same time.
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_EPOLL` to be enabled.
+ *
+ * @tparam tEndian  The endian of the data. [`std::endian::native`]
+ * @tparam ByteT    The type to use as byte. [`char`]
+ */
+template<std::endian tEndian = std::endian::native, typename ByteT = char>
+class AsyncBinaryStream
+{
+public:
+    /// The byte type of this `AsyncBinaryStream` instance.
+    using Byte = ByteT;
+
+    /// The `Binary` type used for packing and unpacking.
+    using BinaryT = Binary<tEndian, Byte>;
+
+    /**
+     * @brief The `AsyncBinaryStream` constructor.
+     *
+     * @param reactor     The reactor to wait with.
+     * @param descriptor  The file descriptor to read from and/or write to.
+     * @param options     The buffer size. [`{}`]
+     *
+     * @throws std::system_error When the descriptor can not be inspected or
+     *                           made non-blocking.
+     */
+    AsyncBinaryStream(Reactor& reactor, int descriptor,
+                      AsyncStreamOptions options = {}) :
+        mReactor(reactor),
+        mDescriptor(descriptor),
+        mBuffer(std::max<std::size_t>(options.bufferSize, 1))
+    {
+        struct stat status{};
+        if (::fstat(mDescriptor, &status) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Unable to inspect file descriptor");
+        }
+
+        mRegular = S_ISREG(status.st_mode);
+        if (mRegular)
+        {
+            mReadPosition = ::lseek(mDescriptor, 0, SEEK_CUR);
+            mWritePosition = mReadPosition;
+
+            return;
+        }
+
+        int flags = ::fcntl(mDescriptor, F_GETFL);
+        if (flags < 0 || ::fcntl(mDescriptor, F_SETFL, flags | O_NONBLOCK) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Unable to make file descriptor "
+                                    "non-blocking");
+        }
+    }
+
+    AsyncBinaryStream(AsyncBinaryStream const&) = delete;
+    AsyncBinaryStream(AsyncBinaryStream&&) = delete;
+
+    /// Stops the reactor from watching the file descriptor.
+    ~AsyncBinaryStream() noexcept
+    {
+        mReactor.forget(mDescriptor);
+    }
+
+    auto operator=(AsyncBinaryStream const&) -> AsyncBinaryStream& = delete;
+    auto operator=(AsyncBinaryStream&&) -> AsyncBinaryStream& = delete;
+
+    /**
+     * @brief Read and unpack values of types `Ts...`.
+     *
+     * @tparam Ts  The types to read, must be `Unpackable`.
+     *
+     * @throws std::runtime_error When the stream ends before all values.
+     * @throws std::system_error When reading fails.
+     *
+     * @return A task returning the values.
+     */
+    template<Unpackable... Ts>
+    auto read()
+        -> Task<std::tuple<Ts...>>
+    {
+        constexpr std::size_t length = lengthOf<Ts...>();
+        co_await fill(length);
+
+        auto values = BinaryT::template unpack<Ts...>(
+            std::span<Byte const>(mBuffer).subspan(mBegin, length));
+        mBegin += length;
+
+        co_return values;
+    }
+
+    /**
+     * @brief Read and unpack a single value of type `T`.
+     *
+     * @tparam T  The type to read, must be `Unpackable`.
+     *
+     * @throws std::runtime_error When the stream ends before the value.
+     * @throws std::system_error When reading fails.
+     *
+     * @return A task returning the value.
+     */
+    template<Unpackable T>
+    auto readSingle()
+        -> Task<T>
+    {
+        co_return std::get<0>(co_await read<T>());
+    }
+
+    /**
+     * @brief Read an amount of raw bytes.
+     *
+     * @param length  The amount of bytes to read.
+     *
+     * @throws std::runtime_error When the stream ends before `length` bytes.
+     * @throws std::system_error When reading fails.
+     *
+     * @return A task returning the bytes.
+     */
+    auto readRaw(std::size_t length)
+        -> Task<std::vector<Byte>>
+    {
+        std::vector<Byte> data(length);
+        co_await readInto(data);
+
+        co_return data;
+    }
+
+    /**
+     * @brief Read raw bytes into `data`.
+     *
+     * @param data  Where to store the bytes, must outlive the task.
+     *
+     * @throws std::runtime_error When the stream ends before `data` is full.
+     * @throws std::system_error When reading fails.
+     *
+     * @return A task.
+     */
+    auto readInto(std::span<Byte> data)
+        -> Task<>
+    {
+        // Buffered bytes first, then large reads straight into `data`
+        std::size_t done = std::min(buffered(), std::ranges::size(data));
+        std::memcpy(std::ranges::data(data),
+                    std::ranges::data(mBuffer) + mBegin, done * sizeof(Byte));
+        mBegin += done;
+
+        while (done < std::ranges::size(data))
+        {
+            std::size_t left = std::ranges::size(data) - done;
+            if (left < std::ranges::size(mBuffer))
+            {
+                co_await fill(left);
+                std::memcpy(std::ranges::data(data) + done,
+                            std::ranges::data(mBuffer) + mBegin,
+                            left * sizeof(Byte));
+                mBegin += left;
+
+                break;
+            }
+
+            std::size_t count = co_await readSome(
+                std::ranges::data(data) + done, left);
+            if (count == 0)
+                throw std::runtime_error("Unexpected end of stream");
+
+            done += count;
+        }
+    }
+
+    /**
+     * @brief Pack and write values of types `Ts...`.
+     *
+     * @tparam Ts  The types to write, must be `Packable`.
+     *
+     * @param values  The values to write.
+     *
+     * @throws std::system_error When writing fails.
+     *
+     * @return A task finishing when every byte has been written.
+     */
+    template<Packable... Ts>
+    auto write(Ts... values)
+        -> Task<>
+    {
+        auto data = BinaryT::template pack<Ts...>(values...);
+
+        co_await writeRaw(data);
+    }
+
+    /**
+     * @brief Write raw bytes.
+     *
+     * @param data  The bytes to write, must outlive the task.
+     *
+     * @throws std::system_error When writing fails.
+     *
+     * @return A task finishing when every byte has been written.
+     */
+    auto writeRaw(std::span<Byte const> data)
+        -> Task<>
+    {
+        while (!std::ranges::empty(data))
+        {
+            std::size_t count = co_await writeSome(std::ranges::data(data),
+                                                   std::ranges::size(data));
+            data = data.subspan(count);
+        }
+    }
+
+    /// Whether the end of the stream was reached by a read.
+    auto eof() const -> bool { return mEof; }
+
+    /// The amount of bytes read ahead into the buffer.
+    auto buffered() const -> std::size_t { return mEnd - mBegin; }
+
+    /// The file descriptor of this stream.
+    auto descriptor() const -> int { return mDescriptor; }
+
+private:
+    Reactor& mReactor;
+    int mDescriptor{-1};
+    bool mRegular{};
+    off_t mReadPosition{};
+    off_t mWritePosition{};
+
+    std::vector<Byte> mBuffer{};
+    std::size_t mBegin{};
+    std::size_t mEnd{};
+    bool mEof{};
+
+    /// Make sure the buffer holds at least `length` bytes.
+    auto fill(std::size_t length)
+        -> Task<>
+    {
+        if (buffered() >= length)
+            co_return;
+
+        // Move the buffered bytes to the front, and grow for large values
+        std::memmove(std::ranges::data(mBuffer),
+                     std::ranges::data(mBuffer) + mBegin,
+                     buffered() * sizeof(Byte));
+        mEnd -= mBegin;
+        mBegin = 0;
+
+        if (length > std::ranges::size(mBuffer))
+            mBuffer.resize(length);
+
+        while (mEnd < length)
+        {
+            std::size_t count = co_await readSome(
+                std::ranges::data(mBuffer) + mEnd,
+                std::ranges::size(mBuffer) - mEnd);
+            if (count == 0)
+                throw std::runtime_error("Unexpected end of stream");
+
+            mEnd += count;
+        }
+    }
+
+    /// Read at most `length` bytes, `0` at the end of the stream.
+    auto readSome(Byte* data, std::size_t length)
+        -> Task<std::size_t>
+    {
+        ssize_t count = -1;
+        if (mRegular)
+        {
+            // `errno` belongs to the helper thread, return it instead
+            off_t position = mReadPosition;
+            count = co_await mReactor.offload([=, this]() -> ssize_t {
+                ssize_t result = ::pread(mDescriptor, data,
+                                         length * sizeof(Byte), position);
+                return (result < 0) ? -errno : result;
+            });
+
+            if (count < 0)
+                throwError(static_cast<int>(-count), "Unable to read");
+
+            mReadPosition += count;
+        }
+        else
+        {
+            while ((count = ::read(mDescriptor, data,
+                                   length * sizeof(Byte))) < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    co_await mReactor.readable(mDescriptor);
+                else if (errno != EINTR)
+                    throwError(errno, "Unable to read");
+            }
+        }
+
+        mEof = (count == 0);
+
+        co_return static_cast<std::size_t>(count) / sizeof(Byte);
+    }
+
+    /// Write at most `length` bytes, returning the amount written.
+    auto writeSome(Byte const* data, std::size_t length)
+        -> Task<std::size_t>
+    {
+        ssize_t count = -1;
+        if (mRegular)
+        {
+            off_t position = mWritePosition;
+            count = co_await mReactor.offload([=, this]() -> ssize_t {
+                ssize_t result = ::pwrite(mDescriptor, data,
+                                          length * sizeof(Byte), position);
+                return (result < 0) ? -errno : result;
+            });
+
+            if (count < 0)
+                throwError(static_cast<int>(-count), "Unable to write");
+
+            mWritePosition += count;
+        }
+        else
+        {
+            while ((count = ::write(mDescriptor, data,
+                                    length * sizeof(Byte))) < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    co_await mReactor.writable(mDescriptor);
+                else if (errno != EINTR)
+                    throwError(errno, "Unable to write");
+            }
+        }
+
+        co_return static_cast<std::size_t>(count) / sizeof(Byte);
+    }
+
+    [[noreturn]] static void throwError(int error, char const* message)
+    {
+        throw std::system_error(error, std::generic_category(), message);
+    }
+};
+#endif
+
+}
+
+#endif
@@ -0,0 +1,724 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_BATCHFILESTREAM_HPP_
+#define SCPPL_BINARY_BATCHFILESTREAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ios>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+/// How a `BatchFileStream` submits its batches.
+enum class BatchBackend
+{
+    /// Use `io_uring` when the kernel supports it, a thread pool otherwise.
+    Auto,
+
+    /// Use `io_uring`, failing to open when it is unavailable.
+    IoUring,
+
+    /// Use a pool of threads doing blocking `pread` and `pwrite` calls.
+    ThreadPool
+};
+
+/// Options for the batches of a `BatchFileStream`.
+struct BatchFileOptions
+{
+    /// The maximum amount of requests in flight at the same time.
+    std::size_t queueDepth = 64;
+
+    /// The amount of threads used by the thread pool backend.
+    std::size_t threads = 4;
+
+    /// How batches are submitted.
+    BatchBackend backend = BatchBackend::Auto;
+
+    /// Register the file descriptor with `io_uring`, saving a lookup per
+    /// request.
+    bool registerFile = true;
+};
+
+/// A single read or write of a batch, at an offset in the file.
+template<typename ByteT>
+struct FileRequest
+{
+    /// Where to store the read bytes, or the bytes to write.
+    ByteT* data{};
+
+    /// The amount of bytes to read or write.
+    std::size_t length{};
+
+    /// The offset in the file.
+    std::size_t offset{};
+
+    /// The index of the registered buffer holding `data`, or `-1`.
+    int buffer = -1;
+
+    /// The amount of bytes read or written, set when the batch is done.
+    std::size_t result{};
+};
+
+/**
+ * @brief A `FileStream` which can read and write many offsets at once.
+ *
+ * @details The stream itself behaves exactly like a @ref scppl::FileStream,
+ *          but `readBatch()` and `writeBatch()` hand a whole set of requests
+ *          to the kernel together instead of waiting for each `pread` in turn.
+ *          Up to `queueDepth` requests are in flight at the same time, which
+ *          is what keeps a fast SSD busy during random reads.
+ *
+ *          On Linux the requests are submitted through an `io_uring`, with
+ *          the file descriptor registered as a fixed file. Buffers used for
+ *          many batches can be registered with `registerBuffers()`, after
+ *          which requests referring to them skip mapping the pages on every
+ *          call. When `io_uring` is not available the requests are spread over
+ *          a pool of threads instead, `backend()` tells which one is used.
+ *
+ *          Batches bypass the buffer of the stream, like `readAt()` does. The
+ *          buffer is flushed before a batch and dropped after a write batch,
+ *          so the stream and the batches always see the same file. With
+ *          `O_DIRECT` the data, lengths and offsets of requests must be
+ *          aligned by the caller.
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled, and
+ *       `SCPPL_CONFIG_BINARY_USE_IO_URING` for the `io_uring` backend.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size. [`char`]
+ */
+template<typename ByteT = char>
+class BatchFileStream : public FileStream<ByteT>
+{
+public:
+    /// The byte type of this `BatchFileStream` instance.
+    using Byte = ByteT;
+
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = std::filesystem::path;
+
+    /**
+     * @brief The `BatchFileStream` constructor.
+     *
+     * @param path     The path of the file to open.
+     * @param mode     The mode to open the file with.
+     *                 [`std::ios::in | std::ios::out`]
+     * @param options  The buffer and synchronization options. [`{}`]
+     * @param batch    The queue depth and backend of batches. [`{}`]
+     *
+     * @throws std::invalid_argument  The alignment is not a power of two.
+     * @throws std::system_error      The file could not be opened, or
+     *                                `io_uring` was requested but is not
+     *                                available.
+     */
+    explicit BatchFileStream(Path const& path,
+                             std::ios::openmode mode = std::ios::in |
+                                                       std::ios::out,
+                             FileStreamOptions options = {},
+                             BatchFileOptions batch = {}) :
+        FileStream<ByteT>(path, mode, options),
+        mOptions(batch)
+    {
+        mOptions.queueDepth = std::clamp<std::size_t>(mOptions.queueDepth,
+                                                      1, 4096);
+        mOptions.threads = std::max<std::size_t>(mOptions.threads, 1);
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+        if (mOptions.backend != BatchBackend::ThreadPool)
+        {
+            int error = setupRing();
+            if (error == 0)
+            {
+                mBackend = BatchBackend::IoUring;
+                return;
+            }
+
+            if (mOptions.backend == BatchBackend::IoUring)
+            {
+                throw std::system_error(error, std::generic_category(),
+                                        "Unable to set up io_uring");
+            }
+        }
+#else
+        if (mOptions.backend == BatchBackend::IoUring)
+        {
+            throw std::system_error(ENOSYS, std::generic_category(),
+                                    "Unable to set up io_uring");
+        }
+#endif
+
+        mBackend = BatchBackend::ThreadPool;
+    }
+
+    BatchFileStream(BatchFileStream const&) = delete;
+    BatchFileStream(BatchFileStream&&) = delete;
+
+    /// Stops the thread pool and closes the `io_uring`.
+    ~BatchFileStream() noexcept
+    {
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+        mWake.notify_all();
+
+        for (std::thread& worker : mWorkers)
+            worker.join();
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+        closeRing();
+#endif
+    }
+
+    auto operator=(BatchFileStream const&) -> BatchFileStream& = delete;
+    auto operator=(BatchFileStream&&) -> BatchFileStream& = delete;
+
+    /**
+     * @brief Read every request of a batch.
+     *
+     * @details Returns when all requests are done. The `result` of each
+     *          request is the amount of bytes read, less than `length` at the
+     *          end of the file.
+     *
+     * @param requests  The offsets to read and where to store the bytes.
+     *
+     * @throws std::system_error  Flushing the buffer or any request failed,
+     *                            the other requests are still done.
+     */
+    void readBatch(std::span<FileRequest<Byte>> requests)
+    {
+        this->flush();
+
+        submit(requests, false);
+    }
+
+    /**
+     * @brief Write every request of a batch.
+     *
+     * @details Returns when all requests are done, the `result` of each
+     *          request is its `length`. Requests of one batch must not
+     *          overlap, they may be written in any order.
+     *
+     * @param requests  The offsets and bytes to write.
+     *
+     * @throws std::system_error  Flushing the buffer or any request failed,
+     *                            the other requests are still done.
+     */
+    void writeBatch(std::span<FileRequest<Byte>> requests)
+    {
+        this->discard();
+
+        submit(requests, true);
+    }
+
+    /**
+     * @brief Register buffers for use by the requests of later batches.
+     *
+     * @details A request refers to a registered buffer by setting `buffer` to
+     *          its index, `data` and `length` must then lie inside it. The
+     *          pages of registered buffers are pinned once, instead of on
+     *          every request. Registering again replaces the earlier buffers.
+     *          The thread pool backend accepts the buffers but does not use
+     *          them.
+     *
+     * @param buffers  The buffers, must outlive the stream or the next call.
+     *
+     * @throws std::system_error  The buffers could not be registered.
+     */
+    void registerBuffers(std::span<std::span<Byte> const> buffers)
+    {
+        mBuffers.assign(std::ranges::begin(buffers),
+                        std::ranges::end(buffers));
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+        if (mBackend != BatchBackend::IoUring)
+            return;
+
+        if (mBuffersRegistered)
+        {
+            enter(IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            mBuffersRegistered = false;
+        }
+
+        if (std::ranges::empty(buffers))
+            return;
+
+        std::vector<::iovec> vectors{};
+        vectors.reserve(std::ranges::size(buffers));
+        for (std::span<Byte> buffer : buffers)
+            vectors.push_back({std::ranges::data(buffer),
+                               std::ranges::size(buffer)});
+
+        if (enter(IORING_REGISTER_BUFFERS, std::ranges::data(vectors),
+                  static_cast<unsigned>(std::ranges::size(vectors))) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Unable to register buffers");
+        }
+
+        mBuffersRegistered = true;
+#endif
+    }
+
+    /// The backend used for batches, `IoUring` or `ThreadPool`.
+    auto backend() const -> BatchBackend { return mBackend; }
+
+private:
+    BatchFileOptions mOptions{};
+    BatchBackend mBackend{BatchBackend::ThreadPool};
+    std::vector<std::span<Byte>> mBuffers{};
+
+    std::mutex mMutex{};
+    std::condition_variable mWake{};
+    std::condition_variable mDone{};
+    std::deque<std::function<void()>> mJobs{};
+    std::vector<std::thread> mWorkers{};
+    bool mStopping{};
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+    int mRing{-1};
+    bool mFileRegistered{};
+    bool mBuffersRegistered{};
+
+    void* mSqMemory{MAP_FAILED};
+    std::size_t mSqSize{};
+    void* mCqMemory{MAP_FAILED};
+    std::size_t mCqSize{};
+    ::io_uring_sqe* mEntries{static_cast<::io_uring_sqe*>(MAP_FAILED)};
+    std::size_t mEntriesSize{};
+
+    unsigned* mSqHead{};
+    unsigned* mSqTail{};
+    unsigned mSqMask{};
+    unsigned* mSqArray{};
+    unsigned* mCqHead{};
+    unsigned* mCqTail{};
+    unsigned mCqMask{};
+    ::io_uring_cqe* mCompletions{};
+#endif
+
+    void submit(std::span<FileRequest<Byte>> requests, bool write)
+    {
+        for (FileRequest<Byte>& request : requests)
+        {
+            if (request.buffer >= 0 && !inBuffer(request))
+            {
+                throw std::invalid_argument("Request is outside of its "
+                                            "registered buffer");
+            }
+
+            request.result = 0;
+        }
+
+        int error = 0;
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+        if (mBackend == BatchBackend::IoUring)
+            error = submitRing(requests, write);
+        else
+#endif
+            error = submitPool(requests, write);
+
+        if (error != 0)
+        {
+            throw std::system_error(error, std::generic_category(),
+                                    write ? "Unable to write batch"
+                                          : "Unable to read batch");
+        }
+    }
+
+    auto inBuffer(FileRequest<Byte> const& request) const -> bool
+    {
+        if (static_cast<std::size_t>(request.buffer) >=
+            std::ranges::size(mBuffers))
+        {
+            return false;
+        }
+
+        std::span<Byte> buffer = mBuffers[request.buffer];
+        return (request.data >= std::ranges::data(buffer) &&
+                request.data + request.length <=
+                    std::ranges::data(buffer) + std::ranges::size(buffer));
+    }
+
+    /// Blocking transfer of the rest of `request`, returns `-errno` on errors.
+    auto transfer(FileRequest<Byte>& request, bool write) const
+        -> int
+    {
+        while (request.result < request.length)
+        {
+            Byte* data = request.data + request.result;
+            std::size_t length = request.length - request.result;
+            auto offset = static_cast<off_t>(request.offset + request.result);
+
+            ssize_t count = write ? ::pwrite(this->handle(), data, length,
+                                             offset)
+                                  : ::pread(this->handle(), data, length,
+                                            offset);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return -errno;
+            }
+
+            if (count == 0)
+                return write ? -EIO : 0;
+
+            request.result += static_cast<std::size_t>(count);
+        }
+
+        return 0;
+    }
+
+    auto submitPool(std::span<FileRequest<Byte>> requests, bool write)
+        -> int
+    {
+        if (std::ranges::empty(requests))
+            return 0;
+
+        std::unique_lock lock(mMutex);
+        while (std::ranges::size(mWorkers) < mOptions.threads)
+            mWorkers.emplace_back([this]() { work(); });
+
+        // One job per request, with the first error kept for the caller
+        std::size_t left = std::ranges::size(requests);
+        int error = 0;
+        for (FileRequest<Byte>& request : requests)
+        {
+            mJobs.emplace_back([&, this]() {
+                int result = transfer(request, write);
+
+                std::lock_guard guard(mMutex);
+                if (result < 0 && error == 0)
+                    error = -result;
+
+                if (--left == 0)
+                    mDone.notify_one();
+            });
+        }
+        mWake.notify_all();
+
+        mDone.wait(lock, [&]() { return left == 0; });
+
+        return error;
+    }
+
+    void work()
+    {
+        std::unique_lock lock(mMutex);
+        while (true)
+        {
+            mWake.wait(lock, [this]() {
+                return mStopping || !std::ranges::empty(mJobs);
+            });
+            if (std::ranges::empty(mJobs))
+                return;
+
+            std::function<void()> job = std::move(mJobs.front());
+            mJobs.pop_front();
+
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+
+#if SCPPL_CONFIG_BINARY_USE_IO_URING
+    /// Create and map the ring, returns `errno` on errors.
+    auto setupRing()
+        -> int
+    {
+        ::io_uring_params parameters{};
+        mRing = static_cast<int>(::syscall(
+            __NR_io_uring_setup, static_cast<unsigned>(mOptions.queueDepth),
+            &parameters));
+        if (mRing < 0)
+            return errno;
+
+        // `IORING_OP_READ` and `IORING_OP_WRITE` need Linux 5.6, older rings
+        // accept them and then fail every request
+        if (!supportsReadWrite())
+        {
+            closeRing();
+            return ENOSYS;
+        }
+
+        mSqSize = parameters.sq_off.array +
+                  parameters.sq_entries * sizeof(unsigned);
+        mCqSize = parameters.cq_off.cqes +
+                  parameters.cq_entries * sizeof(::io_uring_cqe);
+        if ((parameters.features & IORING_FEAT_SINGLE_MMAP) != 0)
+            mSqSize = mCqSize = std::max(mSqSize, mCqSize);
+
+        mSqMemory = ::mmap(nullptr, mSqSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, mRing,
+                           IORING_OFF_SQ_RING);
+        if (mSqMemory == MAP_FAILED)
+            return failRing();
+
+        if ((parameters.features & IORING_FEAT_SINGLE_MMAP) != 0)
+        {
+            mCqMemory = mSqMemory;
+        }
+        else
+        {
+            mCqMemory = ::mmap(nullptr, mCqSize, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, mRing,
+                               IORING_OFF_CQ_RING);
+            if (mCqMemory == MAP_FAILED)
+                return failRing();
+        }
+
+        mEntriesSize = parameters.sq_entries * sizeof(::io_uring_sqe);
+        mEntries = static_cast<::io_uring_sqe*>(::mmap(
+            nullptr, mEntriesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, mRing, IORING_OFF_SQES));
+        if (mEntries == MAP_FAILED)
+            return failRing();
+
+        auto* sq = static_cast<char*>(mSqMemory);
+        mSqHead = reinterpret_cast<unsigned*>(sq + parameters.sq_off.head);
+        mSqTail = reinterpret_cast<unsigned*>(sq + parameters.sq_off.tail);
+        mSqMask = *reinterpret_cast<unsigned*>(sq +
+                                               parameters.sq_off.ring_mask);
+        mSqArray = reinterpret_cast<unsigned*>(sq + parameters.sq_off.array);
+
+        auto* cq = static_cast<char*>(mCqMemory);
+        mCqHead = reinterpret_cast<unsigned*>(cq + parameters.cq_off.head);
+        mCqTail = reinterpret_cast<unsigned*>(cq + parameters.cq_off.tail);
+        mCqMask = *reinterpret_cast<unsigned*>(cq +
+                                               parameters.cq_off.ring_mask);
+        mCompletions = reinterpret_cast<::io_uring_cqe*>(
+            cq + parameters.cq_off.cqes);
+
+        // Never more requests in flight than completions fit in the ring
+        mOptions.queueDepth = std::min<std::size_t>(
+            {mOptions.queueDepth, parameters.sq_entries,
+             parameters.cq_entries});
+
+        if (mOptions.registerFile)
+        {
+            int descriptor = this->handle();
+            mFileRegistered = (enter(IORING_REGISTER_FILES, &descriptor,
+                                     1) == 0);
+        }
+
+        return 0;
+    }
+
+    /// Whether the ring supports `IORING_OP_READ` and `IORING_OP_WRITE`.
+    auto supportsReadWrite() const
+        -> bool
+    {
+        constexpr unsigned count = IORING_OP_WRITE + 1;
+
+        // The probe ends in a flexible array of `count` operations
+        std::vector<std::uint64_t> memory(
+            (sizeof(::io_uring_probe) + count * sizeof(::io_uring_probe_op) +
+             sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto* probe = reinterpret_cast<::io_uring_probe*>(
+            std::ranges::data(memory));
+
+        // Probing itself needs Linux 5.6, so failing means it is too old
+        if (enter(IORING_REGISTER_PROBE, probe, count) != 0)
+            return false;
+
+        return std::ranges::all_of(std::array{IORING_OP_READ, IORING_OP_WRITE},
+                                   [probe](unsigned operation) -> bool {
+            return operation <= probe->last_op &&
+                   (probe->ops[operation].flags & IO_URING_OP_SUPPORTED) != 0;
+        });
+    }
+
+    auto failRing()
+        -> int
+    {
+        int error = errno;
+        closeRing();
+
+        return error;
+    }
+
+    void closeRing() noexcept
+    {
+        if (mEntries != MAP_FAILED)
+            ::munmap(mEntries, mEntriesSize);
+        if (mCqMemory != MAP_FAILED && mCqMemory != mSqMemory)
+            ::munmap(mCqMemory, mCqSize);
+        if (mSqMemory != MAP_FAILED)
+            ::munmap(mSqMemory, mSqSize);
+        if (mRing >= 0)
+            ::close(mRing);
+
+        mEntries = static_cast<::io_uring_sqe*>(MAP_FAILED);
+        mCqMemory = mSqMemory = MAP_FAILED;
+        mRing = -1;
+    }
+
+    auto enter(unsigned opcode, void* arguments, unsigned count) const
+        -> int
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_register, mRing,
+                                          opcode, arguments, count));
+    }
+
+    void prepare(FileRequest<Byte>& request, bool write, std::size_t index)
+    {
+        unsigned tail = *mSqTail;
+        unsigned slot = tail & mSqMask;
+
+        ::io_uring_sqe& entry = mEntries[slot];
+        entry = {};
+        entry.fd = mFileRegistered ? 0 : this->handle();
+        if (mFileRegistered)
+            entry.flags = IOSQE_FIXED_FILE;
+        entry.off = request.offset + request.result;
+        entry.addr = reinterpret_cast<std::uint64_t>(request.data +
+                                                     request.result);
+        entry.len = static_cast<std::uint32_t>(std::min<std::size_t>(
+            request.length - request.result, UINT32_MAX));
+        entry.user_data = index;
+
+        if (request.buffer >= 0 && mBuffersRegistered)
+        {
+            entry.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            entry.buf_index = static_cast<std::uint16_t>(request.buffer);
+        }
+        else
+        {
+            entry.opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        }
+
+        mSqArray[slot] = slot;
+        std::atomic_ref(*mSqTail).store(tail + 1, std::memory_order_release);
+    }
+
+    /// Run the batch on the ring, returns the first `errno` on errors.
+    auto submitRing(std::span<FileRequest<Byte>> requests, bool write)
+        -> int
+    {
+        std::size_t next = 0;
+        std::size_t inFlight = 0;
+        int error = 0;
+        int ringError = 0;
+
+        while (next < std::ranges::size(requests) || inFlight > 0)
+        {
+            while (ringError == 0 && next < std::ranges::size(requests) &&
+                   inFlight < mOptions.queueDepth)
+            {
+                if (requests[next].length > 0)
+                {
+                    prepare(requests[next], write, next);
+                    ++inFlight;
+                }
+
+                ++next;
+            }
+
+            if (inFlight == 0)
+                break;
+
+            // Submit what the kernel has not taken yet, and wait for one
+            unsigned pending = *mSqTail - std::atomic_ref(*mSqHead).load(
+                std::memory_order_acquire);
+            if (::syscall(__NR_io_uring_enter, mRing, pending, 1,
+                          IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                if (ringError == 0)
+                    ringError = errno;
+
+                // The kernel never saw these, take them back, but the ones it
+                // did take still write into the buffers of the caller
+                unsigned head = std::atomic_ref(*mSqHead).load(
+                    std::memory_order_acquire);
+                inFlight -= *mSqTail - head;
+                std::atomic_ref(*mSqTail).store(head,
+                                                std::memory_order_release);
+            }
+
+            inFlight -= reap(requests, write, error);
+        }
+
+        return ringError != 0 ? ringError : error;
+    }
+
+    auto reap(std::span<FileRequest<Byte>> requests, bool write, int& error)
+        -> std::size_t
+    {
+        unsigned head = *mCqHead;
+        unsigned tail = std::atomic_ref(*mCqTail).load(
+            std::memory_order_acquire);
+
+        std::size_t count = 0;
+        for (; head != tail; ++head, ++count)
+        {
+            ::io_uring_cqe const& completion = mCompletions[head & mCqMask];
+            FileRequest<Byte>& request = requests[completion.user_data];
+
+            int result = completion.res;
+            if (result > 0)
+            {
+                request.result += static_cast<std::size_t>(result);
+
+                // Partial transfers are rare, finish them right here
+                if (request.result < request.length)
+                    result = transfer(request, write);
+            }
+            else if (result == 0 && write)
+            {
+                result = -EIO;
+            }
+
+            if (result < 0 && error == 0)
+                error = -result;
+        }
+
+        std::atomic_ref(*mCqHead).store(head, std::memory_order_release);
+
+        return count;
+    }
+#endif
+};
+
+/// An alias for `BinaryStream` using a `BatchFileStream`.
+template<std::endian tEndian = std::endian::native, bool tSynchronized = true>
+using BatchFileBinaryStream = BinaryStream<tEndian, tSynchronized,
+                                           BatchFileStream<>>;
+#endif
+
+}
+
+#endif
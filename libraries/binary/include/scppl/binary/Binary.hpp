@@ -9,7 +9,9 @@
 #include <bit>
 #include <cstring>
 #include <ranges>
+#include <span>
 #include <tuple>
+#include <type_traits>
 
 #if SCPPL_CONFIG_BINARY_USE_PFR
 #include <boost/pfr.hpp>
@@ -56,6 +58,25 @@ public:
         -> ByteArray<lengthOf<Ts...>()>
     {
         ByteArray<lengthOf<Ts...>()> data{};
+        packInto<Ts...>(data, values...);
+
+        return data;
+    }
+
+    /**
+     * @brief Pack `values` of types `Ts...` into an existing buffer.
+     *
+     * @sa scppl::Binary::pack()
+     *
+     * @tparam Ts  The types to pack, must be `Packable`.
+     *
+     * @param data    The buffer to pack into, must be at least
+     *                `lengthOf<Ts...>()` bytes.
+     * @param values  The values of types `Ts...` to pack.
+     */
+    template<Packable... Ts>
+    static void packInto(std::span<Byte> data, Ts... values)
+    {
         auto position = std::ranges::begin(data);
         auto packValue = [&]<typename T>(T value) -> void
         {
@@ -65,8 +86,37 @@ public:
         };
 
         (packValue.template operator()<Ts>(values), ...);
+    }
 
-        return data;
+    /**
+     * @brief Pack `values` of types `Ts...` into an existing buffer and add
+     *        the packed bytes to a checksum.
+     *
+     * @details The checksum is updated right after packing, while the bytes
+     *          are still in the processor cache, instead of in a separate pass
+     *          over the buffer later on.
+     *
+     * @sa scppl::Binary::packInto()
+     *
+     * @tparam Ts  The types to pack, must be `Packable`.
+     *
+     * @param data      The buffer to pack into, must be at least
+     *                  `lengthOf<Ts...>()` bytes.
+     * @param checksum  The checksum to update, like a @ref scppl::Crc32c.
+     * @param values    The values of types `Ts...` to pack.
+     *
+     * @return The checksum after adding the packed bytes.
+     */
+    template<Packable... Ts>
+    static auto packIntoWithChecksum(std::span<Byte> data,
+                                     ChecksumAccumulator<Byte> auto& checksum,
+                                     Ts... values)
+        -> decltype(checksum.value())
+    {
+        packInto<Ts...>(data, values...);
+        checksum.update(std::span<Byte const>(data).first(lengthOf<Ts...>()));
+
+        return checksum.value();
     }
 
     /**
@@ -111,6 +161,43 @@ public:
         std::tie(values...) = unpack<Ts...>(data);
     }
 
+    /**
+     * @brief Converts values between native endian and `tEndian` in place.
+     *
+     * @details The conversion is its own inverse, so this is used for both
+     *          packing and unpacking arrays of values. Scalars are byte-swapped
+     *          directly, other types go through `fromBytes()`.
+     *
+     * @tparam T  The type of the values, must be `Unpackable` and trivially
+     *            copyable.
+     *
+     * @param values  The values to convert.
+     */
+    template<Unpackable T>
+    requires(std::is_trivially_copyable_v<T>)
+    static void convert(std::span<T> values)
+    {
+        if constexpr(endian() == std::endian::native)
+        {
+            return;
+        }
+        else if constexpr(std::is_scalar_v<T>)
+        {
+            for (T& value : values)
+                value = byteSwap(value);
+        }
+        else
+        {
+            for (T& value : values)
+            {
+                ByteArray<sizeof(T)> raw{};
+                std::memcpy(std::ranges::data(raw), &value, sizeof(T));
+
+                value = fromBytes<T>(raw);
+            }
+        }
+    }
+
     /**
      * @brief Converts a single value of type `T` into raw bytes.
      *
@@ -5,40 +5,72 @@
 #ifndef SCPPL_BINARY_BINARYSTREAM_HPP_
 #define SCPPL_BINARY_BINARYSTREAM_HPP_
 
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "scppl/binary/Binary.hpp"
 #include "scppl/binary/BinaryString.hpp"
 #include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
 #include "scppl/binary/Utility.hpp"
 
 namespace scppl {
 
+/// The length prefix of a frame written by `BinaryStream::writeFrame()`.
+enum class FramePrefix
+{
+    /// A `uint16_t` in the endian of the stream.
+    U16,
+
+    /// A `uint32_t` in the endian of the stream.
+    U32,
+
+    /// An unsigned LEB128 varint, 7 bits per byte with the least significant
+    /// group first.
+    Varint
+};
+
+template<bool tSynchronized, typename StreamT, typename ByteT>
+class DynamicEndianBinaryStream;
+
 /**
  * @brief Pack data into and unpack data from a stream.
  *
+ * @details The stream can be any @ref scppl::ByteSource and/or
+ *          @ref scppl::ByteSink, positioning functions are available when it
+ *          is also a @ref scppl::SeekableSource and/or
+ *          @ref scppl::SeekableSink.
+ *
  * @tparam tEndian        The endian of the data. [`std::endian::native`]
  * @tparam tSynchronized  Keep the read and write positions synchronized.
  *                        [`true`]
- * @tparam StreamT        A type of the stream, must be template class with at
- *                        least one parameter for the type.
- *                        [`std::basic_iostream`]
- * @tparam ByteT          The byte type, should be the same as the first type
- *                        of `StreamT`. [`char`]
- * @tparam StreamTs       Any other type parameters for `StreamT`.
+ * @tparam StreamT        The type of the stream. [`std::iostream`]
+ * @tparam ByteT          The byte type of the stream.
+ *                        [`scppl::StreamByteT<StreamT>`]
  */
 template<std::endian tEndian = std::endian::native, bool tSynchronized = true,
-         template<typename, typename...> typename StreamT = std::basic_iostream,
-         typename ByteT = char, typename... StreamTs>
+         typename StreamT = std::iostream, typename ByteT = StreamByteT<StreamT>>
 class BinaryStream
 {
 public:
     /// The stream type of this `BinaryStream` instance.
-    using Stream = StreamT<ByteT, StreamTs...>;
+    using Stream = StreamT;
 
     /// The byte type of this `BinaryStream` instance.
     using Byte = ByteT;
@@ -56,17 +88,269 @@ public:
     /// Whether this `BinaryStream` instance has synchronized positions.
     static constexpr auto synchronized() -> bool { return tSynchronized; }
 
+    /// Is `StreamT` an @ref scppl::ByteSource.
+    static constexpr bool isInputStream = ByteSource<Stream, Byte>;
+
+    /// Is `StreamT` an @ref scppl::ByteSink.
+    static constexpr bool isOutputStream = ByteSink<Stream, Byte>;
+
+    /// Is `StreamT` both an @ref scppl::ByteSource and @ref scppl::ByteSink.
+    static constexpr bool isInputOutputStream = isInputStream && isOutputStream;
+
     /// Is `StreamT` an @ref scppl::InputStream.
-    static constexpr bool isInputStream =
-        InputStream<StreamT, Byte, StreamTs...>;
+    static constexpr bool isSeekableInput = InputStream<Stream, Byte>;
 
     /// Is `StreamT` an @ref scppl::OutputStream.
-    static constexpr bool isOutputStream =
-        OutputStream<StreamT, Byte, StreamTs...>;
+    static constexpr bool isSeekableOutput = OutputStream<Stream, Byte>;
+
+    /// Is `StreamT` an @ref scppl::PositionalSource.
+    static constexpr bool isPositionalInput = PositionalSource<Stream, Byte>;
+
+    /// The default block size of `records()`, in bytes.
+    static constexpr std::size_t defaultBlockSize = std::size_t{1} << 16;
+
+    /// The default maximum payload length of `readFrame()`, in bytes.
+    static constexpr std::size_t defaultMaxFrameLength = std::size_t{1} << 26;
+
+    /// The default maximum length of `readUntil()`, in bytes.
+    static constexpr std::size_t defaultMaxUntilLength = std::size_t{1} << 26;
+
+    /**
+     * @brief A lazy input range of records read from a `BinaryStream`.
+     *
+     * @details Records are decoded from blocks of bytes, which are read from
+     *          the stream in large chunks. Sources that are an
+     *          @ref scppl::SpanSource provide the blocks themselves, so
+     *          records are decoded straight from their buffer.
+     *
+     *          A record is only consumed once it is dereferenced or skipped
+     *          over, so after the range is destroyed, the read position is
+     *          right after the last record that was used.
+     *
+     * @warning The stream must not be used in any other way while the range
+     *          exists, and iterators are invalidated when the range is moved.
+     *
+     * @tparam Ts  The types of a single record, must be `Unpackable`.
+     */
+    template<Unpackable... Ts>
+    class Records : public std::ranges::view_interface<Records<Ts...>>
+    {
+    public:
+        /// The type of a record, `T` for a single type or a tuple of `Ts...`.
+        using Record = std::conditional_t<sizeof...(Ts) == 1,
+                                          std::tuple_element_t<
+                                              0, std::tuple<Ts...>>,
+                                          std::tuple<Ts...>>;
+
+        /// The input iterator of `Records`.
+        class Iterator
+        {
+        public:
+            using value_type = Record;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            /// Default constructor, creates an iterator without range.
+            Iterator() = default;
+
+            /**
+             * @brief The `Iterator` constructor.
+             *
+             * @param records  The range to iterate.
+             */
+            explicit Iterator(Records* records) :
+                mRecords(records)
+            {
+                //
+            }
+
+            /// Decode the current record.
+            auto operator*() const -> Record { return mRecords->current(); }
+
+            /// Move to the next record.
+            auto operator++()
+                -> Iterator&
+            {
+                mRecords->next();
+
+                return *this;
+            }
+
+            /// Move to the next record.
+            void operator++(int) { ++*this; }
+
+            /// Whether there are no more complete records in the stream.
+            friend auto operator==(Iterator const& iterator,
+                                   std::default_sentinel_t)
+                -> bool
+            {
+                return iterator.atEnd();
+            }
+
+        private:
+            Records* mRecords{};
+
+            auto atEnd() const -> bool { return !mRecords->available(); }
+        };
+
+        /**
+         * @brief The `Records` constructor.
+         *
+         * @param stream     The stream to read the records from.
+         * @param blockSize  The amount of bytes to read at once.
+         */
+        Records(BinaryStream& stream, std::size_t blockSize) :
+            mStream(&stream),
+            mBlockSize(blockSize)
+        {
+            //
+        }
+
+        Records(Records const&) = delete;
+
+        /// Move constructor.
+        Records(Records&& other) noexcept :
+            mStream(std::exchange(other.mStream, nullptr)),
+            mBlockSize(other.mBlockSize),
+            mBlock(std::exchange(other.mBlock, {})),
+            mOffset(std::exchange(other.mOffset, 0)),
+            mRecord(std::exchange(other.mRecord, std::nullopt))
+        {
+            //
+        }
+
+        /// Consumes the used records from the stream, see `finish()`.
+        ~Records() noexcept
+        {
+            try
+            {
+                finish();
+            }
+            catch (...)
+            {
+                // Destructors can not report errors, use `finish()` for that
+            }
+        }
+
+        auto operator=(Records const&) -> Records& = delete;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * @throws Any exception thrown by `finish()`.
+         */
+        auto operator=(Records&& other) -> Records&
+        {
+            if (this != &other)
+            {
+                finish();
+
+                mStream = std::exchange(other.mStream, nullptr);
+                mBlockSize = other.mBlockSize;
+                mBlock = std::exchange(other.mBlock, {});
+                mOffset = std::exchange(other.mOffset, 0);
+                mRecord = std::exchange(other.mRecord, std::nullopt);
+            }
+
+            return *this;
+        }
+
+        /// Get an iterator to the current record.
+        auto begin() -> Iterator { return Iterator(this); }
+
+        /// Get the end sentinel.
+        auto end() const -> std::default_sentinel_t { return {}; }
 
-    /// Is `StreamT` an @ref scppl::InputOutputStream.
-    static constexpr bool isInputOutputStream =
-        InputOutputStream<StreamT, Byte, StreamTs...>;
+        /**
+         * @brief Consume the used records from the stream, and drop the bytes
+         *        read ahead of them.
+         *
+         * @details This is done when the range is destroyed, which ignores
+         *          errors. The range can not be used anymore afterwards.
+         *
+         * @throws Any exception thrown when seeking the stream.
+         */
+        void finish()
+        {
+            BinaryStream* stream = std::exchange(mStream, nullptr);
+            if (stream == nullptr)
+                return;
+
+            stream->consumeInput(std::exchange(mOffset, 0));
+            mBlock = {};
+            mRecord.reset();
+
+            // Drop the lookahead, so the stream is at the read position again
+            if constexpr(isSynchronizing)
+            {
+                if (stream->lookahead() > 0)
+                    stream->_seekInput(stream->tellInput());
+
+                stream->synchronizeOutputToInput();
+            }
+        }
+
+    private:
+        static constexpr std::size_t recordLength = lengthOf<Ts...>();
+
+        BinaryStream* mStream{};
+        std::size_t mBlockSize{};
+
+        std::span<Byte const> mBlock{};
+        std::size_t mOffset{};
+        std::optional<Record> mRecord{};
+
+        /// Make sure the block holds a complete record at the offset.
+        auto fill()
+            -> bool
+        {
+            if (mOffset + recordLength <= std::ranges::size(mBlock))
+                return true;
+
+            mStream->consumeInput(std::exchange(mOffset, 0));
+            mBlock = mStream->fillInput(recordLength,
+                                        std::max(recordLength, mBlockSize));
+
+            return std::ranges::size(mBlock) >= recordLength;
+        }
+
+        auto available()
+            -> bool
+        {
+            return mRecord.has_value() || fill();
+        }
+
+        auto current()
+            -> Record
+        {
+            if (!mRecord && fill())
+            {
+                auto values = BinaryT::template unpack<Ts...>(
+                    mBlock.subspan(mOffset, recordLength));
+                mOffset += recordLength;
+
+                if constexpr(sizeof...(Ts) == 1)
+                {
+                    mRecord = std::get<0>(std::move(values));
+                }
+                else
+                {
+                    mRecord = std::move(values);
+                }
+            }
+
+            return *mRecord;
+        }
+
+        void next()
+        {
+            if (!mRecord && fill())
+                mOffset += recordLength;
+
+            mRecord.reset();
+        }
+
+    };
 
     /**
      * @brief The `BinaryStream` constructor.
@@ -81,8 +365,8 @@ public:
         synchronizeOutputToInput();
     }
 
-    /// Default copy constructor.
-    BinaryStream(BinaryStream const&) = default;
+    /// Not copyable, a copy would consume the bytes read ahead a second time.
+    BinaryStream(BinaryStream const&) = delete;
 
     /// Default move constructor.
     BinaryStream(BinaryStream&&) noexcept = default;
@@ -90,12 +374,15 @@ public:
     /// Default destructor.
     ~BinaryStream() noexcept = default;
 
-    /// Default copy assignment operator.
-    auto operator=(BinaryStream const&) -> BinaryStream& = default;
+    /// Not copyable, a copy would consume the bytes read ahead a second time.
+    auto operator=(BinaryStream const&) -> BinaryStream& = delete;
 
     /// Default move assignment operator.
     auto operator=(BinaryStream&&) noexcept -> BinaryStream& = default;
 
+    /// The stream this `BinaryStream` reads from and/or writes to.
+    auto stream() const -> Stream& { return mStream; }
+
     /**
      * @brief Get the read position of this stream.
      *
@@ -105,9 +392,9 @@ public:
      */
     auto tellInput()
         -> std::size_t
-    requires(isInputStream)
+    requires(isSeekableInput)
     {
-        return mStream.tellg();
+        return static_cast<std::size_t>(mStream.tellg()) - lookahead();
     }
 
     /**
@@ -119,8 +406,15 @@ public:
      */
     auto tellOutput()
         -> std::size_t
-    requires(isOutputStream)
+    requires(isSeekableOutput)
     {
+        // The stream is still ahead by the bytes peeked at
+        if constexpr(isSynchronizing)
+        {
+            if (lookahead() > 0)
+                return tellInput();
+        }
+
         return mStream.tellp();
     }
 
@@ -135,14 +429,14 @@ public:
      */
     auto tell()
         -> std::size_t
-    requires((isInputStream || isOutputStream) &&
-             !(isInputOutputStream && !synchronized()))
+    requires((isSeekableInput || isSeekableOutput) &&
+             !(isSeekableInput && isSeekableOutput && !synchronized()))
     {
-        if constexpr(InputStream<StreamT, Byte, StreamTs...>)
+        if constexpr(isSeekableInput)
         {
             return tellInput();
         }
-        else if constexpr(OutputStream<StreamT, Byte, StreamTs...>)
+        else if constexpr(isSeekableOutput)
         {
             return tellOutput();
         }
@@ -151,12 +445,15 @@ public:
     /**
      * @brief Whether the stream is at the end.
      *
+     * @note This requires the stream to have an `eof()` function.
+     *
      * @return `true` if the stream is at the end.
      */
     auto eof()
         -> bool
+    requires(requires(Stream& stream) { stream.eof(); })
     {
-        return mStream.eof();
+        return (mStream.eof() || mLookaheadEnd) && lookahead() == 0;
     }
 
     /**
@@ -169,7 +466,7 @@ public:
      */
     void seekInput(std::size_t offset = 0,
                    std::ios::seekdir direction = std::ios::cur)
-    requires(isInputStream)
+    requires(isSeekableInput)
     {
         _seekInput(offset, direction);
         synchronizeOutputToInput();
@@ -185,7 +482,7 @@ public:
      */
     void seekOutput(std::size_t offset = 0,
                     std::ios::seekdir direction = std::ios::cur)
-    requires(isOutputStream)
+    requires(isSeekableOutput)
     {
         _seekOutput(offset, direction);
         synchronizeInputToOutput();
@@ -203,20 +500,21 @@ public:
      */
     void seek(std::size_t offset = 0,
               std::ios::seekdir direction = std::ios::cur)
+    requires(isSeekableInput || isSeekableOutput)
     {
-        if constexpr(isInputOutputStream && synchronized())
+        if constexpr(isSynchronizing)
         {
             _seekInput(offset, direction);
             _seekOutput(tellInput());
         }
         else
         {
-            if constexpr(isInputStream)
+            if constexpr(isSeekableInput)
             {
                 _seekInput(offset, direction);
             }
 
-            if constexpr(isOutputStream)
+            if constexpr(isSeekableOutput)
             {
                 _seekOutput(offset, direction);
             }
@@ -230,6 +528,7 @@ public:
      * @param offset     The amount of bytes to seek from the begin. [`0`]
      */
     void toBegin(std::size_t offset = 0)
+    requires(isSeekableInput || isSeekableOutput)
     {
         seek(offset, std::ios::beg);
     }
@@ -241,6 +540,7 @@ public:
      * @param offset     The amount of bytes to seek from the end. [`0`]
      */
     void toEnd(std::size_t offset = 0)
+    requires(isSeekableInput || isSeekableOutput)
     {
         seek(offset, std::ios::end);
     }
@@ -250,7 +550,7 @@ public:
      */
     void synchronizeInputToOutput()
     {
-        if constexpr(isInputOutputStream && synchronized())
+        if constexpr(isSynchronizing)
         {
             _seekInput(tellOutput());
         }
@@ -261,9 +561,11 @@ public:
      */
     void synchronizeOutputToInput()
     {
-        if constexpr(isInputOutputStream && synchronized())
+        // With a lookahead, the next write moves the stream back instead
+        if constexpr(isSynchronizing)
         {
-            _seekOutput(tellInput());
+            if (lookahead() == 0)
+                _seekOutput(tellInput());
         }
     }
 
@@ -281,7 +583,7 @@ public:
     requires(isInputStream)
     {
         std::vector<Byte> data(length);
-        mStream.read(std::ranges::data(data), length);
+        readInto(std::ranges::data(data), length);
 
         synchronizeOutputToInput();
 
@@ -304,7 +606,7 @@ public:
         -> std::tuple<Ts...>
     requires(isInputStream)
     {
-        return BinaryT::template unpack<Ts...>(readRaw(lengthOf<Ts...>()));
+        return BinaryT::template unpack<Ts...>(readFixed<lengthOf<Ts...>()>());
     }
 
     /**
@@ -323,133 +625,1322 @@ public:
         -> T
     requires(isInputStream)
     {
-        return BinaryT::template fromBytes<T>(readRaw(lengthOf<T>()));
+        return BinaryT::template fromBytes<T>(readFixed<lengthOf<T>()>());
     }
 
     /**
-     * @brief Read and decode a string from the stream.
+     * @brief Unpack types from the stream without consuming them.
      *
-     * @tparam CharT       The type to use as character.
-     * @tparam CharTraits  The character traits of the character type.
+     * @details The bytes are read ahead into a buffer of this `BinaryStream`,
+     *          or taken from the buffer of an @ref scppl::SpanSource, and are
+     *          returned again by the next read. This works on streams that can
+     *          not seek, like pipes, and peeking at bytes that are already
+     *          buffered does not touch the stream at all.
      *
-     * @param length    The length of the string to read.
-     * @param encoding  The encoding of the string. [`"UTF-8"`]
+     * @note This requires the stream to be an @ref scppl::InputStream.
      *
-     * @return The decoded string.
+     * @sa scppl::Binary::unpack()
+     *
+     * @tparam Ts  The types to peek at, must be `Unpackable`.
+     *
+     * @throws std::out_of_range  The stream ends before all types.
+     *
+     * @return A tuple of the types.
      */
-    template<typename CharT, typename CharTraits = std::char_traits<CharT>>
-    auto readString(std::size_t length, std::string_view encoding = "UTF-8")
-        -> std::basic_string<CharT>
+    template<Unpackable... Ts>
+    auto peek()
+        -> std::tuple<Ts...>
     requires(isInputStream)
     {
-        return BinaryStringT<CharT, CharTraits>::decode(readRaw(length),
-                                                        encoding);
+        return peekWith<BinaryT, Ts...>();
     }
 
     /**
-     * @brief Write a range of bytes to the stream.
+     * @brief Unpack a single type from the stream without consuming it.
      *
-     * @note This requires the stream to be an @ref scppl::OutputStream.
+     * @code{.cpp}
+     * switch (stream.peekSingle<uint32_t>())
+     * {
+     * case pngMagic: return decodePng(stream);
+     * case zipMagic: return decodeZip(stream);
+     * }
+     * @endcode
      *
-     * @param data  The bytes to write to the stream.
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @sa scppl::BinaryStream::peek()
+     *
+     * @tparam T  The type to peek at, must be `Unpackable`.
+     *
+     * @throws std::out_of_range  The stream ends before the type.
+     *
+     * @return The value.
      */
-    void writeRaw(RangeOf<Byte> auto data)
-    requires(isOutputStream)
+    template<Unpackable T>
+    auto peekSingle()
+        -> T
+    requires(isInputStream)
     {
-        mStream.write(std::ranges::data(data), std::ranges::size(data));
+        return std::get<0>(peek<T>());
+    }
 
-        synchronizeInputToOutput();
+    /**
+     * @brief Get the next bytes of the stream without consuming them.
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @sa scppl::BinaryStream::peek()
+     *
+     * @param length  The amount of bytes to peek at.
+     *
+     * @return A view of the bytes, valid until the next use of this
+     *         `BinaryStream`. Shorter than `length` at the end of the stream.
+     */
+    auto peekRaw(std::size_t length)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        std::span<Byte const> data = fillInput(length, length);
+
+        return data.first(std::min(length, std::ranges::size(data)));
     }
 
     /**
-     * @brief Write types to a stream.
+     * @brief Skip over types in the stream without unpacking them.
      *
-     * @note This requires the stream to be an @ref scppl::OutputStream.
+     * @note This requires the stream to be an @ref scppl::InputStream.
      *
-     * @sa scppl::Binary::pack()
+     * @sa scppl::BinaryStream::skipRaw()
      *
-     * @tparam Ts  The types to write to the stream, must be `Packable`.
+     * @tparam Ts  The types to skip, must be `Unpackable`.
      *
-     * @param types  The values to write to the stream.
+     * @param count  The amount of times to skip `Ts...`. [`1`]
      */
-    template<Packable... Ts>
-    void write(Ts... types)
-    requires(isOutputStream)
+    template<Unpackable... Ts>
+    void skip(std::size_t count = 1)
+    requires(isInputStream)
     {
-        writeRaw(BinaryT::template pack<Ts...>(types...));
+        skipRaw(lengthOf<Ts...>() * count);
     }
 
     /**
-     * @brief Encode and write a string to the stream.
+     * @brief Skip over an amount of bytes in the stream.
      *
-     * @tparam CharT       The type to use as character.
-     * @tparam CharTraits  The character traits of the character type.
+     * @details Bytes that are already buffered are skipped by moving past
+     *          them. Otherwise seekable streams are seeked, and other streams
+     *          are read into a reused buffer, so nothing is allocated per call.
+     *          Like `seekInput()`, skipping past the end of a seekable stream
+     *          is not detected until the next read.
      *
-     * @param string    The string to encode and write.
-     * @param encoding  The encoding of the string. [`"UTF-8"`]
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @param length  The amount of bytes to skip.
      */
-    template<typename CharT, typename CharTraits = std::char_traits<CharT>>
-    void writeString(std::basic_string_view<CharT> string,
-                     std::string_view encoding = "UTF-8")
-    requires(isOutputStream)
+    void skipRaw(std::size_t length)
+    requires(isInputStream)
     {
-        writeRaw(BinaryStringT<CharT, CharTraits>::encode(string, encoding));
+        std::size_t ahead = std::min(lookahead(), length);
+        if (ahead > 0)
+            consumeInput(ahead);
+
+        length -= ahead;
+
+        if (length > 0)
+            skipStream(length);
+
+        synchronizeOutputToInput();
     }
 
-private:
-    Stream& mStream{};
+    /**
+     * @brief Read an array of a type from a stream into `values`.
+     *
+     * @details All values are read with a single read from the stream, and
+     *          then converted to native endian in place.
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @sa scppl::Binary::convert()
+     *
+     * @tparam T  The type to read from the stream, must be `Unpackable` and
+     *            trivially copyable.
+     *
+     * @param values  Where to store the read values.
+     *
+     * @return The amount of values read, less than the size of `values` at
+     *         the end of the stream.
+     */
+    template<Unpackable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    auto readArray(std::span<T> values)
+        -> std::size_t
+    requires(isInputStream)
+    {
+        return readArrayWith<BinaryT>(values);
+    }
 
-    /// Actual implementation for `seekInput`.
-    void _seekInput(std::size_t offset = 0,
-                    std::ios::seekdir direction = std::ios::beg)
+    /**
+     * @brief Read an array of a type from a stream.
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @sa scppl::BinaryStream::readArray(std::span<T>)
+     *
+     * @tparam T  The type to read from the stream, must be `Unpackable` and
+     *            trivially copyable.
+     *
+     * @param count  The amount of values to read.
+     *
+     * @return A `std::vector` of the read values, shorter than `count` at the
+     *         end of the stream.
+     */
+    template<Unpackable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    auto readArray(std::size_t count)
+        -> std::vector<T>
     requires(isInputStream)
     {
-        mStream.seekg(offset, direction);
+        std::vector<T> values(count);
+        values.resize(readArray<T>(std::span<T>(values)));
+
+        return values;
     }
 
-    /// Actual implementation for `seekOutput`.
-    void _seekOutput(std::size_t offset = 0,
-                     std::ios::seekdir direction = std::ios::beg)
-    requires(isOutputStream)
+    /**
+     * @brief Read bytes from the stream into multiple ranges at once.
+     *
+     * @details If the stream is an @ref scppl::ScatterSource, like
+     *          @ref scppl::FileStream, the ranges are passed to the stream
+     *          together, which maps to a single `preadv` for large reads.
+     *          Otherwise the ranges are read one after another.
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @param parts  Contiguous ranges of `Byte`s to fill, in order.
+     *
+     * @return The amount of bytes read, less than the total size of the
+     *         ranges at the end of the stream.
+     */
+    template<typename... Rs>
+    requires((std::constructible_from<std::span<Byte>, Rs&> && ...))
+    auto readScatter(Rs&&... parts)
+        -> std::size_t
+    requires(isInputStream)
     {
-        mStream.seekp(offset, direction);
+        std::array<std::span<Byte>, sizeof...(Rs)> spans{
+            std::span<Byte>(parts)...};
+
+        std::size_t done = 0;
+        if constexpr(ScatterSource<Stream, Byte>)
+        {
+            if (lookahead() == 0)
+            {
+                done = mStream.readv(std::span<std::span<Byte> const>(spans));
+
+                synchronizeOutputToInput();
+
+                return done;
+            }
+        }
+
+        for (std::span<Byte> part : spans)
+        {
+            std::size_t count = readInto(std::ranges::data(part),
+                                         std::ranges::size(part));
+            done += count;
+            if (count < std::ranges::size(part))
+                break;
+        }
+
+        synchronizeOutputToInput();
+
+        return done;
+    }
+
+    /**
+     * @brief Read an amount of bytes at an offset into a `std::vector`.
+     *
+     * @details This does not use or move the read position, so it can be
+     *          called from multiple threads at once.
+     *
+     * @note This requires the stream to be an @ref scppl::PositionalSource.
+     *
+     * @param offset  The offset to read from.
+     * @param length  The amount of bytes to read.
+     *
+     * @return A `std::vector` of the read bytes, shorter than `length` at the
+     *         end of the stream.
+     */
+    auto readRawAt(std::size_t offset, std::size_t length) const
+        -> std::vector<Byte>
+    requires(isPositionalInput)
+    {
+        std::vector<Byte> data(length);
+        data.resize(std::as_const(mStream).readAt(std::ranges::data(data),
+                                                  length, offset));
+
+        return data;
+    }
+
+    /**
+     * @brief Read types at an offset.
+     *
+     * @details This does not use or move the read position, so it can be
+     *          called from multiple threads at once.
+     *
+     * @note This requires the stream to be an @ref scppl::PositionalSource.
+     *
+     * @sa scppl::Binary::unpack()
+     *
+     * @tparam Ts  The types to read from the stream, must be `Unpackable`.
+     *
+     * @param offset  The offset to read from.
+     *
+     * @throws std::out_of_range  The stream ends before all types are read.
+     *
+     * @return A tuple of the read types.
+     */
+    template<Unpackable... Ts>
+    auto readAt(std::size_t offset) const
+        -> std::tuple<Ts...>
+    requires(isPositionalInput)
+    {
+        return readAtWith<BinaryT, Ts...>(offset);
+    }
+
+    /**
+     * @brief Lazily read records of types from a stream.
+     *
+     * @details The stream is read in blocks of `blockSize` bytes, and records
+     *          are decoded from the block, which is much faster than calling
+     *          `read()` for every record. The range ends at the first
+     *          incomplete record.
+     *
+     * @code{.cpp}
+     * for (auto [id, value] : stream.records<uint32_t, double>())
+     *     process(id, value);
+     * @endcode
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @sa scppl::BinaryStream::Records
+     *
+     * @tparam Ts  The types of a single record, must be `Unpackable`.
+     *
+     * @param blockSize  The amount of bytes to read at once, ignored if the
+     *                   stream is an @ref scppl::SpanSource.
+     *                   [`defaultBlockSize`]
+     *
+     * @return An input range of `T` for a single type, or of `std::tuple`s of
+     *         `Ts...`.
+     */
+    template<Unpackable... Ts>
+    auto records(std::size_t blockSize = defaultBlockSize)
+        -> Records<Ts...>
+    requires(isInputStream)
+    {
+        return Records<Ts...>(*this, blockSize);
+    }
+
+    /**
+     * @brief Read and decode a string from the stream.
+     *
+     * @tparam CharT       The type to use as character.
+     * @tparam CharTraits  The character traits of the character type.
+     *
+     * @param length    The length of the string to read.
+     * @param encoding  The encoding of the string. [`"UTF-8"`]
+     *
+     * @return The decoded string.
+     */
+    template<typename CharT, typename CharTraits = std::char_traits<CharT>>
+    auto readString(std::size_t length, std::string_view encoding = "UTF-8")
+        -> std::basic_string<CharT>
+    requires(isInputStream)
+    {
+        return BinaryStringT<CharT, CharTraits>::decode(readRaw(length),
+                                                        encoding);
+    }
+
+    /**
+     * @brief Read the bytes up to a delimiter from the stream.
+     *
+     * @details The buffer of the stream is searched with `std::memchr`, which
+     *          is vectorized by the C library. If the stream is an
+     *          @ref scppl::SpanSource, like @ref scppl::FileStream, it is asked
+     *          for more bytes until its buffer holds the delimiter, and the
+     *          view points into that buffer. Other streams are read ahead in blocks and the view
+     *          points into the lookahead of this `BinaryStream`, so a match
+     *          across multiple blocks is not copied again either. Bytes that
+     *          are read ahead are returned by the next read.
+     *
+     * @code{.cpp}
+     * while (!stream.eof())
+     *     handle(stream.readUntil('\n'));
+     * @endcode
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @param delimiter  The byte to read up to, it is consumed but not
+     *                   returned.
+     * @param maxLength  The longest accepted result, protecting against a
+     *                   missing delimiter. [`defaultMaxUntilLength`]
+     *
+     * @throws std::length_error  No delimiter within `maxLength` bytes,
+     *                            nothing is consumed then.
+     *
+     * @return The bytes before the delimiter, valid until the next use of this
+     *         `BinaryStream`. The rest of the stream, with `eof()` set, if the
+     *         stream ends before a delimiter.
+     */
+    auto readUntil(Byte delimiter,
+                   std::size_t maxLength = defaultMaxUntilLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        std::span<Byte const> bytes{};
+        if constexpr(SpanSource<Stream, Byte>)
+        {
+            bytes = scanSource(delimiter, maxLength);
+        }
+        else
+        {
+            bytes = scanLookahead(delimiter, maxLength);
+        }
+
+        synchronizeOutputToInput();
+
+        return bytes;
+    }
+
+    /**
+     * @brief Read a NUL-terminated string from the stream.
+     *
+     * @sa scppl::BinaryStream::readUntil()
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @param maxLength  The longest accepted string, without the terminator.
+     *                   [`defaultMaxUntilLength`]
+     *
+     * @throws std::length_error  No terminator within `maxLength` bytes.
+     *
+     * @return The string without the terminator, valid until the next use of
+     *         this `BinaryStream`.
+     */
+    auto readCString(std::size_t maxLength = defaultMaxUntilLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        return readUntil(Byte{}, maxLength);
+    }
+
+    /**
+     * @brief Read a length-prefixed frame written by `writeFrame()`.
+     *
+     * @details The payload is returned as a view instead of a copy. If the
+     *          stream is an @ref scppl::SpanSource, like
+     *          @ref scppl::FileStream, or the payload is already read ahead,
+     *          the view points into that buffer. Otherwise the payload is read
+     *          into a buffer of this `BinaryStream`, which is reused for every
+     *          frame, so no memory is allocated per frame.
+     *
+     * @code{.cpp}
+     * while (true)
+     * {
+     *     auto payload = stream.readFrame<scppl::FramePrefix::Varint>();
+     *     if (stream.eof())
+     *         break;
+     *
+     *     handle(payload);
+     * }
+     * @endcode
+     *
+     * @note This requires the stream to be an @ref scppl::InputStream.
+     *
+     * @tparam tPrefix  The type of the length prefix. [`FramePrefix::U32`]
+     *
+     * @param maxLength  The largest accepted payload, protecting against
+     *                   corrupt prefixes. [`defaultMaxFrameLength`]
+     *
+     * @throws std::length_error  The payload is longer than `maxLength`.
+     * @throws std::out_of_range  The stream ends inside the frame.
+     *
+     * @return The payload, valid until the next use of this `BinaryStream`.
+     *         Empty with `eof()` set if the stream ends before the frame.
+     */
+    template<FramePrefix tPrefix = FramePrefix::U32>
+    auto readFrame(std::size_t maxLength = defaultMaxFrameLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        return readFrameWith<BinaryT, tPrefix>(maxLength);
+    }
+
+    /**
+     * @brief Write a range of bytes to the stream.
+     *
+     * @note This requires the stream to be an @ref scppl::OutputStream.
+     *
+     * @param data  The bytes to write to the stream.
+     */
+    void writeRaw(RangeOf<Byte> auto data)
+    requires(isOutputStream)
+    {
+        prepareOutput();
+
+        writeFrom(std::ranges::data(data), std::ranges::size(data));
+
+        synchronizeInputToOutput();
+    }
+
+    /**
+     * @brief Write multiple ranges of bytes to the stream at once.
+     *
+     * @details The ranges are never concatenated, so a header packed into a
+     *          `std::array` on the stack can be written together with a
+     *          payload owned by the caller. If the stream is an
+     *          @ref scppl::GatherSink, like @ref scppl::FileStream, the ranges
+     *          are passed to the stream together, which maps to a single
+     *          `pwritev` for large writes. Otherwise the ranges are written
+     *          one after another.
+     *
+     * @code{.cpp}
+     * auto header = scppl::Binary<>::pack(type, size);
+     * stream.writeGather(header, payload, trailer);
+     * @endcode
+     *
+     * @note This requires the stream to be an @ref scppl::OutputStream.
+     *
+     * @param parts  Contiguous ranges of `Byte`s to write, in order.
+     */
+    template<typename... Rs>
+    requires((std::constructible_from<std::span<Byte const>, Rs const&> && ...))
+    void writeGather(Rs const&... parts)
+    requires(isOutputStream)
+    {
+        prepareOutput();
+
+        if constexpr(GatherSink<Stream, Byte>)
+        {
+            std::array<std::span<Byte const>, sizeof...(Rs)> spans{
+                std::span<Byte const>(parts)...};
+            mStream.writev(std::span<std::span<Byte const> const>(spans));
+        }
+        else
+        {
+            (writeFrom(std::ranges::data(parts), std::ranges::size(parts)),
+             ...);
+        }
+
+        synchronizeInputToOutput();
+    }
+
+    /**
+     * @brief Write types to a stream.
+     *
+     * @note This requires the stream to be an @ref scppl::OutputStream.
+     *
+     * @sa scppl::Binary::pack()
+     *
+     * @tparam Ts  The types to write to the stream, must be `Packable`.
+     *
+     * @param types  The values to write to the stream.
+     */
+    template<Packable... Ts>
+    void write(Ts... types)
+    requires(isOutputStream)
+    {
+        writeWith<BinaryT>(types...);
+    }
+
+    /**
+     * @brief Write an array of a type to a stream.
+     *
+     * @details All values are written with a single write to the stream. For
+     *          non-native endian the values are converted in a copy, or in the
+     *          buffer of a @ref scppl::SpanSink.
+     *
+     * @note This requires the stream to be an @ref scppl::OutputStream.
+     *
+     * @sa scppl::Binary::convert()
+     *
+     * @tparam T  The type to write to the stream, must be `Packable` and
+     *            trivially copyable.
+     *
+     * @param values  The values to write to the stream.
+     */
+    template<Packable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    void writeArray(std::span<T const> values)
+    requires(isOutputStream)
+    {
+        writeArrayWith<BinaryT>(values);
+    }
+
+    /**
+     * @brief Encode and write a string to the stream.
+     *
+     * @tparam CharT       The type to use as character.
+     * @tparam CharTraits  The character traits of the character type.
+     *
+     * @param string    The string to encode and write.
+     * @param encoding  The encoding of the string. [`"UTF-8"`]
+     */
+    template<typename CharT, typename CharTraits = std::char_traits<CharT>>
+    void writeString(std::basic_string_view<CharT> string,
+                     std::string_view encoding = "UTF-8")
+    requires(isOutputStream)
+    {
+        writeRaw(BinaryStringT<CharT, CharTraits>::encode(string, encoding));
+    }
+
+    /**
+     * @brief Write a length-prefixed frame.
+     *
+     * @details The prefix and the payload are written together with
+     *          `writeGather()`, so the payload is never copied into a
+     *          temporary buffer.
+     *
+     * @note This requires the stream to be an @ref scppl::OutputStream.
+     *
+     * @tparam tPrefix  The type of the length prefix. [`FramePrefix::U32`]
+     *
+     * @param payload  The bytes of the frame.
+     *
+     * @throws std::length_error  The payload does not fit in the prefix.
+     */
+    template<FramePrefix tPrefix = FramePrefix::U32>
+    void writeFrame(std::span<Byte const> payload)
+    requires(isOutputStream)
+    {
+        writeFrameWith<BinaryT, tPrefix>(payload);
+    }
+
+private:
+    template<bool, typename, typename> friend class DynamicEndianBinaryStream;
+
+    /// The most bytes a varint of a `std::size_t` takes.
+    static constexpr std::size_t maxVarintLength =
+        (std::numeric_limits<std::size_t>::digits + 6) / 7;
+
+    /// Whether the read and write positions need to be kept synchronized.
+    static constexpr bool isSynchronizing =
+        isSeekableInput && isSeekableOutput && synchronized();
+
+    Stream& mStream{};
+
+    /// Bytes read ahead by `fillInput`, for sources without their own buffer.
+    std::vector<Byte> mLookahead{};
+    std::size_t mLookaheadPosition{};
+    bool mLookaheadEnd{};
+
+    /// Reused by `readFrame` and `skipRaw` for bytes the source does not
+    /// buffer itself.
+    std::vector<Byte> mScratch{};
+
+    /// Actual implementation for `seekInput`.
+    void _seekInput(std::size_t offset = 0,
+                    std::ios::seekdir direction = std::ios::beg)
+    requires(isSeekableInput)
+    {
+        // The stream itself is ahead of the read position by the lookahead
+        if (direction == std::ios::cur)
+            offset -= lookahead();
+
+        mLookahead.clear();
+        mLookaheadPosition = 0;
+        mLookaheadEnd = false;
+
+        mStream.seekg(offset, direction);
+    }
+
+    /// Actual implementation for `seekOutput`.
+    void _seekOutput(std::size_t offset = 0,
+                     std::ios::seekdir direction = std::ios::beg)
+    requires(isSeekableOutput)
+    {
+        mStream.seekp(offset, direction);
+    }
+
+    /// Move a synchronized stream back from the bytes peeked at, to write.
+    void prepareOutput()
+    {
+        if constexpr(isSynchronizing)
+        {
+            if (lookahead() > 0)
+            {
+                std::size_t position = tellInput();
+                _seekInput(position);
+                _seekOutput(position);
+            }
+        }
+    }
+
+    /// `peek` with the endian of `BinaryU`.
+    template<typename BinaryU, Unpackable... Ts>
+    auto peekWith()
+        -> std::tuple<Ts...>
+    requires(isInputStream)
+    {
+        constexpr std::size_t length = lengthOf<Ts...>();
+
+        std::span<Byte const> data = fillInput(length, length);
+        if (std::ranges::size(data) < length)
+            throw std::out_of_range("Not enough bytes to peek");
+
+        return BinaryU::template unpack<Ts...>(data.first(length));
+    }
+
+    /// `readArray` with the endian of `BinaryU`.
+    template<typename BinaryU, Unpackable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    auto readArrayWith(std::span<T> values)
+        -> std::size_t
+    requires(isInputStream)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::size_t count = readInto(reinterpret_cast<Byte*>(
+                                         std::ranges::data(values)),
+                                     values.size_bytes()) / sizeof(T);
+        BinaryU::template convert<T>(values.first(count));
+
+        synchronizeOutputToInput();
+
+        return count;
+    }
+
+    /// `readAt` with the endian of `BinaryU`.
+    template<typename BinaryU, Unpackable... Ts>
+    auto readAtWith(std::size_t offset) const
+        -> std::tuple<Ts...>
+    requires(isPositionalInput)
+    {
+        constexpr std::size_t length = lengthOf<Ts...>();
+
+        std::array<Byte, length> data{};
+        if (std::as_const(mStream).readAt(std::ranges::data(data), length,
+                                          offset) < length)
+        {
+            throw std::out_of_range("Not enough bytes to read at offset");
+        }
+
+        return BinaryU::template unpack<Ts...>(data);
+    }
+
+    /// `readFrame` with the endian of `BinaryU`.
+    template<typename BinaryU, FramePrefix tPrefix>
+    auto readFrameWith(std::size_t maxLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        std::optional<std::size_t> prefix{};
+        if constexpr(tPrefix == FramePrefix::U16)
+        {
+            if (auto data = readPrefix<lengthOf<uint16_t>()>())
+                prefix = BinaryU::template fromBytes<uint16_t>(*data);
+        }
+        else if constexpr(tPrefix == FramePrefix::U32)
+        {
+            if (auto data = readPrefix<lengthOf<uint32_t>()>())
+                prefix = BinaryU::template fromBytes<uint32_t>(*data);
+        }
+        else
+        {
+            prefix = readVarint();
+        }
+
+        // Only a stream that ends right before the frame is a clean end
+        std::size_t length = prefix.value_or(0);
+        if (length > maxLength)
+            throw std::length_error("Frame is longer than the maximum length");
+
+        // Not for empty frames, which are also returned at the end of the
+        // stream where the source must keep its state
+        std::span<Byte const> payload{};
+        if (length > 0)
+        {
+            payload = readView(length);
+            if (std::ranges::size(payload) < length)
+                throw std::out_of_range("Not enough bytes to read frame");
+        }
+
+        synchronizeOutputToInput();
+
+        return payload;
+    }
+
+    /// `write` with the endian of `BinaryU`.
+    template<typename BinaryU, Packable... Ts>
+    void writeWith(Ts... types)
+    requires(isOutputStream)
+    {
+        prepareOutput();
+
+        if constexpr(SpanSink<Stream, Byte>)
+        {
+            // Pack straight into the buffer of the sink
+            constexpr std::size_t length = lengthOf<Ts...>();
+            BinaryU::template packInto<Ts...>(mStream.acquire(length),
+                                              types...);
+            mStream.commit(length);
+
+            synchronizeInputToOutput();
+        }
+        else
+        {
+            writeRaw(BinaryU::template pack<Ts...>(types...));
+        }
+    }
+
+    /// `writeArray` with the endian of `BinaryU`.
+    template<typename BinaryU, Packable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    void writeArrayWith(std::span<T const> values)
+    requires(isOutputStream)
+    {
+        prepareOutput();
+
+        using ValueT = std::remove_const_t<T>;
+
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        if constexpr(BinaryU::endian() == std::endian::native)
+        {
+            writeFrom(reinterpret_cast<Byte const*>(std::ranges::data(values)),
+                      values.size_bytes());
+        }
+        else if constexpr(SpanSink<Stream, Byte>)
+        {
+            std::span<Byte> buffer = mStream.acquire(values.size_bytes());
+            std::memcpy(std::ranges::data(buffer), std::ranges::data(values),
+                        values.size_bytes());
+            BinaryU::template convert<ValueT>(
+                {reinterpret_cast<ValueT*>(std::ranges::data(buffer)),
+                 std::ranges::size(values)});
+            mStream.commit(values.size_bytes());
+        }
+        else
+        {
+            std::vector<ValueT> converted(std::ranges::begin(values),
+                                          std::ranges::end(values));
+            BinaryU::template convert<ValueT>(converted);
+            writeFrom(reinterpret_cast<Byte const*>(
+                          std::ranges::data(converted)),
+                      values.size_bytes());
+        }
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        synchronizeInputToOutput();
+    }
+
+    /// `writeFrame` with the endian of `BinaryU`.
+    template<typename BinaryU, FramePrefix tPrefix>
+    void writeFrameWith(std::span<Byte const> payload)
+    requires(isOutputStream)
+    {
+        std::size_t length = std::ranges::size(payload);
+        if constexpr(tPrefix == FramePrefix::Varint)
+        {
+            std::array<Byte, maxVarintLength> prefix{};
+            std::size_t count = 0;
+            do
+            {
+                auto group = static_cast<uint8_t>(length & 0x7f);
+                length >>= 7;
+                prefix[count++] = static_cast<Byte>(
+                    (length != 0) ? (group | 0x80) : group);
+            }
+            while (length != 0);
+
+            writeGather(std::span<Byte const>(prefix).first(count), payload);
+        }
+        else
+        {
+            using Length = std::conditional_t<tPrefix == FramePrefix::U16,
+                                              uint16_t, uint32_t>;
+            if (length > std::numeric_limits<Length>::max())
+                throw std::length_error("Frame is too long for its prefix");
+
+            writeGather(BinaryU::template pack<Length>(
+                            static_cast<Length>(length)),
+                        payload);
+        }
+    }
+
+    /// Read `N` bytes into an array, without allocating.
+    template<std::size_t N>
+    auto readFixed()
+        -> std::array<Byte, N>
+    requires(isInputStream)
+    {
+        std::array<Byte, N> data{};
+        readInto(std::ranges::data(data), N);
+
+        synchronizeOutputToInput();
+
+        return data;
+    }
+
+    /// The amount of bytes read ahead from the stream, but not yet consumed.
+    auto lookahead() const
+        -> std::size_t
+    {
+        return std::ranges::size(mLookahead) - mLookaheadPosition;
+    }
+
+    /**
+     * Get at least `length` bytes from the read position without consuming
+     * them, less at the end of the stream. Sources without their own buffer
+     * are read `hint` bytes at a time.
+     */
+    auto fillInput(std::size_t length, std::size_t hint)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        if constexpr(SpanSource<Stream, Byte>)
+        {
+            return mStream.acquire(length);
+        }
+        else
+        {
+            if (std::size_t available = lookahead(); available < length)
+            {
+                mLookahead.erase(std::ranges::begin(mLookahead),
+                                 std::ranges::begin(mLookahead) +
+                                     static_cast<std::ptrdiff_t>(
+                                         mLookaheadPosition));
+                mLookaheadPosition = 0;
+
+                mLookahead.resize(std::max(length, hint));
+                std::size_t count = readStream(std::ranges::data(mLookahead) +
+                                                   available,
+                                               std::ranges::size(mLookahead) -
+                                                   available);
+                mLookahead.resize(available + count);
+
+                // Reading ahead is allowed to hit the end of the stream, keep
+                // the stream usable and remember the end separately
+                if (std::ranges::size(mLookahead) < std::max(length, hint))
+                {
+                    mLookaheadEnd = true;
+
+                    if constexpr(requires(Stream& stream) {
+                                     stream.clear(stream.rdstate());
+                                 })
+                    {
+                        mStream.clear(mStream.rdstate() &
+                                      ~(std::ios::eofbit | std::ios::failbit));
+                    }
+                }
+            }
+
+            return std::span<Byte const>(mLookahead).subspan(
+                mLookaheadPosition);
+        }
+    }
+
+    /// Consume `length` bytes of the last `fillInput`.
+    void consumeInput(std::size_t length)
+    requires(isInputStream)
+    {
+        if constexpr(SpanSource<Stream, Byte>)
+        {
+            mStream.commit(length);
+        }
+        else
+        {
+            mLookaheadPosition += length;
+            if (mLookaheadPosition == std::ranges::size(mLookahead))
+            {
+                mLookahead.clear();
+                mLookaheadPosition = 0;
+            }
+        }
+    }
+
+    /**
+     * Read the `N` bytes of a frame prefix, `std::nullopt` at the end of the
+     * stream. Throws `std::out_of_range` when the stream ends inside it.
+     */
+    template<std::size_t N>
+    auto readPrefix()
+        -> std::optional<std::array<Byte, N>>
+    requires(isInputStream)
+    {
+        std::array<Byte, N> data{};
+        std::size_t count = readInto(std::ranges::data(data), N);
+        if (count == 0)
+            return std::nullopt;
+
+        if (count < N)
+            throw std::out_of_range("Not enough bytes to read frame length");
+
+        return data;
+    }
+
+    /**
+     * Read an unsigned LEB128 varint, `std::nullopt` at the end of the stream.
+     * Throws `std::out_of_range` when the stream ends inside it.
+     */
+    auto readVarint()
+        -> std::optional<std::size_t>
+    requires(isInputStream)
+    {
+        std::size_t value = 0;
+        for (std::size_t i = 0; i < maxVarintLength; ++i)
+        {
+            Byte byte{};
+            if (readInto(&byte, 1) == 0)
+            {
+                if (i == 0)
+                    return std::nullopt;
+
+                throw std::out_of_range("Not enough bytes to read frame "
+                                        "length");
+            }
+
+            auto group = static_cast<uint8_t>(byte);
+            value |= static_cast<std::size_t>(group & 0x7f) << (7 * i);
+            if ((group & 0x80) == 0)
+                return value;
+        }
+
+        throw std::length_error("Varint is too long");
+    }
+
+    /**
+     * Consume `length` bytes and return a view of them, less at the end of the
+     * stream. The view points into the buffer of the source or the lookahead
+     * when possible, and into `mScratch` otherwise.
+     */
+    auto readView(std::size_t length)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        if constexpr(SpanSource<Stream, Byte>)
+        {
+            // Committing keeps the span valid until the next `acquire()`
+            std::span<Byte const> buffer = mStream.acquire(length);
+            length = std::min(length, std::ranges::size(buffer));
+            mStream.commit(length);
+
+            return buffer.first(length);
+        }
+        else
+        {
+            if (lookahead() >= length)
+            {
+                // Not `consumeInput()`, which would clear the lookahead
+                std::span<Byte const> view = std::span<Byte const>(mLookahead)
+                    .subspan(mLookaheadPosition, length);
+                mLookaheadPosition += length;
+
+                return view;
+            }
+
+            mScratch.resize(length);
+            mScratch.resize(readInto(std::ranges::data(mScratch), length));
+
+            return mScratch;
+        }
+    }
+
+    /// The index of the first `delimiter` in `bytes`, or its size.
+    static auto findByte(std::span<Byte const> bytes, Byte delimiter)
+        -> std::size_t
+    {
+        // An empty span may have no data for `std::memchr` to search
+        if (std::ranges::empty(bytes))
+            return 0;
+
+        void const* found = std::memchr(std::ranges::data(bytes),
+                                        std::bit_cast<unsigned char>(delimiter),
+                                        std::ranges::size(bytes));
+        if (found == nullptr)
+            return std::ranges::size(bytes);
+
+        return static_cast<std::size_t>(static_cast<Byte const*>(found) -
+                                        std::ranges::data(bytes));
+    }
+
+    /**
+     * `readUntil` for an @ref scppl::SpanSource, which asks the source for
+     * more bytes until its buffer holds a delimiter. Nothing is consumed
+     * before the delimiter is found.
+     */
+    auto scanSource(Byte delimiter, std::size_t maxLength)
+        -> std::span<Byte const>
+    requires(isInputStream && SpanSource<Stream, Byte>)
+    {
+        std::size_t scanned = 0;
+        std::size_t wanted = 1;
+        while (true)
+        {
+            std::span<Byte const> buffer = mStream.acquire(wanted);
+            std::size_t index = scanned +
+                                findByte(buffer.subspan(scanned), delimiter);
+            if (index > maxLength)
+                throw std::length_error("Delimiter not found within the "
+                                        "maximum length");
+
+            if (index < std::ranges::size(buffer))
+            {
+                mStream.commit(index + 1);
+
+                return buffer.first(index);
+            }
+
+            if (std::ranges::size(buffer) < wanted)
+            {
+                mStream.commit(index);
+
+                return buffer;
+            }
+
+            // Doubling keeps the bytes a growing source reads again linear
+            scanned = std::ranges::size(buffer);
+            wanted = 2 * scanned;
+        }
+    }
+
+    /**
+     * `readUntil` for other streams, which extends the lookahead until it
+     * holds a delimiter. Only the bytes that were added are searched.
+     */
+    auto scanLookahead(Byte delimiter, std::size_t maxLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        std::size_t scanned = 0;
+        while (true)
+        {
+            std::span<Byte const> buffer = fillInput(scanned + 1,
+                                                     scanned + scanLength());
+            std::size_t index = scanned +
+                                findByte(buffer.subspan(scanned), delimiter);
+            if (index > maxLength)
+                throw std::length_error("Delimiter not found within the "
+                                        "maximum length");
+
+            if (index < std::ranges::size(buffer))
+            {
+                // Not `consumeInput()`, which would clear the lookahead
+                mLookaheadPosition += index + 1;
+
+                return buffer.first(index);
+            }
+
+            if (std::ranges::size(buffer) == scanned)
+            {
+                mLookaheadPosition += index;
+
+                return buffer;
+            }
+
+            scanned = std::ranges::size(buffer);
+        }
+    }
+
+    /**
+     * The amount of bytes to read ahead while searching. For an `iostream`
+     * only what it has available, so a pipe does not block on more data than
+     * needed.
+     */
+    auto scanLength()
+        -> std::size_t
+    requires(isInputStream)
+    {
+        if constexpr(requires(Stream& stream) { stream.rdbuf()->in_avail(); })
+        {
+            auto available = mStream.rdbuf()->in_avail();
+            if (available <= 0)
+                return 1;
+
+            return std::min(static_cast<std::size_t>(available),
+                            defaultBlockSize);
+        }
+        else
+        {
+            return defaultBlockSize;
+        }
+    }
+
+    /// Skip `length` bytes of the stream itself, without a lookahead.
+    void skipStream(std::size_t length)
+    requires(isInputStream)
+    {
+        constexpr bool isIostream = requires(Stream& stream) {
+            stream.rdbuf()->in_avail();
+            stream.ignore(std::streamsize{});
+        };
+
+        if constexpr(isIostream)
+        {
+            // Inside the buffer of the `std::streambuf`, or without seeking
+            auto available = mStream.rdbuf()->in_avail();
+            if (!isSeekableInput ||
+                (available > 0 && static_cast<std::size_t>(available) >= length))
+            {
+                mStream.ignore(static_cast<std::streamsize>(length));
+
+                return;
+            }
+        }
+
+        if constexpr(isSeekableInput)
+        {
+            _seekInput(length, std::ios::cur);
+        }
+        else if constexpr(SpanSource<Stream, Byte>)
+        {
+            while (length > 0)
+            {
+                std::size_t count = std::min(std::ranges::size(
+                                                 mStream.acquire(1)),
+                                             length);
+                if (count == 0)
+                    break;
+
+                mStream.commit(count);
+                length -= count;
+            }
+        }
+        else if constexpr(!isIostream)
+        {
+            mScratch.resize(std::min(length, defaultBlockSize));
+            while (length > 0)
+            {
+                std::size_t part = std::min(length,
+                                            std::ranges::size(mScratch));
+                std::size_t count = readStream(std::ranges::data(mScratch),
+                                               part);
+                length -= count;
+                if (count < part)
+                    break;
+            }
+        }
+    }
+
+    /// Read up to `length` bytes into `data`, returns the amount read.
+    auto readInto(Byte* data, std::size_t length)
+        -> std::size_t
+    requires(isInputStream)
+    {
+        if constexpr(SpanSource<Stream, Byte> &&
+                     !requires { mStream.read(data, length); })
+        {
+            std::size_t done = 0;
+            while (done < length)
+            {
+                std::span<Byte const> buffer = mStream.acquire(length - done);
+                std::size_t count = std::min(std::ranges::size(buffer),
+                                             length - done);
+                if (count == 0)
+                    break;
+
+                std::ranges::copy_n(std::ranges::begin(buffer), count,
+                                    data + done);
+                mStream.commit(count);
+                done += count;
+            }
+
+            return done;
+        }
+        else if constexpr(SpanSource<Stream, Byte>)
+        {
+            return readStream(data, length);
+        }
+        else
+        {
+            // Drain the lookahead before reading from the stream again
+            std::size_t done = std::min(lookahead(), length);
+            std::ranges::copy_n(std::ranges::begin(mLookahead) +
+                                    static_cast<std::ptrdiff_t>(
+                                        mLookaheadPosition),
+                                static_cast<std::ptrdiff_t>(done), data);
+            consumeInput(done);
+
+            if (done < length)
+                done += readStream(data + done, length - done);
+
+            return done;
+        }
+    }
+
+    /// Read up to `length` bytes from the stream itself.
+    auto readStream(Byte* data, std::size_t length)
+        -> std::size_t
+    requires(isInputStream)
+    {
+        std::size_t count = length;
+
+        using Result = decltype(mStream.read(data, length));
+        if constexpr(std::is_integral_v<Result>)
+        {
+            count = static_cast<std::size_t>(mStream.read(data, length));
+        }
+        else if constexpr(requires { mStream.gcount(); })
+        {
+            mStream.read(data, length);
+            count = static_cast<std::size_t>(mStream.gcount());
+        }
+        else
+        {
+            mStream.read(data, length);
+        }
+
+        // A pipe, socket or growing file can have new bytes after an end
+        if (count > 0)
+            mLookaheadEnd = false;
+
+        return count;
+    }
+
+    /// Write `length` bytes from `data`.
+    void writeFrom(Byte const* data, std::size_t length)
+    requires(isOutputStream)
+    {
+        // The bytes already exist, so a sink that buffers gets the chance to
+        // pass large writes past its buffer
+        if constexpr(requires { mStream.write(data, length); })
+        {
+            mStream.write(data, length);
+        }
+        else
+        {
+            std::ranges::copy_n(data, length,
+                                std::ranges::begin(mStream.acquire(length)));
+            mStream.commit(length);
+        }
     }
 };
 
-/// An alias for `BinaryStream`, defaulting `StreamT` to `std::basic_istream`.
+/// An alias for `BinaryStream`, defaulting `StreamT` to `std::istream`.
 template<std::endian tEndian = std::endian::native, bool tSynchronized = true,
-         template<typename, typename...> typename StreamT = std::basic_istream,
-         typename ByteT = char, typename... StreamTs>
-using BinaryInputStream = BinaryStream<tEndian, tSynchronized,
-                                       StreamT, ByteT, StreamTs...>;
+         typename StreamT = std::istream, typename ByteT = StreamByteT<StreamT>>
+using BinaryInputStream = BinaryStream<tEndian, tSynchronized, StreamT, ByteT>;
 
-/// An alias for `BinaryStream`, defaulting `StreamT` to `std::basic_ostream`.
+/// An alias for `BinaryStream`, defaulting `StreamT` to `std::ostream`.
 template<std::endian tEndian = std::endian::native, bool tSynchronized = true,
-         template<typename, typename...> typename StreamT = std::basic_ostream,
-         typename ByteT = char, typename... StreamTs>
-using BinaryOutputStream = BinaryStream<tEndian, tSynchronized,
-                                        StreamT, ByteT, StreamTs...>;
+         typename StreamT = std::ostream, typename ByteT = StreamByteT<StreamT>>
+using BinaryOutputStream = BinaryStream<tEndian, tSynchronized, StreamT, ByteT>;
 
 /// An alias for `BinaryStream`, defaulting `tSynchronized` to `false`.
 template<std::endian tEndian = std::endian::native,
-         template<typename, typename...> typename StreamT = std::basic_iostream,
-         typename ByteT = char, typename... StreamTs>
+         typename StreamT = std::iostream, typename ByteT = StreamByteT<StreamT>>
 using UnsynchronizedBinaryStream =
-    BinaryStream<tEndian, false, StreamT, ByteT, StreamTs...>;
+    BinaryStream<tEndian, false, StreamT, ByteT>;
 
 /// An alias for `BinaryInputStream`, defaulting `tSynchronized` to `false`.
 template<std::endian tEndian = std::endian::native,
-         template<typename, typename...> typename StreamT = std::basic_istream,
-         typename ByteT = char, typename... StreamTs>
+         typename StreamT = std::istream, typename ByteT = StreamByteT<StreamT>>
 using UnsynchronizedBinaryInputStream =
-    BinaryInputStream<tEndian, false, StreamT, ByteT, StreamTs...>;
+    BinaryInputStream<tEndian, false, StreamT, ByteT>;
 
 /// An alias for `BinaryOutputStream`, defaulting `tSynchronized` to `false`.
 template<std::endian tEndian = std::endian::native,
-         template<typename, typename...> typename StreamT = std::basic_ostream,
-         typename ByteT = char, typename... StreamTs>
+         typename StreamT = std::ostream, typename ByteT = StreamByteT<StreamT>>
 using UnsynchronizedBinaryOutputStream =
-    BinaryOutputStream<tEndian, false, StreamT, ByteT, StreamTs...>;
+    BinaryOutputStream<tEndian, false, StreamT, ByteT>;
 
 }
 
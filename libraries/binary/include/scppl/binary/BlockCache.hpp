@@ -0,0 +1,544 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_BLOCKCACHE_HPP_
+#define SCPPL_BINARY_BLOCKCACHE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ios>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+
+namespace scppl {
+
+/// The size and layout of a `BlockCache`.
+struct BlockCacheOptions
+{
+    /// The memory budget of the cached blocks in bytes, split over the
+    /// shards.
+    std::size_t capacity = std::size_t{64} << 20;
+
+    /// The size of a block in bytes.
+    std::size_t blockSize = std::size_t{1} << 14;
+
+    /// The amount of independently locked shards.
+    std::size_t shards = 16;
+};
+
+/// The counters of a `BlockCache`.
+struct BlockCacheStats
+{
+    /// The amount of lookups that found their block.
+    std::uint64_t hits;
+
+    /// The amount of lookups that had to load their block.
+    std::uint64_t misses;
+
+    /// The amount of blocks removed to stay within the memory budget.
+    std::uint64_t evictions;
+
+    /// The amount of cached blocks.
+    std::size_t blocks;
+
+    /// The size of the cached blocks in bytes.
+    std::size_t bytes;
+};
+
+/**
+ * @brief A sharded, thread-safe LRU cache of file blocks.
+ *
+ * @details Blocks are keyed by a file id and the index of the block in the
+ *          file. The key picks one of `shards` shards, each with its own
+ *          lock, LRU list and part of the memory budget, so threads looking
+ *          up different blocks rarely wait for each other. When a shard is
+ *          over its budget, its least recently used blocks are evicted.
+ *
+ *          Blocks are handed out as `std::shared_ptr`s, so an evicted block
+ *          stays valid for as long as it is used. A missing block is loaded
+ *          without holding the lock, when two threads miss the same block at
+ *          once both load it and the first one is kept.
+ *
+ *          @ref scppl::CachedStream reads a file through this cache.
+ *
+ * @tparam ByteT  The byte type. [`char`]
+ */
+template<typename ByteT = char>
+class BlockCache
+{
+public:
+    /// The byte type of this `BlockCache` instance.
+    using Byte = ByteT;
+
+    /// A cached block, shorter than the block size at the end of a file.
+    using Block = std::shared_ptr<std::vector<Byte> const>;
+
+    /**
+     * @brief The `BlockCache` constructor.
+     *
+     * @param options  The memory budget, block size and shards. [`{}`]
+     */
+    explicit BlockCache(BlockCacheOptions options = {}) :
+        mOptions(options),
+        mShards(std::max<std::size_t>(options.shards, 1))
+    {
+        mOptions.blockSize = std::max<std::size_t>(mOptions.blockSize, 1);
+        mShardCapacity = mOptions.capacity / std::ranges::size(mShards);
+    }
+
+    BlockCache(BlockCache const&) = delete;
+    BlockCache(BlockCache&&) = delete;
+
+    ~BlockCache() noexcept = default;
+
+    auto operator=(BlockCache const&) -> BlockCache& = delete;
+    auto operator=(BlockCache&&) -> BlockCache& = delete;
+
+    /// The size of a block in bytes.
+    auto blockSize() const -> std::size_t { return mOptions.blockSize; }
+
+    /**
+     * @brief Get a block, loading it when it is not cached.
+     *
+     * @param file   The id of the file.
+     * @param block  The index of the block in the file.
+     * @param load   Called without arguments to load a missing block,
+     *               returning a `std::vector<Byte>`.
+     *
+     * @throws Any exception thrown by `load`.
+     *
+     * @return The block.
+     */
+    template<typename Loader>
+    auto get(std::uint64_t file, std::uint64_t block, Loader&& load)
+        -> Block
+    {
+        Key key{file, block};
+        Shard& shard = shardOf(key);
+
+        {
+            std::lock_guard lock(shard.mutex);
+            if (auto found = shard.map.find(key);
+                found != std::ranges::end(shard.map))
+            {
+                ++shard.hits;
+                shard.list.splice(std::ranges::begin(shard.list), shard.list,
+                                  found->second);
+
+                return found->second->block;
+            }
+
+            ++shard.misses;
+        }
+
+        auto loaded = std::make_shared<std::vector<Byte> const>(load());
+
+        std::lock_guard lock(shard.mutex);
+        if (auto found = shard.map.find(key);
+            found != std::ranges::end(shard.map))
+        {
+            return found->second->block;
+        }
+
+        shard.list.push_front({key, loaded});
+        shard.map.emplace(key, std::ranges::begin(shard.list));
+        shard.bytes += std::ranges::size(*loaded);
+
+        // The newest block is kept even when it alone is over the budget
+        while (shard.bytes > mShardCapacity &&
+               std::ranges::size(shard.list) > 1)
+        {
+            Entry& oldest = shard.list.back();
+            shard.bytes -= std::ranges::size(*oldest.block);
+            shard.map.erase(oldest.key);
+            shard.list.pop_back();
+            ++shard.evictions;
+        }
+
+        return loaded;
+    }
+
+    /**
+     * @brief Remove the blocks of a file, for example after it changed.
+     *
+     * @param file  The id of the file.
+     */
+    void erase(std::uint64_t file)
+    {
+        for (Shard& shard : mShards)
+        {
+            std::lock_guard lock(shard.mutex);
+            std::erase_if(shard.list, [&shard, file](Entry const& entry) {
+                if (entry.key.file != file)
+                    return false;
+
+                shard.bytes -= std::ranges::size(*entry.block);
+                shard.map.erase(entry.key);
+
+                return true;
+            });
+        }
+    }
+
+    /// The counters, summed over all shards.
+    auto stats() const
+        -> BlockCacheStats
+    {
+        BlockCacheStats stats{};
+        for (Shard const& shard : mShards)
+        {
+            std::lock_guard lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.blocks += std::ranges::size(shard.list);
+            stats.bytes += shard.bytes;
+        }
+
+        return stats;
+    }
+
+private:
+    struct Key
+    {
+        std::uint64_t file;
+        std::uint64_t block;
+
+        auto operator==(Key const&) const -> bool = default;
+    };
+
+    struct Hash
+    {
+        auto operator()(Key const& key) const
+            -> std::size_t
+        {
+            std::uint64_t value = (key.file * 0x9E3779B97F4A7C15u) ^ key.block;
+            value ^= value >> 31;
+            value *= 0xBF58476D1CE4E5B9u;
+
+            return static_cast<std::size_t>(value ^ (value >> 29));
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        Block block;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex{};
+        std::list<Entry> list{};
+        std::unordered_map<Key, typename std::list<Entry>::iterator,
+                           Hash> map{};
+        std::size_t bytes{};
+
+        std::uint64_t hits{};
+        std::uint64_t misses{};
+        std::uint64_t evictions{};
+    };
+
+    BlockCacheOptions mOptions{};
+    std::vector<Shard> mShards;
+    std::size_t mShardCapacity{};
+
+    auto shardOf(Key const& key)
+        -> Shard&
+    {
+        // The high bits, the low bits pick the bucket within the shard
+        std::uint64_t hash = Hash{}(key);
+
+        return mShards[(hash >> 32) % std::ranges::size(mShards)];
+    }
+};
+
+/**
+ * @brief A read-only stream that reads a file through a `BlockCache`.
+ *
+ * @details The file is read in blocks of the block size of the cache with
+ *          `readAt()`, and every block is looked up in the cache first. It is
+ *          a @ref scppl::SpanSource, so @ref scppl::BinaryStream decodes
+ *          values and returns views like `readFrame()` straight from the
+ *          cached block: a read that hits the cache makes no system call and
+ *          copies nothing, unless it crosses into the next block.
+ *
+ *          Every thread needs its own `CachedStream`, since each has its own
+ *          position, but they can share the cache and the source. `readAt()`
+ *          also goes through the cache and does not use the position.
+ *
+ * @code{.cpp}
+ * scppl::BlockCache<> cache({.capacity = 256 << 20});
+ * scppl::FileStream<> file("records.bin", std::ios::in);
+ * scppl::CachedStream cached(file, cache, 1);
+ * scppl::CachedBinaryStream<scppl::FileStream<>> stream(cached);
+ * stream.seek(offset, std::ios::beg);
+ * auto record = stream.readFrame();
+ * @endcode
+ *
+ * @tparam SourceT  The file to read, must be a @ref scppl::PositionalSource.
+ * @tparam ByteT    The byte type of the file. [`scppl::StreamByteT<SourceT>`]
+ */
+template<typename SourceT, typename ByteT = StreamByteT<SourceT>>
+class CachedStream
+{
+public:
+    /// The source type of this `CachedStream` instance.
+    using Source = SourceT;
+
+    /// The byte type of this `CachedStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `CachedStream` constructor.
+     *
+     * @param source  The file to read from, it is only read with `readAt()`.
+     * @param cache   The cache to read through.
+     * @param file    The id of the file in the cache, the same for every
+     *                stream of the same file and unique per file.
+     */
+    CachedStream(Source& source, BlockCache<Byte>& cache, std::uint64_t file) :
+        mSource(source),
+        mCache(cache),
+        mFile(file)
+    {
+        //
+    }
+
+    CachedStream(CachedStream const&) = delete;
+    CachedStream(CachedStream&&) = delete;
+
+    ~CachedStream() noexcept = default;
+
+    auto operator=(CachedStream const&) -> CachedStream& = delete;
+    auto operator=(CachedStream&&) -> CachedStream& = delete;
+
+    /**
+     * @brief Get the bytes from the current position without consuming them.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws Any exception thrown by the source.
+     *
+     * @return The rest of the current block, or a copy of the blocks that
+     *         hold `length` bytes when they do not fit in it. Less than
+     *         `length` at the end of the file.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    {
+        std::span<Byte const> available = current();
+        if (std::ranges::size(available) >= length || isLast(*mBlock))
+        {
+            mEof = (std::ranges::size(available) < length);
+
+            return available;
+        }
+
+        // Crosses into the next blocks, which are copied behind it
+        mSpill.assign(std::ranges::begin(available),
+                      std::ranges::end(available));
+        for (std::uint64_t block = mBlockIndex + 1;
+             std::ranges::size(mSpill) < length; ++block)
+        {
+            Cached next = fetch(block);
+            mSpill.insert(std::ranges::end(mSpill), std::ranges::begin(*next),
+                          std::ranges::end(*next));
+            if (isLast(*next))
+                break;
+        }
+
+        mEof = (std::ranges::size(mSpill) < length);
+
+        return mSpill;
+    }
+
+    /**
+     * @brief Consume bytes from the current position.
+     *
+     * @param length  The amount of bytes to consume, at most the size of the
+     *                last `acquire()`.
+     */
+    void commit(std::size_t length)
+    {
+        mPosition += length;
+    }
+
+    /**
+     * @brief Read bytes from the current position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @throws Any exception thrown by the source.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t done = 0;
+        while (done < length)
+        {
+            std::span<Byte const> available = current();
+            std::size_t count = std::min(std::ranges::size(available),
+                                         length - done);
+            if (count == 0)
+                break;
+
+            std::memcpy(data + done, std::ranges::data(available), count);
+            mPosition += count;
+            done += count;
+        }
+
+        mEof = (done < length);
+
+        return done;
+    }
+
+    /**
+     * @brief Read bytes at an offset, without using the position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     * @param offset  The offset in the file to read from.
+     *
+     * @throws Any exception thrown by the source.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto readAt(Byte* data, std::size_t length, std::size_t offset) const
+        -> std::size_t
+    {
+        std::size_t blockSize = mCache.blockSize();
+
+        std::size_t done = 0;
+        while (done < length)
+        {
+            Cached block = fetch((offset + done) / blockSize);
+            std::size_t start = (offset + done) % blockSize;
+            if (start >= std::ranges::size(*block))
+                break;
+
+            std::size_t count = std::min(std::ranges::size(*block) - start,
+                                         length - done);
+            std::memcpy(data + done, std::ranges::data(*block) + start, count);
+            done += count;
+        }
+
+        return done;
+    }
+
+    /// Get the read position.
+    auto tellg() const -> std::size_t { return mPosition; }
+
+    /**
+     * @brief Move the read position.
+     *
+     * @details Seeking from the end needs a source with `size()`.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        std::streamoff base = 0;
+        if (direction == std::ios::cur)
+        {
+            base = static_cast<std::streamoff>(mPosition);
+        }
+        else if (direction == std::ios::end)
+        {
+            if constexpr(requires { mSource.size(); })
+            {
+                base = static_cast<std::streamoff>(mSource.size());
+            }
+        }
+
+        mPosition = static_cast<std::size_t>(base + offset);
+        mEof = false;
+    }
+
+    /// Whether the last read reached the end of the file.
+    auto eof() const -> bool { return mEof; }
+
+private:
+    using Cached = typename BlockCache<Byte>::Block;
+
+    Source& mSource;
+    BlockCache<Byte>& mCache;
+    std::uint64_t mFile{};
+
+    std::size_t mPosition{};
+    bool mEof{};
+
+    /// The block holding the position, kept so reads within it skip the
+    /// cache lookup.
+    Cached mBlock{};
+    std::uint64_t mBlockIndex{};
+
+    std::vector<Byte> mSpill{};
+
+    /// Get a block through the cache.
+    auto fetch(std::uint64_t block) const
+        -> Cached
+    {
+        return mCache.get(mFile, block, [this, block]() {
+            std::size_t blockSize = mCache.blockSize();
+
+            std::vector<Byte> data(blockSize);
+            data.resize(mSource.readAt(std::ranges::data(data), blockSize,
+                                       block * blockSize));
+
+            return data;
+        });
+    }
+
+    /// Whether `block` is the last block of the file.
+    auto isLast(std::vector<Byte> const& block) const
+        -> bool
+    {
+        return std::ranges::size(block) < mCache.blockSize();
+    }
+
+    /// The bytes of the block holding the position, from the position.
+    auto current()
+        -> std::span<Byte const>
+    {
+        std::size_t blockSize = mCache.blockSize();
+        std::uint64_t index = mPosition / blockSize;
+        if (!mBlock || mBlockIndex != index)
+        {
+            mBlock = fetch(index);
+            mBlockIndex = index;
+        }
+
+        std::size_t start = std::min(mPosition % blockSize,
+                                     std::ranges::size(*mBlock));
+
+        return std::span<Byte const>(*mBlock).subspan(start);
+    }
+};
+
+/// An alias for `BinaryStream` reading through a `CachedStream`.
+template<typename SourceT, std::endian tEndian = std::endian::native>
+using CachedBinaryStream = BinaryStream<tEndian, true, CachedStream<SourceT>>;
+
+}
+
+#endif
@@ -0,0 +1,637 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_BLOCKFILE_HPP_
+#define SCPPL_BINARY_BLOCKFILE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/SpanStream.hpp"
+#include "scppl/binary/Traits.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+/// The last four bytes of a block file, "SCBF" in little endian.
+constexpr std::uint32_t blockFileMagic = 0x46424353;
+
+/// The length of the footer at the end of a block file.
+constexpr std::size_t blockFileFooterLength =
+    lengthOf<uint64_t, uint32_t, uint32_t, uint32_t>();
+
+/// The longest block or index of a block file, their lengths are `uint32_t`.
+constexpr std::size_t blockFileMaxLength =
+    std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * @brief Compares two keys of a block file.
+ *
+ * @details Keys are compared byte by byte as unsigned values, like `memcmp`,
+ *          and a key is less than the keys it is a prefix of.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param left   The first key.
+ * @param right  The second key.
+ *
+ * @return Less than, equal to or greater than `0` when `left` is less than,
+ *         equal to or greater than `right`.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+auto compareBlockKeys(std::span<ByteT const> left,
+                      std::span<ByteT const> right)
+    -> int
+{
+    std::size_t length = std::min(std::ranges::size(left),
+                                  std::ranges::size(right));
+    if (length > 0)
+    {
+        int result = std::memcmp(std::ranges::data(left),
+                                 std::ranges::data(right), length);
+        if (result != 0)
+            return result;
+    }
+
+    if (std::ranges::size(left) == std::ranges::size(right))
+        return 0;
+
+    return (std::ranges::size(left) < std::ranges::size(right)) ? -1 : 1;
+}
+
+/// How a `BlockFileWriter` groups records into blocks.
+struct BlockFileOptions
+{
+    /// Close a block once its records take at least this many bytes.
+    std::size_t blockSize = std::size_t{1} << 16;
+};
+
+/**
+ * @brief The records of one block of a block file.
+ *
+ * @details Owns the bytes of the block, the keys and values are views into
+ *          them. Keys are in increasing order, so `find()` is a binary search.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size. [`char`]
+ */
+template<typename ByteT = char>
+class BlockFileBlock
+{
+public:
+    /// The byte type of this `BlockFileBlock` instance.
+    using Byte = ByteT;
+
+    /// A record in the block.
+    struct Entry
+    {
+        /// The key of the record.
+        std::span<Byte const> key;
+
+        /// The value of the record.
+        std::span<Byte const> value;
+    };
+
+    /**
+     * @brief The `BlockFileBlock` constructor, decoding the records.
+     *
+     * @param data  The records of the block, without the checksum.
+     *
+     * @throws std::out_of_range  The last record is incomplete.
+     */
+    explicit BlockFileBlock(std::vector<Byte> data) :
+        mData(std::move(data))
+    {
+        SpanStream<Byte> source(mData);
+        BinaryStream<std::endian::little, true, SpanStream<Byte>> stream(
+            source);
+        while (source.remaining() > 0)
+        {
+            auto key = stream.template readFrame<FramePrefix::Varint>(
+                blockFileMaxLength);
+            auto value = stream.template readFrame<FramePrefix::Varint>(
+                blockFileMaxLength);
+            mEntries.push_back({key, value});
+        }
+    }
+
+    // The views point into `mData`, which a copy would not share
+    BlockFileBlock(BlockFileBlock const&) = delete;
+    BlockFileBlock(BlockFileBlock&&) noexcept = default;
+
+    ~BlockFileBlock() noexcept = default;
+
+    auto operator=(BlockFileBlock const&) -> BlockFileBlock& = delete;
+    auto operator=(BlockFileBlock&&) noexcept -> BlockFileBlock& = default;
+
+    /**
+     * @brief Find the value of a key in this block.
+     *
+     * @param key  The key to find.
+     *
+     * @return A view of the value, valid as long as this block, or nothing if
+     *         the key is not in this block.
+     */
+    auto find(std::span<Byte const> key) const
+        -> std::optional<std::span<Byte const>>
+    {
+        auto entry = std::ranges::lower_bound(
+            mEntries, key, [](auto left, auto right) {
+                return compareBlockKeys(left, right) < 0;
+            }, &Entry::key);
+
+        if (entry == std::ranges::end(mEntries) ||
+            compareBlockKeys(entry->key, key) != 0)
+        {
+            return std::nullopt;
+        }
+
+        return entry->value;
+    }
+
+    /// The amount of records in this block.
+    auto size() const -> std::size_t { return std::ranges::size(mEntries); }
+
+    /// The record at `index`.
+    auto operator[](std::size_t index) const -> Entry const&
+    {
+        return mEntries[index];
+    }
+
+    /// An iterator to the first record.
+    auto begin() const { return std::ranges::begin(mEntries); }
+
+    /// An iterator past the last record.
+    auto end() const { return std::ranges::end(mEntries); }
+
+    /// The size of the records of this block in bytes.
+    auto length() const -> std::size_t { return std::ranges::size(mData); }
+
+private:
+    std::vector<Byte> mData{};
+    std::vector<Entry> mEntries{};
+};
+
+/**
+ * @brief Writes records into a block file, a file of checksummed blocks with
+ *        an index in the footer.
+ *
+ * @details Records are a key and a value, added in increasing order of their
+ *          keys, see `compareBlockKeys()`. They are collected into a block
+ *          until it holds at least `blockSize` bytes, then the block is
+ *          written followed by its CRC32C. Records are never split, so a large
+ *          record makes its block larger, up to `blockFileMaxLength`.
+ *
+ *          `finish()` writes the last block, an index with the amount of
+ *          blocks and the offset, length and first key of every block, and a
+ *          fixed size footer with the position and CRC32C of the index. All
+ *          numbers are little endian, and the key and value of a record and
+ *          the keys in the index are varint length-prefixed frames. A
+ *          @ref scppl::BlockFileReader only reads the footer and the index
+ *          when opening the file.
+ *
+ *          Offsets in the file count from the start of the stream, so the
+ *          block file can follow other data, like a header, as long as
+ *          nothing follows it.
+ *
+ * @code{.cpp}
+ * scppl::BlockFileWriter<scppl::FileStream<>> writer(file);
+ * for (auto const& [key, value] : sorted)
+ *     writer.add(key, value);
+ * writer.finish();
+ * @endcode
+ *
+ * @tparam StreamT  The type of the stream. [`std::iostream`]
+ * @tparam ByteT    The byte type of the stream, must be one byte in size.
+ *                  [`scppl::StreamByteT<StreamT>`]
+ */
+template<typename StreamT = std::iostream,
+         typename ByteT = StreamByteT<StreamT>>
+class BlockFileWriter
+{
+    static_assert(sizeof(ByteT) == 1, "`ByteT` must be one byte in size");
+
+public:
+    /// The stream type of this `BlockFileWriter` instance.
+    using Stream = StreamT;
+
+    /// The byte type of this `BlockFileWriter` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `BlockFileWriter` constructor.
+     *
+     * @param stream   The stream to write to, from its current position.
+     * @param options  The size of the blocks. [`{}`]
+     */
+    explicit BlockFileWriter(Stream& stream, BlockFileOptions options = {}) :
+        mStream(stream),
+        mOptions(options),
+        mBlockStream(mBlock)
+    {
+        if constexpr(requires { mStream.tellOutput(); })
+        {
+            mStart = mStream.tellOutput();
+            mOffset = mStart;
+        }
+    }
+
+    BlockFileWriter(BlockFileWriter const&) = delete;
+    BlockFileWriter(BlockFileWriter&&) = delete;
+
+    /// Calls `finish()`, if it was not called yet.
+    ~BlockFileWriter() noexcept
+    {
+        try
+        {
+            finish();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `finish()` for that
+        }
+    }
+
+    auto operator=(BlockFileWriter const&) -> BlockFileWriter& = delete;
+    auto operator=(BlockFileWriter&&) -> BlockFileWriter& = delete;
+
+    /**
+     * @brief Add a record.
+     *
+     * @param key    The key, greater than the key of the previous record.
+     * @param value  The value.
+     *
+     * @throws std::invalid_argument  The key is not greater than the previous
+     *                                key, or the file is finished.
+     * @throws std::length_error      The record does not fit in a block.
+     */
+    void add(std::span<Byte const> key, std::span<Byte const> value)
+    {
+        if (mFinished)
+            throw std::invalid_argument("Block file is already finished");
+
+        std::span<Byte const> lastKey(mLastKey);
+        if (mRecords > 0 && compareBlockKeys(key, lastKey) <= 0)
+        {
+            throw std::invalid_argument("Keys must be added in increasing "
+                                        "order");
+        }
+
+        std::size_t length = frameLength(key) + frameLength(value);
+        if (length > blockFileMaxLength)
+            throw std::length_error("Record is too long for a block file");
+
+        if (mBlock.tellp() + length > blockFileMaxLength)
+            writeBlock();
+
+        if (mBlock.tellp() == 0)
+            mIndex.push_back({mOffset, 0, {std::ranges::begin(key),
+                                           std::ranges::end(key)}});
+
+        mBlockStream.template writeFrame<FramePrefix::Varint>(key);
+        mBlockStream.template writeFrame<FramePrefix::Varint>(value);
+        mLastKey.assign(std::ranges::begin(key), std::ranges::end(key));
+        ++mRecords;
+
+        if (mBlock.tellp() >= mOptions.blockSize)
+            writeBlock();
+    }
+
+    /**
+     * @brief Write the last block, the index and the footer.
+     *
+     * @details Calling it again does nothing.
+     *
+     * @throws std::length_error  The index is longer than `blockFileMaxLength`.
+     * @throws Any exception thrown by the stream.
+     */
+    void finish()
+    {
+        if (mFinished)
+            return;
+
+        mFinished = true;
+        writeBlock();
+
+        mBlockStream.write(static_cast<uint32_t>(std::ranges::size(mIndex)));
+        for (auto const& entry : mIndex)
+        {
+            mBlockStream.write(entry.offset, entry.length);
+            mBlockStream.template writeFrame<FramePrefix::Varint>(
+                std::span<Byte const>(entry.firstKey));
+        }
+
+        auto index = mBlock.data().first(mBlock.tellp());
+        if (std::ranges::size(index) > blockFileMaxLength)
+            throw std::length_error("Block file index is too long");
+
+        auto footer = Binary<std::endian::little, Byte>::pack(
+            mOffset, static_cast<uint32_t>(std::ranges::size(index)),
+            crc32c(index), blockFileMagic);
+        mStream.writeGather(index, footer);
+        mOffset += std::ranges::size(index) + blockFileFooterLength;
+
+        if constexpr(requires { mStream.stream().flush(); })
+        {
+            mStream.stream().flush();
+        }
+    }
+
+    /// The amount of records added so far.
+    auto records() const -> std::size_t { return mRecords; }
+
+    /// The amount of blocks written or being collected so far.
+    auto blocks() const -> std::size_t { return std::ranges::size(mIndex); }
+
+    /// The amount of bytes written to the stream so far.
+    auto written() const -> std::uint64_t { return mOffset - mStart; }
+
+private:
+    struct IndexEntry
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::vector<Byte> firstKey;
+    };
+
+    BinaryStream<std::endian::little, true, Stream, Byte> mStream;
+    BlockFileOptions mOptions{};
+
+    BufferStream<Byte> mBlock{};
+    BinaryStream<std::endian::little, true, BufferStream<Byte>> mBlockStream;
+
+    std::vector<IndexEntry> mIndex{};
+    std::vector<Byte> mLastKey{};
+    std::uint64_t mStart{};
+    std::uint64_t mOffset{};
+    std::size_t mRecords{};
+    bool mFinished{};
+
+    /// The length of `bytes` as a varint length-prefixed frame.
+    static auto frameLength(std::span<Byte const> bytes)
+        -> std::size_t
+    {
+        std::size_t length = std::ranges::size(bytes);
+        std::size_t prefix = 1;
+        for (std::size_t rest = length >> 7; rest != 0; rest >>= 7)
+            ++prefix;
+
+        return prefix + length;
+    }
+
+    /// Write the collected block with its checksum and start a new one.
+    void writeBlock()
+    {
+        std::size_t length = mBlock.tellp();
+        if (length == 0)
+            return;
+
+        // Reuses the buffer of the block, the stale bytes after `tellp()` are
+        // overwritten by the next block
+        auto records = mBlock.data().first(length);
+        auto checksum = Binary<std::endian::little, Byte>::pack(
+            crc32c(records));
+        mStream.writeGather(records, checksum);
+
+        mIndex.back().length = static_cast<uint32_t>(length);
+        mOffset += length + std::ranges::size(checksum);
+        mBlock.seekp(0);
+    }
+};
+
+/**
+ * @brief Reads a block file written by a `BlockFileWriter`.
+ *
+ * @details Opening the file only reads the footer and the index, after which
+ *          `findBlock()` finds the block that can contain a key with a binary
+ *          search over the first keys, and `readBlock()` reads and checks
+ *          only that block. So a single record is found with two reads,
+ *          wherever it is in the file.
+ *
+ *          If the stream is an @ref scppl::PositionalSource, like
+ *          @ref scppl::FileStream, blocks are read without moving the read
+ *          position, and `readBlock()` and `find()` can be called from
+ *          multiple threads at once.
+ *
+ * @code{.cpp}
+ * scppl::FileStream<> file("records.scbf", std::ios::in);
+ * scppl::BlockFileReader<scppl::FileStream<>> reader(file);
+ * if (auto value = reader.find(key))
+ *     use(*value);
+ * @endcode
+ *
+ * @tparam StreamT  The type of the stream, must be seekable.
+ *                  [`std::iostream`]
+ * @tparam ByteT    The byte type of the stream, must be one byte in size.
+ *                  [`scppl::StreamByteT<StreamT>`]
+ */
+template<typename StreamT = std::iostream,
+         typename ByteT = StreamByteT<StreamT>>
+class BlockFileReader
+{
+    static_assert(sizeof(ByteT) == 1, "`ByteT` must be one byte in size");
+
+public:
+    /// The stream type of this `BlockFileReader` instance.
+    using Stream = StreamT;
+
+    /// The byte type of this `BlockFileReader` instance.
+    using Byte = ByteT;
+
+    /// The type of a block read by this `BlockFileReader` instance.
+    using Block = BlockFileBlock<Byte>;
+
+    /**
+     * @brief The `BlockFileReader` constructor, reading the footer and the
+     *        index.
+     *
+     * @param stream  The stream to read from, ending with the block file.
+     *
+     * @throws std::runtime_error  The stream is not a block file, or the index
+     *                             is corrupt.
+     */
+    explicit BlockFileReader(Stream& stream) :
+        mStream(stream)
+    {
+        mStream.toEnd();
+        std::size_t size = mStream.tell();
+        if (size < blockFileFooterLength)
+            throw std::runtime_error("Stream is too short for a block file");
+
+        auto footer = readRange(size - blockFileFooterLength,
+                                blockFileFooterLength);
+        auto [indexOffset, indexLength, checksum, magic] =
+            Binary<std::endian::little, Byte>::template unpack<
+                uint64_t, uint32_t, uint32_t, uint32_t>(
+                std::span<Byte const>(footer));
+
+        if (magic != blockFileMagic)
+            throw std::runtime_error("Stream is not a block file");
+
+        if (indexOffset + indexLength + blockFileFooterLength != size)
+            throw std::runtime_error("Block file footer is corrupt");
+
+        mIndexData = readRange(indexOffset, indexLength);
+        if (crc32c(std::span<Byte const>(mIndexData)) != checksum)
+            throw std::runtime_error("Block file index is corrupt");
+
+        SpanStream<Byte> source(mIndexData);
+        BinaryStream<std::endian::little, true, SpanStream<Byte>> index(
+            source);
+        auto count = index.template readSingle<uint32_t>();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto [offset, length] = index.template read<uint64_t, uint32_t>();
+            auto firstKey = index.template readFrame<FramePrefix::Varint>(
+                blockFileMaxLength);
+            mIndex.push_back({offset, length, firstKey});
+        }
+    }
+
+    BlockFileReader(BlockFileReader const&) = delete;
+    BlockFileReader(BlockFileReader&&) = delete;
+
+    ~BlockFileReader() noexcept = default;
+
+    auto operator=(BlockFileReader const&) -> BlockFileReader& = delete;
+    auto operator=(BlockFileReader&&) -> BlockFileReader& = delete;
+
+    /// The amount of blocks in the file.
+    auto blocks() const -> std::size_t { return std::ranges::size(mIndex); }
+
+    /// The first key of the block at `block`.
+    auto firstKey(std::size_t block) const -> std::span<Byte const>
+    {
+        return mIndex.at(block).firstKey;
+    }
+
+    /**
+     * @brief Find the block that can contain a key.
+     *
+     * @param key  The key to find.
+     *
+     * @return The index of the last block with a first key not greater than
+     *         `key`, or nothing if `key` is less than every key in the file.
+     */
+    auto findBlock(std::span<Byte const> key) const
+        -> std::optional<std::size_t>
+    {
+        auto entry = std::ranges::upper_bound(
+            mIndex, key, [](auto left, auto right) {
+                return compareBlockKeys(left, right) < 0;
+            }, &IndexEntry::firstKey);
+
+        if (entry == std::ranges::begin(mIndex))
+            return std::nullopt;
+
+        return static_cast<std::size_t>(
+            std::ranges::distance(std::ranges::begin(mIndex), entry) - 1);
+    }
+
+    /**
+     * @brief Read a block and check its checksum.
+     *
+     * @param block  The index of the block.
+     *
+     * @throws std::out_of_range   There is no block at `block`.
+     * @throws std::runtime_error  The checksum of the block does not match.
+     *
+     * @return The records of the block.
+     */
+    auto readBlock(std::size_t block)
+        -> Block
+    {
+        auto const& entry = mIndex.at(block);
+
+        std::vector<Byte> data = readRange(entry.offset,
+                                           entry.length + sizeof(uint32_t));
+        auto [checksum] = Binary<std::endian::little, Byte>::template unpack<
+            uint32_t>(std::span<Byte const>(data).last(sizeof(uint32_t)));
+        data.resize(entry.length);
+
+        if (crc32c(std::span<Byte const>(data)) != checksum)
+            throw std::runtime_error("Block file block is corrupt");
+
+        return Block(std::move(data));
+    }
+
+    /**
+     * @brief Find the value of a key.
+     *
+     * @param key  The key to find.
+     *
+     * @throws std::runtime_error  The checksum of the block does not match.
+     *
+     * @return A copy of the value, or nothing if the key is not in the file.
+     */
+    auto find(std::span<Byte const> key)
+        -> std::optional<std::vector<Byte>>
+    {
+        auto block = findBlock(key);
+        if (!block)
+            return std::nullopt;
+
+        auto records = readBlock(*block);
+        auto value = records.find(key);
+        if (!value)
+            return std::nullopt;
+
+        return std::vector<Byte>(std::ranges::begin(*value),
+                                 std::ranges::end(*value));
+    }
+
+private:
+    struct IndexEntry
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::span<Byte const> firstKey;
+    };
+
+    using BinaryStreamT = BinaryStream<std::endian::little, true, Stream,
+                                       Byte>;
+
+    BinaryStreamT mStream;
+
+    std::vector<Byte> mIndexData{};
+    std::vector<IndexEntry> mIndex{};
+
+    /// Read `length` bytes at `offset`, throwing when the stream is shorter.
+    auto readRange(std::size_t offset, std::size_t length)
+        -> std::vector<Byte>
+    {
+        std::vector<Byte> data{};
+        if constexpr(BinaryStreamT::isPositionalInput)
+        {
+            data = mStream.readRawAt(offset, length);
+        }
+        else
+        {
+            mStream.seek(offset, std::ios::beg);
+            data = mStream.readRaw(length);
+        }
+
+        if (std::ranges::size(data) < length)
+            throw std::runtime_error("Block file is truncated");
+
+        return data;
+    }
+};
+
+}
+
+#endif
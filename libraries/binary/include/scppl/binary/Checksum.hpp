@@ -0,0 +1,556 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_CHECKSUM_HPP_
+#define SCPPL_BINARY_CHECKSUM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#endif
+
+namespace scppl {
+
+/// The lookup tables for `crc32c`, one per byte of an 8 byte block.
+constexpr auto crc32cTables = []() {
+    std::array<std::array<std::uint32_t, 256>, 8> tables{};
+
+    for (std::uint32_t index = 0; index < 256; ++index)
+    {
+        std::uint32_t crc = index;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78u : 0u);
+
+        tables[0][index] = crc;
+    }
+
+    for (std::size_t table = 1; table < 8; ++table)
+    {
+        for (std::size_t index = 0; index < 256; ++index)
+        {
+            std::uint32_t previous = tables[table - 1][index];
+            tables[table][index] = (previous >> 8) ^
+                                   tables[0][previous & 0xFF];
+        }
+    }
+
+    return tables;
+}();
+
+/// The CRC32C (Castagnoli) polynomial, reflected.
+constexpr std::uint32_t crc32cPolynomial = 0x82F63B78u;
+
+/**
+ * @brief Calculates the CRC32C (Castagnoli) checksum of bytes with lookup
+ *        tables.
+ *
+ * @details The checksum is calculated 8 bytes at a time. This is the portable
+ *          version, usable at compile time, `crc32c()` uses the processor when
+ *          it can.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param data  The bytes to calculate the checksum of.
+ * @param crc   The checksum of the preceding bytes. [`0`]
+ *
+ * @return The checksum of the preceding bytes followed by `data`.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+constexpr auto crc32cSoftware(std::span<ByteT const> data,
+                              std::uint32_t crc = 0)
+    -> std::uint32_t
+{
+    auto const& tables = crc32cTables;
+    auto byte = [&data](std::size_t index) -> std::uint32_t {
+        return static_cast<std::uint8_t>(data[index]);
+    };
+
+    crc = ~crc;
+
+    std::size_t index = 0;
+    for (; index + 8 <= std::ranges::size(data); index += 8)
+    {
+        std::uint32_t low = crc ^ (byte(index) | byte(index + 1) << 8 |
+                                   byte(index + 2) << 16 |
+                                   byte(index + 3) << 24);
+
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^
+              tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24] ^
+              tables[3][byte(index + 4)] ^ tables[2][byte(index + 5)] ^
+              tables[1][byte(index + 6)] ^ tables[0][byte(index + 7)];
+    }
+
+    for (; index < std::ranges::size(data); ++index)
+        crc = (crc >> 8) ^ tables[0][(crc ^ byte(index)) & 0xFF];
+
+    return ~crc;
+}
+
+/**
+ * @brief Multiplies two polynomials modulo the CRC32C polynomial.
+ *
+ * @details Both are reflected, like the checksums themselves, so `x^0` is the
+ *          highest bit.
+ *
+ * @param a  The first polynomial.
+ * @param b  The second polynomial.
+ *
+ * @return The product modulo the CRC32C polynomial.
+ */
+constexpr auto crc32cMultiply(std::uint32_t a, std::uint32_t b)
+    -> std::uint32_t
+{
+    std::uint32_t product = 0;
+    for (std::uint32_t bit = std::uint32_t{1} << 31; bit != 0; bit >>= 1)
+    {
+        if ((a & bit) != 0)
+            product ^= b;
+
+        b = (b >> 1) ^ ((b & 1) != 0 ? crc32cPolynomial : 0u);
+    }
+
+    return product;
+}
+
+/**
+ * @brief Calculates the polynomial that appends zero bytes to a checksum.
+ *
+ * @param length  The amount of zero bytes.
+ *
+ * @return `x^(8 * length)` modulo the CRC32C polynomial, for
+ *         `crc32cMultiply()`.
+ */
+constexpr auto crc32cZeros(std::size_t length)
+    -> std::uint32_t
+{
+    std::uint32_t result = std::uint32_t{1} << 31;
+    std::uint32_t square = std::uint32_t{1} << 23;
+    for (; length != 0; length >>= 1)
+    {
+        if ((length & 1) != 0)
+            result = crc32cMultiply(square, result);
+
+        square = crc32cMultiply(square, square);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Combines the checksums of two consecutive ranges of bytes.
+ *
+ * @details This allows calculating the checksum of parts of the data
+ *          separately, for example on multiple threads.
+ *
+ * @param first         The checksum of the first range.
+ * @param second        The checksum of the second range, started at `0`.
+ * @param secondLength  The length of the second range in bytes.
+ *
+ * @return The checksum of the first range followed by the second.
+ */
+constexpr auto crc32cCombine(std::uint32_t first, std::uint32_t second,
+                             std::size_t secondLength)
+    -> std::uint32_t
+{
+    return crc32cMultiply(crc32cZeros(secondLength), first) ^ second;
+}
+
+/// The length of each of the three streams `crc32cHardware()` interleaves.
+constexpr std::size_t crc32cStripeLength = 4096;
+
+/// Whether the processor has the SSE4.2 `crc32` instruction.
+inline auto hasHardwareCrc32c()
+    -> bool
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    static bool const supported = []() {
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("sse4.2") != 0;
+    }();
+
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+/// The SSE4.2 implementation of `crc32cHardware()`, on the inverted `crc`.
+__attribute__((target("sse4.2")))
+inline auto crc32cSse42(unsigned char const* data, std::size_t length,
+                        std::uint32_t crc)
+    -> std::uint32_t
+{
+    auto load = [](unsigned char const* bytes) -> std::uint64_t {
+        std::uint64_t value{};
+        std::memcpy(&value, bytes, sizeof(value));
+
+        return value;
+    };
+
+    // The instruction takes 3 cycles but can start every cycle, so three
+    // independent stripes are calculated at once and combined afterwards
+    constexpr std::uint32_t shiftOne = crc32cZeros(crc32cStripeLength);
+    constexpr std::uint32_t shiftTwo = crc32cZeros(2 * crc32cStripeLength);
+
+    std::uint64_t a = crc;
+    while (length >= 3 * crc32cStripeLength)
+    {
+        std::uint64_t b = 0;
+        std::uint64_t c = 0;
+        for (std::size_t index = 0; index < crc32cStripeLength; index += 8)
+        {
+            a = _mm_crc32_u64(a, load(data + index));
+            b = _mm_crc32_u64(b, load(data + crc32cStripeLength + index));
+            c = _mm_crc32_u64(c, load(data + 2 * crc32cStripeLength + index));
+        }
+
+        a = crc32cMultiply(shiftTwo, static_cast<std::uint32_t>(a)) ^
+            crc32cMultiply(shiftOne, static_cast<std::uint32_t>(b)) ^
+            static_cast<std::uint32_t>(c);
+
+        data += 3 * crc32cStripeLength;
+        length -= 3 * crc32cStripeLength;
+    }
+
+    for (; length >= 8; data += 8, length -= 8)
+        a = _mm_crc32_u64(a, load(data));
+
+    auto result = static_cast<std::uint32_t>(a);
+    if (length >= 4)
+    {
+        std::uint32_t value{};
+        std::memcpy(&value, data, sizeof(value));
+        result = _mm_crc32_u32(result, value);
+        data += 4;
+        length -= 4;
+    }
+
+    if (length >= 2)
+    {
+        std::uint16_t value{};
+        std::memcpy(&value, data, sizeof(value));
+        result = _mm_crc32_u16(result, value);
+        data += 2;
+        length -= 2;
+    }
+
+    if (length > 0)
+        result = _mm_crc32_u8(result, *data);
+
+    return result;
+}
+#endif
+
+/**
+ * @brief Calculates the CRC32C (Castagnoli) checksum of bytes with the
+ *        processor.
+ *
+ * @details This uses the SSE4.2 `crc32` instruction, on three interleaved
+ *          stripes for large inputs, or `crc32cSoftware()` when the processor
+ *          does not have it.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param data  The bytes to calculate the checksum of.
+ * @param crc   The checksum of the preceding bytes. [`0`]
+ *
+ * @return The checksum of the preceding bytes followed by `data`.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+auto crc32cHardware(std::span<ByteT const> data, std::uint32_t crc = 0)
+    -> std::uint32_t
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (hasHardwareCrc32c())
+    {
+        return ~crc32cSse42(
+            reinterpret_cast<unsigned char const*>(std::ranges::data(data)),
+            std::ranges::size(data), ~crc);
+    }
+#endif
+
+    return crc32cSoftware(data, crc);
+}
+
+/**
+ * @brief Calculates the CRC32C (Castagnoli) checksum of bytes.
+ *
+ * @details Uses `crc32cHardware()` at runtime and `crc32cSoftware()` at
+ *          compile time. Checksums can be chained, the checksum of `a`
+ *          followed by `b` is `crc32c(b, crc32c(a))`.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param data  The bytes to calculate the checksum of.
+ * @param crc   The checksum of the preceding bytes. [`0`]
+ *
+ * @return The checksum of the preceding bytes followed by `data`.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+constexpr auto crc32c(std::span<ByteT const> data, std::uint32_t crc = 0)
+    -> std::uint32_t
+{
+    if (std::is_constant_evaluated())
+        return crc32cSoftware(data, crc);
+
+    return crc32cHardware(data, crc);
+}
+
+/// The primes of xxHash64.
+constexpr std::array<std::uint64_t, 5> xxHash64Primes{
+    0x9E3779B185EBCA87u, 0xC2B2AE3D27D4EB4Fu, 0x165667B19E3779F9u,
+    0x85EBCA77C2B2AE63u, 0x27D4EB2F165667C5u
+};
+
+/**
+ * @brief An accumulator for the CRC32C checksum of bytes passed in parts.
+ *
+ * @details Like every checksum accumulator, it has `update(data)` and
+ *          `value()`, see @ref scppl::ChecksumAccumulator.
+ */
+class Crc32c
+{
+public:
+    /// The type of the checksum.
+    using Value = std::uint32_t;
+
+    /**
+     * @brief The `Crc32c` constructor.
+     *
+     * @param crc  The checksum of preceding bytes. [`0`]
+     */
+    constexpr explicit Crc32c(std::uint32_t crc = 0) :
+        mCrc(crc)
+    {
+        //
+    }
+
+    /**
+     * @brief Add bytes to the checksum.
+     *
+     * @tparam ByteT  The byte type, must be one byte in size.
+     *
+     * @param data  The bytes to add.
+     */
+    template<typename ByteT>
+    requires(sizeof(ByteT) == 1)
+    constexpr void update(std::span<ByteT const> data)
+    {
+        mCrc = crc32c(data, mCrc);
+    }
+
+    /// The checksum of the bytes so far.
+    constexpr auto value() const -> Value { return mCrc; }
+
+    /// Start over, as if no bytes were added.
+    constexpr void reset() { mCrc = 0; }
+
+private:
+    std::uint32_t mCrc{};
+};
+
+/**
+ * @brief An accumulator for the xxHash64 hash of bytes passed in parts.
+ *
+ * @details xxHash64 is a fast non-cryptographic hash, processing 32 bytes at
+ *          a time with only multiplications, rotations and additions. It
+ *          detects corruption as well as a CRC but has no hardware support to
+ *          rely on, so it is as fast on every processor.
+ */
+class XxHash64
+{
+public:
+    /// The type of the checksum.
+    using Value = std::uint64_t;
+
+    /**
+     * @brief The `XxHash64` constructor.
+     *
+     * @param seed  The seed of the hash. [`0`]
+     */
+    constexpr explicit XxHash64(std::uint64_t seed = 0) :
+        mSeed(seed)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Add bytes to the hash.
+     *
+     * @tparam ByteT  The byte type, must be one byte in size.
+     *
+     * @param data  The bytes to add.
+     */
+    template<typename ByteT>
+    requires(sizeof(ByteT) == 1)
+    constexpr void update(std::span<ByteT const> data)
+    {
+        mLength += std::ranges::size(data);
+
+        // Complete a stripe from an earlier update first
+        if (mBuffered > 0)
+        {
+            std::size_t count = std::min(std::ranges::size(data),
+                                         std::ranges::size(mBuffer) -
+                                             mBuffered);
+            for (std::size_t index = 0; index < count; ++index)
+                mBuffer[mBuffered + index] = static_cast<std::uint8_t>(
+                    data[index]);
+
+            mBuffered += count;
+            data = data.subspan(count);
+            if (mBuffered < std::ranges::size(mBuffer))
+                return;
+
+            stripe(std::span<std::uint8_t const>(mBuffer));
+            mBuffered = 0;
+        }
+
+        for (; std::ranges::size(data) >= 32; data = data.subspan(32))
+            stripe(data.first(32));
+
+        for (std::size_t index = 0; index < std::ranges::size(data); ++index)
+            mBuffer[index] = static_cast<std::uint8_t>(data[index]);
+
+        mBuffered = std::ranges::size(data);
+    }
+
+    /// The hash of the bytes so far.
+    constexpr auto value() const
+        -> Value
+    {
+        auto const& primes = xxHash64Primes;
+
+        std::uint64_t hash{};
+        if (mLength >= 32)
+        {
+            hash = std::rotl(mLanes[0], 1) + std::rotl(mLanes[1], 7) +
+                   std::rotl(mLanes[2], 12) + std::rotl(mLanes[3], 18);
+            for (std::uint64_t lane : mLanes)
+                hash = (hash ^ round(0, lane)) * primes[0] + primes[3];
+        }
+        else
+        {
+            hash = mSeed + primes[4];
+        }
+
+        hash += mLength;
+
+        std::span<std::uint8_t const> rest(std::ranges::data(mBuffer),
+                                           mBuffered);
+        for (; std::ranges::size(rest) >= 8; rest = rest.subspan(8))
+        {
+            hash ^= round(0, load<std::uint64_t>(rest));
+            hash = std::rotl(hash, 27) * primes[0] + primes[3];
+        }
+
+        if (std::ranges::size(rest) >= 4)
+        {
+            hash ^= load<std::uint32_t>(rest) * primes[0];
+            hash = std::rotl(hash, 23) * primes[1] + primes[2];
+            rest = rest.subspan(4);
+        }
+
+        for (std::uint8_t byte : rest)
+        {
+            hash ^= byte * primes[4];
+            hash = std::rotl(hash, 11) * primes[0];
+        }
+
+        hash ^= hash >> 33;
+        hash *= primes[1];
+        hash ^= hash >> 29;
+        hash *= primes[2];
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    /// Start over, as if no bytes were added.
+    constexpr void reset()
+    {
+        auto const& primes = xxHash64Primes;
+
+        mLanes = {mSeed + primes[0] + primes[1], mSeed + primes[1], mSeed,
+                  mSeed - primes[0]};
+        mLength = 0;
+        mBuffered = 0;
+    }
+
+private:
+    std::uint64_t mSeed{};
+    std::array<std::uint64_t, 4> mLanes{};
+    std::uint64_t mLength{};
+
+    std::array<std::uint8_t, 32> mBuffer{};
+    std::size_t mBuffered{};
+
+    /// Mix 8 bytes of input into a lane.
+    static constexpr auto round(std::uint64_t lane, std::uint64_t input)
+        -> std::uint64_t
+    {
+        lane += input * xxHash64Primes[1];
+
+        return std::rotl(lane, 31) * xxHash64Primes[0];
+    }
+
+    /// Read a little endian integer from the front of `data`.
+    template<typename T, typename ByteT>
+    static constexpr auto load(std::span<ByteT const> data)
+        -> T
+    {
+        T value{};
+        for (std::size_t index = 0; index < sizeof(T); ++index)
+            value |= static_cast<T>(static_cast<std::uint8_t>(data[index]))
+                     << (8 * index);
+
+        return value;
+    }
+
+    /// Mix a stripe of 32 bytes into the lanes.
+    template<typename ByteT>
+    constexpr void stripe(std::span<ByteT const> data)
+    {
+        for (std::size_t lane = 0; lane < 4; ++lane)
+            mLanes[lane] = round(mLanes[lane], load<std::uint64_t>(
+                                                   data.subspan(lane * 8)));
+    }
+};
+
+/**
+ * @brief Calculates the xxHash64 hash of bytes.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param data  The bytes to hash.
+ * @param seed  The seed of the hash. [`0`]
+ *
+ * @return The hash.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+constexpr auto xxHash64(std::span<ByteT const> data, std::uint64_t seed = 0)
+    -> std::uint64_t
+{
+    XxHash64 hash(seed);
+    hash.update(data);
+
+    return hash.value();
+}
+}
+
+#endif
@@ -0,0 +1,314 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_CHECKSUMSTREAM_HPP_
+#define SCPPL_BINARY_CHECKSUMSTREAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <ios>
+#include <span>
+#include <utility>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+
+namespace scppl {
+
+/// The amount of bytes a `ChecksumStream` collects before adding them to its
+/// checksum.
+constexpr std::size_t checksumStreamStageLength = 4096;
+
+/**
+ * @brief A stream that calculates a checksum of the bytes passing through it.
+ *
+ * @details Every byte written to or read from the stream is added to the
+ *          checksum on the way, while it is still in the processor cache,
+ *          instead of in a second pass over the data afterwards. `reset()`
+ *          starts a new checksum, for example per record.
+ *
+ *          Small reads and writes, like single values, are collected and
+ *          added to the checksum `checksumStreamStageLength` bytes at a time.
+ *          Adding them one by one would make every value wait for the
+ *          checksum of the previous one, while a block is checksummed at the
+ *          full speed of @ref scppl::crc32c().
+ *
+ *          When the stream is a @ref scppl::SpanSource, like
+ *          @ref scppl::FileStream, this is one too and bytes are added when
+ *          they are consumed, so a @ref scppl::BinaryStream over it reads
+ *          views without copying and the checksum covers exactly the bytes
+ *          read. Otherwise bytes are added when they are read from the
+ *          stream, which includes bytes `BinaryStream` buffers ahead.
+ *
+ *          Seeking moves the position without adding the skipped bytes.
+ *
+ * @code{.cpp}
+ * scppl::ChecksumStream<scppl::FileStream<>> checksummed(file);
+ * scppl::ChecksumBinaryStream<scppl::FileStream<>,
+ *                             std::endian::little> stream(checksummed);
+ * stream.write(id, timestamp);
+ * stream.writeRaw(payload);
+ * stream.write(checksummed.value());
+ * @endcode
+ *
+ * @tparam StreamT    The stream to read from and/or write to.
+ * @tparam ChecksumT  The checksum, must be an
+ *                    @ref scppl::ChecksumAccumulator. [`scppl::Crc32c`]
+ * @tparam ByteT      The byte type of the stream.
+ *                    [`scppl::StreamByteT<StreamT>`]
+ */
+template<typename StreamT, typename ChecksumT = Crc32c,
+         typename ByteT = StreamByteT<StreamT>>
+requires(ChecksumAccumulator<ChecksumT, ByteT>)
+class ChecksumStream
+{
+public:
+    /// The stream type of this `ChecksumStream` instance.
+    using Stream = StreamT;
+
+    /// The checksum type of this `ChecksumStream` instance.
+    using Checksum = ChecksumT;
+
+    /// The byte type of this `ChecksumStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `ChecksumStream` constructor.
+     *
+     * @param stream    The stream to read from and/or write to.
+     * @param checksum  The initial checksum. [`Checksum{}`]
+     */
+    explicit ChecksumStream(Stream& stream, Checksum checksum = Checksum{}) :
+        mStream(stream),
+        mChecksum(std::move(checksum)),
+        mInitial(mChecksum)
+    {
+        //
+    }
+
+    ChecksumStream(ChecksumStream const&) = delete;
+    ChecksumStream(ChecksumStream&&) = delete;
+
+    ~ChecksumStream() noexcept = default;
+
+    auto operator=(ChecksumStream const&) -> ChecksumStream& = delete;
+    auto operator=(ChecksumStream&&) -> ChecksumStream& = delete;
+
+    /**
+     * @brief Read bytes from the stream and add them to the checksum.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @throws Any exception thrown by the stream.
+     *
+     * @return The amount of bytes read.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    requires(requires(Stream& stream) { stream.read(data, length); })
+    {
+        std::size_t count = 0;
+        if constexpr(std::convertible_to<decltype(mStream.read(data, length)),
+                                         std::size_t>)
+        {
+            count = mStream.read(data, length);
+        }
+        else
+        {
+            mStream.read(data, length);
+            count = static_cast<std::size_t>(mStream.gcount());
+        }
+
+        add(std::span<Byte const>(data, count));
+
+        return count;
+    }
+
+    /**
+     * @brief Get bytes from the buffer of the stream without consuming them.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws Any exception thrown by the stream.
+     *
+     * @return The bytes from the stream, see @ref scppl::SpanSource.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    requires(SpanSource<Stream, Byte>)
+    {
+        mAcquired = mStream.acquire(length);
+
+        return mAcquired;
+    }
+
+    /**
+     * @brief Consume bytes of the last `acquire()` and add them to the
+     *        checksum.
+     *
+     * @param length  The amount of bytes to consume.
+     */
+    void commit(std::size_t length)
+    requires(SpanSource<Stream, Byte>)
+    {
+        add(mAcquired.first(length));
+        mAcquired = mAcquired.subspan(length);
+
+        mStream.commit(length);
+    }
+
+    /**
+     * @brief Add bytes to the checksum and write them to the stream.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void write(Byte const* data, std::size_t length)
+    requires(requires(Stream& stream) { stream.write(data, length); })
+    {
+        add(std::span<Byte const>(data, length));
+        mStream.write(data, length);
+    }
+
+    /**
+     * @brief Add multiple parts to the checksum and write them to the stream
+     *        at once.
+     *
+     * @param parts  The parts to write, in order.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void writev(std::span<std::span<Byte const> const> parts)
+    requires(GatherSink<Stream, Byte>)
+    {
+        for (std::span<Byte const> part : parts)
+            add(part);
+
+        mStream.writev(parts);
+    }
+
+    /**
+     * @brief Flush the stream.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void flush()
+    requires(requires(Stream& stream) { stream.flush(); })
+    {
+        mStream.flush();
+    }
+
+    /// Get the read position of the stream.
+    auto tellg()
+    requires(SeekableSource<Stream>)
+    {
+        return mStream.tellg();
+    }
+
+    /// Move the read position of the stream, without adding skipped bytes.
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    requires(SeekableSource<Stream>)
+    {
+        mAcquired = {};
+        mStream.seekg(offset, direction);
+    }
+
+    /// Get the write position of the stream.
+    auto tellp()
+    requires(requires(Stream& stream) { stream.tellp(); })
+    {
+        return mStream.tellp();
+    }
+
+    /// Move the write position of the stream.
+    void seekp(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    requires(SeekableSink<Stream>)
+    {
+        mStream.seekp(offset, direction);
+    }
+
+    /// Whether the stream reached its end.
+    auto eof()
+        -> bool
+    requires(requires(Stream& stream) { stream.eof(); })
+    {
+        return mStream.eof();
+    }
+
+    /// The checksum of the bytes so far.
+    auto value() const
+    {
+        if (mStaged == 0)
+            return mChecksum.value();
+
+        Checksum checksum = mChecksum;
+        checksum.update(std::span<Byte const>(std::ranges::data(mStage),
+                                              mStaged));
+
+        return checksum.value();
+    }
+
+    /// Start a new checksum, equal to the one passed to the constructor.
+    void reset()
+    {
+        mChecksum = mInitial;
+        mStaged = 0;
+    }
+
+    /// The stream this stream reads from and/or writes to.
+    auto stream() const -> Stream& { return mStream; }
+
+private:
+    Stream& mStream;
+    Checksum mChecksum;
+    Checksum mInitial;
+
+    std::span<Byte const> mAcquired{};
+
+    std::array<Byte, checksumStreamStageLength> mStage{};
+    std::size_t mStaged{};
+
+    /// Add bytes to the checksum, collecting small amounts first.
+    void add(std::span<Byte const> data)
+    {
+        if (mStaged + std::ranges::size(data) > std::ranges::size(mStage))
+        {
+            mChecksum.update(std::span<Byte const>(std::ranges::data(mStage),
+                                                   mStaged));
+            mStaged = 0;
+        }
+
+        if (std::ranges::size(data) >= std::ranges::size(mStage))
+        {
+            mChecksum.update(data);
+
+            return;
+        }
+
+        std::ranges::copy(data, std::ranges::begin(mStage) +
+                                    static_cast<std::ptrdiff_t>(mStaged));
+        mStaged += std::ranges::size(data);
+    }
+};
+
+/// An alias for `BinaryStream` reading and/or writing through a
+/// `ChecksumStream`.
+template<typename StreamT, std::endian tEndian = std::endian::native,
+         typename ChecksumT = Crc32c>
+using ChecksumBinaryStream = BinaryStream<tEndian, true,
+                                          ChecksumStream<StreamT, ChecksumT>>;
+
+}
+
+#endif
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_COALESCINGSTREAM_HPP_
+#define SCPPL_BINARY_COALESCINGSTREAM_HPP_
+
+#include <bit>
+#include <cstring>
+#include <ios>
+#include <span>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+#include "scppl/binary/WriteBuffer.hpp"
+
+namespace scppl {
+
+/// When a `CoalescingStream` writes its buffer to the sink.
+struct CoalescingOptions
+{
+    /// The size of the buffer in bytes, writes at least this large bypass it.
+    std::size_t capacity = std::size_t{1} << 16;
+
+    /// Flush once this many bytes are buffered, `0` to only flush when full.
+    std::size_t threshold = 0;
+
+    /// Flush once this many writes are buffered, `0` to disable.
+    std::size_t records = 0;
+
+    /// Flush the buffer when the stream is destroyed.
+    bool flushOnDestroy = true;
+};
+
+/**
+ * @brief A write-only stream that coalesces small writes into a single buffer.
+ *
+ * @details Writes are copied into a contiguous buffer, which is written to the
+ *          sink with a single `write` when it is full, when one of the
+ *          triggers in @ref scppl::CoalescingOptions is reached, when
+ *          `flush()` is called or when the stream is destroyed. It is a
+ *          @ref scppl::SpanSink, so @ref scppl::BinaryStream packs values
+ *          straight into the buffer.
+ *
+ *          The write position is available when the sink is an
+ *          @ref scppl::SeekableSink, seeking flushes the buffer first.
+ *
+ * @tparam SinkT  The sink to write to, must have a `write(data, length)`.
+ * @tparam ByteT  The byte type of the sink. [`scppl::StreamByteT<SinkT>`]
+ */
+template<typename SinkT, typename ByteT = StreamByteT<SinkT>>
+class CoalescingStream
+{
+public:
+    /// The sink type of this `CoalescingStream` instance.
+    using Sink = SinkT;
+
+    /// The byte type of this `CoalescingStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `CoalescingStream` constructor.
+     *
+     * @param sink     The sink to write the buffer to.
+     * @param options  The buffer size and flush triggers. [`{}`]
+     */
+    explicit CoalescingStream(Sink& sink, CoalescingOptions options = {}) :
+        mSink(sink),
+        mOptions(options),
+        mBuffer(options.capacity)
+    {
+        //
+    }
+
+    CoalescingStream(CoalescingStream const&) = delete;
+    CoalescingStream(CoalescingStream&&) = delete;
+
+    /// Flushes the buffer, if `flushOnDestroy` is set.
+    ~CoalescingStream() noexcept
+    {
+        if (!mOptions.flushOnDestroy)
+            return;
+
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `flush()` for that
+        }
+    }
+
+    auto operator=(CoalescingStream const&) -> CoalescingStream& = delete;
+    auto operator=(CoalescingStream&&) -> CoalescingStream& = delete;
+
+    /**
+     * @brief Write bytes into the buffer.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        if (mBuffer.bypasses(length))
+        {
+            drain();
+            mSink.write(data, length);
+
+            return;
+        }
+
+        std::memcpy(std::ranges::data(acquire(length)), data,
+                    length * sizeof(Byte));
+        commit(length);
+    }
+
+    /**
+     * @brief Get space at the end of the buffer, draining it first when
+     *        `length` bytes do not fit.
+     *
+     * @details A `length` larger than the buffer grows it until the bytes are
+     *          committed, they are then written to the sink right away.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @return The free space in the buffer, at least `length` bytes.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte>
+    {
+        if (!mBuffer.fits(length))
+            drain();
+
+        return mBuffer.acquire(length);
+    }
+
+    /**
+     * @brief Mark bytes of the last `acquire()` as written.
+     *
+     * @param length  The amount of bytes written.
+     */
+    void commit(std::size_t length)
+    {
+        mBuffer.commit(length);
+        ++mRecords;
+
+        if (mBuffer.oversized() ||
+            (mOptions.threshold > 0 && mBuffer.size() >= mOptions.threshold) ||
+            (mOptions.records > 0 && mRecords >= mOptions.records))
+        {
+            drain();
+        }
+    }
+
+    /**
+     * @brief Write the buffer to the sink, and flush the sink if it has a
+     *        `flush()` function.
+     */
+    void flush()
+    {
+        drain();
+
+        if constexpr(requires(Sink& sink) { sink.flush(); })
+        {
+            mSink.flush();
+        }
+    }
+
+    /// Get the write position, including the buffered bytes.
+    auto tellp()
+        -> std::size_t
+    requires(SeekableSink<Sink>)
+    {
+        return static_cast<std::size_t>(mSink.tellp()) + mBuffer.size();
+    }
+
+    /**
+     * @brief Flush the buffer and move the write position of the sink.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekp(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    requires(SeekableSink<Sink>)
+    {
+        drain();
+        mSink.seekp(offset, direction);
+    }
+
+    /// The amount of bytes in the buffer.
+    auto buffered() const -> std::size_t { return mBuffer.size(); }
+
+    /// The sink this stream writes to.
+    auto sink() const -> Sink& { return mSink; }
+
+private:
+    Sink& mSink;
+    CoalescingOptions mOptions{};
+
+    WriteBuffer<Byte> mBuffer;
+    std::size_t mRecords{};
+
+    /// Write the buffer to the sink with a single write.
+    void drain()
+    {
+        std::span<Byte const> data = mBuffer.data();
+        if (!std::ranges::empty(data))
+            mSink.write(std::ranges::data(data), std::ranges::size(data));
+
+        mBuffer.clear();
+        mRecords = 0;
+    }
+};
+
+/// An alias for `BinaryStream` writing through a `CoalescingStream`.
+template<typename SinkT, std::endian tEndian = std::endian::native>
+using CoalescingBinaryStream = BinaryStream<tEndian, true,
+                                            CoalescingStream<SinkT>>;
+
+}
+
+#endif
@@ -0,0 +1,689 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_COMPRESSEDSTREAM_HPP_
+#define SCPPL_BINARY_COMPRESSEDSTREAM_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/Compression.hpp"
+#include "scppl/binary/SpanStream.hpp"
+#include "scppl/binary/Traits.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+/// The last four bytes of a compressed stream, "SCCS" in little endian.
+constexpr std::uint32_t compressedStreamMagic = 0x53434353;
+
+/// The length of the footer at the end of a compressed stream.
+constexpr std::size_t compressedStreamFooterLength =
+    lengthOf<uint64_t, uint32_t, uint32_t, uint32_t>();
+
+/// How a `CompressedStreamWriter` compresses its blocks.
+struct CompressedStreamOptions
+{
+    /// The amount of uncompressed bytes per block, larger blocks compress
+    /// better but make seeking decompress more.
+    std::size_t blockSize = std::size_t{1} << 16;
+
+    /// The codec to compress blocks with.
+    Compression compression = defaultCompression;
+
+    /// The compression level of zstd, ignored by the other codecs.
+    int level = defaultCompressionLevel;
+};
+
+/**
+ * @brief Writes a stream of independently compressed blocks.
+ *
+ * @details Written bytes are collected until they fill a block of `blockSize`
+ *          bytes, which is then compressed and written to the stream. A block
+ *          that does not get smaller is stored as is, so incompressible data
+ *          costs little more than its own length.
+ *
+ *          `finish()` writes the last block, an index with the amount of
+ *          blocks and the offset, compressed length, uncompressed length,
+ *          codec and CRC32C of every block, and a fixed size footer with the
+ *          position and CRC32C of the index. All numbers are little endian.
+ *          Because every block is compressed on its own, a
+ *          @ref scppl::CompressedStreamReader can seek to any position by
+ *          decompressing only the block holding it.
+ *
+ *          Offsets in the stream count from its start, so the compressed
+ *          stream can follow other data, like a header, as long as nothing
+ *          follows it.
+ *
+ *          This is a @ref scppl::SpanSink, so a @ref scppl::BinaryStream over
+ *          it packs values straight into the block.
+ *
+ * @code{.cpp}
+ * scppl::CompressedStreamWriter<scppl::FileStream<>> compressed(file);
+ * scppl::CompressedBinaryOutputStream<scppl::FileStream<>,
+ *                                     std::endian::little> stream(compressed);
+ * stream.write(id, timestamp);
+ * compressed.finish();
+ * @endcode
+ *
+ * @tparam StreamT  The type of the stream. [`std::iostream`]
+ * @tparam ByteT    The byte type of the stream, must be one byte in size.
+ *                  [`scppl::StreamByteT<StreamT>`]
+ */
+template<typename StreamT = std::iostream,
+         typename ByteT = StreamByteT<StreamT>>
+class CompressedStreamWriter
+{
+    static_assert(sizeof(ByteT) == 1, "`ByteT` must be one byte in size");
+
+public:
+    /// The stream type of this `CompressedStreamWriter` instance.
+    using Stream = StreamT;
+
+    /// The byte type of this `CompressedStreamWriter` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `CompressedStreamWriter` constructor.
+     *
+     * @param stream   The stream to write to, from its current position.
+     * @param options  The size of the blocks and the codec. [`{}`]
+     *
+     * @throws std::invalid_argument  The block size is `0` or does not fit in
+     *                                32 bits, or the codec is not available.
+     */
+    explicit CompressedStreamWriter(Stream& stream,
+                                    CompressedStreamOptions options = {}) :
+        mStream(stream),
+        mOptions(options),
+        mCodec(options.level)
+    {
+        if (mOptions.blockSize == 0 ||
+            mOptions.blockSize > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::invalid_argument("Block size must be between 1 and "
+                                        "2^32 - 1");
+        }
+
+        if (!isCompressionAvailable(mOptions.compression))
+            throw std::invalid_argument("Compression is not available");
+
+        mBlock.resize(mOptions.blockSize);
+
+        if constexpr(requires { mStream.tellOutput(); })
+        {
+            mStart = mStream.tellOutput();
+            mOffset = mStart;
+        }
+    }
+
+    CompressedStreamWriter(CompressedStreamWriter const&) = delete;
+    CompressedStreamWriter(CompressedStreamWriter&&) = delete;
+
+    /// Calls `finish()`, if it was not called yet.
+    ~CompressedStreamWriter() noexcept
+    {
+        try
+        {
+            finish();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `finish()` for that
+        }
+    }
+
+    auto operator=(CompressedStreamWriter const&)
+        -> CompressedStreamWriter& = delete;
+    auto operator=(CompressedStreamWriter&&)
+        -> CompressedStreamWriter& = delete;
+
+    /**
+     * @brief Write bytes, compressing every block that fills up.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     *
+     * @throws std::invalid_argument  The stream is already finished.
+     * @throws Any exception thrown by the stream.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        checkFinished();
+
+        while (length > 0)
+        {
+            std::size_t count = std::min(length,
+                                         mOptions.blockSize - mLength);
+            std::memcpy(std::ranges::data(mBlock) + mLength, data, count);
+            mLength += count;
+            data += count;
+            length -= count;
+
+            if (mLength == mOptions.blockSize)
+                writeBlock();
+        }
+    }
+
+    /**
+     * @brief Get space in the current block to write to.
+     *
+     * @details Writes the current block first when `length` does not fit in
+     *          it, and grows the next block when `length` is larger than a
+     *          block.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws std::invalid_argument  The stream is already finished.
+     * @throws Any exception thrown by the stream.
+     *
+     * @return At least `length` bytes, see @ref scppl::SpanSink.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte>
+    {
+        checkFinished();
+
+        if (std::ranges::size(mBlock) - mLength < length)
+        {
+            writeBlock();
+            if (std::ranges::size(mBlock) < length)
+                mBlock.resize(length);
+        }
+
+        return std::span<Byte>(mBlock).subspan(mLength);
+    }
+
+    /**
+     * @brief Mark bytes of the last `acquire()` as written.
+     *
+     * @param length  The amount of bytes written.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void commit(std::size_t length)
+    {
+        mLength += length;
+        if (mLength >= mOptions.blockSize)
+            writeBlock();
+    }
+
+    /**
+     * @brief Compress the collected bytes as a shorter block and flush the
+     *        stream.
+     *
+     * @details Every flush ends a block, so flushing often compresses worse.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void flush()
+    {
+        writeBlock();
+
+        if constexpr(requires { mStream.stream().flush(); })
+        {
+            mStream.stream().flush();
+        }
+    }
+
+    /// Get the write position, in uncompressed bytes.
+    auto tellp() const -> std::size_t { return mPosition + mLength; }
+
+    /**
+     * @brief Write the last block, the index and the footer.
+     *
+     * @details Calling it again does nothing.
+     *
+     * @throws Any exception thrown by the stream.
+     */
+    void finish()
+    {
+        if (mFinished)
+            return;
+
+        mFinished = true;
+        writeBlock();
+
+        BufferStream<Byte> buffer{};
+        BinaryStream<std::endian::little, true, BufferStream<Byte>> index(
+            buffer);
+        index.write(static_cast<uint32_t>(std::ranges::size(mIndex)));
+        for (auto const& entry : mIndex)
+        {
+            index.write(entry.offset, entry.length, entry.rawLength,
+                        entry.compression, entry.checksum);
+        }
+
+        auto data = buffer.data().first(buffer.tellp());
+        auto footer = Binary<std::endian::little, Byte>::pack(
+            mOffset, static_cast<uint32_t>(std::ranges::size(data)),
+            crc32c(data), compressedStreamMagic);
+        mStream.writeGather(data, footer);
+        mOffset += std::ranges::size(data) + compressedStreamFooterLength;
+
+        if constexpr(requires { mStream.stream().flush(); })
+        {
+            mStream.stream().flush();
+        }
+    }
+
+    /// The amount of blocks written so far.
+    auto blocks() const -> std::size_t { return std::ranges::size(mIndex); }
+
+    /// The amount of bytes written to the stream so far.
+    auto written() const -> std::uint64_t { return mOffset - mStart; }
+
+private:
+    struct IndexEntry
+    {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::uint32_t rawLength;
+        std::uint8_t compression;
+        std::uint32_t checksum;
+    };
+
+    BinaryStream<std::endian::little, true, Stream, Byte> mStream;
+    CompressedStreamOptions mOptions{};
+    BlockCodec mCodec;
+
+    std::vector<Byte> mBlock{};
+    std::size_t mLength{};
+    std::vector<Byte> mCompressed{};
+
+    std::vector<IndexEntry> mIndex{};
+    std::uint64_t mStart{};
+    std::uint64_t mOffset{};
+    std::size_t mPosition{};
+    bool mFinished{};
+
+    void checkFinished() const
+    {
+        if (mFinished)
+            throw std::invalid_argument("Compressed stream is finished");
+    }
+
+    /// Compress and write the collected block, and start a new one.
+    void writeBlock()
+    {
+        if (mLength == 0)
+            return;
+
+        std::span<Byte const> raw(std::ranges::data(mBlock), mLength);
+
+        Compression compression = mOptions.compression;
+        mCompressed.resize(BlockCodec::compressBound(compression, mLength));
+        std::size_t length = mCodec.compress(compression, raw,
+                                             std::span<Byte>(mCompressed));
+
+        std::span<Byte const> stored(std::ranges::data(mCompressed), length);
+        if (length >= mLength)
+        {
+            compression = Compression::None;
+            stored = raw;
+        }
+
+        mStream.writeRaw(stored);
+        mIndex.push_back({mOffset, static_cast<uint32_t>(std::ranges::size(
+                                       stored)),
+                          static_cast<uint32_t>(mLength),
+                          static_cast<uint8_t>(compression), crc32c(stored)});
+
+        mOffset += std::ranges::size(stored);
+        mPosition += mLength;
+        mLength = 0;
+
+        // Back to the normal size after an `acquire()` larger than a block
+        mBlock.resize(mOptions.blockSize);
+    }
+};
+
+/**
+ * @brief Reads a stream written by a `CompressedStreamWriter`.
+ *
+ * @details Opening the stream only reads the footer and the index. Reading
+ *          decompresses one block at a time, after checking its CRC32C, and
+ *          seeking finds the block holding the new position with a binary
+ *          search over the index, so only that block is read and
+ *          decompressed.
+ *
+ *          This is a @ref scppl::SpanSource, so a @ref scppl::BinaryStream
+ *          over it reads views straight from the decompressed block.
+ *
+ * @code{.cpp}
+ * scppl::CompressedStreamReader<scppl::FileStream<>> compressed(file);
+ * scppl::CompressedBinaryInputStream<scppl::FileStream<>,
+ *                                    std::endian::little> stream(compressed);
+ * stream.toBegin(offset);
+ * auto [id, timestamp] = stream.read<uint64_t, uint64_t>();
+ * @endcode
+ *
+ * @tparam StreamT  The type of the stream, must be seekable.
+ *                  [`std::iostream`]
+ * @tparam ByteT    The byte type of the stream, must be one byte in size.
+ *                  [`scppl::StreamByteT<StreamT>`]
+ */
+template<typename StreamT = std::iostream,
+         typename ByteT = StreamByteT<StreamT>>
+class CompressedStreamReader
+{
+    static_assert(sizeof(ByteT) == 1, "`ByteT` must be one byte in size");
+
+public:
+    /// The stream type of this `CompressedStreamReader` instance.
+    using Stream = StreamT;
+
+    /// The byte type of this `CompressedStreamReader` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `CompressedStreamReader` constructor, reading the footer and
+     *        the index.
+     *
+     * @param stream  The stream to read from, ending with the compressed
+     *                stream.
+     *
+     * @throws std::runtime_error  The stream is not a compressed stream, or
+     *                             the index is corrupt.
+     */
+    explicit CompressedStreamReader(Stream& stream) :
+        mStream(stream)
+    {
+        mStream.toEnd();
+        std::size_t size = mStream.tell();
+        if (size < compressedStreamFooterLength)
+        {
+            throw std::runtime_error("Stream is too short for a compressed "
+                                     "stream");
+        }
+
+        auto footer = readRange(size - compressedStreamFooterLength,
+                                compressedStreamFooterLength);
+        auto [indexOffset, indexLength, checksum, magic] =
+            Binary<std::endian::little, Byte>::template unpack<
+                uint64_t, uint32_t, uint32_t, uint32_t>(
+                std::span<Byte const>(footer));
+
+        if (magic != compressedStreamMagic)
+            throw std::runtime_error("Stream is not a compressed stream");
+
+        if (indexOffset + indexLength + compressedStreamFooterLength != size)
+            throw std::runtime_error("Compressed stream footer is corrupt");
+
+        auto data = readRange(indexOffset, indexLength);
+        if (crc32c(std::span<Byte const>(data)) != checksum)
+            throw std::runtime_error("Compressed stream index is corrupt");
+
+        SpanStream<Byte> source(data);
+        BinaryStream<std::endian::little, true, SpanStream<Byte>> index(
+            source);
+        auto count = index.template readSingle<uint32_t>();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto [offset, length, rawLength, compression, blockChecksum] =
+                index.template read<uint64_t, uint32_t, uint32_t, uint8_t,
+                                    uint32_t>();
+            if (offset + length > indexOffset)
+                throw std::runtime_error("Compressed stream index is corrupt");
+
+            mIndex.push_back({offset, mSize, length, rawLength,
+                              static_cast<Compression>(compression),
+                              blockChecksum});
+            mSize += rawLength;
+        }
+    }
+
+    CompressedStreamReader(CompressedStreamReader const&) = delete;
+    CompressedStreamReader(CompressedStreamReader&&) = delete;
+
+    ~CompressedStreamReader() noexcept = default;
+
+    auto operator=(CompressedStreamReader const&)
+        -> CompressedStreamReader& = delete;
+    auto operator=(CompressedStreamReader&&)
+        -> CompressedStreamReader& = delete;
+
+    /**
+     * @brief Get the bytes from the current position without consuming them.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws std::runtime_error  A block is corrupt.
+     * @throws Any exception thrown by the stream.
+     *
+     * @return The rest of the current block, or a copy of the blocks that
+     *         hold `length` bytes when they do not fit in it. Less than
+     *         `length` at the end of the stream.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    {
+        std::span<Byte const> available = current();
+        if (std::ranges::size(available) >= length ||
+            mBlockIndex + 1 >= std::ranges::size(mIndex))
+        {
+            mEof = (std::ranges::size(available) < length);
+
+            return available;
+        }
+
+        // Crosses into the next blocks, which are copied behind it
+        mSpill.assign(std::ranges::begin(available),
+                      std::ranges::end(available));
+        std::size_t position = mPosition + std::ranges::size(available);
+        while (std::ranges::size(mSpill) < length && position < mSize)
+        {
+            std::span<Byte const> next = current(position);
+            mSpill.insert(std::ranges::end(mSpill), std::ranges::begin(next),
+                          std::ranges::end(next));
+            position += std::ranges::size(next);
+        }
+
+        mEof = (std::ranges::size(mSpill) < length);
+
+        return mSpill;
+    }
+
+    /**
+     * @brief Consume bytes from the current position.
+     *
+     * @param length  The amount of bytes to consume, at most the size of the
+     *                last `acquire()`.
+     */
+    void commit(std::size_t length)
+    {
+        mPosition += length;
+    }
+
+    /**
+     * @brief Read bytes from the current position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @throws std::runtime_error  A block is corrupt.
+     * @throws Any exception thrown by the stream.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t done = 0;
+        while (done < length)
+        {
+            std::span<Byte const> available = current();
+            std::size_t count = std::min(std::ranges::size(available),
+                                         length - done);
+            if (count == 0)
+                break;
+
+            std::memcpy(data + done, std::ranges::data(available), count);
+            mPosition += count;
+            done += count;
+        }
+
+        mEof = (done < length);
+
+        return done;
+    }
+
+    /// Get the read position, in uncompressed bytes.
+    auto tellg() const -> std::size_t { return mPosition; }
+
+    /**
+     * @brief Move the read position.
+     *
+     * @details Only the block holding the new position is decompressed, when
+     *          it is read from.
+     *
+     * @param offset     The amount of uncompressed bytes to seek from
+     *                   `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        std::streamoff base = 0;
+        if (direction == std::ios::cur)
+            base = static_cast<std::streamoff>(mPosition);
+        else if (direction == std::ios::end)
+            base = static_cast<std::streamoff>(mSize);
+
+        mPosition = static_cast<std::size_t>(base + offset);
+        mEof = false;
+    }
+
+    /// Whether the last read reached the end of the stream.
+    auto eof() const -> bool { return mEof; }
+
+    /// The amount of uncompressed bytes in the stream.
+    auto size() const -> std::size_t { return mSize; }
+
+    /// The amount of blocks in the stream.
+    auto blocks() const -> std::size_t { return std::ranges::size(mIndex); }
+
+private:
+    struct IndexEntry
+    {
+        std::uint64_t offset;
+        std::uint64_t position;
+        std::uint32_t length;
+        std::uint32_t rawLength;
+        Compression compression;
+        std::uint32_t checksum;
+    };
+
+    using BinaryStreamT = BinaryStream<std::endian::little, true, Stream,
+                                       Byte>;
+
+    BinaryStreamT mStream;
+    BlockCodec mCodec{};
+
+    std::vector<IndexEntry> mIndex{};
+    std::size_t mSize{};
+
+    std::size_t mPosition{};
+    bool mEof{};
+
+    /// The decompressed block holding the position, if `mLoaded`.
+    std::vector<Byte> mBlock{};
+    std::size_t mBlockIndex{};
+    bool mLoaded{};
+
+    std::vector<Byte> mSpill{};
+
+    /// Read `length` bytes at `offset`, throwing when the stream is shorter.
+    auto readRange(std::size_t offset, std::size_t length)
+        -> std::vector<Byte>
+    {
+        std::vector<Byte> data{};
+        if constexpr(BinaryStreamT::isPositionalInput)
+        {
+            data = mStream.readRawAt(offset, length);
+        }
+        else
+        {
+            mStream.seek(offset, std::ios::beg);
+            data = mStream.readRaw(length);
+        }
+
+        if (std::ranges::size(data) < length)
+            throw std::runtime_error("Compressed stream is truncated");
+
+        return data;
+    }
+
+    /// Read, check and decompress the block at `block`.
+    void load(std::size_t block)
+    {
+        auto const& entry = mIndex[block];
+
+        mLoaded = false;
+        auto data = readRange(entry.offset, entry.length);
+        if (crc32c(std::span<Byte const>(data)) != entry.checksum)
+            throw std::runtime_error("Compressed stream block is corrupt");
+
+        mBlock.resize(entry.rawLength);
+        mCodec.decompress(entry.compression, std::span<Byte const>(data),
+                          std::span<Byte>(mBlock));
+
+        mBlockIndex = block;
+        mLoaded = true;
+    }
+
+    /// The bytes of the block holding `position`, from `position`.
+    auto current(std::size_t position)
+        -> std::span<Byte const>
+    {
+        if (position >= mSize)
+            return {};
+
+        if (!mLoaded || position < mIndex[mBlockIndex].position ||
+            position - mIndex[mBlockIndex].position >= std::ranges::size(
+                                                           mBlock))
+        {
+            auto entry = std::ranges::upper_bound(mIndex, position, {},
+                                                  &IndexEntry::position);
+            load(static_cast<std::size_t>(
+                std::ranges::distance(std::ranges::begin(mIndex), entry) - 1));
+        }
+
+        return std::span<Byte const>(mBlock).subspan(
+            position - mIndex[mBlockIndex].position);
+    }
+
+    /// The bytes of the block holding the position, from the position.
+    auto current()
+        -> std::span<Byte const>
+    {
+        return current(mPosition);
+    }
+};
+
+/// An alias for `BinaryStream` writing through a `CompressedStreamWriter`.
+template<typename StreamT, std::endian tEndian = std::endian::native>
+using CompressedBinaryOutputStream =
+    BinaryStream<tEndian, true, CompressedStreamWriter<StreamT>>;
+
+/// An alias for `BinaryStream` reading through a `CompressedStreamReader`.
+template<typename StreamT, std::endian tEndian = std::endian::native>
+using CompressedBinaryInputStream =
+    BinaryStream<tEndian, true, CompressedStreamReader<StreamT>>;
+
+}
+
+#endif
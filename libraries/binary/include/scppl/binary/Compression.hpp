@@ -0,0 +1,626 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_COMPRESSION_HPP_
+#define SCPPL_BINARY_COMPRESSION_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#if SCPPL_CONFIG_BINARY_USE_LZ4
+#include <lz4.h>
+#endif
+
+namespace scppl {
+
+/// The codecs a block of data can be compressed with.
+enum class Compression : std::uint8_t
+{
+    /// Stored as is.
+    None = 0,
+
+    /// The built-in LZ codec, see `lzCompress()`.
+    Lz = 1,
+
+    /// zstd, requires `SCPPL_CONFIG_BINARY_USE_ZSTD`.
+    Zstd = 2,
+
+    /// LZ4, requires `SCPPL_CONFIG_BINARY_USE_LZ4`.
+    Lz4 = 3
+};
+
+/// The best available codec: zstd, otherwise LZ4, otherwise the built-in LZ.
+constexpr Compression defaultCompression =
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+    Compression::Zstd;
+#elif SCPPL_CONFIG_BINARY_USE_LZ4
+    Compression::Lz4;
+#else
+    Compression::Lz;
+#endif
+
+/// The default compression level of zstd, fast with a good ratio.
+constexpr int defaultCompressionLevel = 3;
+
+/**
+ * @brief Checks whether a codec was enabled when configuring.
+ *
+ * @param compression  The codec to check.
+ *
+ * @return Whether blocks can be compressed and decompressed with it.
+ */
+constexpr auto isCompressionAvailable(Compression compression)
+    -> bool
+{
+    switch (compression)
+    {
+    case Compression::None:
+    case Compression::Lz:
+        return true;
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+    case Compression::Zstd:
+        return true;
+#endif
+
+#if SCPPL_CONFIG_BINARY_USE_LZ4
+    case Compression::Lz4:
+        return true;
+#endif
+
+    default:
+        return false;
+    }
+}
+
+/// The shortest match of the built-in LZ codec.
+constexpr std::size_t lzMinMatch = 4;
+
+/// The farthest match of the built-in LZ codec.
+constexpr std::size_t lzMaxOffset = 65535;
+
+/// The amount of entries in the hash table of `lzCompress()`.
+constexpr std::size_t lzHashLength = std::size_t{1} << 14;
+
+/**
+ * @brief The largest output of `lzCompress()`.
+ *
+ * @param length  The length of the input.
+ *
+ * @return The output length needed for an incompressible input.
+ */
+constexpr auto lzCompressBound(std::size_t length)
+    -> std::size_t
+{
+    return length + length / 255 + 16;
+}
+
+/**
+ * @brief Compresses bytes with the built-in LZ codec.
+ *
+ * @details The output is a list of sequences, like LZ4: a token with the
+ *          amounts of literals and matched bytes, the literals, and a 16 bit
+ *          offset back to the match. The last sequence only has literals.
+ *          Matches are found greedily with a hash table of 4 byte sequences,
+ *          and the search speeds up over incompressible data. It compresses
+ *          less than zstd, but needs no dependency and decompresses about as
+ *          fast as it copies.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param input   The bytes to compress.
+ * @param output  Where to store the compressed bytes, at least
+ *                `lzCompressBound(std::ranges::size(input))` bytes.
+ * @param table   The hash table, `lzHashLength` entries. It is only a hint,
+ *                so it can be reused between calls without clearing it.
+ *
+ * @throws std::length_error  `output` or `table` is too small.
+ *
+ * @return The length of the compressed bytes.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+auto lzCompress(std::span<ByteT const> input, std::span<ByteT> output,
+                std::span<std::uint32_t> table)
+    -> std::size_t
+{
+    if (std::ranges::size(output) < lzCompressBound(std::ranges::size(input)))
+        throw std::length_error("Output is too small for the compressed data");
+
+    if (std::ranges::size(table) < lzHashLength)
+        throw std::length_error("Table is smaller than `lzHashLength`");
+
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const* in = reinterpret_cast<unsigned char const*>(
+        std::ranges::data(input));
+    auto* out = reinterpret_cast<unsigned char*>(std::ranges::data(output));
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    std::size_t length = std::ranges::size(input);
+    std::size_t written = 0;
+
+    auto load = [in]<typename T>(std::size_t position) -> T {
+        T value{};
+        std::memcpy(&value, in + position, sizeof(T));
+
+        return value;
+    };
+
+    auto writeLength = [out, &written](std::size_t rest) {
+        for (; rest >= 255; rest -= 255)
+            out[written++] = 255;
+
+        out[written++] = static_cast<unsigned char>(rest);
+    };
+
+    auto writeSequence = [&](std::size_t anchor, std::size_t literals,
+                             std::size_t offset, std::size_t match) {
+        std::size_t extra = (offset > 0 ? match - lzMinMatch : 0);
+        out[written++] = static_cast<unsigned char>(
+            std::min<std::size_t>(literals, 15) << 4 |
+            std::min<std::size_t>(extra, 15));
+
+        if (literals >= 15)
+            writeLength(literals - 15);
+
+        if (literals > 0)
+            std::memcpy(out + written, in + anchor, literals);
+
+        written += literals;
+
+        if (offset == 0)
+            return;
+
+        out[written++] = static_cast<unsigned char>(offset & 0xFF);
+        out[written++] = static_cast<unsigned char>(offset >> 8);
+
+        if (extra >= 15)
+            writeLength(extra - 15);
+    };
+
+    std::size_t anchor = 0;
+    std::size_t position = 0;
+    std::size_t misses = 0;
+    while (position + lzMinMatch <= length)
+    {
+        auto sequence = load.template operator()<std::uint32_t>(position);
+        std::size_t hash = (sequence * 2654435761u) >>
+                           (32 - std::countr_zero(lzHashLength));
+
+        std::size_t candidate = table[hash];
+        table[hash] = static_cast<std::uint32_t>(position);
+
+        // Entries from earlier calls are only used when the bytes match
+        if (candidate >= position || position - candidate > lzMaxOffset ||
+            load.template operator()<std::uint32_t>(candidate) != sequence)
+        {
+            // Skip ahead faster the longer nothing matches
+            position += 1 + (misses++ >> 5);
+
+            continue;
+        }
+
+        std::size_t match = lzMinMatch;
+        while (position + match + 8 <= length)
+        {
+            auto difference =
+                load.template operator()<std::uint64_t>(candidate + match) ^
+                load.template operator()<std::uint64_t>(position + match);
+            if (difference != 0)
+            {
+                match += static_cast<std::size_t>(
+                    std::endian::native == std::endian::little
+                        ? std::countr_zero(difference)
+                        : std::countl_zero(difference)) / 8;
+
+                break;
+            }
+
+            match += 8;
+        }
+
+        if (position + match + 8 > length)
+        {
+            while (position + match < length &&
+                   in[candidate + match] == in[position + match])
+            {
+                ++match;
+            }
+        }
+
+        writeSequence(anchor, position - anchor, position - candidate, match);
+
+        position += match;
+        anchor = position;
+        misses = 0;
+    }
+
+    writeSequence(anchor, length - anchor, 0, 0);
+
+    return written;
+}
+
+/**
+ * @brief Decompresses bytes compressed with `lzCompress()`.
+ *
+ * @details Every length and offset is checked, so corrupt input throws
+ *          instead of reading or writing out of bounds.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param input   The compressed bytes.
+ * @param output  Where to store the decompressed bytes.
+ *
+ * @throws std::runtime_error  The input is corrupt or does not fit in
+ *                             `output`.
+ *
+ * @return The length of the decompressed bytes.
+ */
+template<typename ByteT>
+requires(sizeof(ByteT) == 1)
+auto lzDecompress(std::span<ByteT const> input, std::span<ByteT> output)
+    -> std::size_t
+{
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const* in = reinterpret_cast<unsigned char const*>(
+        std::ranges::data(input));
+    auto* out = reinterpret_cast<unsigned char*>(std::ranges::data(output));
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    std::size_t inLength = std::ranges::size(input);
+    std::size_t outLength = std::ranges::size(output);
+    std::size_t read = 0;
+    std::size_t written = 0;
+
+    auto corrupt = []() {
+        return std::runtime_error("Compressed data is corrupt");
+    };
+
+    // Runs are short, so copying them in chunks of 16 bytes is faster than
+    // calling `memcpy()` with their exact length. It needs 15 bytes of room
+    // past the run, which are overwritten later.
+    auto copyChunks = [](unsigned char* destination,
+                         unsigned char const* source, std::size_t length) {
+        for (std::size_t index = 0; index < length; index += 16)
+            std::memcpy(destination + index, source + index, 16);
+    };
+
+    auto readLength = [&](std::size_t length) -> std::size_t {
+        unsigned char byte = 255;
+        while (byte == 255)
+        {
+            if (read >= inLength || length > outLength)
+                throw corrupt();
+
+            byte = in[read++];
+            length += byte;
+        }
+
+        return length;
+    };
+
+    while (true)
+    {
+        if (read >= inLength)
+            throw corrupt();
+
+        unsigned char token = in[read++];
+
+        std::size_t literals = token >> 4;
+        if (literals == 15)
+            literals = readLength(literals);
+
+        if (literals > inLength - read || literals > outLength - written)
+            throw corrupt();
+
+        if (literals + 15 <= inLength - read &&
+            literals + 15 <= outLength - written)
+        {
+            copyChunks(out + written, in + read, literals);
+        }
+        else if (literals > 0)
+        {
+            std::memcpy(out + written, in + read, literals);
+        }
+
+        read += literals;
+        written += literals;
+
+        if (read == inLength)
+            break;
+
+        if (inLength - read < 2)
+            throw corrupt();
+
+        std::size_t offset = in[read] | static_cast<std::size_t>(in[read + 1])
+                                        << 8;
+        read += 2;
+
+        std::size_t match = (token & 0x0F);
+        if (match == 15)
+            match = readLength(match);
+
+        match += lzMinMatch;
+        if (offset == 0 || offset > written || match > outLength - written)
+            throw corrupt();
+
+        unsigned char* destination = out + written;
+        unsigned char const* source = destination - offset;
+        if (offset >= 16 && match + 15 <= outLength - written)
+        {
+            // Every chunk only reads bytes written before it
+            copyChunks(destination, source, match);
+        }
+        else if (offset >= match)
+        {
+            std::memcpy(destination, source, match);
+        }
+        else
+        {
+            // Overlapping, the match repeats the last `offset` bytes
+            for (std::size_t index = 0; index < match; ++index)
+                destination[index] = source[index];
+        }
+
+        written += match;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Compresses and decompresses blocks with any available codec.
+ *
+ * @details Keeps the state every codec needs between blocks, like the hash
+ *          table of `lzCompress()` and the contexts of zstd, so it should be
+ *          reused for every block of a stream. It is not thread-safe, use one
+ *          per thread.
+ */
+class BlockCodec
+{
+public:
+    /**
+     * @brief The `BlockCodec` constructor.
+     *
+     * @param level  The compression level of zstd, ignored by the other
+     *               codecs. [`defaultCompressionLevel`]
+     */
+    explicit BlockCodec(int level = defaultCompressionLevel) :
+        mLevel(level)
+    {
+        //
+    }
+
+    BlockCodec(BlockCodec const&) = delete;
+    BlockCodec(BlockCodec&&) = delete;
+
+    ~BlockCodec() noexcept
+    {
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+        ZSTD_freeCCtx(mZstdCompress);
+        ZSTD_freeDCtx(mZstdDecompress);
+#endif
+    }
+
+    auto operator=(BlockCodec const&) -> BlockCodec& = delete;
+    auto operator=(BlockCodec&&) -> BlockCodec& = delete;
+
+    /**
+     * @brief The largest compressed length of a block.
+     *
+     * @param compression  The codec.
+     * @param length       The length of the block.
+     *
+     * @throws std::invalid_argument  The codec is not available.
+     *
+     * @return The output length `compress()` needs.
+     */
+    static auto compressBound(Compression compression, std::size_t length)
+        -> std::size_t
+    {
+        switch (compression)
+        {
+        case Compression::None:
+            return length;
+
+        case Compression::Lz:
+            return lzCompressBound(length);
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+        case Compression::Zstd:
+            return ZSTD_compressBound(length);
+#endif
+
+#if SCPPL_CONFIG_BINARY_USE_LZ4
+        case Compression::Lz4:
+            return static_cast<std::size_t>(
+                LZ4_compressBound(static_cast<int>(length)));
+#endif
+
+        default:
+            throw std::invalid_argument("Compression is not available");
+        }
+    }
+
+    /**
+     * @brief Compress a block.
+     *
+     * @tparam ByteT  The byte type, must be one byte in size.
+     *
+     * @param compression  The codec.
+     * @param input        The bytes to compress.
+     * @param output       Where to store the compressed bytes, at least
+     *                     `compressBound()` bytes.
+     *
+     * @throws std::invalid_argument  The codec is not available.
+     * @throws std::length_error      `output` is too small.
+     * @throws std::runtime_error     The codec failed.
+     *
+     * @return The length of the compressed bytes.
+     */
+    template<typename ByteT>
+    requires(sizeof(ByteT) == 1)
+    auto compress(Compression compression, std::span<ByteT const> input,
+                  std::span<ByteT> output)
+        -> std::size_t
+    {
+        if (std::ranges::size(output) <
+            compressBound(compression, std::ranges::size(input)))
+        {
+            throw std::length_error("Output is too small for the compressed "
+                                    "data");
+        }
+
+        switch (compression)
+        {
+        case Compression::None:
+            std::ranges::copy(input, std::ranges::begin(output));
+
+            return std::ranges::size(input);
+
+        case Compression::Lz:
+            mTable.resize(lzHashLength);
+
+            return lzCompress(input, output, std::span(mTable));
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+        case Compression::Zstd:
+        {
+            if (mZstdCompress == nullptr)
+                mZstdCompress = ZSTD_createCCtx();
+
+            std::size_t result = ZSTD_compressCCtx(
+                mZstdCompress, std::ranges::data(output),
+                std::ranges::size(output), std::ranges::data(input),
+                std::ranges::size(input), mLevel);
+            if (ZSTD_isError(result))
+                throw std::runtime_error(ZSTD_getErrorName(result));
+
+            return result;
+        }
+#endif
+
+#if SCPPL_CONFIG_BINARY_USE_LZ4
+        case Compression::Lz4:
+        {
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            int result = LZ4_compress_default(
+                reinterpret_cast<char const*>(std::ranges::data(input)),
+                reinterpret_cast<char*>(std::ranges::data(output)),
+                static_cast<int>(std::ranges::size(input)),
+                static_cast<int>(std::ranges::size(output)));
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (result <= 0)
+                throw std::runtime_error("LZ4 compression failed");
+
+            return static_cast<std::size_t>(result);
+        }
+#endif
+
+        default:
+            throw std::invalid_argument("Compression is not available");
+        }
+    }
+
+    /**
+     * @brief Decompress a block.
+     *
+     * @tparam ByteT  The byte type, must be one byte in size.
+     *
+     * @param compression  The codec the block was compressed with.
+     * @param input        The compressed bytes.
+     * @param output       Where to store the decompressed bytes, exactly the
+     *                     length of the block.
+     *
+     * @throws std::invalid_argument  The codec is not available.
+     * @throws std::runtime_error     The block is corrupt or has a different
+     *                                length.
+     */
+    template<typename ByteT>
+    requires(sizeof(ByteT) == 1)
+    void decompress(Compression compression, std::span<ByteT const> input,
+                    std::span<ByteT> output)
+    {
+        std::size_t length = 0;
+        switch (compression)
+        {
+        case Compression::None:
+            if (std::ranges::size(input) != std::ranges::size(output))
+                throw std::runtime_error("Compressed data is corrupt");
+
+            std::ranges::copy(input, std::ranges::begin(output));
+            length = std::ranges::size(input);
+            break;
+
+        case Compression::Lz:
+            length = lzDecompress(input, output);
+            break;
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+        case Compression::Zstd:
+        {
+            if (mZstdDecompress == nullptr)
+                mZstdDecompress = ZSTD_createDCtx();
+
+            length = ZSTD_decompressDCtx(
+                mZstdDecompress, std::ranges::data(output),
+                std::ranges::size(output), std::ranges::data(input),
+                std::ranges::size(input));
+            if (ZSTD_isError(length))
+                throw std::runtime_error("Compressed data is corrupt");
+
+            break;
+        }
+#endif
+
+#if SCPPL_CONFIG_BINARY_USE_LZ4
+        case Compression::Lz4:
+        {
+            // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+            int result = LZ4_decompress_safe(
+                reinterpret_cast<char const*>(std::ranges::data(input)),
+                reinterpret_cast<char*>(std::ranges::data(output)),
+                static_cast<int>(std::ranges::size(input)),
+                static_cast<int>(std::ranges::size(output)));
+            // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+            if (result < 0)
+                throw std::runtime_error("Compressed data is corrupt");
+
+            length = static_cast<std::size_t>(result);
+            break;
+        }
+#endif
+
+        default:
+            throw std::invalid_argument("Compression is not available");
+        }
+
+        if (length != std::ranges::size(output))
+            throw std::runtime_error("Compressed data is corrupt");
+    }
+
+private:
+    [[maybe_unused]] int mLevel{};
+
+    std::vector<std::uint32_t> mTable{};
+
+#if SCPPL_CONFIG_BINARY_USE_ZSTD
+    ZSTD_CCtx* mZstdCompress{};
+    ZSTD_DCtx* mZstdDecompress{};
+#endif
+};
+
+}
+
+#endif
@@ -5,7 +5,11 @@
 #ifndef SCPPL_BINARY_CONCEPTS_HPP_
 #define SCPPL_BINARY_CONCEPTS_HPP_
 
+#include <concepts>
+#include <cstddef>
+#include <ios>
 #include <ranges>
+#include <span>
 
 #include "scppl/binary/Traits.hpp"
 
@@ -54,39 +58,179 @@ template<typename T>
 concept Unpackable = UnpackableTrait<T>::value;
 
 /**
- * @brief Concept for an input stream type.
+ * @brief Concept for a source that hands out spans of its own buffer.
  *
- * @details A type is an input stream if it has a read function accepting a
- *          pointer to it's underlying data type and a length.
+ * @details A type is a span source if `acquire(length)` returns a
+ *          `std::span<ByteT const>` over at least `length` buffered bytes (or
+ *          less at the end), and `commit(length)` consumes bytes from the
+ *          front of it. The span stays valid until the next call other than
+ *          `commit(length)`.
  *
- * @tparam StreamT  The stream type to test.
- * @tparam ByteT    The underlying type of the stream.
- * @tparam Ts       Other stream parameters.
+ * @tparam StreamT  The source type to test.
+ * @tparam ByteT    The byte type of the source.
  */
-template<template<typename, typename...> typename StreamT,
-         typename ByteT, typename... Ts>
-concept InputStream = requires(StreamT<ByteT, Ts...> stream, ByteT* data)
+template<typename StreamT, typename ByteT>
+concept SpanSource = requires(StreamT& stream, std::size_t length)
 {
-    stream.read(data, std::declval<std::size_t>());
+    { stream.acquire(length) } -> std::same_as<std::span<ByteT const>>;
+    stream.commit(length);
 };
 
 /**
- * @brief Concept for an output stream type.
+ * @brief Concept for a sink that hands out spans of its own buffer.
  *
- * @details A type is an output stream if it has a write function accepting a
- *          pointer to it's underlying data type and a length.
+ * @details A type is a span sink if `acquire(length)` returns a writable
+ *          `std::span<ByteT>` of at least `length` bytes, and `commit(length)`
+ *          marks bytes at the front of it as written.
  *
- * @tparam StreamT  The stream type to test.
- * @tparam ByteT    The underlying type of the stream.
- * @tparam Ts       Other stream parameters.
+ * @tparam StreamT  The sink type to test.
+ * @tparam ByteT    The byte type of the sink.
+ */
+template<typename StreamT, typename ByteT>
+concept SpanSink = requires(StreamT& stream, std::size_t length)
+{
+    { stream.acquire(length) } -> std::same_as<std::span<ByteT>>;
+    stream.commit(length);
+};
+
+/**
+ * @brief Concept for a type bytes can be read from.
+ *
+ * @details A type is a byte source if it has a read function accepting a
+ *          pointer to bytes and a length, or if it is a
+ *          @ref scppl::SpanSource. The read function may return the amount of
+ *          bytes read, otherwise `gcount()` is used when available.
+ *
+ * @tparam StreamT  The source type to test.
+ * @tparam ByteT    The byte type of the source.
+ */
+template<typename StreamT, typename ByteT>
+concept ByteSource = requires(StreamT& stream, ByteT* data, std::size_t length)
+{
+    stream.read(data, length);
+} || SpanSource<StreamT, ByteT>;
+
+/**
+ * @brief Concept for a type bytes can be written to.
+ *
+ * @details A type is a byte sink if it has a write function accepting a
+ *          pointer to bytes and a length, or if it is a @ref scppl::SpanSink.
+ *
+ * @tparam StreamT  The sink type to test.
+ * @tparam ByteT    The byte type of the sink.
+ */
+template<typename StreamT, typename ByteT>
+concept ByteSink = requires(StreamT& stream, ByteT const* data,
+                            std::size_t length)
+{
+    stream.write(data, length);
+} || SpanSink<StreamT, ByteT>;
+
+/**
+ * @brief Concept for a source that can read into multiple spans at once.
+ *
+ * @details A type is a scatter source if `readv(parts)` accepts a span of
+ *          writable `std::span<ByteT>`s, fills them in order and returns the
+ *          amount of bytes read, like `readv`.
+ *
+ * @tparam StreamT  The source type to test.
+ * @tparam ByteT    The byte type of the source.
+ */
+template<typename StreamT, typename ByteT>
+concept ScatterSource = requires(StreamT& stream,
+                                 std::span<std::span<ByteT> const> parts)
+{
+    { stream.readv(parts) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief Concept for a sink that can write multiple spans at once.
+ *
+ * @details A type is a gather sink if `writev(parts)` accepts a span of
+ *          `std::span<ByteT const>`s and writes them in order, like `writev`.
+ *
+ * @tparam StreamT  The sink type to test.
+ * @tparam ByteT    The byte type of the sink.
+ */
+template<typename StreamT, typename ByteT>
+concept GatherSink = requires(StreamT& stream,
+                              std::span<std::span<ByteT const> const> parts)
+{
+    stream.writev(parts);
+};
+
+/**
+ * @brief Concept for a source that can read at an offset.
+ *
+ * @details A type is a positional source if `readAt(data, length, offset)`
+ *          can be called on a const instance, returning the amount of bytes
+ *          read. It must not use or move the read position, and must be safe
+ *          to call from multiple threads at once, like `pread`.
+ *
+ * @tparam StreamT  The source type to test.
+ * @tparam ByteT    The byte type of the source.
+ */
+template<typename StreamT, typename ByteT>
+concept PositionalSource = requires(StreamT const& stream, ByteT* data,
+                                    std::size_t length)
+{
+    { stream.readAt(data, length, length) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief Concept for a source with a movable read position.
+ *
+ * @details A type is a seekable source if it has `tellg()` and
+ *          `seekg(offset, direction)`, like `std::basic_istream`.
+ *
+ * @tparam StreamT  The source type to test.
+ */
+template<typename StreamT>
+concept SeekableSource = requires(StreamT& stream, std::streamoff offset)
+{
+    stream.tellg();
+    stream.seekg(offset, std::ios::beg);
+};
+
+/**
+ * @brief Concept for a sink with a movable write position.
+ *
+ * @details A type is a seekable sink if it has `tellp()` and
+ *          `seekp(offset, direction)`, like `std::basic_ostream`.
+ *
+ * @tparam StreamT  The sink type to test.
  */
-template<template<typename, typename...> typename StreamT,
-         typename ByteT, typename... Ts>
-concept OutputStream = requires(StreamT<ByteT, Ts...> stream, ByteT* data)
+template<typename StreamT>
+concept SeekableSink = requires(StreamT& stream, std::streamoff offset)
 {
-    stream.write(data, std::declval<std::size_t>());
+    stream.tellp();
+    stream.seekp(offset, std::ios::beg);
 };
 
+/**
+ * @brief Concept for an input stream type.
+ *
+ * @details A type is an input stream if it is a seekable
+ *          @ref scppl::ByteSource, like `std::basic_istream`.
+ *
+ * @tparam StreamT  The stream type to test.
+ * @tparam ByteT    The byte type of the stream.
+ */
+template<typename StreamT, typename ByteT>
+concept InputStream = ByteSource<StreamT, ByteT> && SeekableSource<StreamT>;
+
+/**
+ * @brief Concept for an output stream type.
+ *
+ * @details A type is an output stream if it is a seekable
+ *          @ref scppl::ByteSink, like `std::basic_ostream`.
+ *
+ * @tparam StreamT  The stream type to test.
+ * @tparam ByteT    The byte type of the stream.
+ */
+template<typename StreamT, typename ByteT>
+concept OutputStream = ByteSink<StreamT, ByteT> && SeekableSink<StreamT>;
+
 /**
  * @brief Concept for an input/output stream type.
  *
@@ -94,13 +238,29 @@ concept OutputStream = requires(StreamT<ByteT, Ts...> stream, ByteT* data)
  *          `OutputStream`.
  *
  * @tparam StreamT  The stream type to test.
- * @tparam ByteT    The underlying type of the stream.
- * @tparam Ts       Other stream parameters.
+ * @tparam ByteT    The byte type of the stream.
  */
-template<template<typename, typename...> typename StreamT,
-         typename ByteT, typename... Ts>
-concept InputOutputStream = InputStream<StreamT, ByteT, Ts...>
-                            && OutputStream<StreamT, ByteT, Ts...>;
+template<typename StreamT, typename ByteT>
+concept InputOutputStream = InputStream<StreamT, ByteT>
+                            && OutputStream<StreamT, ByteT>;
+
+/**
+ * @brief Concept for a checksum calculated over bytes passed in parts.
+ *
+ * @details A type is a checksum accumulator if `update(data)` adds a
+ *          `std::span<ByteT const>` to it and `value()` returns the checksum
+ *          of the bytes so far, like @ref scppl::Crc32c.
+ *
+ * @tparam ChecksumT  The accumulator type to test.
+ * @tparam ByteT      The byte type of the data.
+ */
+template<typename ChecksumT, typename ByteT>
+concept ChecksumAccumulator = requires(ChecksumT& checksum,
+                                       std::span<ByteT const> data)
+{
+    checksum.update(data);
+    checksum.value();
+};
 
 }
 
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_COPYRANGE_HPP_
+#define SCPPL_BINARY_COPYRANGE_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <vector>
+
+#include "scppl/binary/BinaryStream.hpp"
+
+namespace scppl {
+
+/// The size of the buffer used by `copyRange` when copying in user space.
+constexpr std::size_t copyBufferSize = std::size_t{1} << 20;
+
+/**
+ * @brief Copy bytes from the read position of one stream to the write position
+ *        of another.
+ *
+ * @details If the stream of `destination` has a `copyFrom(source, length)`
+ *          function accepting the stream of `source`, like
+ *          @ref scppl::FileStream, the copy is done by that function. For
+ *          files this uses `copy_file_range` or `sendfile`, so the bytes never
+ *          enter user space. Otherwise the bytes are copied through a buffer
+ *          of at most @ref scppl::copyBufferSize bytes.
+ *
+ *          Both streams must have the same byte type, their endian does not
+ *          matter since the bytes are copied as they are.
+ *
+ * @code{.cpp}
+ * auto [type, size] = input.read<uint32_t, uint64_t>();
+ * output.write(type, size);
+ * scppl::copyRange(input, output, size);
+ * @endcode
+ *
+ * @param source       The stream to copy from, must be an input stream.
+ * @param destination  The stream to copy to, must be an output stream.
+ * @param length       The amount of bytes to copy.
+ *
+ * @return The amount of bytes copied, less than `length` at the end of
+ *         `source`.
+ */
+template<std::endian tSourceEndian, bool tSourceSynchronized,
+         typename SourceT, std::endian tDestinationEndian,
+         bool tDestinationSynchronized, typename DestinationT, typename ByteT>
+requires(BinaryStream<tSourceEndian, tSourceSynchronized, SourceT,
+                      ByteT>::isInputStream &&
+         BinaryStream<tDestinationEndian, tDestinationSynchronized,
+                      DestinationT, ByteT>::isOutputStream)
+auto copyRange(BinaryStream<tSourceEndian, tSourceSynchronized, SourceT,
+                            ByteT>& source,
+               BinaryStream<tDestinationEndian, tDestinationSynchronized,
+                            DestinationT, ByteT>& destination,
+               std::size_t length)
+    -> std::size_t
+{
+    if constexpr(requires(SourceT& input, DestinationT& output) {
+                     output.copyFrom(input, length);
+                 })
+    {
+        std::size_t done = destination.stream().copyFrom(source.stream(),
+                                                         length);
+
+        source.synchronizeOutputToInput();
+        destination.synchronizeInputToOutput();
+
+        return done;
+    }
+    else
+    {
+        std::vector<ByteT> buffer(std::min(length, copyBufferSize));
+
+        std::size_t done = 0;
+        while (done < length)
+        {
+            auto part = std::span<ByteT>(buffer).first(
+                std::min(std::ranges::size(buffer), length - done));
+
+            std::size_t count = source.readScatter(part);
+            destination.writeRaw(part.first(count));
+
+            done += count;
+            if (count < std::ranges::size(part))
+                break;
+        }
+
+        return done;
+    }
+}
+
+}
+
+#endif
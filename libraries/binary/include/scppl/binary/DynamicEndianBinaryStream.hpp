@@ -0,0 +1,288 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_DYNAMICENDIANBINARYSTREAM_HPP_
+#define SCPPL_BINARY_DYNAMICENDIANBINARYSTREAM_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+/**
+ * @brief A `BinaryStream` with an endian chosen at runtime.
+ *
+ * @details For formats that declare their byte order in a header, like TIFF
+ *          or ELF. The endian is checked once per call, after which the same
+ *          code as a @ref scppl::BinaryStream of that endian runs, so
+ *          `read<Ts...>()` checks it once for all types and `readArray()` once
+ *          for the whole array.
+ *
+ *          All functions of @ref scppl::BinaryStream are available, except
+ *          `records()`.
+ *
+ * @code{.cpp}
+ * scppl::DynamicEndianBinaryStream<> stream(file);
+ * stream.setEndian(stream.readRaw(2)[0] == 'M' ? std::endian::big
+ *                                              : std::endian::little);
+ * auto [magic, offset] = stream.read<uint16_t, uint32_t>();
+ * @endcode
+ *
+ * @tparam tSynchronized  Keep the read and write positions synchronized.
+ *                        [`true`]
+ * @tparam StreamT        The type of the stream. [`std::iostream`]
+ * @tparam ByteT          The byte type of the stream.
+ *                        [`scppl::StreamByteT<StreamT>`]
+ */
+template<bool tSynchronized = true, typename StreamT = std::iostream,
+         typename ByteT = StreamByteT<StreamT>>
+class DynamicEndianBinaryStream :
+    private BinaryStream<std::endian::native, tSynchronized, StreamT, ByteT>
+{
+    using Base = BinaryStream<std::endian::native, tSynchronized, StreamT,
+                              ByteT>;
+
+public:
+    using typename Base::Stream;
+    using typename Base::Byte;
+    using Base::synchronized;
+    using Base::isInputStream;
+    using Base::isOutputStream;
+    using Base::isInputOutputStream;
+    using Base::isSeekableInput;
+    using Base::isSeekableOutput;
+    using Base::isPositionalInput;
+    using Base::defaultMaxFrameLength;
+    using Base::defaultMaxUntilLength;
+
+    /**
+     * @brief The `DynamicEndianBinaryStream` constructor.
+     *
+     * @param stream  A reference to a stream type, like `std::stringstream` or
+     *                `std::fstream`.
+     * @param endian  The initial endian of the data. [`std::endian::native`]
+     *
+     * @throws std::invalid_argument  `endian` is not big or little endian.
+     */
+    explicit DynamicEndianBinaryStream(
+        Stream& stream, std::endian endian = std::endian::native) :
+        Base(stream)
+    {
+        setEndian(endian);
+    }
+
+    /// The current endian of the data.
+    auto endian() const -> std::endian { return mEndian; }
+
+    /**
+     * @brief Change the endian of the data, for all following calls.
+     *
+     * @param endian  The new endian.
+     *
+     * @throws std::invalid_argument  `endian` is not big or little endian.
+     */
+    void setEndian(std::endian endian)
+    {
+        if (endian != std::endian::big && endian != std::endian::little)
+            throw std::invalid_argument("Endian must be big or little");
+
+        mEndian = endian;
+    }
+
+    using Base::stream;
+    using Base::tellInput;
+    using Base::tellOutput;
+    using Base::tell;
+    using Base::eof;
+    using Base::seekInput;
+    using Base::seekOutput;
+    using Base::seek;
+    using Base::toBegin;
+    using Base::toEnd;
+    using Base::synchronizeInputToOutput;
+    using Base::synchronizeOutputToInput;
+
+    using Base::readRaw;
+    using Base::peekRaw;
+    using Base::skip;
+    using Base::skipRaw;
+    using Base::readScatter;
+    using Base::readRawAt;
+    using Base::readString;
+    using Base::readUntil;
+    using Base::readCString;
+
+    using Base::writeRaw;
+    using Base::writeGather;
+    using Base::writeString;
+
+    /// @copydoc scppl::BinaryStream::read()
+    template<Unpackable... Ts>
+    auto read()
+        -> std::tuple<Ts...>
+    requires(isInputStream)
+    {
+        auto data = Base::template readFixed<lengthOf<Ts...>()>();
+
+        return dispatch([&]<typename BinaryU>() {
+            return BinaryU::template unpack<Ts...>(data);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::readSingle()
+    template<Unpackable T>
+    auto readSingle()
+        -> T
+    requires(isInputStream)
+    {
+        // Swapping a native read is cheaper than branching between unpacks
+        if constexpr(std::is_scalar_v<T>)
+        {
+            T value = Base::template readSingle<T>();
+
+            return (mEndian == std::endian::native) ? value : byteSwap(value);
+        }
+        else
+        {
+            auto data = Base::template readFixed<lengthOf<T>()>();
+
+            return dispatch([&]<typename BinaryU>() {
+                return BinaryU::template fromBytes<T>(data);
+            });
+        }
+    }
+
+    /// @copydoc scppl::BinaryStream::peek()
+    template<Unpackable... Ts>
+    auto peek()
+        -> std::tuple<Ts...>
+    requires(isInputStream)
+    {
+        return dispatch([&, this]<typename BinaryU>() {
+            return Base::template peekWith<BinaryU, Ts...>();
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::peekSingle()
+    template<Unpackable T>
+    auto peekSingle()
+        -> T
+    requires(isInputStream)
+    {
+        return std::get<0>(peek<T>());
+    }
+
+    /// @copydoc scppl::BinaryStream::readArray(std::span<T>)
+    template<Unpackable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    auto readArray(std::span<T> values)
+        -> std::size_t
+    requires(isInputStream)
+    {
+        return dispatch([&, this]<typename BinaryU>() {
+            return Base::template readArrayWith<BinaryU>(values);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::readArray(std::size_t)
+    template<Unpackable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    auto readArray(std::size_t count)
+        -> std::vector<T>
+    requires(isInputStream)
+    {
+        std::vector<T> values(count);
+        values.resize(readArray<T>(std::span<T>(values)));
+
+        return values;
+    }
+
+    /// @copydoc scppl::BinaryStream::readAt()
+    template<Unpackable... Ts>
+    auto readAt(std::size_t offset) const
+        -> std::tuple<Ts...>
+    requires(isPositionalInput)
+    {
+        return dispatch([&, this]<typename BinaryU>() {
+            return Base::template readAtWith<BinaryU, Ts...>(offset);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::readFrame()
+    template<FramePrefix tPrefix = FramePrefix::U32>
+    auto readFrame(std::size_t maxLength = defaultMaxFrameLength)
+        -> std::span<Byte const>
+    requires(isInputStream)
+    {
+        return dispatch([&, this]<typename BinaryU>() {
+            return Base::template readFrameWith<BinaryU, tPrefix>(maxLength);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::write()
+    template<Packable... Ts>
+    void write(Ts... types)
+    requires(isOutputStream)
+    {
+        dispatch([&, this]<typename BinaryU>() {
+            Base::template writeWith<BinaryU>(types...);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::writeArray()
+    template<Packable T>
+    requires(std::is_trivially_copyable_v<T> && sizeof(Byte) == 1)
+    void writeArray(std::span<T const> values)
+    requires(isOutputStream)
+    {
+        dispatch([&, this]<typename BinaryU>() {
+            Base::template writeArrayWith<BinaryU>(values);
+        });
+    }
+
+    /// @copydoc scppl::BinaryStream::writeFrame()
+    template<FramePrefix tPrefix = FramePrefix::U32>
+    void writeFrame(std::span<Byte const> payload)
+    requires(isOutputStream)
+    {
+        dispatch([&, this]<typename BinaryU>() {
+            Base::template writeFrameWith<BinaryU, tPrefix>(payload);
+        });
+    }
+
+private:
+    /// The current endian of the data, big or little.
+    std::endian mEndian{std::endian::native};
+
+    /// Call `function` with the `Binary` of the current endian as template
+    /// argument.
+    template<typename Function>
+    auto dispatch(Function&& function) const
+        -> decltype(auto)
+    {
+        using Big = Binary<std::endian::big, Byte>;
+        using Little = Binary<std::endian::little, Byte>;
+
+        if (mEndian == std::endian::big)
+            return function.template operator()<Big>();
+
+        return function.template operator()<Little>();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,1008 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_FILESTREAM_HPP_
+#define SCPPL_BINARY_FILESTREAM_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+#include "scppl/binary/BinaryStream.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+/// When a `FileStream` should call `fdatasync`.
+enum class FileSync
+{
+    /// Never synchronize, leave it to the operating system.
+    Never,
+
+    /// Synchronize after every flush of the buffer.
+    OnFlush,
+
+    /// Synchronize once when the file is closed.
+    OnClose
+};
+
+/// Options for opening a `FileStream`.
+struct FileStreamOptions
+{
+    /// The size of the buffer in bytes, rounded up to `alignment`.
+    std::size_t bufferSize = std::size_t{1} << 20;
+
+    /// The alignment of the buffer and of buffer refills, a power of two.
+    std::size_t alignment = 4096;
+
+    /// Open the file with `O_DIRECT`, bypassing the page cache.
+    bool direct = false;
+
+    /// When to call `fdatasync`.
+    FileSync sync = FileSync::Never;
+};
+
+/**
+ * @brief A buffered file stream on top of a POSIX file descriptor.
+ *
+ * @details All reads and writes go through a single aligned buffer and are
+ *          done with `pread` and `pwrite` at the current position, so there is
+ *          no locale, sentry or virtual dispatch involved. Reads and writes
+ *          larger than the buffer bypass it, unless `O_DIRECT` is used.
+ *
+ *          The interface mirrors the parts of `std::basic_fstream` used by
+ *          @ref scppl::BinaryStream, with a single position for reading and
+ *          writing. It is also a @ref scppl::SpanSource, so records can be
+ *          decoded straight from the buffer, and a @ref scppl::ScatterSource
+ *          and @ref scppl::GatherSink using `preadv` and `pwritev`.
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size. [`char`]
+ */
+template<typename ByteT = char>
+class FileStream
+{
+    static_assert(sizeof(ByteT) == 1, "`ByteT` must be one byte in size");
+
+public:
+    /// The byte type of this `FileStream` instance.
+    using Byte = ByteT;
+
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = std::filesystem::path;
+
+    /**
+     * @brief The `FileStream` constructor.
+     *
+     * @details The open modes are interpreted like `std::basic_fstream` does,
+     *          except that `std::ios::app` creates the file and starts at the
+     *          end without forcing every write to the end.
+     *
+     * @param path     The path of the file to open.
+     * @param mode     The mode to open the file with.
+     *                 [`std::ios::in | std::ios::out`]
+     * @param options  The buffer and synchronization options. [`{}`]
+     *
+     * @throws std::invalid_argument  The alignment is not a power of two.
+     * @throws std::system_error      The file could not be opened.
+     */
+    explicit FileStream(Path const& path,
+                        std::ios::openmode mode = std::ios::in | std::ios::out,
+                        FileStreamOptions options = {}) :
+        mOptions(options)
+    {
+        if (!std::has_single_bit(mOptions.alignment))
+            throw std::invalid_argument("Alignment must be a power of two");
+
+        mCapacity = bufferCapacity();
+        mBuffer.reset(static_cast<Byte*>(
+            std::aligned_alloc(mOptions.alignment, mCapacity)));
+        if (!mBuffer)
+            throw std::bad_alloc();
+
+        mDescriptor = ::open(path.c_str(), toFlags(mode), 0666);
+        if (mDescriptor < 0)
+            throwError("Unable to open file");
+
+        if ((mode & (std::ios::ate | std::ios::app)) != 0)
+            mPosition = size();
+    }
+
+    FileStream(FileStream const&) = delete;
+
+    /// Move constructor.
+    FileStream(FileStream&& other) noexcept :
+        mDescriptor(std::exchange(other.mDescriptor, -1)),
+        mOptions(other.mOptions),
+        mBuffer(std::move(other.mBuffer)),
+        mCapacity(std::exchange(other.mCapacity, 0)),
+        mMode(std::exchange(other.mMode, Mode::None)),
+        mBufferOffset(other.mBufferOffset),
+        mBufferLength(std::exchange(other.mBufferLength, 0)),
+        mPosition(other.mPosition),
+        mEof(other.mEof)
+    {
+        //
+    }
+
+    /// Flushes the buffer and closes the file.
+    ~FileStream() noexcept
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `close()` for that
+        }
+    }
+
+    auto operator=(FileStream const&) -> FileStream& = delete;
+
+    /// Move assignment operator.
+    auto operator=(FileStream&& other) noexcept -> FileStream&
+    {
+        if (this != &other)
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+                // Same as the destructor, use `close()` to handle errors
+            }
+
+            mDescriptor = std::exchange(other.mDescriptor, -1);
+            mOptions = other.mOptions;
+            mBuffer = std::move(other.mBuffer);
+            mCapacity = std::exchange(other.mCapacity, 0);
+            mMode = std::exchange(other.mMode, Mode::None);
+            mBufferOffset = other.mBufferOffset;
+            mBufferLength = std::exchange(other.mBufferLength, 0);
+            mPosition = other.mPosition;
+            mEof = other.mEof;
+        }
+
+        return *this;
+    }
+
+    /// Whether this stream has an open file.
+    auto is_open() const -> bool { return mDescriptor >= 0; }
+
+    /// The underlying file descriptor.
+    auto handle() const -> int { return mDescriptor; }
+
+    /**
+     * @brief Flush the buffer and close the file.
+     *
+     * @throws std::system_error  Flushing, synchronizing or closing failed.
+     */
+    void close()
+    {
+        if (!is_open())
+            return;
+
+        flush();
+        if (mOptions.sync == FileSync::OnClose)
+            sync();
+
+        int descriptor = std::exchange(mDescriptor, -1);
+        if (::close(descriptor) != 0)
+            throwError("Unable to close file");
+    }
+
+    /**
+     * @brief Read bytes from the current position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @throws std::system_error  Reading failed.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        if (mMode == Mode::Writing)
+            flush();
+
+        std::size_t done = 0;
+        while (done < length)
+        {
+            if (std::size_t available = buffered(); available > 0)
+            {
+                std::size_t count = std::min(available, length - done);
+                std::memcpy(data + done,
+                            mBuffer.get() + (mPosition - mBufferOffset), count);
+
+                done += count;
+                mPosition += count;
+                continue;
+            }
+
+            if (!mOptions.direct && length - done >= mCapacity)
+            {
+                std::size_t count = readAll(data + done, length - done,
+                                            mPosition);
+                done += count;
+                mPosition += count;
+                break;
+            }
+
+            if (!refill())
+                break;
+        }
+
+        mEof = (done < length);
+
+        return done;
+    }
+
+    /**
+     * @brief Get the buffered bytes from the current position without
+     *        consuming them.
+     *
+     * @details The buffer is refilled when it holds less than `length` bytes,
+     *          and grown when `length` does not fit in it. It shrinks back to
+     *          `bufferSize` on the next refill.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws std::system_error  Reading failed.
+     *
+     * @return All buffered bytes, less than `length` at the end.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    {
+        if (mMode == Mode::Writing)
+            flush();
+
+        if (buffered() < length)
+            refill(length);
+
+        mEof = (buffered() < length);
+
+        return {mBuffer.get() + (mPosition - mBufferOffset), buffered()};
+    }
+
+    /**
+     * @brief Consume bytes from the current position.
+     *
+     * @param length  The amount of bytes to consume, at most the size of the
+     *                last `acquire()`.
+     */
+    void commit(std::size_t length)
+    {
+        mPosition += length;
+    }
+
+    /**
+     * @brief Read bytes from the current position into multiple spans.
+     *
+     * @details Small reads go through the buffer. Larger reads take what is
+     *          buffered first and read the rest with `preadv`, straight into
+     *          the spans.
+     *
+     * @param parts  The spans to fill, in order.
+     *
+     * @throws std::system_error  Reading failed.
+     *
+     * @return The amount of bytes read, less than the total size at the end.
+     */
+    auto readv(std::span<std::span<Byte> const> parts)
+        -> std::size_t
+    {
+        std::size_t total = totalSize(parts);
+        if (mOptions.direct || total < mCapacity)
+        {
+            std::size_t done = 0;
+            for (std::span<Byte> part : parts)
+            {
+                std::size_t count = read(std::ranges::data(part),
+                                         std::ranges::size(part));
+                done += count;
+                if (count < std::ranges::size(part))
+                    break;
+            }
+
+            return done;
+        }
+
+        if (mMode == Mode::Writing)
+            flush();
+
+        std::size_t done = 0;
+        std::vector<::iovec> vectors{};
+        vectors.reserve(std::ranges::size(parts));
+        for (std::span<Byte> part : parts)
+        {
+            std::size_t count = std::min(buffered(), std::ranges::size(part));
+            std::memcpy(std::ranges::data(part),
+                        mBuffer.get() + (mPosition - mBufferOffset), count);
+            mPosition += count;
+            done += count;
+
+            if (count < std::ranges::size(part))
+            {
+                vectors.push_back({std::ranges::data(part) + count,
+                                   std::ranges::size(part) - count});
+            }
+        }
+
+        std::size_t count = transferAll<false>(vectors, mPosition);
+        mPosition += count;
+        done += count;
+
+        mEof = (done < total);
+
+        return done;
+    }
+
+    /**
+     * @brief Write multiple spans at the current position.
+     *
+     * @details Small writes go through the buffer. Larger writes flush the
+     *          buffer and are written with `pwritev`, straight from the spans.
+     *
+     * @param parts  The spans to write, in order.
+     *
+     * @throws std::system_error  Writing failed.
+     */
+    void writev(std::span<std::span<Byte const> const> parts)
+    {
+        std::size_t total = totalSize(parts);
+        if (mOptions.direct || total < mCapacity)
+        {
+            for (std::span<Byte const> part : parts)
+                write(std::ranges::data(part), std::ranges::size(part));
+
+            return;
+        }
+
+        flush();
+        mMode = Mode::None;
+        mBufferLength = 0;
+
+        std::vector<::iovec> vectors{};
+        vectors.reserve(std::ranges::size(parts));
+        for (std::span<Byte const> part : parts)
+        {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+            vectors.push_back({const_cast<Byte*>(std::ranges::data(part)),
+                               std::ranges::size(part)});
+        }
+
+        transferAll<true>(vectors, mPosition);
+        mPosition += total;
+    }
+
+    /**
+     * @brief Read bytes at an offset, without using the position or buffer.
+     *
+     * @details This is a single `pread` (or a few, for interrupted or partial
+     *          reads), so it is safe to call from multiple threads at once.
+     *          Writes that are still in the buffer are not visible, call
+     *          `flush()` before sharing the stream between threads.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     * @param offset  The offset in the file to read from.
+     *
+     * @throws std::system_error  Reading failed.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto readAt(Byte* data, std::size_t length, std::size_t offset) const
+        -> std::size_t
+    {
+        if (!mOptions.direct)
+            return readAll(data, length, offset);
+
+        // `O_DIRECT` needs an aligned buffer, offset and length
+        std::size_t begin = offset & ~(mOptions.alignment - 1);
+        std::size_t size = alignUp(offset + length) - begin;
+        std::unique_ptr<Byte[], Free> buffer(static_cast<Byte*>(
+            std::aligned_alloc(mOptions.alignment, size)));
+        if (!buffer)
+            throw std::bad_alloc();
+
+        std::size_t count = readAll(buffer.get(), size, begin);
+        if (count <= offset - begin)
+            return 0;
+
+        count = std::min(count - (offset - begin), length);
+        std::memcpy(data, buffer.get() + (offset - begin), count);
+
+        return count;
+    }
+
+    /**
+     * @brief Write bytes at the current position.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     *
+     * @throws std::system_error  Writing failed.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        if (mMode == Mode::Writing &&
+            mPosition != mBufferOffset + mBufferLength)
+        {
+            flush();
+        }
+
+        if (mMode != Mode::Writing)
+        {
+            resize(bufferCapacity());
+
+            mMode = Mode::Writing;
+            mBufferOffset = mPosition;
+            mBufferLength = 0;
+        }
+
+        if (!mOptions.direct && length >= mCapacity)
+        {
+            flush();
+            writeAll(data, length, mPosition);
+            mPosition += length;
+
+            return;
+        }
+
+        while (length > 0)
+        {
+            std::size_t count = std::min(mCapacity - mBufferLength, length);
+            std::memcpy(mBuffer.get() + mBufferLength, data, count);
+
+            mBufferLength += count;
+            mPosition += count;
+            data += count;
+            length -= count;
+
+            if (mBufferLength == mCapacity)
+            {
+                flush();
+
+                mMode = Mode::Writing;
+                mBufferOffset = mPosition;
+            }
+        }
+    }
+
+    /**
+     * @brief Write the buffered bytes to the file.
+     *
+     * @details If `sync` is `FileSync::OnFlush`, then this also calls
+     *          `fdatasync`.
+     *
+     * @throws std::system_error  Writing or synchronizing failed.
+     */
+    void flush()
+    {
+        if (mMode != Mode::Writing)
+            return;
+
+        std::size_t length = std::exchange(mBufferLength, 0);
+        mMode = Mode::None;
+
+        if (length == 0)
+            return;
+
+        writeBuffer(length);
+
+        if (mOptions.sync == FileSync::OnFlush)
+            sync();
+    }
+
+    /**
+     * @brief Flush the buffer and drop the bytes read ahead, so the next read
+     *        sees writes made through the file descriptor.
+     *
+     * @throws std::system_error  Writing or synchronizing failed.
+     */
+    void discard()
+    {
+        flush();
+
+        mMode = Mode::None;
+        mBufferLength = 0;
+    }
+
+    /**
+     * @brief Flush the buffer and wait for the data to reach the disk.
+     *
+     * @throws std::system_error  Writing or synchronizing failed.
+     */
+    void sync()
+    {
+        flush();
+
+        if (::fdatasync(mDescriptor) != 0)
+            throwError("Unable to synchronize file");
+    }
+
+    /// Get the read position.
+    auto tellg() const -> std::size_t { return mPosition; }
+
+    /// Get the write position, which is the same as the read position.
+    auto tellp() const -> std::size_t { return mPosition; }
+
+    /**
+     * @brief Move the read position, which also moves the write position.
+     *
+     * @details Like `std::basic_istream::seekg`, this clears the end of file
+     *          state.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        seek(offset, direction);
+        mEof = false;
+    }
+
+    /**
+     * @brief Move the write position, which also moves the read position.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekp(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        seek(offset, direction);
+    }
+
+    /// Whether the last read reached the end of the file.
+    auto eof() const -> bool { return mEof; }
+
+    /// The size of the buffer in bytes.
+    auto capacity() const -> std::size_t { return mCapacity; }
+
+    /**
+     * @brief Copy bytes from the position of another file to the position of
+     *        this file, without copying them through user space.
+     *
+     * @details The pending writes of both streams are flushed first. On Linux
+     *          this uses `copy_file_range`, falling back to `sendfile` when the
+     *          files are on different file systems or the kernel is too old.
+     *          Otherwise, or when both fail, the bytes are copied with `pread`
+     *          and `pwrite` through the buffer of this stream. Both positions
+     *          are moved past the copied bytes.
+     *
+     * @param source  The file to copy from.
+     * @param length  The amount of bytes to copy.
+     *
+     * @throws std::system_error  Copying failed.
+     *
+     * @return The amount of bytes copied, less than `length` at the end of
+     *         `source`.
+     */
+    auto copyFrom(FileStream& source, std::size_t length)
+        -> std::size_t
+    {
+        source.flush();
+        flush();
+
+        // The buffer might hold old contents of the range that is written
+        mMode = Mode::None;
+        mBufferLength = 0;
+
+        std::size_t done = 0;
+#ifdef __linux__
+        auto input = static_cast<::loff_t>(source.mPosition);
+        auto output = static_cast<::loff_t>(mPosition);
+        bool supported = true;
+        while (done < length && supported)
+        {
+            ::ssize_t count = ::copy_file_range(source.mDescriptor, &input,
+                                                mDescriptor, &output,
+                                                length - done, 0);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0 && !isUnsupported(errno))
+                throwError("Unable to copy file");
+            if (count <= 0)
+            {
+                supported = (count == 0);
+                break;
+            }
+
+            done += static_cast<std::size_t>(count);
+        }
+
+        if (!supported &&
+            ::lseek(mDescriptor, static_cast<::off_t>(output), SEEK_SET) >= 0)
+        {
+            auto offset = static_cast<::off_t>(input);
+            supported = true;
+            while (done < length && supported)
+            {
+                ::ssize_t count = ::sendfile(mDescriptor, source.mDescriptor,
+                                             &offset, length - done);
+                if (count < 0 && errno == EINTR)
+                    continue;
+                if (count < 0 && !isUnsupported(errno))
+                    throwError("Unable to copy file");
+                if (count <= 0)
+                {
+                    supported = (count == 0);
+                    break;
+                }
+
+                done += static_cast<std::size_t>(count);
+            }
+        }
+
+        if (supported)
+        {
+            source.mPosition += done;
+            mPosition += done;
+            source.mEof = (done < length);
+
+            return done;
+        }
+#endif
+
+        while (done < length)
+        {
+            std::size_t wanted = std::min(mCapacity, length - done);
+            std::size_t count = readAll(mBuffer.get(), wanted,
+                                        source.mPosition + done);
+            writeAll(mBuffer.get(), count, mPosition + done);
+
+            done += count;
+            if (count < wanted)
+                break;
+        }
+
+        source.mPosition += done;
+        mPosition += done;
+        source.mEof = (done < length);
+
+        return done;
+    }
+
+    /**
+     * @brief Get the size of the file, including buffered writes.
+     *
+     * @throws std::system_error  Getting the file status failed.
+     *
+     * @return The size of the file in bytes.
+     */
+    auto size() const
+        -> std::size_t
+    {
+        struct ::stat status{};
+        if (::fstat(mDescriptor, &status) != 0)
+            throwError("Unable to get file status");
+
+        auto fileSize = static_cast<std::size_t>(status.st_size);
+        if (mMode == Mode::Writing)
+            fileSize = std::max(fileSize, mBufferOffset + mBufferLength);
+
+        return fileSize;
+    }
+
+private:
+    enum class Mode
+    {
+        None,
+        Reading,
+        Writing
+    };
+
+    struct Free
+    {
+        void operator()(Byte* pointer) const { std::free(pointer); }
+    };
+
+    int mDescriptor{-1};
+    FileStreamOptions mOptions{};
+
+    std::unique_ptr<Byte[], Free> mBuffer{};
+    std::size_t mCapacity{};
+
+    Mode mMode{Mode::None};
+    std::size_t mBufferOffset{};
+    std::size_t mBufferLength{};
+
+    std::size_t mPosition{};
+    bool mEof{};
+
+    [[noreturn]] static void throwError(char const* message)
+    {
+        throw std::system_error(errno, std::generic_category(), message);
+    }
+
+    /// Whether `error` means a copy system call can not be used here.
+    static auto isUnsupported(int error)
+        -> bool
+    {
+        return error == EXDEV || error == EINVAL || error == ENOSYS ||
+               error == EOPNOTSUPP || error == EBADF;
+    }
+
+    auto toFlags(std::ios::openmode mode) const
+        -> int
+    {
+        bool in = (mode & std::ios::in) != 0;
+        bool out = (mode & (std::ios::out | std::ios::app)) != 0;
+
+        int flags = O_CLOEXEC;
+        if (in && out)
+            flags |= O_RDWR;
+        else if (out)
+            flags |= O_WRONLY;
+        else
+            flags |= O_RDONLY;
+
+        if (out && (!in || (mode & (std::ios::trunc | std::ios::app)) != 0))
+            flags |= O_CREAT;
+
+        if (out && ((mode & std::ios::trunc) != 0 ||
+                    (!in && (mode & std::ios::app) == 0)))
+        {
+            flags |= O_TRUNC;
+        }
+
+        if (mOptions.direct)
+        {
+#ifdef O_DIRECT
+            flags |= O_DIRECT;
+#else
+            throw std::invalid_argument("O_DIRECT is not supported");
+#endif
+        }
+
+        return flags;
+    }
+
+    auto alignUp(std::size_t value) const
+        -> std::size_t
+    {
+        return (value + mOptions.alignment - 1) & ~(mOptions.alignment - 1);
+    }
+
+    /// The amount of buffered bytes available for reading at the position.
+    auto buffered() const
+        -> std::size_t
+    {
+        if (mMode != Mode::Reading || mPosition < mBufferOffset ||
+            mPosition >= mBufferOffset + mBufferLength)
+        {
+            return 0;
+        }
+
+        return mBufferOffset + mBufferLength - mPosition;
+    }
+
+    /**
+     * Fill the buffer from the aligned block containing the position, with
+     * room for at least `length` bytes from the position. A buffer grown for
+     * an earlier, larger `length` is shrunk back to `bufferSize`.
+     */
+    auto refill(std::size_t length = 0)
+        -> bool
+    {
+        resize(std::max(alignUp((mPosition & (mOptions.alignment - 1)) +
+                                length),
+                        bufferCapacity()));
+
+        mMode = Mode::Reading;
+        mBufferOffset = mPosition & ~(mOptions.alignment - 1);
+        mBufferLength = readAll(mBuffer.get(), mCapacity, mBufferOffset);
+
+        return buffered() > 0;
+    }
+
+    /// The size of the buffer from the options, aligned.
+    auto bufferCapacity() const
+        -> std::size_t
+    {
+        return alignUp(std::max<std::size_t>(mOptions.bufferSize, 1));
+    }
+
+    /// Replace the buffer when it is not `capacity` bytes.
+    void resize(std::size_t capacity)
+    {
+        if (capacity != mCapacity)
+            reallocate(capacity);
+    }
+
+    /// Replace the buffer with an empty one of `capacity` bytes.
+    void reallocate(std::size_t capacity)
+    {
+        std::unique_ptr<Byte[], Free> buffer(static_cast<Byte*>(
+            std::aligned_alloc(mOptions.alignment, capacity)));
+        if (!buffer)
+            throw std::bad_alloc();
+
+        mBuffer = std::move(buffer);
+        mCapacity = capacity;
+        mMode = Mode::None;
+        mBufferLength = 0;
+    }
+
+    auto readAll(Byte* data, std::size_t length, std::size_t offset) const
+        -> std::size_t
+    {
+        std::size_t done = 0;
+        while (done < length)
+        {
+            ::ssize_t count = ::pread(mDescriptor, data + done, length - done,
+                                      static_cast<::off_t>(offset + done));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                throwError("Unable to read file");
+            if (count == 0)
+                break;
+
+            done += static_cast<std::size_t>(count);
+        }
+
+        return done;
+    }
+
+    void writeAll(Byte const* data, std::size_t length,
+                  std::size_t offset) const
+    {
+        std::size_t done = 0;
+        while (done < length)
+        {
+            ::ssize_t count = ::pwrite(mDescriptor, data + done, length - done,
+                                       static_cast<::off_t>(offset + done));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                throwError("Unable to write file");
+
+            done += static_cast<std::size_t>(count);
+        }
+    }
+
+    template<typename PartT>
+    static auto totalSize(std::span<PartT const> parts)
+        -> std::size_t
+    {
+        std::size_t total = 0;
+        for (PartT const& part : parts)
+            total += std::ranges::size(part);
+
+        return total;
+    }
+
+    /// Read or write all `vectors` at `offset`, returns the amount done.
+    template<bool tWrite>
+    auto transferAll(std::span<::iovec> vectors, std::size_t offset) const
+        -> std::size_t
+    {
+#ifdef IOV_MAX
+        constexpr std::size_t maxVectors = IOV_MAX;
+#else
+        constexpr std::size_t maxVectors = _XOPEN_IOV_MAX;
+#endif
+
+        std::size_t done = 0;
+        while (!std::ranges::empty(vectors))
+        {
+            int count = static_cast<int>(std::min(std::ranges::size(vectors),
+                                                  maxVectors));
+            auto position = static_cast<::off_t>(offset + done);
+
+            ::ssize_t result = tWrite ?
+                ::pwritev(mDescriptor, std::ranges::data(vectors), count,
+                          position) :
+                ::preadv(mDescriptor, std::ranges::data(vectors), count,
+                         position);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0)
+                throwError(tWrite ? "Unable to write file" :
+                                    "Unable to read file");
+            if (result == 0)
+                break;
+
+            done += static_cast<std::size_t>(result);
+
+            // Skip the finished vectors and continue a partial one
+            auto remaining = static_cast<std::size_t>(result);
+            while (!std::ranges::empty(vectors) &&
+                   remaining >= vectors.front().iov_len)
+            {
+                remaining -= vectors.front().iov_len;
+                vectors = vectors.subspan(1);
+            }
+
+            if (!std::ranges::empty(vectors))
+            {
+                vectors.front().iov_base =
+                    static_cast<Byte*>(vectors.front().iov_base) + remaining;
+                vectors.front().iov_len -= remaining;
+            }
+        }
+
+        return done;
+    }
+
+    void writeBuffer(std::size_t length)
+    {
+        bool aligned = (mBufferOffset % mOptions.alignment == 0 &&
+                        length % mOptions.alignment == 0);
+        if (!mOptions.direct || aligned)
+        {
+            writeAll(mBuffer.get(), length, mBufferOffset);
+            return;
+        }
+
+#ifdef O_DIRECT
+        // `O_DIRECT` requires aligned offsets and lengths, so an unaligned
+        // write (like the tail of a file) is done through the page cache
+        int flags = ::fcntl(mDescriptor, F_GETFL);
+        ::fcntl(mDescriptor, F_SETFL, flags & ~O_DIRECT);
+        try
+        {
+            writeAll(mBuffer.get(), length, mBufferOffset);
+        }
+        catch (...)
+        {
+            ::fcntl(mDescriptor, F_SETFL, flags);
+            throw;
+        }
+        ::fcntl(mDescriptor, F_SETFL, flags);
+#endif
+    }
+
+    void seek(std::streamoff offset, std::ios::seekdir direction)
+    {
+        std::streamoff base = 0;
+        if (direction == std::ios::cur)
+            base = static_cast<std::streamoff>(mPosition);
+        else if (direction == std::ios::end)
+            base = static_cast<std::streamoff>(size());
+
+        mPosition = static_cast<std::size_t>(base + offset);
+    }
+};
+
+/// An alias for `BinaryStream` using a `FileStream`.
+template<std::endian tEndian = std::endian::native, bool tSynchronized = true>
+using FileBinaryStream = BinaryStream<tEndian, tSynchronized, FileStream<>>;
+#endif
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_LOGREADER_HPP_
+#define SCPPL_BINARY_LOGREADER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+/// The length of the header in front of every log record.
+constexpr std::size_t logHeaderLength = lengthOf<uint32_t, uint32_t>();
+
+/// The default largest log record payload, protecting against corrupt lengths.
+constexpr std::size_t defaultMaxLogRecordLength = std::size_t{1} << 26;
+
+/**
+ * @brief Calculates the checksum stored in the header of a log record.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size.
+ *
+ * @param payload  The payload of the record.
+ *
+ * @return The CRC32C of the little endian payload length followed by the
+ *         payload.
+ */
+template<typename ByteT>
+auto logChecksum(std::span<ByteT const> payload)
+    -> std::uint32_t
+{
+    auto length = Binary<std::endian::little, ByteT>::pack(
+        static_cast<uint32_t>(std::ranges::size(payload)));
+
+    return crc32c(payload, crc32c(std::span<ByteT const>(length)));
+}
+
+/**
+ * @brief Reads the records of a log written by a `LogWriter`.
+ *
+ * @details Every record is a little endian `uint32_t` checksum, followed by a
+ *          `uint32_t` length and the payload, see `logChecksum()`. Records are
+ *          returned as views into the buffer of the file, so reading does not
+ *          copy or allocate per record.
+ *
+ *          A crash while appending can leave a partially written record at
+ *          the end of the log, a torn tail. Reading stops at the first record
+ *          that is incomplete or has a wrong checksum, `validLength()` is then
+ *          the length of the log up to and including the last valid record,
+ *          and `torn()` tells whether any bytes follow it. A
+ *          @ref scppl::LogWriter uses this to cut off the torn tail before
+ *          appending. A complete record with a valid checksum that is longer
+ *          than the maximum length is not torn, it throws instead, so a
+ *          smaller maximum never cuts off valid records.
+ *
+ * @code{.cpp}
+ * scppl::LogReader<> reader("state.log");
+ * while (auto record = reader.next())
+ *     apply(*record);
+ * @endcode
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size. [`char`]
+ */
+template<typename ByteT = char>
+class LogReader
+{
+public:
+    /// The byte type of this `LogReader` instance.
+    using Byte = ByteT;
+
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = typename FileStream<Byte>::Path;
+
+    /**
+     * @brief The `LogReader` constructor.
+     *
+     * @param path       The path of the log.
+     * @param maxLength  The largest accepted payload.
+     *                   [`defaultMaxLogRecordLength`]
+     * @param options    The buffer options of the file. [`{}`]
+     *
+     * @throws std::system_error  The file could not be opened.
+     */
+    explicit LogReader(Path const& path,
+                       std::size_t maxLength = defaultMaxLogRecordLength,
+                       FileStreamOptions options = {}) :
+        mFile(path, std::ios::in, options),
+        mStream(mFile),
+        mMaxLength(maxLength)
+    {
+        //
+    }
+
+    LogReader(LogReader const&) = delete;
+    LogReader(LogReader&&) = delete;
+
+    ~LogReader() noexcept = default;
+
+    auto operator=(LogReader const&) -> LogReader& = delete;
+    auto operator=(LogReader&&) -> LogReader& = delete;
+
+    /**
+     * @brief Read the next record.
+     *
+     * @throws std::length_error  A valid record is longer than the maximum.
+     * @throws std::system_error  Reading failed.
+     *
+     * @return The payload, valid until the next call. Empty at the end of the
+     *         log or at the first invalid record.
+     */
+    auto next()
+        -> std::optional<std::span<Byte const>>
+    {
+        if (mDone)
+            return std::nullopt;
+
+        std::size_t available = std::ranges::size(
+            mStream.peekRaw(logHeaderLength));
+        if (available < logHeaderLength)
+            return stop(available > 0);
+
+        std::size_t offset = mStream.tell();
+        auto checksum = mStream.template readSingle<uint32_t>();
+
+        std::span<Byte const> payload{};
+        try
+        {
+            payload = mStream.readFrame(mMaxLength);
+        }
+        catch (std::length_error const&)
+        {
+            // Possibly a corrupt length, but not when the checksum agrees
+            if (validRecord(offset))
+            {
+                throw std::length_error("Log record is longer than the "
+                                        "maximum length");
+            }
+
+            return stop(true);
+        }
+        catch (std::out_of_range const&)
+        {
+            return stop(true);
+        }
+
+        if (logChecksum(payload) != checksum)
+            return stop(true);
+
+        mValidLength = mStream.tell();
+
+        return payload;
+    }
+
+    /// The length of the log up to and including the last valid record.
+    auto validLength() const -> std::size_t { return mValidLength; }
+
+    /// Whether reading stopped at an invalid record instead of the end.
+    auto torn() const -> bool { return mTorn; }
+
+private:
+    FileStream<Byte> mFile;
+    BinaryStream<std::endian::little, true, FileStream<Byte>> mStream;
+    std::size_t mMaxLength{};
+
+    std::size_t mValidLength{};
+    bool mTorn{};
+    bool mDone{};
+
+    /**
+     * Whether the record at `offset` is complete and matches its checksum,
+     * without holding its whole payload in memory.
+     */
+    auto validRecord(std::size_t offset) const
+        -> bool
+    {
+        std::array<Byte, logHeaderLength> header{};
+        if (mFile.readAt(std::ranges::data(header), logHeaderLength, offset) <
+            logHeaderLength)
+        {
+            return false;
+        }
+
+        auto [checksum, length] = Binary<std::endian::little, Byte>::template
+            unpack<uint32_t, uint32_t>(header);
+
+        // The checksum covers the length followed by the payload
+        std::span<Byte const> lengthBytes = std::span<Byte const>(header)
+            .subspan(lengthOf<uint32_t>());
+        std::uint32_t crc = crc32c(lengthBytes);
+
+        std::vector<Byte> chunk(std::min<std::size_t>(length,
+                                                      std::size_t{1} << 16));
+        offset += logHeaderLength;
+        for (std::size_t done = 0; done < length;)
+        {
+            std::size_t count = std::min<std::size_t>(std::ranges::size(chunk),
+                                                      length - done);
+            if (mFile.readAt(std::ranges::data(chunk), count, offset + done) <
+                count)
+            {
+                return false;
+            }
+
+            crc = crc32c(std::span<Byte const>(chunk).first(count), crc);
+            done += count;
+        }
+
+        return crc == checksum;
+    }
+
+    /// Stop reading, `torn` tells whether bytes follow the last valid record.
+    auto stop(bool torn)
+        -> std::nullopt_t
+    {
+        mDone = true;
+        mTorn = torn;
+
+        return std::nullopt;
+    }
+};
+#endif
+
+}
+
+#endif
@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_LOGWRITER_HPP_
+#define SCPPL_BINARY_LOGWRITER_HPP_
+
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+#include <unistd.h>
+#endif
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/LogReader.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+/// How a `LogWriter` groups commits.
+struct LogWriterOptions
+{
+    /// How long a commit waits for other records before synchronizing.
+    std::chrono::microseconds commitWindow{0};
+
+    /// Stop waiting once this many bytes are waiting to be committed.
+    std::size_t commitBytes = std::size_t{1} << 20;
+
+    /// Call `fdatasync` when committing, otherwise commits only write the
+    /// records to the operating system.
+    bool sync = true;
+
+    /// The largest accepted payload.
+    std::size_t maxRecordLength = defaultMaxLogRecordLength;
+
+    /// The buffer options of the file.
+    FileStreamOptions file{};
+};
+
+/**
+ * @brief An append-only log of checksummed, length-prefixed records, with
+ *        group commit.
+ *
+ * @details `append()` adds a record to the buffer of the file and returns its
+ *          log sequence number, the length of the log including the record.
+ *          `commit()` waits until the log is durable up to a sequence number.
+ *          Both can be called from multiple threads at the same time.
+ *
+ *          Commits are grouped: the first thread that needs a commit writes
+ *          the buffer and calls `fdatasync` for every record appended so far,
+ *          while the other threads wait for it and append records for the next
+ *          commit. So concurrent writers share a `fdatasync` instead of doing
+ *          one per record. With a `commitWindow`, the committing thread first
+ *          waits for more records, up to `commitBytes`, which helps when the
+ *          synchronization itself is fast or there are few writers.
+ *
+ *          Opening an existing log reads it with a @ref scppl::LogReader and
+ *          cuts off a torn tail before appending, see `truncated()`.
+ *
+ * @code{.cpp}
+ * scppl::LogWriter<> log("state.log", {.commitWindow = 100us});
+ * log.commit(log.append(change));
+ * @endcode
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled.
+ *
+ * @tparam ByteT  The byte type, must be one byte in size. [`char`]
+ */
+template<typename ByteT = char>
+class LogWriter
+{
+public:
+    /// The byte type of this `LogWriter` instance.
+    using Byte = ByteT;
+
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = typename FileStream<Byte>::Path;
+
+    /**
+     * @brief The `LogWriter` constructor, opening or creating the log.
+     *
+     * @param path     The path of the log.
+     * @param options  The commit and buffer options. [`{}`]
+     *
+     * @throws std::length_error  A valid record in the log is longer than
+     *                            `maxRecordLength`.
+     * @throws std::system_error  The file could not be opened or recovered.
+     */
+    explicit LogWriter(Path const& path, LogWriterOptions options = {}) :
+        mOptions(options),
+        mTruncated(recover(path, options)),
+        mFile(path, std::ios::out | std::ios::app, options.file),
+        mStream(mFile)
+    {
+        mAppended = mFile.tellp();
+        mCommitted = mAppended;
+    }
+
+    LogWriter(LogWriter const&) = delete;
+    LogWriter(LogWriter&&) = delete;
+
+    /// Writes the buffer, without waiting for it to reach the disk.
+    ~LogWriter() noexcept = default;
+
+    auto operator=(LogWriter const&) -> LogWriter& = delete;
+    auto operator=(LogWriter&&) -> LogWriter& = delete;
+
+    /**
+     * @brief Append a record to the log.
+     *
+     * @param payload  The payload of the record.
+     *
+     * @throws std::length_error  The payload is longer than `maxRecordLength`.
+     * @throws std::system_error  Writing failed.
+     *
+     * @return The sequence number of the record, to pass to `commit()`.
+     */
+    auto append(std::span<Byte const> payload)
+        -> std::uint64_t
+    {
+        if (std::ranges::size(payload) > mOptions.maxRecordLength)
+            throw std::length_error("Record is longer than the maximum length");
+
+        auto header = Binary<std::endian::little, Byte>::pack(
+            logChecksum(payload),
+            static_cast<uint32_t>(std::ranges::size(payload)));
+
+        std::lock_guard lock(mMutex);
+
+        mStream.writeGather(header, payload);
+        mAppended += logHeaderLength + std::ranges::size(payload);
+
+        if (mCommitting && mAppended - mCommitted >= mOptions.commitBytes)
+            mGathered.notify_one();
+
+        return mAppended;
+    }
+
+    /**
+     * @brief Wait until the log is durable up to a sequence number.
+     *
+     * @param sequence  The sequence number returned by `append()`.
+     *
+     * @throws std::system_error  Writing or synchronizing failed.
+     */
+    void commit(std::uint64_t sequence)
+    {
+        std::unique_lock lock(mMutex);
+
+        while (mCommitted < sequence)
+        {
+            if (mCommitting)
+            {
+                mCommittedSignal.wait(lock);
+                continue;
+            }
+
+            mCommitting = true;
+
+            try
+            {
+                commitGroup(lock);
+            }
+            catch (...)
+            {
+                mCommitting = false;
+                mCommittedSignal.notify_all();
+
+                throw;
+            }
+
+            mCommitting = false;
+            mCommittedSignal.notify_all();
+        }
+    }
+
+    /**
+     * @brief Wait until every appended record is durable.
+     *
+     * @throws std::system_error  Writing or synchronizing failed.
+     */
+    void sync()
+    {
+        commit(appended());
+    }
+
+    /// The sequence number of the last appended record.
+    auto appended() const
+        -> std::uint64_t
+    {
+        std::lock_guard lock(mMutex);
+
+        return mAppended;
+    }
+
+    /// The sequence number up to which the log is durable.
+    auto committed() const
+        -> std::uint64_t
+    {
+        std::lock_guard lock(mMutex);
+
+        return mCommitted;
+    }
+
+    /// The amount of bytes of a torn tail cut off when opening the log.
+    auto truncated() const -> std::size_t { return mTruncated; }
+
+private:
+    LogWriterOptions mOptions{};
+    std::size_t mTruncated{};
+
+    FileStream<Byte> mFile;
+    BinaryStream<std::endian::little, true, FileStream<Byte>> mStream;
+
+    mutable std::mutex mMutex{};
+    std::condition_variable mGathered{};
+    std::condition_variable mCommittedSignal{};
+
+    std::uint64_t mAppended{};
+    std::uint64_t mCommitted{};
+    bool mCommitting{};
+
+    /// Cut off the torn tail of an existing log, returns the amount of bytes.
+    static auto recover(Path const& path, LogWriterOptions const& options)
+        -> std::size_t
+    {
+        if (!std::filesystem::exists(path))
+            return 0;
+
+        std::size_t validLength = 0;
+        {
+            LogReader<Byte> reader(path, options.maxRecordLength,
+                                   options.file);
+            while (reader.next())
+            {
+                //
+            }
+
+            if (!reader.torn())
+                return 0;
+
+            validLength = reader.validLength();
+        }
+
+        std::size_t length = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, validLength);
+
+        return length - validLength;
+    }
+
+    /// Commit everything appended so far, called by one thread at a time.
+    void commitGroup(std::unique_lock<std::mutex>& lock)
+    {
+        if (mOptions.commitWindow.count() > 0)
+        {
+            mGathered.wait_for(lock, mOptions.commitWindow, [this]() {
+                return mAppended - mCommitted >= mOptions.commitBytes;
+            });
+        }
+
+        std::uint64_t target = mAppended;
+        mFile.flush();
+
+        if (mOptions.sync)
+        {
+            // Other threads keep appending to the buffer in the meantime,
+            // they are not part of this commit
+            lock.unlock();
+            int result = ::fdatasync(mFile.handle());
+            int error = errno;
+            lock.lock();
+
+            if (result != 0)
+            {
+                throw std::system_error(error, std::generic_category(),
+                                        "Unable to synchronize file");
+            }
+        }
+
+        mCommitted = target;
+    }
+};
+#endif
+
+}
+
+#endif
@@ -0,0 +1,561 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_OFFSETINDEX_HPP_
+#define SCPPL_BINARY_OFFSETINDEX_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <ios>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/Utility.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+/// The last four bytes of an offset index, "SCOI" in little endian.
+constexpr std::uint32_t offsetIndexMagic = 0x494F4353;
+
+/// The length of the footer at the end of an offset index.
+constexpr std::size_t offsetIndexFooterLength =
+    lengthOf<uint64_t, uint64_t, uint32_t, uint32_t>();
+
+/// How an offset index is built and stored.
+struct OffsetIndexOptions
+{
+    /// Store every this many offsets in full, the offsets in between are
+    /// stored as varint deltas. Looking up an offset decodes at most
+    /// `stride - 1` deltas.
+    std::size_t stride = 64;
+
+    /// The amount of threads scanning chunks, for records that allow it.
+    std::size_t threads = 4;
+
+    /// The size of a chunk scanned by one thread in bytes.
+    std::size_t chunkSize = std::size_t{1} << 22;
+};
+
+/**
+ * @brief Writes a sidecar file with the offsets of the records of another
+ *        file.
+ *
+ * @details Offsets are added in increasing order. Every `stride`th offset is
+ *          kept in a table of checkpoints, with the position of the deltas
+ *          that follow it. The deltas are written as varints, so an offset
+ *          usually takes one or two bytes. `finish()` writes the table and a
+ *          footer after the deltas.
+ *
+ *          All numbers are little endian. The footer is the position of the
+ *          table, the amount of offsets, the stride and a magic number, and
+ *          every entry of the table is the checkpoint offset and the position
+ *          of its deltas, both `uint64_t`.
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled.
+ */
+class OffsetIndexWriter
+{
+public:
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = std::filesystem::path;
+
+    /**
+     * @brief The `OffsetIndexWriter` constructor, creating the sidecar.
+     *
+     * @param path     The path of the sidecar.
+     * @param options  The stride of the checkpoints. [`{}`]
+     *
+     * @throws std::invalid_argument  The stride is `0`.
+     * @throws std::system_error      The file could not be opened.
+     */
+    explicit OffsetIndexWriter(Path const& path,
+                               OffsetIndexOptions options = {}) :
+        mFile(path, std::ios::out | std::ios::trunc),
+        mStream(mFile),
+        mStride(options.stride)
+    {
+        if (mStride == 0)
+            throw std::invalid_argument("Stride must be greater than 0");
+    }
+
+    OffsetIndexWriter(OffsetIndexWriter const&) = delete;
+    OffsetIndexWriter(OffsetIndexWriter&&) = delete;
+
+    /// Calls `finish()`, if it was not called yet.
+    ~OffsetIndexWriter() noexcept
+    {
+        try
+        {
+            finish();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `finish()` for that
+        }
+    }
+
+    auto operator=(OffsetIndexWriter const&) -> OffsetIndexWriter& = delete;
+    auto operator=(OffsetIndexWriter&&) -> OffsetIndexWriter& = delete;
+
+    /**
+     * @brief Add the offset of the next record.
+     *
+     * @param offset  The offset, not less than the previous offset.
+     *
+     * @throws std::invalid_argument  The offset is less than the previous
+     *                                offset, or the index is finished.
+     * @throws std::system_error      Writing failed.
+     */
+    void add(std::uint64_t offset)
+    {
+        if (mFinished)
+            throw std::invalid_argument("Offset index is already finished");
+
+        if (mCount > 0 && offset < mPrevious)
+            throw std::invalid_argument("Offsets must be added in order");
+
+        if (mCount % mStride == 0)
+        {
+            mCheckpoints.push_back(offset);
+            mCheckpoints.push_back(mPosition);
+        }
+        else
+        {
+            std::array<char, 10> varint{};
+            std::size_t length = 0;
+            std::uint64_t delta = offset - mPrevious;
+            do
+            {
+                auto group = static_cast<uint8_t>(delta & 0x7f);
+                delta >>= 7;
+                varint[length++] = static_cast<char>(
+                    (delta != 0) ? (group | 0x80) : group);
+            }
+            while (delta != 0);
+
+            mStream.writeRaw(std::span<char const>(varint).first(length));
+            mPosition += length;
+        }
+
+        mPrevious = offset;
+        ++mCount;
+    }
+
+    /**
+     * @brief Write the table of checkpoints and the footer.
+     *
+     * @details Calling it again does nothing.
+     *
+     * @throws std::system_error  Writing failed.
+     */
+    void finish()
+    {
+        if (mFinished)
+            return;
+
+        mFinished = true;
+
+        mStream.writeArray(std::span<std::uint64_t const>(mCheckpoints));
+        mStream.write(mPosition, mCount, static_cast<uint32_t>(mStride),
+                      offsetIndexMagic);
+
+        mFile.flush();
+    }
+
+    /// The amount of offsets added so far.
+    auto size() const -> std::uint64_t { return mCount; }
+
+private:
+    FileStream<> mFile;
+    BinaryStream<std::endian::little, true, FileStream<>> mStream;
+    std::size_t mStride{};
+
+    /// Pairs of a checkpoint offset and the position of its deltas.
+    std::vector<std::uint64_t> mCheckpoints{};
+    std::uint64_t mPosition{};
+    std::uint64_t mPrevious{};
+    std::uint64_t mCount{};
+    bool mFinished{};
+};
+
+/**
+ * @brief A sidecar file of record offsets, mapped into memory.
+ *
+ * @details Only the footer is read when opening the index, the rest is read
+ *          on demand by the operating system. Looking up an offset reads the
+ *          checkpoint before it from the table and decodes at most
+ *          `stride - 1` deltas, so it takes constant time for any record.
+ *          Lookups do not change the index, so they can be done from
+ *          multiple threads at once.
+ *
+ * @code{.cpp}
+ * scppl::OffsetIndex index("records.bin.idx");
+ * stream.seek(index[n], std::ios::beg);
+ * auto record = stream.readFrame();
+ * @endcode
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_POSIX` to be enabled.
+ */
+class OffsetIndex
+{
+public:
+    /// A simple alias for a `std::filesystem::path`.
+    using Path = std::filesystem::path;
+
+    /**
+     * @brief The `OffsetIndex` constructor, mapping the sidecar.
+     *
+     * @param path  The path of the sidecar.
+     *
+     * @throws std::system_error   The file could not be opened or mapped.
+     * @throws std::runtime_error  The file is not an offset index.
+     */
+    explicit OffsetIndex(Path const& path)
+    {
+        int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0)
+            throwError("Unable to open offset index");
+
+        struct ::stat status{};
+        if (::fstat(descriptor, &status) != 0)
+        {
+            int error = errno;
+            ::close(descriptor);
+            throw std::system_error(error, std::generic_category(),
+                                    "Unable to get file status");
+        }
+
+        mLength = static_cast<std::size_t>(status.st_size);
+        if (mLength < offsetIndexFooterLength)
+        {
+            ::close(descriptor);
+            throw std::runtime_error("File is too short for an offset index");
+        }
+
+        void* memory = ::mmap(nullptr, mLength, PROT_READ, MAP_SHARED,
+                              descriptor, 0);
+        int error = errno;
+        ::close(descriptor);
+        if (memory == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(),
+                                    "Unable to map offset index");
+        }
+
+        mData = static_cast<unsigned char const*>(memory);
+
+        try
+        {
+            readFooter();
+        }
+        catch (...)
+        {
+            ::munmap(const_cast<unsigned char*>(mData), mLength);
+            throw;
+        }
+    }
+
+    OffsetIndex(OffsetIndex const&) = delete;
+    OffsetIndex(OffsetIndex&&) = delete;
+
+    /// Unmaps the sidecar.
+    ~OffsetIndex() noexcept
+    {
+        ::munmap(const_cast<unsigned char*>(mData), mLength);
+    }
+
+    auto operator=(OffsetIndex const&) -> OffsetIndex& = delete;
+    auto operator=(OffsetIndex&&) -> OffsetIndex& = delete;
+
+    /// The amount of offsets in the index.
+    auto size() const -> std::uint64_t { return mCount; }
+
+    /// The stride of the checkpoints.
+    auto stride() const -> std::size_t { return mStride; }
+
+    /**
+     * @brief Get the offset of a record, without bounds checking.
+     *
+     * @param index  The index of the record, less than `size()`.
+     *
+     * @throws std::runtime_error  The deltas of the record are corrupt.
+     *
+     * @return The offset of the record.
+     */
+    auto operator[](std::uint64_t index) const
+        -> std::uint64_t
+    {
+        std::uint64_t group = index / mStride;
+        auto [offset, position] = load<uint64_t, uint64_t>(
+            mTablePosition + group * 2 * sizeof(uint64_t));
+
+        for (std::uint64_t i = group * mStride; i < index; ++i)
+            offset += decodeVarint(position);
+
+        return offset;
+    }
+
+    /**
+     * @brief Get the offset of a record.
+     *
+     * @param index  The index of the record.
+     *
+     * @throws std::out_of_range   `index` is not less than `size()`.
+     * @throws std::runtime_error  The deltas of the record are corrupt.
+     *
+     * @return The offset of the record.
+     */
+    auto at(std::uint64_t index) const
+        -> std::uint64_t
+    {
+        if (index >= mCount)
+            throw std::out_of_range("Record index is out of range");
+
+        return (*this)[index];
+    }
+
+private:
+    unsigned char const* mData{};
+    std::size_t mLength{};
+
+    std::size_t mTablePosition{};
+    std::uint64_t mCount{};
+    std::size_t mStride{};
+
+    [[noreturn]] static void throwError(char const* message)
+    {
+        throw std::system_error(errno, std::generic_category(), message);
+    }
+
+    /// Unpack `Ts...` at `position` of the mapped file.
+    template<typename... Ts>
+    auto load(std::size_t position) const
+        -> std::tuple<Ts...>
+    {
+        return Binary<std::endian::little, unsigned char>::template unpack<
+            Ts...>(std::span<unsigned char const>(mData + position,
+                                                  lengthOf<Ts...>()));
+    }
+
+    void readFooter()
+    {
+        auto [tablePosition, count, stride, magic] =
+            load<uint64_t, uint64_t, uint32_t, uint32_t>(
+                mLength - offsetIndexFooterLength);
+
+        if (magic != offsetIndexMagic || stride == 0)
+            throw std::runtime_error("File is not an offset index");
+
+        std::uint64_t groups = (count + stride - 1) / stride;
+        if (tablePosition > mLength ||
+            groups > (mLength - tablePosition) / (2 * sizeof(uint64_t)) ||
+            tablePosition + groups * 2 * sizeof(uint64_t) +
+                    offsetIndexFooterLength != mLength)
+        {
+            throw std::runtime_error("Offset index footer is corrupt");
+        }
+
+        mTablePosition = static_cast<std::size_t>(tablePosition);
+        mCount = count;
+        mStride = stride;
+    }
+
+    /// Decode the varint at `position`, moving `position` past it.
+    auto decodeVarint(std::uint64_t& position) const
+        -> std::uint64_t
+    {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (position >= mTablePosition)
+                break;
+
+            unsigned char group = mData[position++];
+            value |= static_cast<std::uint64_t>(group & 0x7f) << shift;
+            if ((group & 0x80) == 0)
+                return value;
+        }
+
+        throw std::runtime_error("Offset index delta is corrupt");
+    }
+};
+
+/**
+ * @brief Build an offset index of the length-prefixed frames in a stream.
+ *
+ * @details The frames are read once from the current position until the end
+ *          of the stream, like `readFrame()` does. The lengths of frames do
+ *          not allow finding the start of a frame in the middle of the
+ *          stream, so this scans on a single thread.
+ *
+ * @tparam tPrefix  The type of the length prefix. [`FramePrefix::U32`]
+ *
+ * @param stream     The stream with the frames, must be seekable.
+ * @param path       The path of the sidecar to write.
+ * @param options    The stride of the checkpoints. [`{}`]
+ * @param maxLength  The largest accepted payload. [`defaultMaxFrameLength`]
+ *
+ * @throws std::length_error  A payload is longer than `maxLength`.
+ * @throws std::out_of_range  The stream ends inside a frame.
+ *
+ * @return The amount of frames.
+ */
+template<FramePrefix tPrefix = FramePrefix::U32, std::endian tEndian,
+         bool tSynchronized, typename StreamT, typename ByteT>
+auto buildOffsetIndex(BinaryStream<tEndian, tSynchronized, StreamT,
+                                   ByteT>& stream,
+                      std::filesystem::path const& path,
+                      OffsetIndexOptions options = {},
+                      std::size_t maxLength =
+                          BinaryStream<tEndian, tSynchronized, StreamT,
+                                       ByteT>::defaultMaxFrameLength)
+    -> std::uint64_t
+{
+    OffsetIndexWriter writer(path, options);
+    while (true)
+    {
+        std::size_t offset = stream.tell();
+        stream.template readFrame<tPrefix>(maxLength);
+        if (stream.eof())
+            break;
+
+        writer.add(offset);
+    }
+
+    writer.finish();
+
+    return writer.size();
+}
+
+/**
+ * @brief Build an offset index of the records in a file that are terminated
+ *        by a delimiter, like lines.
+ *
+ * @details A record starts at the beginning of the file and after every
+ *          delimiter, except at the end of the file. Since the start of the
+ *          next record can be found from anywhere in the file, the file is
+ *          split into chunks of `chunkSize` bytes that are scanned by
+ *          `threads` threads at once, each with its own `pread` calls.
+ *
+ * @param file       The path of the file with the records.
+ * @param delimiter  The byte that ends a record.
+ * @param path       The path of the sidecar to write.
+ * @param options    The stride, threads and chunk size. [`{}`]
+ *
+ * @throws std::system_error  Reading or writing failed.
+ *
+ * @return The amount of records.
+ */
+inline auto buildDelimitedOffsetIndex(std::filesystem::path const& file,
+                                      char delimiter,
+                                      std::filesystem::path const& path,
+                                      OffsetIndexOptions options = {})
+    -> std::uint64_t
+{
+    FileStream<> source(file, std::ios::in, {.bufferSize = 1});
+    std::size_t size = source.size();
+
+    std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    std::size_t threads = std::max<std::size_t>(options.threads, 1);
+    std::size_t chunks = (size + chunkSize - 1) / chunkSize;
+
+    // The starts of the records in the chunk at `begin`, found from the
+    // delimiters in the byte before it up to the byte before the next chunk
+    auto scan = [&](std::size_t begin, std::vector<std::uint64_t>& starts,
+                    std::vector<char>& buffer) {
+        std::size_t end = std::min(begin + chunkSize, size);
+        std::size_t first = (begin > 0) ? begin - 1 : 0;
+
+        buffer.resize(end - first);
+        buffer.resize(source.readAt(std::ranges::data(buffer),
+                                    std::ranges::size(buffer), first));
+
+        starts.clear();
+        if (begin == 0)
+            starts.push_back(0);
+
+        char const* data = std::ranges::data(buffer);
+        char const* stop = data + std::ranges::size(buffer);
+        for (char const* position = data; position < stop; ++position)
+        {
+            position = static_cast<char const*>(
+                std::memchr(position, delimiter,
+                            static_cast<std::size_t>(stop - position)));
+            if (position == nullptr)
+                break;
+
+            std::uint64_t start = first + (position - data) + 1;
+            if (start >= begin && start < end)
+                starts.push_back(start);
+        }
+    };
+
+    OffsetIndexWriter writer(path, options);
+
+    std::vector<std::vector<std::uint64_t>> starts(threads);
+    std::vector<std::vector<char>> buffers(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    for (std::size_t wave = 0; wave < chunks; wave += threads)
+    {
+        std::size_t count = std::min(threads, chunks - wave);
+
+        std::vector<std::thread> workers{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            workers.emplace_back([&, i]() {
+                try
+                {
+                    scan((wave + i) * chunkSize, starts[i], buffers[i]);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (errors[i])
+                std::rethrow_exception(errors[i]);
+
+            for (std::uint64_t start : starts[i])
+                writer.add(start);
+        }
+    }
+
+    writer.finish();
+
+    return writer.size();
+}
+#endif
+
+}
+
+#endif
@@ -0,0 +1,519 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_REACTOR_HPP_
+#define SCPPL_BINARY_REACTOR_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "scppl/binary/Task.hpp"
+
+namespace scppl {
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+/**
+ * @brief An event loop resuming coroutines when file descriptors are ready.
+ *
+ * @details Coroutines wait for a non-blocking file descriptor with
+ *          `co_await reactor.readable(descriptor)` or `writable`, the reactor
+ *          waits for all of them at once with `epoll` and resumes the ones
+ *          that are ready. Blocking work, like reading a regular file (which
+ *          `epoll` does not support), is done on a helper thread with
+ *          `co_await reactor.offload(function)`, the coroutine is resumed on
+ *          the reactor thread when it is done.
+ *
+ *          Everything except the end of `offload` runs on the thread calling
+ *          `run()`, so coroutines on the same reactor never run concurrently.
+ *
+ * @note This requires `SCPPL_CONFIG_BINARY_USE_EPOLL` to be enabled.
+ */
+class Reactor
+{
+public:
+    /// Waits until a file descriptor is ready.
+    class ReadyAwaiter
+    {
+    public:
+        ReadyAwaiter(Reactor& reactor, int descriptor, bool write) :
+            mReactor(reactor),
+            mDescriptor(descriptor),
+            mWrite(write)
+        {
+            //
+        }
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            mReactor.wait(mDescriptor, mWrite, handle);
+        }
+
+        void await_resume() const noexcept
+        {
+            //
+        }
+
+    private:
+        Reactor& mReactor;
+        int mDescriptor{};
+        bool mWrite{};
+    };
+
+    /// Runs a function on the helper thread.
+    template<typename FunctionT>
+    class OffloadAwaiter
+    {
+    public:
+        using Result = std::invoke_result_t<FunctionT&>;
+
+        OffloadAwaiter(Reactor& reactor, FunctionT function) :
+            mReactor(reactor),
+            mFunction(std::move(function))
+        {
+            //
+        }
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            mReactor.submit([this, handle]() {
+                try
+                {
+                    mResult.emplace(mFunction());
+                }
+                catch (...)
+                {
+                    mError = std::current_exception();
+                }
+
+                mReactor.post(handle);
+            });
+        }
+
+        auto await_resume()
+            -> Result
+        {
+            if (mError)
+                std::rethrow_exception(mError);
+
+            return std::move(*mResult);
+        }
+
+    private:
+        Reactor& mReactor;
+        FunctionT mFunction;
+        std::optional<Result> mResult{};
+        std::exception_ptr mError{};
+    };
+
+    /**
+     * @brief The `Reactor` constructor.
+     *
+     * @throws std::system_error When `epoll` or `eventfd` fails.
+     */
+    Reactor() :
+        mEpoll(::epoll_create1(EPOLL_CLOEXEC)),
+        mEvent(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+        if (mEpoll < 0 || mEvent < 0)
+        {
+            int error = errno;
+            close();
+
+            throw std::system_error(error, std::generic_category(),
+                                    "Unable to create reactor");
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = mEvent;
+        ::epoll_ctl(mEpoll, EPOLL_CTL_ADD, mEvent, &event);
+    }
+
+    Reactor(Reactor const&) = delete;
+    Reactor(Reactor&&) = delete;
+
+    /// Stops the helper thread and closes the `epoll` instance.
+    ~Reactor() noexcept
+    {
+        {
+            std::scoped_lock lock(mMutex);
+            mStopping = true;
+        }
+
+        mJobCondition.notify_one();
+        if (mHelper.joinable())
+            mHelper.join();
+
+        close();
+    }
+
+    auto operator=(Reactor const&) -> Reactor& = delete;
+    auto operator=(Reactor&&) -> Reactor& = delete;
+
+    /**
+     * @brief Wait until `descriptor` can be read from.
+     *
+     * @param descriptor  A non-blocking file descriptor.
+     *
+     * @return An awaitable.
+     */
+    auto readable(int descriptor)
+        -> ReadyAwaiter
+    {
+        return {*this, descriptor, false};
+    }
+
+    /**
+     * @brief Wait until `descriptor` can be written to.
+     *
+     * @param descriptor  A non-blocking file descriptor.
+     *
+     * @return An awaitable.
+     */
+    auto writable(int descriptor)
+        -> ReadyAwaiter
+    {
+        return {*this, descriptor, true};
+    }
+
+    /**
+     * @brief Run `function` on the helper thread.
+     *
+     * @details The helper thread is started when it is first needed, jobs run
+     *          one after another in the order they were offloaded.
+     *
+     * @param function  The function to run, must return a value.
+     *
+     * @return An awaitable returning the result of `function`, or rethrowing
+     *         its exception.
+     */
+    template<typename FunctionT>
+    auto offload(FunctionT function)
+        -> OffloadAwaiter<FunctionT>
+    {
+        return {*this, std::move(function)};
+    }
+
+    /**
+     * @brief Start `task` and run the event loop until it has finished.
+     *
+     * @param task  The task to run.
+     *
+     * @throws std::runtime_error When the task waits while nothing is pending.
+     * @throws Any exception of `task` or of a spawned task.
+     *
+     * @return The value of `task`.
+     */
+    template<typename T>
+    auto run(Task<T> task)
+        -> T
+    {
+        task.start();
+        while (!task.done())
+        {
+            if (mWaiting == 0 && mPending == 0)
+                throw std::runtime_error("Task is waiting for nothing");
+
+            poll(-1);
+        }
+
+        return task.result();
+    }
+
+    /**
+     * @brief Start `task` next to the task passed to `run()`.
+     *
+     * @details The reactor keeps the task until it has finished, its
+     *          exception is rethrown by `poll()`.
+     *
+     * @param task  The task to start.
+     */
+    void spawn(Task<> task)
+    {
+        task.start();
+        if (!task.done())
+            mSpawned.push_back(std::move(task));
+        else
+            task.result();
+    }
+
+    /**
+     * @brief Wait for ready file descriptors and finished offloads, and
+     *        resume their coroutines.
+     *
+     * @param timeout  The maximum time to wait in milliseconds, `-1` to wait
+     *                 until something is ready.
+     *
+     * @throws std::system_error When `epoll_wait` fails.
+     * @throws Any exception of a spawned task.
+     *
+     * @return The amount of resumed coroutines.
+     */
+    auto poll(int timeout)
+        -> std::size_t
+    {
+        std::array<epoll_event, 64> events{};
+        int count = ::epoll_wait(mEpoll, std::ranges::data(events),
+                                 static_cast<int>(std::ranges::size(events)),
+                                 timeout);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                return 0;
+
+            throw std::system_error(errno, std::generic_category(),
+                                    "Unable to wait for events");
+        }
+
+        // Collect first, resumed coroutines can wait for the same descriptor
+        std::vector<std::coroutine_handle<>> ready{};
+        for (epoll_event const& event : std::span(events).first(
+                 static_cast<std::size_t>(count)))
+        {
+            if (event.data.fd == mEvent)
+            {
+                collectPosted(ready);
+                continue;
+            }
+
+            collectWaiting(event.data.fd, event.events, ready);
+        }
+
+        for (std::coroutine_handle<> handle : ready)
+            handle.resume();
+
+        collectSpawned();
+
+        return std::ranges::size(ready);
+    }
+
+    /**
+     * @brief Stop watching `descriptor`, before it is closed.
+     *
+     * @param descriptor  The file descriptor.
+     */
+    void forget(int descriptor)
+    {
+        auto waiters = mWaiters.find(descriptor);
+        if (waiters == std::ranges::end(mWaiters))
+            return;
+
+        ::epoll_ctl(mEpoll, EPOLL_CTL_DEL, descriptor, nullptr);
+        mWaiting -= static_cast<std::size_t>(bool(waiters->second.reader)) +
+                    static_cast<std::size_t>(bool(waiters->second.writer));
+        mWaiters.erase(waiters);
+    }
+
+private:
+    /// The coroutines waiting for a file descriptor.
+    struct Waiters
+    {
+        std::coroutine_handle<> reader{};
+        std::coroutine_handle<> writer{};
+        bool added{};
+    };
+
+    int mEpoll{-1};
+    int mEvent{-1};
+
+    std::unordered_map<int, Waiters> mWaiters{};
+    std::size_t mWaiting{};
+    std::size_t mPending{};
+    std::list<Task<>> mSpawned{};
+
+    // Shared with the helper thread
+    std::mutex mMutex{};
+    std::condition_variable mJobCondition{};
+    std::deque<std::function<void()>> mJobs{};
+    std::vector<std::coroutine_handle<>> mPosted{};
+    bool mStopping{};
+    std::thread mHelper{};
+
+    void close() noexcept
+    {
+        if (mEvent >= 0)
+            ::close(mEvent);
+        if (mEpoll >= 0)
+            ::close(mEpoll);
+    }
+
+    /// Register `handle` to be resumed when `descriptor` is ready.
+    void wait(int descriptor, bool write, std::coroutine_handle<> handle)
+    {
+        Waiters& waiters = mWaiters[descriptor];
+        (write ? waiters.writer : waiters.reader) = handle;
+        ++mWaiting;
+
+        watch(descriptor, waiters);
+    }
+
+    /// Update the events `epoll` watches for `descriptor`.
+    void watch(int descriptor, Waiters& waiters)
+    {
+        epoll_event event{};
+        event.events = (waiters.reader ? EPOLLIN | EPOLLRDHUP : 0U) |
+                       (waiters.writer ? EPOLLOUT : 0U);
+        event.data.fd = descriptor;
+
+        int operation = waiters.added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (::epoll_ctl(mEpoll, operation, descriptor, &event) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Unable to watch file descriptor");
+        }
+
+        waiters.added = true;
+    }
+
+    /// Take the waiters of a ready file descriptor.
+    void collectWaiting(int descriptor, std::uint32_t events,
+                        std::vector<std::coroutine_handle<>>& ready)
+    {
+        auto found = mWaiters.find(descriptor);
+        if (found == std::ranges::end(mWaiters))
+            return;
+
+        Waiters& waiters = found->second;
+        std::uint32_t failed = EPOLLERR | EPOLLHUP;
+        if (waiters.reader && (events & (EPOLLIN | EPOLLRDHUP | failed)))
+        {
+            ready.push_back(std::exchange(waiters.reader, nullptr));
+            --mWaiting;
+        }
+
+        if (waiters.writer && (events & (EPOLLOUT | failed)))
+        {
+            ready.push_back(std::exchange(waiters.writer, nullptr));
+            --mWaiting;
+        }
+
+        if (waiters.reader || waiters.writer)
+        {
+            watch(descriptor, waiters);
+
+            return;
+        }
+
+        // `epoll` always reports errors and hang-ups, even with no events, so
+        // a hung-up descriptor would keep waking `poll()` while nothing waits
+        if (waiters.added)
+            ::epoll_ctl(mEpoll, EPOLL_CTL_DEL, descriptor, nullptr);
+
+        mWaiters.erase(found);
+    }
+
+    /// Take the coroutines of finished offloads.
+    void collectPosted(std::vector<std::coroutine_handle<>>& ready)
+    {
+        std::uint64_t value{};
+        [[maybe_unused]] auto result = ::read(mEvent, &value, sizeof(value));
+
+        std::scoped_lock lock(mMutex);
+        mPending -= std::ranges::size(mPosted);
+        ready.insert(std::ranges::end(ready), std::ranges::begin(mPosted),
+                     std::ranges::end(mPosted));
+        mPosted.clear();
+    }
+
+    /// Remove finished spawned tasks, rethrowing their exceptions.
+    void collectSpawned()
+    {
+        for (auto task = std::ranges::begin(mSpawned);
+             task != std::ranges::end(mSpawned);)
+        {
+            if (!task->done())
+            {
+                ++task;
+                continue;
+            }
+
+            Task<> finished = std::move(*task);
+            task = mSpawned.erase(task);
+            finished.result();
+        }
+    }
+
+    /// Queue a job for the helper thread, starting it when needed.
+    void submit(std::function<void()> job)
+    {
+        ++mPending;
+        {
+            std::scoped_lock lock(mMutex);
+            mJobs.push_back(std::move(job));
+        }
+
+        if (!mHelper.joinable())
+            mHelper = std::thread([this]() { help(); });
+
+        mJobCondition.notify_one();
+    }
+
+    /// Resume `handle` on the reactor thread, called by the helper thread.
+    void post(std::coroutine_handle<> handle)
+    {
+        {
+            std::scoped_lock lock(mMutex);
+            mPosted.push_back(handle);
+        }
+
+        std::uint64_t value = 1;
+        [[maybe_unused]] auto result = ::write(mEvent, &value, sizeof(value));
+    }
+
+    /// The helper thread, running jobs until the reactor is destroyed.
+    void help()
+    {
+        while (true)
+        {
+            std::function<void()> job{};
+            {
+                std::unique_lock lock(mMutex);
+                mJobCondition.wait(lock, [this]() {
+                    return !mJobs.empty() || mStopping;
+                });
+
+                if (mJobs.empty())
+                    return;
+
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+            }
+
+            job();
+        }
+    }
+};
+#endif
+
+}
+
+#endif
@@ -0,0 +1,515 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_READAHEADSTREAM_HPP_
+#define SCPPL_BINARY_READAHEADSTREAM_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <ios>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+
+namespace scppl {
+
+/// How a `ReadAheadStream` prefetches from its source.
+struct ReadAheadOptions
+{
+    /// The size of every block read from the source in bytes.
+    std::size_t blockSize = std::size_t{1} << 20;
+
+    /// The amount of blocks, including the one being consumed. [`2`]
+    std::size_t depth = 2;
+};
+
+/**
+ * @brief A read-only stream that reads ahead on a background thread.
+ *
+ * @details A worker thread reads the source in blocks of `blockSize` bytes
+ *          into a ring of `depth` buffers, while the consumer reads from the
+ *          oldest filled block. With the default depth of `2` the next block
+ *          is read while the current one is decoded. It is a
+ *          @ref scppl::SpanSource, so @ref scppl::BinaryStream unpacks values
+ *          straight from the blocks. Values that cross the end of a block are
+ *          copied into a small carry buffer first.
+ *
+ *          Exceptions thrown by the source are stored and rethrown by the
+ *          consumer once it has read every block before the error. The
+ *          destructor stops and joins the worker, which waits for a read that
+ *          is still in progress.
+ *
+ *          The source must not be used by anything else while this stream
+ *          exists. The read position is available when the source is a
+ *          @ref scppl::SeekableSource, seeking stops the worker, seeks the
+ *          source and starts reading ahead again.
+ *
+ * @tparam SourceT  The source to read from, must have a `read(data, length)`.
+ * @tparam ByteT    The byte type of the source.
+ *                  [`scppl::StreamByteT<SourceT>`]
+ */
+template<typename SourceT, typename ByteT = StreamByteT<SourceT>>
+class ReadAheadStream
+{
+public:
+    /// The source type of this `ReadAheadStream` instance.
+    using Source = SourceT;
+
+    /// The byte type of this `ReadAheadStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `ReadAheadStream` constructor, starting the worker thread.
+     *
+     * @param source   The source to read from.
+     * @param options  The block size and depth. [`{}`]
+     */
+    explicit ReadAheadStream(Source& source, ReadAheadOptions options = {}) :
+        mSource(source),
+        mBlocks(std::max<std::size_t>(options.depth, 1))
+    {
+        for (Block& block : mBlocks)
+            block.data.resize(std::max<std::size_t>(options.blockSize, 1));
+
+        if constexpr(SeekableSource<Source>)
+        {
+            mPosition = static_cast<std::size_t>(mSource.tellg());
+        }
+
+        start();
+    }
+
+    ReadAheadStream(ReadAheadStream const&) = delete;
+    ReadAheadStream(ReadAheadStream&&) = delete;
+
+    /// Stops and joins the worker thread.
+    ~ReadAheadStream() noexcept
+    {
+        stop();
+    }
+
+    auto operator=(ReadAheadStream const&) -> ReadAheadStream& = delete;
+    auto operator=(ReadAheadStream&&) -> ReadAheadStream& = delete;
+
+    /**
+     * @brief Read bytes from the current position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @throws Any exception thrown by the source.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t count = 0;
+        while (count < length)
+        {
+            std::span<Byte const> available = acquire(1);
+            if (std::ranges::empty(available))
+                break;
+
+            std::size_t part = std::min(std::ranges::size(available),
+                                        length - count);
+            std::memcpy(data + count, std::ranges::data(available),
+                        part * sizeof(Byte));
+            commit(part);
+
+            count += part;
+        }
+
+        mEof = (count < length);
+
+        return count;
+    }
+
+    /**
+     * @brief Get the bytes from the current position without consuming them,
+     *        waiting for the worker when needed.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws Any exception thrown by the source.
+     *
+     * @return At least `length` bytes, less at the end.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    {
+        if (carried() == 0)
+        {
+            Block const* block = front();
+            if (block == nullptr)
+            {
+                mEof = (length > 0);
+
+                return {};
+            }
+
+            if (block->length - mOffset >= length)
+            {
+                mEof = false;
+
+                return std::span<Byte const>(block->data)
+                    .subspan(mOffset, block->length - mOffset);
+            }
+
+            mCarry.clear();
+            mCarryOffset = 0;
+        }
+
+        // The value crosses the end of a block, copy it into the carry buffer
+        while (carried() < length)
+        {
+            Block const* block = front();
+            if (block == nullptr)
+                break;
+
+            std::size_t part = std::min(block->length - mOffset,
+                                        length - carried());
+            mCarry.insert(std::ranges::end(mCarry),
+                          std::ranges::begin(block->data) + mOffset,
+                          std::ranges::begin(block->data) + mOffset + part);
+
+            mOffset += part;
+            if (mOffset == block->length)
+                pop();
+        }
+
+        mEof = (carried() < length);
+
+        return std::span<Byte const>(mCarry).subspan(mCarryOffset);
+    }
+
+    /**
+     * @brief Consume bytes of the last `acquire()`.
+     *
+     * @param length  The amount of bytes to consume.
+     */
+    void commit(std::size_t length)
+    {
+        if (length == 0)
+            return;
+
+        mPosition += length;
+
+        if (carried() > 0)
+        {
+            mCarryOffset += length;
+
+            return;
+        }
+
+        // The oldest block is filled, it was returned by `acquire()`. It is
+        // given back by the next `front()`, so the span stays valid until then
+        mOffset += length;
+    }
+
+    /// Get the read position.
+    auto tellg() const
+        -> std::size_t
+    requires(SeekableSource<Source>)
+    {
+        return mPosition;
+    }
+
+    /**
+     * @brief Stop reading ahead, move the read position of the source and
+     *        start reading ahead from there.
+     *
+     * @details Forward seeks to a position that is already read ahead only
+     *          skip over the buffered bytes, without stopping the thread.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    requires(SeekableSource<Source>)
+    {
+        if (direction != std::ios::end)
+        {
+            std::streamoff target = offset;
+            if (direction == std::ios::cur)
+                target += static_cast<std::streamoff>(mPosition);
+
+            auto position = static_cast<std::streamoff>(mPosition);
+            if (target >= position &&
+                skipBuffered(static_cast<std::size_t>(target - position)))
+            {
+                mEof = false;
+
+                return;
+            }
+        }
+
+        stop();
+
+        if constexpr(requires(Source& source) { source.clear(); })
+        {
+            mSource.clear();
+        }
+
+        if (direction == std::ios::cur)
+            mSource.seekg(static_cast<std::streamoff>(mPosition) + offset,
+                          std::ios::beg);
+        else
+            mSource.seekg(offset, direction);
+
+        mPosition = static_cast<std::size_t>(mSource.tellg());
+        start();
+    }
+
+    /// Whether the last read reached the end of the source.
+    auto eof() const -> bool { return mEof; }
+
+    /// The source this stream reads from.
+    auto source() const -> Source& { return mSource; }
+
+private:
+    /// A buffer filled by the worker.
+    struct Block
+    {
+        std::vector<Byte> data{};
+        std::size_t length{};
+        bool last{};
+    };
+
+    Source& mSource;
+
+    std::vector<Block> mBlocks{};
+    std::size_t mHead{};
+    std::size_t mFilled{};
+    bool mDone{};
+    bool mStopping{};
+    std::exception_ptr mError{};
+
+    std::mutex mMutex{};
+    std::condition_variable mFilledCondition{};
+    std::condition_variable mFreeCondition{};
+    std::thread mWorker{};
+
+    std::size_t mOffset{};
+    std::vector<Byte> mCarry{};
+    std::size_t mCarryOffset{};
+
+    std::size_t mPosition{};
+    bool mEof{};
+
+    /// The amount of bytes left in the carry buffer.
+    auto carried() const
+        -> std::size_t
+    {
+        return std::ranges::size(mCarry) - mCarryOffset;
+    }
+
+    /// Skip `length` bytes if they are all read ahead, `false` otherwise.
+    auto skipBuffered(std::size_t length)
+        -> bool
+    {
+        if (carried() > 0)
+        {
+            if (carried() < length)
+                return false;
+
+            mCarryOffset += length;
+            mPosition += length;
+
+            return true;
+        }
+
+        std::scoped_lock lock(mMutex);
+
+        std::size_t available = 0;
+        for (std::size_t i = 0; i < mFilled; ++i)
+        {
+            std::size_t index = (mHead + i) % std::ranges::size(mBlocks);
+            available += mBlocks[index].length;
+        }
+        if (available - std::min(available, mOffset) < length)
+            return false;
+
+        mPosition += length;
+        while (true)
+        {
+            std::size_t part = std::min(mBlocks[mHead].length - mOffset,
+                                        length);
+            mOffset += part;
+            length -= part;
+            if (length == 0)
+                return true;
+
+            // The whole block is skipped, there is a filled one after it
+            mHead = (mHead + 1) % std::ranges::size(mBlocks);
+            --mFilled;
+            mOffset = 0;
+
+            mFreeCondition.notify_one();
+        }
+    }
+
+    /// Wait for the oldest block, `nullptr` at the end of the source.
+    auto front()
+        -> Block const*
+    {
+        std::unique_lock lock(mMutex);
+        if (mFilled > 0 && mOffset == mBlocks[mHead].length &&
+            !mBlocks[mHead].last)
+        {
+            mHead = (mHead + 1) % std::ranges::size(mBlocks);
+            --mFilled;
+            mOffset = 0;
+
+            mFreeCondition.notify_one();
+        }
+
+        mFilledCondition.wait(lock, [this]() { return mFilled > 0 || mDone; });
+
+        if (mFilled == 0)
+        {
+            if (mError)
+                std::rethrow_exception(std::exchange(mError, nullptr));
+
+            return nullptr;
+        }
+
+        Block const& block = mBlocks[mHead];
+        if (mOffset == block.length)
+            return nullptr;
+
+        return &block;
+    }
+
+    /// Give the oldest block back to the worker, unless it is the last one.
+    void pop()
+    {
+        std::scoped_lock lock(mMutex);
+        if (mBlocks[mHead].last)
+            return;
+
+        mHead = (mHead + 1) % std::ranges::size(mBlocks);
+        --mFilled;
+        mOffset = 0;
+
+        mFreeCondition.notify_one();
+    }
+
+    /// Reset the blocks and start the worker thread.
+    void start()
+    {
+        mHead = 0;
+        mFilled = 0;
+        mDone = false;
+        mStopping = false;
+        mError = nullptr;
+
+        mOffset = 0;
+        mCarry.clear();
+        mCarryOffset = 0;
+        mEof = false;
+
+        mWorker = std::thread([this]() { work(); });
+    }
+
+    /// Stop and join the worker thread.
+    void stop() noexcept
+    {
+        {
+            std::scoped_lock lock(mMutex);
+            mStopping = true;
+        }
+
+        mFreeCondition.notify_one();
+        if (mWorker.joinable())
+            mWorker.join();
+    }
+
+    /// The worker, filling free blocks until the end of the source.
+    void work()
+    {
+        while (true)
+        {
+            Block* block = nullptr;
+            {
+                std::unique_lock lock(mMutex);
+                mFreeCondition.wait(lock, [this]() {
+                    return mFilled < std::ranges::size(mBlocks) || mStopping;
+                });
+
+                if (mStopping)
+                    return;
+
+                // Only the consumer touches filled blocks
+                std::size_t index = (mHead + mFilled) %
+                                    std::ranges::size(mBlocks);
+                block = &mBlocks[index];
+            }
+
+            try
+            {
+                block->length = readSource(std::ranges::data(block->data),
+                                           std::ranges::size(block->data));
+                block->last = (block->length < std::ranges::size(block->data));
+            }
+            catch (...)
+            {
+                std::scoped_lock lock(mMutex);
+                mError = std::current_exception();
+                mDone = true;
+                mFilledCondition.notify_one();
+
+                return;
+            }
+
+            std::scoped_lock lock(mMutex);
+            ++mFilled;
+            mDone = block->last;
+            mFilledCondition.notify_one();
+
+            if (mDone)
+                return;
+        }
+    }
+
+    /// Read from the source, returning the amount of bytes read.
+    auto readSource(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        using Result = decltype(mSource.read(data, length));
+        if constexpr(std::is_integral_v<Result>)
+        {
+            return static_cast<std::size_t>(mSource.read(data, length));
+        }
+        else if constexpr(requires(Source& source) { source.gcount(); })
+        {
+            mSource.read(data, length);
+            return static_cast<std::size_t>(mSource.gcount());
+        }
+        else
+        {
+            mSource.read(data, length);
+            return length;
+        }
+    }
+};
+
+/// An alias for `BinaryStream` reading through a `ReadAheadStream`.
+template<typename SourceT, std::endian tEndian = std::endian::native>
+using ReadAheadBinaryStream = BinaryStream<tEndian, true,
+                                           ReadAheadStream<SourceT>>;
+
+}
+
+#endif
@@ -0,0 +1,323 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_SPANSTREAM_HPP_
+#define SCPPL_BINARY_SPANSTREAM_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <ios>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "scppl/binary/BinaryStream.hpp"
+
+namespace scppl {
+
+/**
+ * @brief A read-only stream over an existing span of bytes.
+ *
+ * @details The bytes are not copied, the span must outlive the stream. Every
+ *          read is bounds checked once and then copied with `std::memcpy`,
+ *          there are no virtual functions involved. It is also a
+ *          @ref scppl::SpanSource, so the bytes can be used without copying.
+ *
+ * @tparam ByteT  The byte type. [`char`]
+ */
+template<typename ByteT = char>
+class SpanStream
+{
+public:
+    /// The byte type of this `SpanStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `SpanStream` constructor.
+     *
+     * @param data  The bytes to read from.
+     */
+    explicit SpanStream(std::span<Byte const> data) :
+        mData(data)
+    {
+        //
+    }
+
+    /**
+     * @brief Read bytes from the current position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t count = std::min(length, remaining());
+        if (count > 0)
+        {
+            std::memcpy(data, std::ranges::data(mData) + mPosition,
+                        count * sizeof(Byte));
+        }
+
+        mPosition += count;
+        mEof = (count < length);
+
+        return count;
+    }
+
+    /**
+     * @brief Get the bytes from the current position without consuming them.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @return All remaining bytes, less than `length` at the end.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte const>
+    {
+        mEof = (remaining() < length);
+
+        return mData.subspan(mPosition);
+    }
+
+    /**
+     * @brief Consume bytes from the current position.
+     *
+     * @param length  The amount of bytes to consume, at most `remaining()`.
+     */
+    void commit(std::size_t length)
+    {
+        mPosition += length;
+    }
+
+    /**
+     * @brief Read bytes at an offset, without using the position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     * @param offset  The offset in the span to read from.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto readAt(Byte* data, std::size_t length, std::size_t offset) const
+        -> std::size_t
+    {
+        if (offset >= std::ranges::size(mData))
+            return 0;
+
+        std::size_t count = std::min(length, std::ranges::size(mData) - offset);
+        if (count > 0)
+        {
+            std::memcpy(data, std::ranges::data(mData) + offset,
+                        count * sizeof(Byte));
+        }
+
+        return count;
+    }
+
+    /// Get the read position.
+    auto tellg() const -> std::size_t { return mPosition; }
+
+    /**
+     * @brief Move the read position, clamped to the size of the span.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        mPosition = seekPosition(mPosition, std::ranges::size(mData),
+                                 offset, direction);
+        mEof = false;
+    }
+
+    /// Whether the last read reached the end of the span.
+    auto eof() const -> bool { return mEof; }
+
+    /// The amount of bytes left to read.
+    auto remaining() const -> std::size_t
+    {
+        return std::ranges::size(mData) - mPosition;
+    }
+
+    /// The span this stream reads from.
+    auto data() const -> std::span<Byte const> { return mData; }
+
+private:
+    std::span<Byte const> mData{};
+    std::size_t mPosition{};
+    bool mEof{};
+
+    template<typename> friend class BufferStream;
+
+    static auto seekPosition(std::size_t position, std::size_t size,
+                             std::streamoff offset, std::ios::seekdir direction)
+        -> std::size_t
+    {
+        std::streamoff base = 0;
+        if (direction == std::ios::cur)
+            base = static_cast<std::streamoff>(position);
+        else if (direction == std::ios::end)
+            base = static_cast<std::streamoff>(size);
+
+        return static_cast<std::size_t>(
+            std::clamp<std::streamoff>(base + offset, 0,
+                                       static_cast<std::streamoff>(size)));
+    }
+};
+
+/**
+ * @brief A growable in-memory stream.
+ *
+ * @details Like `std::basic_stringstream`, this stream has separate read and
+ *          write positions. Writing past the end grows the buffer, reading is
+ *          bounds checked once per call.
+ *
+ * @tparam ByteT  The byte type. [`char`]
+ */
+template<typename ByteT = char>
+class BufferStream
+{
+public:
+    /// The byte type of this `BufferStream` instance.
+    using Byte = ByteT;
+
+    /// The default constructor, starting with an empty buffer.
+    BufferStream() = default;
+
+    /**
+     * @brief The `BufferStream` constructor.
+     *
+     * @param data  The initial contents of the buffer.
+     */
+    explicit BufferStream(std::vector<Byte> data) :
+        mData(std::move(data))
+    {
+        //
+    }
+
+    /**
+     * @brief Read bytes from the current read position.
+     *
+     * @param data    Where to store the read bytes.
+     * @param length  The amount of bytes to read.
+     *
+     * @return The amount of bytes read, less than `length` at the end.
+     */
+    auto read(Byte* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t count = std::min(length, std::ranges::size(mData) - mRead);
+        if (count > 0)
+        {
+            std::memcpy(data, std::ranges::data(mData) + mRead,
+                        count * sizeof(Byte));
+        }
+
+        mRead += count;
+        mEof = (count < length);
+
+        return count;
+    }
+
+    /**
+     * @brief Write bytes at the current write position, growing the buffer
+     *        when needed.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        // `data` may be null for empty writes, which `std::memcpy` does not allow
+        if (length == 0)
+            return;
+
+        if (mWrite + length > std::ranges::size(mData))
+            mData.resize(mWrite + length);
+
+        std::memcpy(std::ranges::data(mData) + mWrite, data,
+                    length * sizeof(Byte));
+
+        mWrite += length;
+    }
+
+    /// Get the read position.
+    auto tellg() const -> std::size_t { return mRead; }
+
+    /// Get the write position.
+    auto tellp() const -> std::size_t { return mWrite; }
+
+    /**
+     * @brief Move the read position, clamped to the size of the buffer.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekg(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        mRead = SpanStream<Byte>::seekPosition(mRead, std::ranges::size(mData),
+                                               offset, direction);
+        mEof = false;
+    }
+
+    /**
+     * @brief Move the write position, clamped to the size of the buffer.
+     *
+     * @param offset     The amount of bytes to seek from `direction`.
+     * @param direction  The direction to seek from. [`std::ios::beg`]
+     */
+    void seekp(std::streamoff offset,
+               std::ios::seekdir direction = std::ios::beg)
+    {
+        mWrite = SpanStream<Byte>::seekPosition(mWrite,
+                                                std::ranges::size(mData),
+                                                offset, direction);
+    }
+
+    /// Whether the last read reached the end of the buffer.
+    auto eof() const -> bool { return mEof; }
+
+    /// A view of the whole buffer.
+    auto data() const -> std::span<Byte const> { return mData; }
+
+    /**
+     * @brief Take the buffer out of the stream, leaving it empty.
+     *
+     * @return The buffer.
+     */
+    auto release()
+        -> std::vector<Byte>
+    {
+        mRead = 0;
+        mWrite = 0;
+        mEof = false;
+
+        return std::exchange(mData, {});
+    }
+
+private:
+    std::vector<Byte> mData{};
+    std::size_t mRead{};
+    std::size_t mWrite{};
+    bool mEof{};
+};
+
+/// An alias for `BinaryStream` reading from a `SpanStream`.
+template<std::endian tEndian = std::endian::native>
+using SpanBinaryStream = BinaryStream<tEndian, true, SpanStream<>>;
+
+/// An alias for `BinaryStream` using a `BufferStream`.
+template<std::endian tEndian = std::endian::native, bool tSynchronized = true>
+using BufferBinaryStream = BinaryStream<tEndian, tSynchronized,
+                                        BufferStream<>>;
+
+}
+
+#endif
@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_TASK_HPP_
+#define SCPPL_BINARY_TASK_HPP_
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace scppl {
+
+template<typename T> class Task;
+
+/// The promise parts shared by every `Task`.
+class TaskPromiseBase
+{
+public:
+    /// Resumes the awaiting coroutine when the task is finished.
+    struct FinalAwaiter
+    {
+        auto await_ready() const noexcept -> bool { return false; }
+
+        template<typename PromiseT>
+        auto await_suspend(std::coroutine_handle<PromiseT> handle) noexcept
+            -> std::coroutine_handle<>
+        {
+            return handle.promise().mContinuation;
+        }
+
+        void await_resume() const noexcept
+        {
+            //
+        }
+    };
+
+    /// Tasks are lazy, they start when they are awaited.
+    auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+
+    /// Continue with the awaiting coroutine.
+    auto final_suspend() const noexcept -> FinalAwaiter { return {}; }
+
+    /// Store the exception, it is rethrown in the awaiting coroutine.
+    void unhandled_exception() noexcept
+    {
+        mError = std::current_exception();
+    }
+
+    /// Set the coroutine to resume when the task is finished.
+    void continueWith(std::coroutine_handle<> continuation)
+    {
+        mContinuation = continuation;
+    }
+
+protected:
+    std::coroutine_handle<> mContinuation{std::noop_coroutine()};
+    std::exception_ptr mError{};
+
+    /// Rethrow the exception of the task, if there is one.
+    void rethrow() const
+    {
+        if (mError)
+            std::rethrow_exception(mError);
+    }
+};
+
+/// The promise of a `Task` returning a value.
+template<typename T>
+class TaskPromise : public TaskPromiseBase
+{
+public:
+    auto get_return_object() -> Task<T>;
+
+    void return_value(T value)
+    {
+        mValue.emplace(std::move(value));
+    }
+
+    /// Get the value, or rethrow the exception of the task.
+    auto result()
+        -> T
+    {
+        rethrow();
+
+        return std::move(*mValue);
+    }
+
+private:
+    std::optional<T> mValue{};
+};
+
+/// The promise of a `Task` without a value.
+template<>
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+    auto get_return_object() -> Task<void>;
+
+    void return_void() const noexcept
+    {
+        //
+    }
+
+    /// Rethrow the exception of the task.
+    void result() const
+    {
+        rethrow();
+    }
+};
+
+/**
+ * @brief A lazily started coroutine returning a `T`.
+ *
+ * @details The coroutine starts when the task is awaited with `co_await`, and
+ *          the awaiting coroutine continues when it is finished, with its
+ *          value or exception. Finished tasks transfer straight to the
+ *          awaiting coroutine, so long chains of tasks do not grow the stack.
+ *
+ *          Tasks that are not awaited by another coroutine are started with
+ *          `start()`, for example by a @ref scppl::Reactor.
+ *
+ * @tparam T  The type of the value. [`void`]
+ */
+template<typename T = void>
+class Task
+{
+public:
+    /// The promise type of this `Task` instance.
+    using promise_type = TaskPromise<T>;
+
+    /// Awaits the task, starting it first.
+    struct Awaiter
+    {
+        std::coroutine_handle<promise_type> handle{};
+
+        auto await_ready() const noexcept -> bool { return handle.done(); }
+
+        auto await_suspend(std::coroutine_handle<> continuation) noexcept
+            -> std::coroutine_handle<>
+        {
+            handle.promise().continueWith(continuation);
+
+            return handle;
+        }
+
+        auto await_resume() -> T { return handle.promise().result(); }
+    };
+
+    Task(Task const&) = delete;
+
+    Task(Task&& other) noexcept :
+        mHandle(std::exchange(other.mHandle, nullptr))
+    {
+        //
+    }
+
+    /// Destroys the coroutine frame.
+    ~Task()
+    {
+        if (mHandle)
+            mHandle.destroy();
+    }
+
+    auto operator=(Task const&) -> Task& = delete;
+
+    auto operator=(Task&& other) noexcept
+        -> Task&
+    {
+        if (this != &other)
+        {
+            if (mHandle)
+                mHandle.destroy();
+
+            mHandle = std::exchange(other.mHandle, nullptr);
+        }
+
+        return *this;
+    }
+
+    auto operator co_await() const noexcept -> Awaiter { return {mHandle}; }
+
+    /// Start the coroutine without awaiting it.
+    void start() const { mHandle.resume(); }
+
+    /// Whether the coroutine has finished.
+    auto done() const -> bool { return mHandle.done(); }
+
+    /// Get the value of a finished task, or rethrow its exception.
+    auto result() const -> T { return mHandle.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> mHandle{};
+
+    friend promise_type;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) :
+        mHandle(handle)
+    {
+        //
+    }
+};
+
+template<typename T>
+auto TaskPromise<T>::get_return_object()
+    -> Task<T>
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline auto TaskPromise<void>::get_return_object()
+    -> Task<void>
+{
+    return Task<void>(
+        std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+}
+
+#endif
@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_TEESTREAM_HPP_
+#define SCPPL_BINARY_TEESTREAM_HPP_
+
+#include <bit>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <tuple>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+#include "scppl/binary/WriteBuffer.hpp"
+
+namespace scppl {
+
+/// How a `TeeStream` buffers writes.
+struct TeeOptions
+{
+    /// The size of the buffer in bytes, writes at least this large bypass it.
+    std::size_t capacity = std::size_t{1} << 16;
+
+    /// Flush the buffer when the stream is destroyed.
+    bool flushOnDestroy = true;
+};
+
+/**
+ * @brief A write-only stream that writes the same bytes to multiple sinks.
+ *
+ * @details Writes are copied into a single buffer, which is written to every
+ *          sink in order when it is full, when `flush()` is called or when the
+ *          stream is destroyed. It is a @ref scppl::SpanSink, so
+ *          @ref scppl::BinaryStream packs values once, straight into the
+ *          buffer, instead of once per sink.
+ *
+ *          Every sink is only written to with whole buffers, so a sink is not
+ *          touched while values are packed. A slow sink, like a network
+ *          connection, can be wrapped in a @ref scppl::WriteBehindStream to
+ *          write it on a background thread, the other sinks then do not wait
+ *          for it.
+ *
+ *          When a sink throws, the buffer is still written to the other sinks
+ *          and the first exception is rethrown afterwards.
+ *
+ * @code{.cpp}
+ * scppl::WriteBehindStream<Socket> replica(socket);
+ * scppl::TeeStream tee(file, replica);
+ * scppl::TeeBinaryStream<std::endian::big, scppl::FileStream<>,
+ *                        scppl::WriteBehindStream<Socket>> stream(tee);
+ * @endcode
+ *
+ * @tparam SinkTs  The sinks to write to, must have a `write(data, length)`
+ *                 and the same byte type.
+ */
+template<typename... SinkTs>
+requires(sizeof...(SinkTs) > 0)
+class TeeStream
+{
+public:
+    /// The byte type of this `TeeStream` instance.
+    using Byte = StreamByteT<std::tuple_element_t<0, std::tuple<SinkTs...>>>;
+
+    /**
+     * @brief The `TeeStream` constructor.
+     *
+     * @param sinks  The sinks to write to, in order.
+     */
+    explicit TeeStream(SinkTs&... sinks) :
+        TeeStream(TeeOptions{}, sinks...)
+    {
+        //
+    }
+
+    /**
+     * @brief The `TeeStream` constructor.
+     *
+     * @param options  The buffer size.
+     * @param sinks    The sinks to write to, in order.
+     */
+    explicit TeeStream(TeeOptions options, SinkTs&... sinks) :
+        mSinks(sinks...),
+        mOptions(options),
+        mBuffer(options.capacity)
+    {
+        //
+    }
+
+    TeeStream(TeeStream const&) = delete;
+    TeeStream(TeeStream&&) = delete;
+
+    /// Flushes the buffer, if `flushOnDestroy` is set.
+    ~TeeStream() noexcept
+    {
+        if (!mOptions.flushOnDestroy)
+            return;
+
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `flush()` for that
+        }
+    }
+
+    auto operator=(TeeStream const&) -> TeeStream& = delete;
+    auto operator=(TeeStream&&) -> TeeStream& = delete;
+
+    /**
+     * @brief Write bytes into the buffer.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     *
+     * @throws Any exception thrown by a sink.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        if (mBuffer.bypasses(length))
+        {
+            drain();
+            forward(data, length);
+
+            return;
+        }
+
+        std::memcpy(std::ranges::data(acquire(length)), data,
+                    length * sizeof(Byte));
+        commit(length);
+    }
+
+    /**
+     * @brief Get space at the end of the buffer, draining it first when
+     *        `length` bytes do not fit.
+     *
+     * @details A `length` larger than the buffer grows it until the bytes are
+     *          committed, they are then written to the sinks right away.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws Any exception thrown by a sink.
+     *
+     * @return The free space in the buffer, at least `length` bytes.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte>
+    {
+        if (!mBuffer.fits(length))
+            drain();
+
+        return mBuffer.acquire(length);
+    }
+
+    /**
+     * @brief Mark bytes of the last `acquire()` as written.
+     *
+     * @param length  The amount of bytes written.
+     *
+     * @throws Any exception thrown by a sink.
+     */
+    void commit(std::size_t length)
+    {
+        mBuffer.commit(length);
+
+        if (mBuffer.oversized())
+            drain();
+    }
+
+    /**
+     * @brief Write the buffer to every sink, and flush the sinks that have a
+     *        `flush()` function.
+     *
+     * @throws Any exception thrown by a sink.
+     */
+    void flush()
+    {
+        drain();
+
+        std::exception_ptr error{};
+        std::apply([&error](SinkTs&... sinks) {
+            (call(error, [&sinks]() {
+                 if constexpr(requires { sinks.flush(); })
+                 {
+                     sinks.flush();
+                 }
+             }), ...);
+        }, mSinks);
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /// Get the write position, the amount of bytes written so far.
+    auto tellp() const -> std::size_t { return mWritten + mBuffer.size(); }
+
+    /// The amount of bytes in the buffer.
+    auto buffered() const -> std::size_t { return mBuffer.size(); }
+
+    /// The sink at `tIndex`.
+    template<std::size_t tIndex>
+    auto sink() const -> auto& { return std::get<tIndex>(mSinks); }
+
+private:
+    std::tuple<SinkTs&...> mSinks;
+    TeeOptions mOptions{};
+
+    WriteBuffer<Byte> mBuffer;
+    std::size_t mWritten{};
+
+    /// Call `function`, storing the first exception in `error`.
+    template<typename Function>
+    static void call(std::exception_ptr& error, Function&& function)
+    {
+        try
+        {
+            function();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    /// Write the buffer to every sink.
+    void drain()
+    {
+        std::span<Byte const> data = mBuffer.data();
+        if (std::ranges::empty(data))
+            return;
+
+        // Not written again after an exception, the other sinks have it
+        try
+        {
+            forward(std::ranges::data(data), std::ranges::size(data));
+        }
+        catch (...)
+        {
+            mBuffer.clear();
+            throw;
+        }
+
+        mBuffer.clear();
+    }
+
+    /// Write `length` bytes to every sink, in order.
+    void forward(Byte const* data, std::size_t length)
+    {
+        std::exception_ptr error{};
+        std::apply([&error, data, length](SinkTs&... sinks) {
+            (call(error, [&sinks, data, length]() {
+                 sinks.write(data, length);
+             }), ...);
+        }, mSinks);
+
+        mWritten += length;
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+/// An alias for `BinaryStream` writing through a `TeeStream`.
+template<std::endian tEndian, typename... SinkTs>
+using TeeBinaryStream = BinaryStream<tEndian, true, TeeStream<SinkTs...>>;
+
+}
+
+#endif
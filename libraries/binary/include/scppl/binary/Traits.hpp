@@ -63,6 +63,46 @@ struct UnpackableTrait<T> : UnpackableTrait<std::ranges::range_value_t<T>> {};
 
 /** @} */
 
+/**
+ * @defgroup scpplStreamByteTrait scppl::StreamByteTrait
+ *
+ * @brief Trait for the byte type of a stream.
+ *
+ * @details The byte type of a stream is:
+ *          - `StreamT::Byte` if it exists.
+ *          - `StreamT::char_type` if it exists, like for iostreams.
+ *          - `char` otherwise.
+ *
+ * @{
+ */
+
+template<typename StreamT>
+struct StreamByteTrait
+{
+    using type = char;
+};
+
+template<typename StreamT>
+requires requires { typename StreamT::Byte; }
+struct StreamByteTrait<StreamT>
+{
+    using type = typename StreamT::Byte;
+};
+
+template<typename StreamT>
+requires(requires { typename StreamT::char_type; } &&
+         !requires { typename StreamT::Byte; })
+struct StreamByteTrait<StreamT>
+{
+    using type = typename StreamT::char_type;
+};
+
+/// A shortcut for `StreamByteTrait<StreamT>::type`.
+template<typename StreamT>
+using StreamByteT = typename StreamByteTrait<StreamT>::type;
+
+/** @} */
+
 }
 
 #endif
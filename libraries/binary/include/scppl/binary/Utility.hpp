@@ -5,7 +5,12 @@
 #ifndef SCPPL_BINARY_UTILITY_HPP_
 #define SCPPL_BINARY_UTILITY_HPP_
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 namespace scppl {
 
@@ -26,6 +31,26 @@ constexpr auto lengthOf()
     return (sizeof(Ts) + ...);
 }
 
+/**
+ * @brief Reverses the bytes of a scalar value.
+ *
+ * @tparam T  The type of the value, must be a scalar type.
+ *
+ * @param value  The value to reverse the bytes of.
+ *
+ * @return The value with its bytes reversed.
+ */
+template<typename T>
+requires(std::is_scalar_v<T>)
+constexpr auto byteSwap(T value)
+    -> T
+{
+    auto raw = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+    std::ranges::reverse(raw);
+
+    return std::bit_cast<T>(raw);
+}
+
 }
 
 #endif
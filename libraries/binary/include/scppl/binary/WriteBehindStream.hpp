@@ -0,0 +1,388 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_WRITEBEHINDSTREAM_HPP_
+#define SCPPL_BINARY_WRITEBEHINDSTREAM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/Concepts.hpp"
+#include "scppl/binary/Traits.hpp"
+
+namespace scppl {
+
+/// What a `WriteBehindStream` does when every buffer is waiting to be written.
+enum class Backpressure
+{
+    /// Wait for the writer thread to free a buffer.
+    Block,
+
+    /// Throw away the full buffer and count the bytes in `dropped()`. Writes
+    /// are not split over buffers then, so only whole writes are dropped.
+    Drop,
+
+    /// Keep appending to the current buffer until a buffer is free.
+    Grow
+};
+
+/// How a `WriteBehindStream` buffers and hands off writes.
+struct WriteBehindOptions
+{
+    /// The size of a buffer in bytes, a full buffer is handed to the writer.
+    std::size_t bufferSize = std::size_t{1} << 20;
+
+    /// The amount of buffers that can wait for the writer.
+    std::size_t depth = 4;
+
+    /// What to do when every buffer is waiting for the writer.
+    Backpressure backpressure = Backpressure::Block;
+};
+
+/**
+ * @brief A write-only stream that writes to its sink on a background thread.
+ *
+ * @details Writes are copied into the current buffer, which is handed to a
+ *          writer thread once it holds `bufferSize` bytes. Full buffers wait
+ *          in a bounded single-producer single-consumer ring of `depth`
+ *          buffers, which only uses atomics, so a write never waits for a
+ *          lock or for the sink. When the ring is full the
+ *          @ref scppl::Backpressure option decides whether to wait, drop the
+ *          buffer or let the current buffer grow. It is a
+ *          @ref scppl::SpanSink, so @ref scppl::BinaryStream packs values
+ *          straight into the current buffer.
+ *
+ *          `sync()` waits until everything written so far has reached the
+ *          sink. Exceptions thrown by the sink stop the writer, they are
+ *          rethrown by the next `write`, `flush` or `sync`. The destructor
+ *          writes the remaining buffers and joins the writer.
+ *
+ *          Only one thread may write to this stream, and the sink must not be
+ *          used by anything else while it exists.
+ *
+ * @tparam SinkT  The sink to write to, must have a `write(data, length)`.
+ * @tparam ByteT  The byte type of the sink. [`scppl::StreamByteT<SinkT>`]
+ */
+template<typename SinkT, typename ByteT = StreamByteT<SinkT>>
+class WriteBehindStream
+{
+public:
+    /// The sink type of this `WriteBehindStream` instance.
+    using Sink = SinkT;
+
+    /// The byte type of this `WriteBehindStream` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `WriteBehindStream` constructor, starting the writer thread.
+     *
+     * @param sink     The sink to write to.
+     * @param options  The buffer size, depth and backpressure. [`{}`]
+     */
+    explicit WriteBehindStream(Sink& sink, WriteBehindOptions options = {}) :
+        mSink(sink),
+        mOptions(options),
+        mBuffers(std::max<std::size_t>(options.depth, 1))
+    {
+        mOptions.bufferSize = std::max<std::size_t>(mOptions.bufferSize, 1);
+        mCurrent.data.resize(mOptions.bufferSize);
+
+        mWriter = std::thread([this]() { work(); });
+    }
+
+    WriteBehindStream(WriteBehindStream const&) = delete;
+    WriteBehindStream(WriteBehindStream&&) = delete;
+
+    /// Writes the remaining buffers and joins the writer thread.
+    ~WriteBehindStream() noexcept
+    {
+        try
+        {
+            submit(Backpressure::Block);
+        }
+        catch (...)
+        {
+            // Destructors can not report errors, use `sync()` for that
+        }
+
+        mStopping.store(true, std::memory_order_release);
+        mSignal.fetch_add(1, std::memory_order_release);
+        mSignal.notify_one();
+
+        mWriter.join();
+    }
+
+    auto operator=(WriteBehindStream const&) -> WriteBehindStream& = delete;
+    auto operator=(WriteBehindStream&&) -> WriteBehindStream& = delete;
+
+    /**
+     * @brief Copy bytes into the current buffer.
+     *
+     * @param data    The bytes to write.
+     * @param length  The amount of bytes to write.
+     *
+     * @throws Any exception thrown by the sink on the writer thread.
+     */
+    void write(Byte const* data, std::size_t length)
+    {
+        // Half of a dropped write would corrupt the framing of the sink
+        if (mOptions.backpressure == Backpressure::Drop)
+        {
+            std::span<Byte> buffer = acquire(length);
+            if (length > 0)
+            {
+                std::memcpy(std::ranges::data(buffer), data,
+                            length * sizeof(Byte));
+            }
+            commit(length);
+
+            return;
+        }
+
+        while (length > 0)
+        {
+            std::span<Byte> buffer = acquire(1);
+            std::size_t part = std::min(std::ranges::size(buffer), length);
+            std::memcpy(std::ranges::data(buffer), data, part * sizeof(Byte));
+            commit(part);
+
+            data += part;
+            length -= part;
+        }
+    }
+
+    /**
+     * @brief Get space in the current buffer.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @throws Any exception thrown by the sink on the writer thread.
+     *
+     * @return The free space in the current buffer, at least `length` bytes.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte>
+    {
+        rethrow();
+
+        // Values are never split, and `Backpressure::Grow` keeps appending
+        std::size_t size = std::ranges::size(mCurrent.data);
+        if (mCurrent.length + length > size)
+            mCurrent.data.resize(std::max(mCurrent.length + length, 2 * size));
+
+        return std::span<Byte>(mCurrent.data).subspan(mCurrent.length);
+    }
+
+    /**
+     * @brief Mark bytes of the last `acquire()` as written, handing the
+     *        buffer to the writer once it is full.
+     *
+     * @param length  The amount of bytes written.
+     */
+    void commit(std::size_t length)
+    {
+        mCurrent.length += length;
+        mPosition += length;
+
+        if (mCurrent.length >= mOptions.bufferSize)
+            submit(mOptions.backpressure);
+    }
+
+    /**
+     * @brief Hand the current buffer to the writer, without waiting for it to
+     *        be written.
+     *
+     * @throws Any exception thrown by the sink on the writer thread.
+     */
+    void flush()
+    {
+        rethrow();
+        submit(Backpressure::Block);
+    }
+
+    /**
+     * @brief Wait until every byte written so far has been written to the
+     *        sink, and flush the sink if it has a `flush()` function.
+     *
+     * @throws Any exception thrown by the sink on the writer thread.
+     */
+    void sync()
+    {
+        flush();
+
+        std::size_t tail = mTail.load(std::memory_order_relaxed);
+        for (std::size_t head = mHead.load(std::memory_order_acquire);
+             head != tail; head = mHead.load(std::memory_order_acquire))
+        {
+            mHead.wait(head, std::memory_order_acquire);
+        }
+
+        rethrow();
+
+        // The writer is waiting for a buffer, the sink can be used here
+        if constexpr(requires(Sink& sink) { sink.flush(); })
+        {
+            mSink.flush();
+        }
+    }
+
+    /// Get the amount of bytes written to this stream, including dropped ones.
+    auto tellp() const -> std::size_t { return mPosition; }
+
+    /// The amount of bytes thrown away because of `Backpressure::Drop`.
+    auto dropped() const -> std::size_t { return mDropped; }
+
+    /// The amount of buffers waiting for the writer.
+    auto pending() const
+        -> std::size_t
+    {
+        return mTail.load(std::memory_order_relaxed) -
+               mHead.load(std::memory_order_relaxed);
+    }
+
+    /// The sink this stream writes to.
+    auto sink() const -> Sink& { return mSink; }
+
+private:
+    /// A buffer and the amount of bytes written to it.
+    struct Buffer
+    {
+        std::vector<Byte> data{};
+        std::size_t length{};
+    };
+
+    Sink& mSink;
+    WriteBehindOptions mOptions{};
+
+    // Only used by the writing thread
+    Buffer mCurrent{};
+    std::size_t mPosition{};
+    std::size_t mDropped{};
+
+    // Buffers `[mHead, mTail)` belong to the writer, the others are free
+    std::vector<Buffer> mBuffers{};
+    alignas(64) std::atomic<std::size_t> mHead{};
+    alignas(64) std::atomic<std::size_t> mTail{};
+    alignas(64) std::atomic<std::uint32_t> mSignal{};
+    std::atomic<bool> mStopping{};
+    std::atomic<bool> mFailed{};
+    std::exception_ptr mError{};
+
+    std::thread mWriter{};
+
+    /// Rethrow an exception of the writer thread.
+    void rethrow() const
+    {
+        if (mFailed.load(std::memory_order_acquire))
+            std::rethrow_exception(mError);
+    }
+
+    /// Bring an empty buffer back to `bufferSize`, after a large write grew it.
+    void resize(Buffer& buffer) const
+    {
+        std::size_t size = std::ranges::size(buffer.data);
+        if (size < mOptions.bufferSize)
+        {
+            buffer.data.resize(mOptions.bufferSize);
+        }
+        else if (size > mOptions.bufferSize)
+        {
+            buffer.data.resize(mOptions.bufferSize);
+            buffer.data.shrink_to_fit();
+        }
+    }
+
+    /// Hand the current buffer to the writer, applying `backpressure`.
+    void submit(Backpressure backpressure)
+    {
+        if (mCurrent.length == 0)
+            return;
+
+        std::size_t tail = mTail.load(std::memory_order_relaxed);
+        std::size_t depth = std::ranges::size(mBuffers);
+        for (std::size_t head = mHead.load(std::memory_order_acquire);
+             tail - head == depth; head = mHead.load(std::memory_order_acquire))
+        {
+            if (backpressure == Backpressure::Drop)
+            {
+                mDropped += mCurrent.length;
+                mCurrent.length = 0;
+                resize(mCurrent);
+
+                return;
+            }
+
+            if (backpressure == Backpressure::Grow)
+                return;
+
+            mHead.wait(head, std::memory_order_acquire);
+        }
+
+        // Swap with the free buffer, so its memory is used again
+        Buffer& slot = mBuffers[tail % depth];
+        std::swap(slot, mCurrent);
+        mCurrent.length = 0;
+        resize(mCurrent);
+
+        mTail.store(tail + 1, std::memory_order_release);
+        mSignal.fetch_add(1, std::memory_order_release);
+        mSignal.notify_one();
+    }
+
+    /// The writer, writing full buffers to the sink in order.
+    void work()
+    {
+        std::size_t head = mHead.load(std::memory_order_relaxed);
+        while (true)
+        {
+            std::uint32_t signal = mSignal.load(std::memory_order_acquire);
+            std::size_t tail = mTail.load(std::memory_order_acquire);
+            if (head == tail)
+            {
+                if (mStopping.load(std::memory_order_acquire))
+                    return;
+
+                mSignal.wait(signal, std::memory_order_acquire);
+                continue;
+            }
+
+            Buffer& buffer = mBuffers[head % std::ranges::size(mBuffers)];
+            if (!mFailed.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    mSink.write(std::ranges::data(buffer.data), buffer.length);
+                }
+                catch (...)
+                {
+                    // Keep freeing buffers, so the writing thread never waits
+                    mError = std::current_exception();
+                    mFailed.store(true, std::memory_order_release);
+                }
+            }
+
+            buffer.length = 0;
+            mHead.store(++head, std::memory_order_release);
+            mHead.notify_one();
+        }
+    }
+};
+
+/// An alias for `BinaryStream` writing through a `WriteBehindStream`.
+template<typename SinkT, std::endian tEndian = std::endian::native>
+using WriteBehindBinaryStream = BinaryStream<tEndian, true,
+                                             WriteBehindStream<SinkT>>;
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef SCPPL_BINARY_WRITEBUFFER_HPP_
+#define SCPPL_BINARY_WRITEBUFFER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace scppl {
+
+/**
+ * @brief The buffer of a stream that collects writes before passing them on,
+ *        like @ref scppl::CoalescingStream and @ref scppl::TeeStream.
+ *
+ * @details Writes at least `capacity()` bytes should bypass the buffer, see
+ *          `bypasses()`. A larger `acquire()` still has to return enough
+ *          space, so the buffer grows for it, but only until the next
+ *          `clear()`. The stream should drain it right after the commit, see
+ *          `oversized()`, so one large value does not keep its memory around
+ *          for the life of the stream.
+ *
+ * @tparam ByteT  The byte type of the buffer.
+ */
+template<typename ByteT>
+class WriteBuffer
+{
+public:
+    /// The byte type of this `WriteBuffer` instance.
+    using Byte = ByteT;
+
+    /**
+     * @brief The `WriteBuffer` constructor.
+     *
+     * @param capacity  The size of the buffer in bytes, at least `1`.
+     */
+    explicit WriteBuffer(std::size_t capacity) :
+        mCapacity(std::max<std::size_t>(capacity, 1)),
+        mData(mCapacity)
+    {
+        //
+    }
+
+    /// Whether a write of `length` bytes should bypass the buffer.
+    auto bypasses(std::size_t length) const -> bool
+    {
+        return length >= mCapacity;
+    }
+
+    /// Whether `length` more bytes fit behind the buffered bytes.
+    auto fits(std::size_t length) const -> bool
+    {
+        return mLength + length <= std::ranges::size(mData);
+    }
+
+    /**
+     * @brief Get space behind the buffered bytes.
+     *
+     * @details Grows the buffer until the next `clear()` when `length` bytes
+     *          do not fit, the stream should drain it first.
+     *
+     * @param length  The amount of bytes needed.
+     *
+     * @return The free space in the buffer, at least `length` bytes.
+     */
+    auto acquire(std::size_t length)
+        -> std::span<Byte>
+    {
+        if (!fits(length))
+            mData.resize(mLength + length);
+
+        return std::span<Byte>(mData).subspan(mLength);
+    }
+
+    /**
+     * @brief Mark bytes of the last `acquire()` as buffered.
+     *
+     * @param length  The amount of bytes written.
+     */
+    void commit(std::size_t length)
+    {
+        mLength += length;
+    }
+
+    /// Whether the buffer grew past its capacity, it should then be drained.
+    auto oversized() const -> bool
+    {
+        return std::ranges::size(mData) > mCapacity;
+    }
+
+    /// Remove the buffered bytes, and shrink the buffer back to its capacity.
+    void clear()
+    {
+        mLength = 0;
+
+        if (oversized())
+        {
+            mData.resize(mCapacity);
+            mData.shrink_to_fit();
+        }
+    }
+
+    /// The buffered bytes.
+    auto data() const -> std::span<Byte const>
+    {
+        return std::span<Byte const>(mData).first(mLength);
+    }
+
+    /// The amount of buffered bytes.
+    auto size() const -> std::size_t { return mLength; }
+
+    /// The size of the buffer in bytes, not counting temporary growth.
+    auto capacity() const -> std::size_t { return mCapacity; }
+
+private:
+    std::size_t mCapacity{};
+
+    std::vector<Byte> mData{};
+    std::size_t mLength{};
+};
+
+}
+
+#endif
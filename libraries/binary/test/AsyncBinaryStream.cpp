@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/AsyncBinaryStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_EPOLL
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// A pair of connected sockets, closed at the end of the test
+class SocketPair
+{
+public:
+    SocketPair()
+    {
+        ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0,
+                     std::ranges::data(mDescriptors));
+    }
+
+    SocketPair(SocketPair const&) = delete;
+    SocketPair(SocketPair&&) = delete;
+
+    ~SocketPair()
+    {
+        ::close(mDescriptors[0]);
+        ::close(mDescriptors[1]);
+    }
+
+    auto operator=(SocketPair const&) -> SocketPair& = delete;
+    auto operator=(SocketPair&&) -> SocketPair& = delete;
+
+    auto first() const -> int { return mDescriptors[0]; }
+    auto second() const -> int { return mDescriptors[1]; }
+
+private:
+    std::array<int, 2> mDescriptors{-1, -1};
+};
+
+using Stream = scppl::AsyncBinaryStream<std::endian::big>;
+
+auto writeMessages(Stream& stream, std::size_t count,
+                   std::vector<char> const& payload)
+    -> scppl::Task<>
+{
+    auto length = static_cast<uint32_t>(std::ranges::size(payload));
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        co_await stream.write(static_cast<uint16_t>(i), length);
+        co_await stream.writeRaw(payload);
+    }
+}
+
+auto readMessages(Stream& stream, std::size_t count)
+    -> scppl::Task<std::size_t>
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto [type, length] = co_await stream.read<uint16_t, uint32_t>();
+        if (type != static_cast<uint16_t>(i))
+            throw std::runtime_error("Wrong message type");
+
+        auto payload = co_await stream.readRaw(length);
+        total += std::ranges::size(payload);
+    }
+
+    co_return total;
+}
+
+}
+
+TEST(AsyncBinaryStream, SocketPair)
+{
+    SocketPair sockets{};
+    scppl::Reactor reactor{};
+    Stream writer(reactor, sockets.first());
+    Stream reader(reactor, sockets.second(), {.bufferSize = 64});
+
+    // Larger than the socket buffer, so both sides have to wait
+    std::vector<char> payload(1 << 20);
+    std::iota(std::ranges::begin(payload), std::ranges::end(payload), 0);
+
+    reactor.spawn(writeMessages(writer, 8, payload));
+    ASSERT_EQ(reactor.run(readMessages(reader, 8)), 8 << 20);
+}
+
+TEST(AsyncBinaryStream, Values)
+{
+    SocketPair sockets{};
+    scppl::Reactor reactor{};
+    Stream writer(reactor, sockets.first());
+    Stream reader(reactor, sockets.second());
+
+    reactor.run(writer.write(A, B, C, D));
+    assertValuesEqual(reactor.run(reader.read<A_t, B_t, C_t, D_t>()),
+                      std::tuple(A, B, C, D));
+
+    reactor.run(writer.write(D));
+    ASSERT_EQ(reactor.run(reader.readSingle<D_t>()), D);
+}
+
+TEST(AsyncBinaryStream, EndOfStream)
+{
+    SocketPair sockets{};
+    scppl::Reactor reactor{};
+    Stream writer(reactor, sockets.first());
+    Stream reader(reactor, sockets.second());
+
+    reactor.run(writer.write(A));
+    ::shutdown(sockets.first(), SHUT_WR);
+
+    ASSERT_THROW(reactor.run(reader.read<A_t, B_t>()), std::runtime_error);
+    ASSERT_TRUE(reader.eof());
+}
+
+TEST(AsyncBinaryStream, HungUp)
+{
+    std::array<int, 2> descriptors{-1, -1};
+    ASSERT_EQ(::pipe2(std::ranges::data(descriptors), O_NONBLOCK | O_CLOEXEC),
+              0);
+
+    scppl::Reactor reactor{};
+    Stream reader(reactor, descriptors[0]);
+
+    // The reader waits for the pipe, and is resumed by the hang-up
+    bool failed = false;
+    reactor.spawn([](Stream& reader, bool& failed) -> scppl::Task<> {
+        try
+        {
+            co_await reader.read<A_t>();
+        }
+        catch (std::runtime_error const&)
+        {
+            failed = true;
+        }
+    }(reader, failed));
+    ::close(descriptors[1]);
+
+    // Nothing waits for the hung-up pipe anymore, so it must not wake the
+    // reactor while another coroutine waits
+    bool finished = false;
+    reactor.spawn([](scppl::Reactor& reactor, bool& finished) -> scppl::Task<> {
+        co_await reactor.offload([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            return 0;
+        });
+
+        finished = true;
+    }(reactor, finished));
+
+    std::size_t iterations = 0;
+    while (!finished)
+    {
+        reactor.poll(-1);
+        ++iterations;
+    }
+
+    ASSERT_TRUE(failed);
+    ASSERT_LE(iterations, 3);
+    ::close(descriptors[0]);
+}
+
+TEST(AsyncBinaryStream, RegularFile)
+{
+    TemporaryFile file("scppl_test_async_binary_stream");
+    int descriptor = ::open(file.path().c_str(),
+                            O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    ASSERT_GE(descriptor, 0);
+
+    {
+        scppl::Reactor reactor{};
+        scppl::AsyncBinaryStream<std::endian::little> stream(reactor,
+                                                             descriptor);
+
+        // Regular files are read and written on the helper thread
+        reactor.run(stream.write(A, B, C, D));
+        assertValuesEqual(reactor.run(stream.read<A_t, B_t, C_t, D_t>()),
+                          std::tuple(A, B, C, D));
+        ASSERT_THROW(reactor.run(stream.read<A_t>()), std::runtime_error);
+    }
+
+    ::close(descriptor);
+}
+
+TEST(AsyncBinaryStream, Exception)
+{
+    scppl::Reactor reactor{};
+
+    ASSERT_THROW(reactor.run([]() -> scppl::Task<> {
+        throw std::runtime_error("Task failed");
+        co_return;
+    }()), std::runtime_error);
+}
+#endif
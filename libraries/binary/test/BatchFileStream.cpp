@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BatchFileStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+using Request = scppl::FileRequest<char>;
+
+constexpr std::size_t recordLength = scppl::lengthOf<uint32_t, D_t>();
+
+// Opens a stream, skipping the test when the backend is not available
+auto open(TemporaryFile const& file, scppl::BatchBackend backend)
+    -> std::unique_ptr<scppl::BatchFileStream<>>
+{
+    try
+    {
+        return std::make_unique<scppl::BatchFileStream<>>(
+            file.path(), std::ios::in | std::ios::out | std::ios::trunc,
+            scppl::FileStreamOptions{},
+            scppl::BatchFileOptions{.queueDepth = 8, .backend = backend});
+    }
+    catch (std::system_error const&)
+    {
+        if (backend != scppl::BatchBackend::IoUring)
+            throw;
+
+        return nullptr;
+    }
+}
+
+void readBatchAndAssert(scppl::BatchBackend backend)
+{
+    TemporaryFile file("scppl_test_batch_file_stream_read");
+    auto fileStream = open(file, backend);
+    if (!fileStream)
+        GTEST_SKIP() << "io_uring is not available";
+
+    ASSERT_EQ(fileStream->backend(), backend);
+
+    // Still in the buffer, the batch has to flush it first
+    scppl::BatchFileBinaryStream<std::endian::big> stream(*fileStream);
+    for (uint32_t i = 0; i < 100; ++i)
+        stream.write(i, D);
+
+    // More requests than the queue depth, in a random order
+    std::vector<std::array<char, recordLength>> records(50);
+    std::vector<Request> requests{};
+    for (std::size_t i = 0; i < 50; ++i)
+    {
+        requests.push_back({.data = std::ranges::data(records[i]),
+                            .length = recordLength,
+                            .offset = ((i * 37) % 100) * recordLength});
+    }
+
+    fileStream->readBatch(requests);
+    for (std::size_t i = 0; i < 50; ++i)
+    {
+        ASSERT_EQ(requests[i].result, recordLength);
+        assertValuesEqual(
+            scppl::Binary<std::endian::big>::unpack<uint32_t, D_t>(
+                records[i]),
+            std::tuple{static_cast<uint32_t>((i * 37) % 100), D});
+    }
+
+    // Past the end of the file
+    std::array<char, 2 * recordLength> tail{};
+    std::array<Request, 1> last{{{.data = std::ranges::data(tail),
+                                  .length = 2 * recordLength,
+                                  .offset = 99 * recordLength}}};
+    fileStream->readBatch(last);
+    ASSERT_EQ(last[0].result, recordLength);
+}
+
+void writeBatchAndAssert(scppl::BatchBackend backend)
+{
+    TemporaryFile file("scppl_test_batch_file_stream_write");
+    auto fileStream = open(file, backend);
+    if (!fileStream)
+        GTEST_SKIP() << "io_uring is not available";
+
+    scppl::BatchFileBinaryStream<std::endian::big> stream(*fileStream);
+    for (uint32_t i = 0; i < 100; ++i)
+        stream.write(i, D);
+
+    // Read once, so the buffer holds the old records
+    stream.toBegin();
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 0);
+
+    std::vector<std::array<char, recordLength>> records(50);
+    std::vector<Request> requests{};
+    for (uint32_t i = 0; i < 100; i += 2)
+    {
+        records[i / 2] = scppl::Binary<std::endian::big>::pack(i + 1000, D);
+        requests.push_back({.data = std::ranges::data(records[i / 2]),
+                            .length = recordLength,
+                            .offset = i * recordLength});
+    }
+
+    fileStream->writeBatch(requests);
+    for (Request const& request : requests)
+        ASSERT_EQ(request.result, recordLength);
+
+    // The stream sees the new records, not the buffered ones
+    stream.toBegin();
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        assertValuesEqual(stream.read<uint32_t, D_t>(),
+                          std::tuple{(i % 2 == 0) ? i + 1000 : i, D});
+    }
+}
+
+}
+
+TEST(BatchFileStream, IoUringReadBatch)
+{
+    readBatchAndAssert(scppl::BatchBackend::IoUring);
+}
+
+TEST(BatchFileStream, ThreadPoolReadBatch)
+{
+    readBatchAndAssert(scppl::BatchBackend::ThreadPool);
+}
+
+TEST(BatchFileStream, IoUringWriteBatch)
+{
+    writeBatchAndAssert(scppl::BatchBackend::IoUring);
+}
+
+TEST(BatchFileStream, ThreadPoolWriteBatch)
+{
+    writeBatchAndAssert(scppl::BatchBackend::ThreadPool);
+}
+
+TEST(BatchFileStream, RegisteredBuffers)
+{
+    TemporaryFile file("scppl_test_batch_file_stream_buffers");
+
+    for (auto backend : {scppl::BatchBackend::Auto,
+                         scppl::BatchBackend::ThreadPool})
+    {
+        auto fileStream = open(file, backend);
+
+        std::vector<char> buffer(4096);
+        std::array<std::span<char>, 1> buffers{buffer};
+        fileStream->registerBuffers(buffers);
+
+        // Write the two halves of the buffer swapped
+        std::fill_n(std::ranges::begin(buffer), 2048, 'a');
+        std::fill_n(std::ranges::begin(buffer) + 2048, 2048, 'b');
+        std::array<Request, 2> requests{{
+            {.data = std::ranges::data(buffer), .length = 2048,
+             .offset = 2048, .buffer = 0},
+            {.data = std::ranges::data(buffer) + 2048, .length = 2048,
+             .offset = 0, .buffer = 0}
+        }};
+        fileStream->writeBatch(requests);
+
+        std::ranges::fill(buffer, 0);
+        requests[0].offset = 0;
+        requests[1].offset = 2048;
+        fileStream->readBatch(requests);
+        ASSERT_EQ(buffer[0], 'b');
+        ASSERT_EQ(buffer[4095], 'a');
+
+        // Outside of the registered buffer
+        std::array<char, 16> other{};
+        std::array<Request, 1> invalid{{{.data = std::ranges::data(other),
+                                         .length = 16, .buffer = 0}}};
+        ASSERT_THROW(fileStream->readBatch(invalid), std::invalid_argument);
+    }
+}
+
+TEST(BatchFileStream, Error)
+{
+    TemporaryFile file("scppl_test_batch_file_stream_error");
+    {
+        scppl::FileStream<> create(file.path(),
+                                   std::ios::out | std::ios::trunc);
+    }
+
+    for (auto backend : {scppl::BatchBackend::Auto,
+                         scppl::BatchBackend::ThreadPool})
+    {
+        scppl::BatchFileStream<> fileStream(file.path(), std::ios::in, {},
+                                            {.backend = backend});
+
+        std::array<char, 16> data{};
+        std::array<Request, 2> requests{{
+            {.data = std::ranges::data(data), .length = 16},
+            {.data = std::ranges::data(data), .length = 16, .offset = 16}
+        }};
+        ASSERT_THROW(fileStream.writeBatch(requests), std::system_error);
+    }
+}
+#endif
@@ -0,0 +1,161 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+namespace {
+
+// A sink handing out its own buffer, like a shared memory ring
+class ArraySink
+{
+public:
+    auto acquire(std::size_t length) -> std::span<char>
+    {
+        return std::span(mData).subspan(mLength, length);
+    }
+
+    void commit(std::size_t length)
+    {
+        mLength += length;
+    }
+
+    auto data() const -> std::span<char const>
+    {
+        return std::span(mData).first(mLength);
+    }
+
+private:
+    std::array<char, 64> mData{};
+    std::size_t mLength{};
+};
+
+// A source handing out its own buffer, without positions
+class ArraySource
+{
+public:
+    explicit ArraySource(std::span<char const> data) :
+        mData(data)
+    {
+        //
+    }
+
+    auto acquire(std::size_t /* length */) -> std::span<char const>
+    {
+        return mData;
+    }
+
+    void commit(std::size_t length)
+    {
+        mData = mData.subspan(length);
+    }
+
+private:
+    std::span<char const> mData{};
+};
+
+}
+
+static_assert(scppl::InputOutputStream<std::stringstream, char>);
+static_assert(scppl::InputStream<scppl::SpanStream<>, char>);
+static_assert(scppl::ByteSink<VectorSink, char>);
+static_assert(!scppl::ByteSource<VectorSink, char>);
+static_assert(!scppl::SeekableSink<VectorSink>);
+static_assert(scppl::SpanSink<ArraySink, char>);
+static_assert(!scppl::SpanSource<ArraySink, char>);
+static_assert(scppl::SpanSource<ArraySource, char>);
+static_assert(!scppl::ByteSink<ArraySource, char>);
+
+TEST(BinaryStreamBackends, WriteSink)
+{
+    VectorSink sink{};
+    scppl::BinaryStream<std::endian::little, true, VectorSink> stream(sink);
+
+    stream.write(A, B);
+    stream.write(C, D);
+
+    auto expected = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    ASSERT_TRUE(std::ranges::equal(sink.data(), expected));
+    ASSERT_EQ(sink.writes(), 2);
+}
+
+TEST(BinaryStreamBackends, WriteSpanSink)
+{
+    ArraySink sink{};
+    scppl::BinaryStream<std::endian::big, true, ArraySink> stream(sink);
+
+    stream.write(A, B);
+    stream.writeRaw(CDataBE);
+    stream.write(D);
+
+    auto expected = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE);
+    ASSERT_TRUE(std::ranges::equal(sink.data(), expected));
+}
+
+TEST(BinaryStreamBackends, ReadSpanSource)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE);
+    ArraySource source(data);
+    scppl::BinaryStream<std::endian::big, true, ArraySource> stream(source);
+
+    assertValuesEqual(stream.read<A_t, B_t>(), std::tuple{A, B});
+    ASSERT_EQ(stream.readSingle<C_t>(), C);
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+}
+
+TEST(BinaryStreamBackends, WriteArraySpanSink)
+{
+    ArraySink sink{};
+    scppl::BinaryStream<std::endian::big, true, ArraySink> stream(sink);
+
+    stream.writeArray<D_t>(DArray);
+
+    ASSERT_TRUE(std::ranges::equal(sink.data(), DArrayDataBE));
+}
+
+TEST(BinaryStreamBackends, WriteGatherSink)
+{
+    VectorSink sink{};
+    scppl::BinaryStream<std::endian::little, true, VectorSink> stream(sink);
+
+    auto header = scppl::Binary<std::endian::little>::pack(A, B);
+    std::vector<char> payload(CDataLE.begin(), CDataLE.end());
+    stream.writeGather(header, payload, DDataLE);
+
+    // Without `writev` every part is a separate write
+    ASSERT_EQ(sink.writes(), 3);
+    auto expected = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    ASSERT_TRUE(std::ranges::equal(sink.data(), expected));
+}
+
+TEST(BinaryStreamBackends, ReadScatterSpanSource)
+{
+    auto data = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    ArraySource source(data);
+    scppl::BinaryStream<std::endian::little, true, ArraySource> stream(source);
+
+    std::array<char, 3> first{};
+    std::vector<char> second(4);
+    std::array<char, 16> third{};
+    ASSERT_EQ(stream.readScatter(first, second, third), 15);
+    ASSERT_TRUE(std::ranges::equal(second, CDataLE));
+    ASSERT_TRUE(std::ranges::equal(std::span(third).first(8), DDataLE));
+}
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <ios>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/ReadAheadStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Utility.hpp"
+
+namespace {
+
+// Payloads around the one and two byte varint boundaries, and a large one
+const std::vector<std::size_t> payloadLengths{0, 1, 127, 128, 300, 70000};
+
+auto payloadOf(std::size_t length)
+    -> std::vector<char>
+{
+    std::vector<char> payload(length);
+    std::iota(std::ranges::begin(payload), std::ranges::end(payload),
+              static_cast<char>(length));
+
+    return payload;
+}
+
+template<scppl::FramePrefix tPrefix, typename BinaryStreamT>
+void writeFrames(BinaryStreamT& stream)
+{
+    for (std::size_t length : payloadLengths)
+        stream.template writeFrame<tPrefix>(payloadOf(length));
+}
+
+template<scppl::FramePrefix tPrefix, typename BinaryStreamT>
+void readFramesAndAssert(BinaryStreamT& stream)
+{
+    for (std::size_t length : payloadLengths)
+    {
+        std::span<char const> payload = stream.template readFrame<tPrefix>();
+        ASSERT_TRUE(std::ranges::equal(payload, payloadOf(length)));
+    }
+
+    ASSERT_TRUE(std::ranges::empty(stream.template readFrame<tPrefix>()));
+    ASSERT_TRUE(stream.eof());
+}
+
+template<scppl::FramePrefix tPrefix>
+void writeAndReadAndAssert()
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    writeFrames<tPrefix>(stream);
+
+    stream.toBegin();
+    readFramesAndAssert<tPrefix>(stream);
+}
+
+}
+
+TEST(BinaryStreamFrames, U16)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::little> stream(stringstream);
+
+    stream.writeFrame<scppl::FramePrefix::U16>(payloadOf(300));
+    ASSERT_EQ(stringstream.str().substr(0, 2), std::string("\x2c\x01", 2));
+
+    stream.toBegin();
+    ASSERT_EQ(std::ranges::size(
+                  stream.readFrame<scppl::FramePrefix::U16>()), 300);
+
+    ASSERT_THROW(stream.writeFrame<scppl::FramePrefix::U16>(
+                     payloadOf(70000)),
+                 std::length_error);
+}
+
+TEST(BinaryStreamFrames, U32)
+{
+    writeAndReadAndAssert<scppl::FramePrefix::U32>();
+}
+
+TEST(BinaryStreamFrames, Varint)
+{
+    writeAndReadAndAssert<scppl::FramePrefix::Varint>();
+
+    std::stringstream stringstream{};
+    scppl::BinaryStream<> stream(stringstream);
+    stream.writeFrame<scppl::FramePrefix::Varint>(payloadOf(300));
+    ASSERT_EQ(stringstream.str().substr(0, 2), std::string("\xac\x02", 2));
+}
+
+TEST(BinaryStreamFrames, SpanStreamView)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> writer(stringstream);
+    writeFrames<scppl::FramePrefix::Varint>(writer);
+
+    std::string data = stringstream.str();
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+
+    // The payload is a view of the span itself
+    stream.readFrame<scppl::FramePrefix::Varint>();
+    auto payload = stream.readFrame<scppl::FramePrefix::Varint>();
+    ASSERT_EQ(std::ranges::data(payload), std::ranges::data(data) + 2);
+
+    stream.toBegin();
+    readFramesAndAssert<scppl::FramePrefix::Varint>(stream);
+}
+
+TEST(BinaryStreamFrames, FileStream)
+{
+    TemporaryFile file("scppl_test_binary_stream_frames");
+
+    // Frames cross the end of the small buffer, or are larger than it
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 256, .alignment = 64});
+    scppl::FileBinaryStream<std::endian::big> stream(fileStream);
+    writeFrames<scppl::FramePrefix::U32>(stream);
+
+    stream.toBegin();
+    readFramesAndAssert<scppl::FramePrefix::U32>(stream);
+}
+
+TEST(BinaryStreamFrames, ReadAheadStream)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> writer(stringstream);
+    writeFrames<scppl::FramePrefix::U32>(writer);
+
+    // Blocks ending right after a frame must stay valid until the next read
+    std::string data = stringstream.str();
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::ReadAheadStream<scppl::SpanStream<>> readAhead(spanStream,
+                                                          {.blockSize = 5});
+    scppl::ReadAheadBinaryStream<scppl::SpanStream<>, std::endian::big>
+        stream(readAhead);
+    readFramesAndAssert<scppl::FramePrefix::U32>(stream);
+}
+
+TEST(BinaryStreamFrames, Errors)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    stream.writeFrame(payloadOf(100));
+
+    stream.toBegin();
+    ASSERT_THROW(stream.readFrame(99), std::length_error);
+
+    // Cut off inside the payload
+    std::string data = stringstream.str().substr(0, 50);
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::SpanBinaryStream<std::endian::big> truncated(spanStream);
+    ASSERT_THROW(truncated.readFrame(), std::out_of_range);
+
+    // Cut off inside the length prefix
+    std::string fixed("\x00\x00", 2);
+    scppl::SpanStream<> fixedStream{std::span<char const>(fixed)};
+    scppl::SpanBinaryStream<std::endian::big> fixedPrefix(fixedStream);
+    ASSERT_THROW(fixedPrefix.readFrame(), std::out_of_range);
+
+    std::string varint("\x85", 1);
+    scppl::SpanStream<> varintStream{std::span<char const>(varint)};
+    scppl::SpanBinaryStream<std::endian::big> varintPrefix(varintStream);
+    ASSERT_THROW(varintPrefix.readFrame<scppl::FramePrefix::Varint>(),
+                 std::out_of_range);
+}
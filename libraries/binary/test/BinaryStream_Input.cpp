@@ -138,3 +138,43 @@ TEST(BinaryStreamInput, ReadStringJPShiftJIS)
         readStringAndAssert(JPChar8Text, "Shift-JIS", JPTextShiftJISData);
     }
 }
+
+TEST(BinaryStreamInput, LittleEndianReadBulk)
+{
+    auto stringstream = toStream(CArrayDataLE);
+    scppl::BinaryInputStream<std::endian::little> stream(stringstream);
+    auto values = stream.readArray<C_t>(std::ranges::size(CArray));
+
+    ASSERT_TRUE(std::ranges::equal(values, CArray));
+}
+
+TEST(BinaryStreamInput, BigEndianReadBulk)
+{
+    auto stringstream = toStream(DArrayDataBE);
+    scppl::BinaryInputStream<std::endian::big> stream(stringstream);
+
+    DArray_t<std::tuple_size_v<decltype(DArray)>> values{};
+    ASSERT_EQ(stream.readArray<D_t>(values), std::ranges::size(DArray));
+    ASSERT_EQ(values, DArray);
+}
+
+TEST(BinaryStreamInput, BigEndianReadBulkStruct)
+{
+    auto stringstream = toStream(AB_CDArrayDataBE);
+    scppl::BinaryInputStream<std::endian::big> stream(stringstream);
+    auto values = stream.readArray<AB_CD_t>(std::ranges::size(AB_CDArray));
+
+    if constexpr(SCPPL_CONFIG_BINARY_USE_PFR)
+    {
+        ASSERT_TRUE(std::ranges::equal(values, AB_CDArray));
+    }
+}
+
+TEST(BinaryStreamInput, ReadBulkShort)
+{
+    auto stringstream = toStream(BArrayDataLE);
+    scppl::BinaryInputStream<std::endian::little> stream(stringstream);
+    auto values = stream.readArray<B_t>(8);
+
+    ASSERT_TRUE(std::ranges::equal(values, BArray));
+}
@@ -43,7 +43,7 @@ void writeAndAssert(std::tuple<Ts...> values, ByteArray<Ns>... expected)
     std::ostringstream stringstream{};
     scppl::BinaryOutputStream<tEndian> stream(stringstream);
     std::apply(std::bind_front(&decltype(stream)::template write<Ts...>,
-                               stream),
+                               std::ref(stream)),
                 values);
 
     auto data = fromStream<(Ns + ...)>(stringstream);
@@ -140,3 +140,34 @@ TEST(BinaryStreamOutput, WriteStringJPShiftJIS)
         writeStringAndAssert(JPChar8Text, "Shift-JIS", JPTextShiftJISData);
     }
 }
+
+TEST(BinaryStreamOutput, LittleEndianWriteBulk)
+{
+    std::ostringstream stringstream{};
+    scppl::BinaryOutputStream<std::endian::little> stream(stringstream);
+    stream.writeArray<C_t>(CArray);
+
+    assertDataEqual(fromStream<sizeof(CArray)>(stringstream), CArrayDataLE);
+}
+
+TEST(BinaryStreamOutput, BigEndianWriteBulk)
+{
+    std::ostringstream stringstream{};
+    scppl::BinaryOutputStream<std::endian::big> stream(stringstream);
+    stream.writeArray<D_t>(DArray);
+
+    assertDataEqual(fromStream<sizeof(DArray)>(stringstream), DArrayDataBE);
+}
+
+TEST(BinaryStreamOutput, BigEndianWriteBulkStruct)
+{
+    std::ostringstream stringstream{};
+    scppl::BinaryOutputStream<std::endian::big> stream(stringstream);
+    stream.writeArray<AB_CD_t>(AB_CDArray);
+
+    if constexpr(SCPPL_CONFIG_BINARY_USE_PFR)
+    {
+        assertDataEqual(fromStream<sizeof(AB_CDArray)>(stringstream),
+                        AB_CDArrayDataBE);
+    }
+}
@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+namespace {
+
+// A source without positions that counts its reads, like a pipe
+class PipeSource
+{
+public:
+    explicit PipeSource(std::span<char const> data) :
+        mData(data)
+    {
+        //
+    }
+
+    auto read(char* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t count = std::min(length, std::ranges::size(mData));
+        std::ranges::copy_n(std::ranges::begin(mData), count, data);
+        mData = mData.subspan(count);
+        ++mReads;
+
+        return count;
+    }
+
+    auto reads() const -> std::size_t { return mReads; }
+
+private:
+    std::span<char const> mData{};
+    std::size_t mReads{};
+};
+
+}
+
+TEST(BinaryStreamPeek, StringStream)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE);
+    std::stringstream stringstream(std::string(std::ranges::begin(data),
+                                               std::ranges::end(data)));
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+
+    assertValuesEqual(stream.peek<A_t, B_t>(), std::tuple{A, B});
+    ASSERT_EQ(stream.peekSingle<A_t>(), A);
+    ASSERT_EQ(stream.tell(), 0);
+
+    assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                      std::tuple{A, B, C, D});
+    ASSERT_THROW(stream.peek<A_t>(), std::out_of_range);
+}
+
+TEST(BinaryStreamPeek, NonSeekable)
+{
+    auto data = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    PipeSource source(data);
+    scppl::BinaryStream<std::endian::little, true, PipeSource> stream(source);
+
+    // Only the bytes that are not peeked at yet are read from the source
+    ASSERT_EQ(stream.peekSingle<A_t>(), A);
+    ASSERT_EQ(source.reads(), 1);
+    assertValuesEqual(stream.peek<A_t, B_t>(), std::tuple{A, B});
+    ASSERT_EQ(source.reads(), 2);
+    assertValuesEqual(stream.peek<A_t, B_t>(), std::tuple{A, B});
+    ASSERT_EQ(source.reads(), 2);
+
+    assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                      std::tuple{A, B, C, D});
+
+    ASSERT_TRUE(std::ranges::empty(stream.peekRaw(4)));
+}
+
+TEST(BinaryStreamPeek, SpanStreamView)
+{
+    auto data = combineArrays(CDataLE, DDataLE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::little> stream(spanStream);
+
+    std::span<char const> bytes = stream.peekRaw(4);
+    ASSERT_EQ(std::ranges::data(bytes), std::ranges::data(data));
+    ASSERT_EQ(std::ranges::size(bytes), 4);
+
+    // Shorter at the end
+    ASSERT_EQ(std::ranges::size(stream.peekRaw(100)), 12);
+    ASSERT_EQ(stream.readSingle<C_t>(), C);
+}
+
+TEST(BinaryStreamPeek, PeekThenWrite)
+{
+    TemporaryFile file("scppl_test_binary_stream_peek");
+    std::fstream fstream(file.path(), std::ios::in | std::ios::out |
+                                      std::ios::trunc | std::ios::binary);
+    scppl::BinaryStream<std::endian::little> stream(fstream);
+
+    stream.write(C, C, C);
+    stream.toBegin();
+
+    // The write goes to the read position, not after the peeked bytes
+    ASSERT_EQ(stream.readSingle<C_t>(), C);
+    ASSERT_EQ(stream.peekSingle<C_t>(), C);
+    ASSERT_EQ(stream.tellOutput(), 4);
+    stream.write(D);
+    ASSERT_EQ(stream.tell(), 12);
+
+    stream.toBegin();
+    assertValuesEqual(stream.read<C_t, D_t>(), std::tuple{C, D});
+}
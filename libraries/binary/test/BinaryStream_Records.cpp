@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <ranges>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+template<typename BinaryStreamT>
+void writeIndices(BinaryStreamT& stream, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        stream.write(static_cast<uint32_t>(i), D);
+}
+
+template<typename BinaryStreamT>
+void readIndicesAndAssert(BinaryStreamT& stream, std::size_t first,
+                          std::size_t count, std::size_t blockSize)
+{
+    std::size_t index = first;
+    for (auto [value, d] : stream.template records<uint32_t, D_t>(blockSize))
+    {
+        ASSERT_EQ(value, index++);
+        ASSERT_EQ(d, D);
+    }
+
+    ASSERT_EQ(index, count);
+}
+
+// A string stream that fails to seek on request, like a failing file would
+class FailingStream : public std::stringstream
+{
+public:
+    bool fail = false;
+
+    auto seekg(std::streamoff offset, std::ios::seekdir direction)
+        -> FailingStream&
+    {
+        if (fail)
+            throw std::ios::failure("Unable to seek");
+
+        std::stringstream::seekg(offset, direction);
+
+        return *this;
+    }
+};
+
+static_assert(std::ranges::input_range<
+                  scppl::BinaryStream<>::Records<uint32_t, D_t>>);
+static_assert(std::ranges::view<scppl::BinaryStream<>::Records<C_t>>);
+
+TEST(BinaryStreamRecords, StringStream)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    writeIndices(stream, 100);
+
+    // A block size that does not divide the record length
+    stream.toBegin();
+    readIndicesAndAssert(stream, 0, 100, 40);
+    ASSERT_TRUE(stream.eof());
+}
+
+TEST(BinaryStreamRecords, SingleType)
+{
+    auto data = combineArrays(CDataLE, CDataLE, CDataLE, ADataLE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::little> stream(spanStream);
+
+    std::size_t count = 0;
+    for (C_t value : stream.records<C_t>())
+    {
+        ASSERT_EQ(value, C);
+        ++count;
+    }
+
+    // The trailing byte is not a complete record
+    ASSERT_EQ(count, 3);
+    ASSERT_EQ(stream.tell(), 12);
+}
+
+TEST(BinaryStreamRecords, FilterTake)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::little> stream(stringstream);
+    writeIndices(stream, 100);
+    stream.toBegin();
+
+    auto isOdd = [](std::tuple<uint32_t, D_t> record) -> bool
+    {
+        return std::get<0>(record) % 2 == 1;
+    };
+
+    std::vector<uint32_t> values{};
+    for (auto [value, d] : stream.records<uint32_t, D_t>() |
+                           std::views::filter(isOdd) | std::views::take(3))
+    {
+        values.push_back(value);
+    }
+
+    ASSERT_EQ(values, (std::vector<uint32_t>{1, 3, 5}));
+}
+
+TEST(BinaryStreamRecords, ContinueReading)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::little> output(stringstream);
+    writeIndices(output, 100);
+
+    // Only the used records are consumed, the rest can still be read
+    std::istringstream input(stringstream.str());
+    scppl::BinaryInputStream<std::endian::little> stream(input);
+
+    constexpr std::size_t length = scppl::lengthOf<uint32_t, D_t>();
+    for (auto [value, d] : stream.records<uint32_t, D_t>() |
+                           std::views::take(5))
+    {
+        ASSERT_EQ(d, D);
+    }
+    ASSERT_EQ(stream.tell(), 5 * length);
+
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 5);
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+
+    readIndicesAndAssert(stream, 6, 100, 1 << 10);
+    ASSERT_EQ(stream.tell(), 100 * length);
+}
+
+TEST(BinaryStreamRecords, ContinueWriting)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::little> stream(stringstream);
+    writeIndices(stream, 10);
+    stream.toBegin();
+
+    for (auto record : stream.records<uint32_t, D_t>() | std::views::take(2))
+        std::ignore = record;
+
+    // The write position follows the read position after the range
+    stream.write(uint32_t{42}, D);
+    stream.toBegin();
+    ASSERT_EQ(stream.readArray<uint32_t>(7)[6], 42);
+}
+
+TEST(BinaryStreamRecords, FailingFinish)
+{
+    FailingStream failingStream{};
+    scppl::BinaryStream<std::endian::little, true, FailingStream> stream(
+        failingStream);
+    writeIndices(stream, 10);
+    stream.toBegin();
+
+    // Destroying the range can not throw, finishing it explicitly does
+    failingStream.fail = true;
+    for (auto record : stream.records<uint32_t, D_t>() | std::views::take(2))
+        std::ignore = record;
+
+    failingStream.fail = false;
+    stream.toBegin();
+
+    auto records = stream.records<uint32_t, D_t>();
+    ASSERT_EQ(std::get<0>(*std::ranges::begin(records)), 0);
+
+    failingStream.fail = true;
+    ASSERT_THROW(records.finish(), std::ios::failure);
+    ASSERT_NO_THROW(records.finish());
+}
+
+TEST(BinaryStreamRecords, GrowingStream)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryOutputStream<std::endian::little> output(stringstream);
+    writeIndices(output, 2);
+
+    scppl::BinaryInputStream<std::endian::little> stream(stringstream);
+    readIndicesAndAssert(stream, 0, 2, 64);
+    ASSERT_TRUE(stream.eof());
+
+    // Bytes that arrive after the end are read again
+    writeIndices(output, 1);
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 0);
+    ASSERT_FALSE(stream.eof());
+
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+    ASSERT_FALSE(stream.eof());
+}
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+TEST(BinaryStreamRecords, FileStream)
+{
+    TemporaryFile file("scppl_test_records");
+
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 16, .alignment = 8});
+    scppl::FileBinaryStream<std::endian::little> stream(fileStream);
+    writeIndices(stream, 100);
+
+    // Records are larger than the buffer, so it has to grow
+    stream.toBegin();
+    readIndicesAndAssert(stream, 0, 100, 0);
+    ASSERT_TRUE(stream.eof());
+}
+#endif
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <ios>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/ReadAheadStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+namespace {
+
+// A source without positions, like a pipe
+class PipeSource
+{
+public:
+    explicit PipeSource(std::span<char const> data) :
+        mData(data)
+    {
+        //
+    }
+
+    auto read(char* data, std::size_t length)
+        -> std::size_t
+    {
+        std::size_t count = std::min(length, std::ranges::size(mData));
+        std::ranges::copy_n(std::ranges::begin(mData), count, data);
+        mData = mData.subspan(count);
+
+        return count;
+    }
+
+private:
+    std::span<char const> mData{};
+};
+
+template<typename BinaryStreamT>
+void skipAndAssert(BinaryStreamT& stream)
+{
+    stream.template skip<A_t>();
+    ASSERT_EQ(stream.template readSingle<B_t>(), B);
+    stream.template skip<C_t>(2);
+    ASSERT_EQ(stream.template readSingle<D_t>(), D);
+    stream.skipRaw(scppl::lengthOf<A_t, B_t>());
+    assertValuesEqual(stream.template read<C_t, D_t>(), std::tuple{C, D});
+}
+
+}
+
+TEST(BinaryStreamSkip, StringStream)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, CDataBE, DDataBE,
+                              ADataBE, BDataBE, CDataBE, DDataBE);
+    std::stringstream stringstream(std::string(std::ranges::begin(data),
+                                               std::ranges::end(data)));
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    skipAndAssert(stream);
+
+    // After peeking, the lookahead is skipped first
+    stream.toBegin();
+    ASSERT_EQ(stream.peekSingle<A_t>(), A);
+    stream.skip<A_t>();
+    ASSERT_EQ(stream.tell(), scppl::lengthOf<A_t>());
+    ASSERT_EQ(stream.readSingle<B_t>(), B);
+}
+
+TEST(BinaryStreamSkip, NonSeekable)
+{
+    auto data = combineArrays(ADataLE, BDataLE, CDataLE, CDataLE, DDataLE,
+                              ADataLE, BDataLE, CDataLE, DDataLE);
+    PipeSource source(data);
+    scppl::BinaryStream<std::endian::little, true, PipeSource> stream(source);
+    skipAndAssert(stream);
+
+    // Past the end of the source
+    stream.skipRaw(100);
+    ASSERT_TRUE(std::ranges::empty(stream.peekRaw(1)));
+}
+
+TEST(BinaryStreamSkip, FileStream)
+{
+    TemporaryFile file("scppl_test_binary_stream_skip");
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 64, .alignment = 64});
+    scppl::FileBinaryStream<std::endian::big> stream(fileStream);
+    for (std::size_t i = 0; i < 10; ++i)
+        stream.write(A, B, C, C, D, A, B, C, D);
+
+    // Within the buffer and past it
+    stream.toBegin();
+    for (std::size_t i = 0; i < 10; ++i)
+        skipAndAssert(stream);
+}
+
+TEST(BinaryStreamSkip, ReadAheadStream)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, CDataBE, DDataBE,
+                              ADataBE, BDataBE, CDataBE, DDataBE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::ReadAheadStream<scppl::SpanStream<>> readAhead(spanStream,
+                                                          {.blockSize = 8});
+    scppl::ReadAheadBinaryStream<scppl::SpanStream<>, std::endian::big>
+        stream(readAhead);
+    skipAndAssert(stream);
+
+    // Beyond the blocks read ahead
+    stream.toBegin();
+    stream.skipRaw(std::ranges::size(data) - scppl::lengthOf<D_t>());
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+}
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <ios>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BinaryStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/ReadAheadStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+namespace {
+
+// A line longer than the buffers in the tests, followed by short ones
+auto makeLines()
+    -> std::string
+{
+    return std::string(1000, 'a') + "\nfirst\n\nsecond\nlast";
+}
+
+auto text(std::span<char const> bytes)
+    -> std::string_view
+{
+    return std::string_view(std::ranges::data(bytes), std::ranges::size(bytes));
+}
+
+template<typename BinaryStreamT>
+void readLinesAndAssert(BinaryStreamT& stream)
+{
+    ASSERT_EQ(text(stream.readUntil('\n')), std::string(1000, 'a'));
+    ASSERT_EQ(text(stream.readUntil('\n')), "first");
+    ASSERT_EQ(text(stream.readUntil('\n')), "");
+    ASSERT_EQ(text(stream.readUntil('\n')), "second");
+    ASSERT_FALSE(stream.eof());
+
+    // The end of the stream also ends the last line
+    ASSERT_EQ(text(stream.readUntil('\n')), "last");
+    ASSERT_TRUE(stream.eof());
+    ASSERT_TRUE(std::ranges::empty(stream.readUntil('\n')));
+}
+
+}
+
+TEST(BinaryStreamUntil, StringStream)
+{
+    std::stringstream stringstream(makeLines());
+    scppl::BinaryStream<> stream(stringstream);
+    readLinesAndAssert(stream);
+}
+
+TEST(BinaryStreamUntil, SpanStreamView)
+{
+    std::string data = makeLines();
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::SpanBinaryStream<> stream(spanStream);
+
+    // The line is a view of the span itself
+    stream.readUntil('\n');
+    ASSERT_EQ(std::ranges::data(stream.readUntil('\n')),
+              std::ranges::data(data) + 1001);
+
+    stream.toBegin();
+    readLinesAndAssert(stream);
+}
+
+TEST(BinaryStreamUntil, FileStream)
+{
+    TemporaryFile file("scppl_test_binary_stream_until");
+
+    // The long line crosses the end of the small buffer
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 256, .alignment = 64});
+    scppl::FileBinaryStream<> stream(fileStream);
+    stream.writeRaw(makeLines());
+
+    stream.toBegin();
+    readLinesAndAssert(stream);
+}
+
+TEST(BinaryStreamUntil, ReadAheadStream)
+{
+    std::string data = makeLines();
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::ReadAheadStream<scppl::SpanStream<>> readAhead(spanStream,
+                                                          {.blockSize = 7});
+    scppl::ReadAheadBinaryStream<scppl::SpanStream<>> stream(readAhead);
+    readLinesAndAssert(stream);
+}
+
+TEST(BinaryStreamUntil, CString)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> stream(stringstream);
+    stream.writeRaw(std::string_view("name\0", 5));
+    stream.write(A, B);
+
+    // Reading continues after the bytes that were read ahead
+    stream.toBegin();
+    ASSERT_EQ(text(stream.readCString()), "name");
+    ASSERT_EQ(stream.tell(), 5);
+    ASSERT_EQ(stream.readSingle<A_t>(), A);
+    ASSERT_EQ(stream.readSingle<B_t>(), B);
+}
+
+TEST(BinaryStreamUntil, MaxLength)
+{
+    std::string data = makeLines();
+    std::stringstream stringstream(data);
+    scppl::BinaryStream<> stream(stringstream);
+    ASSERT_THROW(stream.readUntil('\n', 999), std::length_error);
+    ASSERT_EQ(std::ranges::size(stream.readUntil('\n', 1000)), 1000);
+
+    scppl::SpanStream<> spanStream{std::span<char const>(data)};
+    scppl::SpanBinaryStream<> spanStreamBinary(spanStream);
+    ASSERT_THROW(spanStreamBinary.readUntil('\n', 999), std::length_error);
+    ASSERT_EQ(std::ranges::size(spanStreamBinary.readUntil('\n', 1000)), 1000);
+
+    // Nothing is consumed either when the line crosses buffers of the source
+    scppl::SpanStream<> readAheadSource{std::span<char const>(data)};
+    scppl::ReadAheadStream<scppl::SpanStream<>> readAhead(readAheadSource,
+                                                          {.blockSize = 7});
+    scppl::ReadAheadBinaryStream<scppl::SpanStream<>> readAheadStream(
+        readAhead);
+    ASSERT_THROW(readAheadStream.readUntil('\n', 999), std::length_error);
+    ASSERT_EQ(std::ranges::size(readAheadStream.readUntil('\n', 1000)), 1000);
+}
@@ -2,16 +2,20 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <tuple>
 #include <utility>
 
 #include <gtest/gtest.h>
 
 #include "scppl/binary/Binary.hpp"
+#include "scppl/binary/Checksum.hpp"
 
 #include "Data.hpp"
 #include "Types.hpp"
@@ -217,3 +221,18 @@ TEST(BinaryPack, BigEndianArrayStructArray)
         packAndAssertBE(std::tuple{ABCDArrayArray}, ABCDArrayArrayDataBE);
     }
 }
+
+TEST(BinaryPack, PackIntoWithChecksum)
+{
+    std::array<char, 16> data{};
+    scppl::Crc32c crc{};
+
+    auto value = scppl::Binary<std::endian::big>::packIntoWithChecksum<
+        std::uint32_t, std::uint16_t>(data, crc, 0x01020304u, 0x0506);
+
+    auto expected = scppl::Binary<std::endian::big>::pack<
+        std::uint32_t, std::uint16_t>(0x01020304u, 0x0506);
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), data.begin()));
+    ASSERT_EQ(value, scppl::crc32c(std::span<char const>(expected)));
+    ASSERT_EQ(crc.value(), value);
+}
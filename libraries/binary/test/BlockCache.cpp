@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BlockCache.hpp"
+#include "scppl/binary/SpanStream.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+#include "Utility.hpp"
+
+// A positional source over memory, counting the reads that reach it
+class CountingSource
+{
+public:
+    using Byte = char;
+
+    explicit CountingSource(std::vector<char> data) :
+        mData(std::move(data))
+    {
+        //
+    }
+
+    auto readAt(char* data, std::size_t length, std::size_t offset) const
+        -> std::size_t
+    {
+        ++mReads;
+        if (offset >= mData.size())
+            return 0;
+
+        length = std::min(length, mData.size() - offset);
+        std::memcpy(data, mData.data() + offset, length);
+
+        return length;
+    }
+
+    auto size() const -> std::size_t { return mData.size(); }
+
+    auto reads() const -> std::size_t { return mReads; }
+
+private:
+    std::vector<char> mData{};
+    mutable std::atomic<std::size_t> mReads{};
+};
+
+auto makeBytes(std::size_t length)
+    -> std::vector<char>
+{
+    std::vector<char> data(length);
+    for (std::size_t i = 0; i < length; ++i)
+        data[i] = static_cast<char>(i * 7 + i / 251);
+
+    return data;
+}
+
+TEST(BlockCache, HitsAndMisses)
+{
+    scppl::BlockCache<> cache({.capacity = 1 << 16, .blockSize = 64,
+                               .shards = 4});
+
+    std::size_t loads = 0;
+    auto load = [&loads]() {
+        ++loads;
+
+        return std::vector<char>(64, 'x');
+    };
+
+    auto first = cache.get(1, 0, load);
+    auto second = cache.get(1, 0, load);
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(loads, 1);
+
+    // Another file or block is another key
+    cache.get(2, 0, load);
+    cache.get(1, 1, load);
+    ASSERT_EQ(loads, 3);
+
+    auto stats = cache.stats();
+    ASSERT_EQ(stats.hits, 1);
+    ASSERT_EQ(stats.misses, 3);
+    ASSERT_EQ(stats.evictions, 0);
+    ASSERT_EQ(stats.blocks, 3);
+    ASSERT_EQ(stats.bytes, 3 * 64);
+
+    cache.erase(1);
+    stats = cache.stats();
+    ASSERT_EQ(stats.blocks, 1);
+    ASSERT_EQ(stats.bytes, 64);
+
+    cache.get(1, 0, load);
+    ASSERT_EQ(loads, 4);
+}
+
+TEST(BlockCache, EvictsLeastRecentlyUsed)
+{
+    // One shard of four blocks
+    scppl::BlockCache<> cache({.capacity = 4 * 16, .blockSize = 16,
+                               .shards = 1});
+    auto load = []() { return std::vector<char>(16); };
+
+    cache.get(1, 0, load);
+    auto evicted = cache.get(1, 1, load);
+    cache.get(1, 2, load);
+    cache.get(1, 3, load);
+
+    // Using block 0 makes block 1 the least recently used
+    auto kept = cache.get(1, 0, load);
+    cache.get(1, 4, load);
+
+    auto stats = cache.stats();
+    ASSERT_EQ(stats.evictions, 1);
+    ASSERT_EQ(stats.blocks, 4);
+    ASSERT_EQ(stats.bytes, 4 * 16);
+    ASSERT_EQ(stats.misses, 5);
+
+    // An evicted block stays valid while used
+    ASSERT_EQ(evicted->size(), 16);
+    ASSERT_NE(cache.get(1, 1, load), evicted);
+    ASSERT_EQ(cache.stats().misses, 6);
+    ASSERT_EQ(cache.get(1, 0, load), kept);
+}
+
+TEST(BlockCache, CachedStreamReads)
+{
+    std::vector<char> data = makeBytes(1000);
+    CountingSource source(data);
+    scppl::BlockCache<> cache({.blockSize = 64});
+    scppl::CachedStream stream(source, cache, 1);
+
+    // Reading across blocks
+    std::vector<char> read(300);
+    ASSERT_EQ(stream.read(read.data(), 250), 250);
+    ASSERT_EQ(std::memcmp(read.data(), data.data(), 250), 0);
+    ASSERT_EQ(stream.tellg(), 250);
+    ASSERT_EQ(source.reads(), 4);
+
+    stream.seekg(900);
+    ASSERT_EQ(stream.read(read.data(), 300), 100);
+    ASSERT_TRUE(stream.eof());
+    ASSERT_EQ(std::memcmp(read.data(), data.data() + 900, 100), 0);
+
+    stream.seekg(-10, std::ios::end);
+    ASSERT_EQ(stream.tellg(), 990);
+    ASSERT_FALSE(stream.eof());
+
+    // Cached blocks are read without reaching the source
+    std::size_t reads = source.reads();
+    stream.seekg(10);
+    ASSERT_EQ(stream.read(read.data(), 200), 200);
+    ASSERT_EQ(std::memcmp(read.data(), data.data() + 10, 200), 0);
+    ASSERT_EQ(stream.readAt(read.data(), 100, 20), 100);
+    ASSERT_EQ(std::memcmp(read.data(), data.data() + 20, 100), 0);
+    ASSERT_EQ(source.reads(), reads);
+
+    ASSERT_EQ(stream.readAt(read.data(), 100, 950), 50);
+    ASSERT_EQ(stream.readAt(read.data(), 100, 2000), 0);
+}
+
+TEST(BlockCache, CachedStreamAcquire)
+{
+    std::vector<char> data = makeBytes(1000);
+    CountingSource source(data);
+    scppl::BlockCache<> cache({.blockSize = 64});
+    scppl::CachedStream stream(source, cache, 1);
+
+    // Within a block the span points into the cached block
+    auto span = stream.acquire(16);
+    ASSERT_EQ(span.size(), 64);
+    ASSERT_EQ(std::memcmp(span.data(), data.data(), 64), 0);
+    stream.commit(60);
+
+    // Across blocks it is copied together
+    span = stream.acquire(16);
+    ASSERT_GE(span.size(), 16);
+    ASSERT_EQ(std::memcmp(span.data(), data.data() + 60, 16), 0);
+    stream.commit(16);
+    ASSERT_EQ(stream.tellg(), 76);
+
+    stream.seekg(990);
+    span = stream.acquire(16);
+    ASSERT_EQ(span.size(), 10);
+    ASSERT_TRUE(stream.eof());
+}
+
+TEST(BlockCache, CachedBinaryStreamFrames)
+{
+    scppl::BufferStream<> buffer{};
+    std::vector<std::size_t> offsets{};
+    {
+        scppl::BinaryStream<std::endian::little, true,
+                            scppl::BufferStream<>> writer(buffer);
+        for (std::size_t i = 0; i < 200; ++i)
+        {
+            offsets.push_back(writer.tell());
+
+            std::string payload = std::to_string(i) + std::string(i, 'c');
+            writer.writeFrame(std::span<char const>(payload));
+        }
+    }
+
+    CountingSource source(std::vector<char>(buffer.data().begin(),
+                                            buffer.data().end()));
+    scppl::BlockCache<> cache({.blockSize = 256});
+    scppl::CachedStream cached(source, cache, 1);
+    scppl::CachedBinaryStream<CountingSource,
+                              std::endian::little> stream(cached);
+
+    for (std::size_t i : {199, 0, 100, 57, 58, 199})
+    {
+        stream.seek(offsets[i], std::ios::beg);
+        auto payload = stream.readFrame();
+        ASSERT_EQ(std::string(payload.begin(), payload.end()),
+                  std::to_string(i) + std::string(i, 'c'));
+    }
+
+    // The second read of the last frame hit the cache
+    ASSERT_GT(cache.stats().hits, 0);
+}
+
+TEST(BlockCache, ConcurrentReaders)
+{
+    std::vector<char> data = makeBytes(1 << 16);
+    CountingSource source(data);
+
+    // Small enough to keep evicting
+    scppl::BlockCache<> cache({.capacity = 1 << 13, .blockSize = 256,
+                               .shards = 4});
+
+    std::atomic<bool> failed{};
+    std::vector<std::thread> threads{};
+    for (std::size_t t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            scppl::CachedStream stream(source, cache, 1);
+
+            std::vector<char> read(100);
+            for (std::size_t i = 0; i < 2000; ++i)
+            {
+                std::size_t offset = (i * 7919 + t * 104729) %
+                                     (data.size() - 100);
+                stream.seekg(static_cast<std::streamoff>(offset));
+                if (stream.read(read.data(), 100) != 100 ||
+                    std::memcmp(read.data(), data.data() + offset, 100) != 0)
+                {
+                    failed = true;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    ASSERT_FALSE(failed);
+
+    auto stats = cache.stats();
+    ASSERT_GT(stats.evictions, 0);
+    ASSERT_LE(stats.bytes, 1 << 13);
+}
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+TEST(BlockCache, FileStream)
+{
+    TemporaryFile temporary("scppl_test_block_cache");
+
+    std::vector<char> data = makeBytes(100000);
+    {
+        scppl::FileStream<> file(temporary.path(),
+                                 std::ios::out | std::ios::trunc);
+        file.write(data.data(), data.size());
+    }
+
+    scppl::FileStream<> file(temporary.path(), std::ios::in);
+    scppl::BlockCache<> cache({.blockSize = 4096});
+    scppl::CachedStream stream(file, cache, 1);
+
+    std::vector<char> read(5000);
+    for (std::size_t offset : {96000, 0, 4000, 50000, 4000})
+    {
+        stream.seekg(static_cast<std::streamoff>(offset));
+        ASSERT_EQ(stream.read(read.data(), 4000), 4000);
+        ASSERT_EQ(std::memcmp(read.data(), data.data() + offset, 4000), 0);
+    }
+
+    // Only the second read at 4000 found its blocks in the cache
+    ASSERT_EQ(cache.stats().hits, 2);
+}
+#endif
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdio>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/BlockFile.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+auto makeKey(std::size_t index)
+    -> std::string
+{
+    char key[16]{};
+    std::snprintf(key, sizeof(key), "key%08zu", index);
+
+    return key;
+}
+
+auto makeValue(std::size_t index)
+    -> std::string
+{
+    return std::string(index % 50, static_cast<char>('a' + index % 26));
+}
+
+auto asBytes(std::string const& text)
+    -> std::span<char const>
+{
+    return std::span<char const>(text);
+}
+
+template<typename StreamT>
+void writeRecords(StreamT& stream, std::size_t count, std::size_t blockSize)
+{
+    scppl::BlockFileWriter<StreamT> writer(stream, {.blockSize = blockSize});
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // Only even keys, so odd keys are missing between records
+        writer.add(asBytes(makeKey(2 * i)), asBytes(makeValue(i)));
+    }
+
+    writer.finish();
+    ASSERT_EQ(writer.records(), count);
+}
+
+template<typename StreamT>
+void findAndAssert(StreamT& stream, std::size_t count)
+{
+    scppl::BlockFileReader<StreamT> reader(stream);
+    ASSERT_GT(reader.blocks(), 1);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto value = reader.find(asBytes(makeKey(2 * i)));
+        ASSERT_TRUE(value);
+        ASSERT_EQ(std::string(value->begin(), value->end()), makeValue(i));
+
+        ASSERT_FALSE(reader.find(asBytes(makeKey(2 * i + 1))));
+    }
+
+    ASSERT_FALSE(reader.find(asBytes(std::string("a"))));
+    ASSERT_FALSE(reader.find(asBytes(std::string("z"))));
+
+    // Every record is in exactly one block, in order
+    std::size_t index = 0;
+    for (std::size_t block = 0; block < reader.blocks(); ++block)
+    {
+        auto records = reader.readBlock(block);
+        ASSERT_EQ(std::string(records[0].key.begin(), records[0].key.end()),
+                  std::string(reader.firstKey(block).begin(),
+                              reader.firstKey(block).end()));
+
+        for (auto const& entry : records)
+        {
+            ASSERT_EQ(std::string(entry.key.begin(), entry.key.end()),
+                      makeKey(2 * index));
+            ++index;
+        }
+    }
+
+    ASSERT_EQ(index, count);
+}
+
+TEST(BlockFile, WriteFindStringStream)
+{
+    std::stringstream stream{};
+    writeRecords(stream, 1000, 256);
+    findAndAssert(stream, 1000);
+}
+
+TEST(BlockFile, WriteFindBufferStream)
+{
+    scppl::BufferStream<> stream{};
+    writeRecords(stream, 1000, 1024);
+    findAndAssert(stream, 1000);
+}
+
+TEST(BlockFile, LargeRecordAndEmptyFile)
+{
+    std::stringstream stream{};
+    {
+        scppl::BlockFileWriter<> writer(stream, {.blockSize = 64});
+        writer.add(asBytes(makeKey(0)), asBytes(std::string(1000, 'x')));
+        writer.add(asBytes(makeKey(1)), asBytes(std::string{}));
+        ASSERT_EQ(writer.blocks(), 2);
+    }
+
+    scppl::BlockFileReader<> reader(stream);
+    ASSERT_EQ(reader.blocks(), 2);
+    ASSERT_EQ(reader.find(asBytes(makeKey(0)))->size(), 1000);
+    ASSERT_TRUE(reader.find(asBytes(makeKey(1)))->empty());
+
+    std::stringstream empty{};
+    scppl::BlockFileWriter<>(empty).finish();
+
+    scppl::BlockFileReader<> emptyReader(empty);
+    ASSERT_EQ(emptyReader.blocks(), 0);
+    ASSERT_FALSE(emptyReader.find(asBytes(makeKey(0))));
+}
+
+TEST(BlockFile, AfterHeader)
+{
+    // The offsets in the file count from the start of the stream
+    std::stringstream stream{};
+    stream << "header";
+    stream.seekg(6);
+    writeRecords(stream, 100, 256);
+    ASSERT_EQ(stream.str().substr(0, 6), "header");
+    findAndAssert(stream, 100);
+}
+
+TEST(BlockFile, HugeRecord)
+{
+    // Longer than the default maximum of `readFrame()`
+    std::size_t length = scppl::BinaryStream<>::defaultMaxFrameLength + 1;
+
+    scppl::BufferStream<> stream{};
+    {
+        scppl::BlockFileWriter<scppl::BufferStream<>> writer(stream);
+        writer.add(asBytes(makeKey(0)), asBytes(std::string(length, 'x')));
+    }
+
+    scppl::BlockFileReader<scppl::BufferStream<>> reader(stream);
+    ASSERT_EQ(reader.find(asBytes(makeKey(0)))->size(), length);
+}
+
+TEST(BlockFile, KeyOrder)
+{
+    std::stringstream stream{};
+    scppl::BlockFileWriter<> writer(stream);
+    writer.add(asBytes(makeKey(1)), asBytes(makeValue(1)));
+
+    ASSERT_THROW(writer.add(asBytes(makeKey(1)), asBytes(makeValue(1))),
+                 std::invalid_argument);
+    ASSERT_THROW(writer.add(asBytes(makeKey(0)), asBytes(makeValue(0))),
+                 std::invalid_argument);
+
+    // Bytes compare as unsigned, and a prefix is less
+    writer.add(asBytes(makeKey(1) + "\x01"), asBytes(makeValue(2)));
+    writer.add(asBytes(makeKey(1) + "\xFF"), asBytes(makeValue(3)));
+
+    writer.finish();
+    ASSERT_THROW(writer.add(asBytes(makeKey(2)), asBytes(makeValue(2))),
+                 std::invalid_argument);
+}
+
+TEST(BlockFile, Corruption)
+{
+    std::stringstream stream{};
+    writeRecords(stream, 100, 256);
+    std::string data = stream.str();
+
+    // A flipped byte in the first block only fails that block
+    std::stringstream corruptBlock(data);
+    corruptBlock.seekp(1);
+    corruptBlock.put('#');
+
+    scppl::BlockFileReader<> reader(corruptBlock);
+    ASSERT_THROW(reader.readBlock(0), std::runtime_error);
+    ASSERT_NO_THROW(reader.readBlock(1));
+    ASSERT_THROW(reader.readBlock(reader.blocks()), std::out_of_range);
+
+    // A flipped byte in the index or footer fails opening
+    for (std::size_t offset : {scppl::blockFileFooterLength + 2,
+                               std::size_t{1}, std::size_t{10}})
+    {
+        std::string corrupt = data;
+        corrupt[corrupt.size() - offset] ^= 0x5A;
+
+        std::stringstream corruptIndex(corrupt);
+        ASSERT_THROW(scppl::BlockFileReader<>{corruptIndex},
+                     std::runtime_error);
+    }
+
+    std::stringstream truncated(data.substr(0, 10));
+    ASSERT_THROW(scppl::BlockFileReader<>{truncated}, std::runtime_error);
+}
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/Checksum.hpp"
+
+TEST(Checksum, Crc32cKnownValues)
+{
+    constexpr std::string_view digits = "123456789";
+
+    ASSERT_EQ(scppl::crc32c(std::span<char const>{}), 0u);
+    ASSERT_EQ(scppl::crc32c(std::span<char const>(digits)), 0xE3069283u);
+
+    std::vector<unsigned char> zeros(32, 0);
+    ASSERT_EQ(scppl::crc32c(std::span<unsigned char const>(zeros)),
+              0x8A9136AAu);
+
+    static_assert(scppl::crc32c(std::span<char const>(digits)) == 0xE3069283u);
+}
+
+TEST(Checksum, Crc32cChained)
+{
+    std::vector<char> data(1000);
+    std::iota(std::ranges::begin(data), std::ranges::end(data), char{0});
+    std::span<char const> bytes(data);
+
+    std::uint32_t whole = scppl::crc32c(bytes);
+    for (std::size_t split : {0, 1, 7, 8, 9, 500, 999, 1000})
+    {
+        ASSERT_EQ(scppl::crc32c(bytes.subspan(split),
+                                scppl::crc32c(bytes.first(split))),
+                  whole);
+    }
+}
+
+TEST(Checksum, Crc32cHardwareMatchesSoftware)
+{
+    std::vector<unsigned char> data(40000);
+    for (std::size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<unsigned char>(i * 31 + i / 97);
+
+    std::span<unsigned char const> bytes(data);
+
+    // Around the stripes of 3 * 4096 bytes, and from unaligned starts
+    for (std::size_t length : {0, 1, 7, 8, 9, 100, 12287, 12288, 12289,
+                               24576, 30000, 39999})
+    {
+        for (std::size_t start : {0, 1, 3})
+        {
+            auto part = bytes.subspan(start, length);
+            ASSERT_EQ(scppl::crc32cHardware(part, 0x12345678u),
+                      scppl::crc32cSoftware(part, 0x12345678u));
+            ASSERT_EQ(scppl::crc32c(part), scppl::crc32cSoftware(part));
+        }
+    }
+}
+
+TEST(Checksum, Crc32cCombine)
+{
+    std::vector<char> data(5000);
+    std::iota(std::ranges::begin(data), std::ranges::end(data), char{3});
+    std::span<char const> bytes(data);
+
+    std::uint32_t whole = scppl::crc32c(bytes);
+    for (std::size_t split : {0, 1, 8, 2500, 4999, 5000})
+    {
+        auto second = bytes.subspan(split);
+        ASSERT_EQ(scppl::crc32cCombine(scppl::crc32c(bytes.first(split)),
+                                       scppl::crc32c(second), second.size()),
+                  whole);
+    }
+}
+
+TEST(Checksum, Crc32cAccumulator)
+{
+    constexpr std::string_view digits = "123456789";
+
+    scppl::Crc32c crc{};
+    crc.update(std::span<char const>(digits.substr(0, 4)));
+    crc.update(std::span<char const>(digits.substr(4)));
+    ASSERT_EQ(crc.value(), 0xE3069283u);
+
+    crc.reset();
+    ASSERT_EQ(crc.value(), 0u);
+}
+
+TEST(Checksum, XxHash64KnownValues)
+{
+    constexpr std::string_view sentence =
+        "Nobody inspects the spammish repetition";
+
+    ASSERT_EQ(scppl::xxHash64(std::span<char const>{}), 0xEF46DB3751D8E999u);
+    ASSERT_EQ(scppl::xxHash64(std::span<char const>(std::string_view("abc"))),
+              0x44BC2CF5AD770999u);
+    ASSERT_EQ(scppl::xxHash64(std::span<char const>(sentence)),
+              0xFBCEA83C8A378BF1u);
+
+    static_assert(scppl::xxHash64(std::span<char const>{}) ==
+                  0xEF46DB3751D8E999u);
+}
+
+TEST(Checksum, XxHash64Parts)
+{
+    std::vector<char> data(1000);
+    std::iota(std::ranges::begin(data), std::ranges::end(data), char{0});
+    std::span<char const> bytes(data);
+
+    for (std::uint64_t seed : {0u, 42u})
+    {
+        std::uint64_t whole = scppl::xxHash64(bytes, seed);
+        for (std::size_t split : {0, 1, 5, 31, 32, 33, 500, 999})
+        {
+            scppl::XxHash64 hash(seed);
+            hash.update(bytes.first(split));
+
+            // Small updates go through the stripe buffer
+            for (std::size_t i = split; i < bytes.size(); i += 3)
+                hash.update(bytes.subspan(i, std::min<std::size_t>(
+                                                 3, bytes.size() - i)));
+
+            ASSERT_EQ(hash.value(), whole);
+        }
+    }
+
+    ASSERT_NE(scppl::xxHash64(bytes, 42), scppl::xxHash64(bytes));
+}
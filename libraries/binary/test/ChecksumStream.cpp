@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/Binary.hpp"
+#include "scppl/binary/Checksum.hpp"
+#include "scppl/binary/ChecksumStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+TEST(ChecksumStream, Write)
+{
+    constexpr std::string_view payload = "checksummed payload";
+
+    scppl::BufferStream<> buffer{};
+    scppl::ChecksumStream checksummed(buffer);
+    scppl::ChecksumBinaryStream<scppl::BufferStream<>,
+                                std::endian::little> stream(checksummed);
+
+    stream.write(std::uint32_t{1}, std::uint16_t{2});
+    stream.writeRaw(std::span<char const>(payload));
+    auto crc = checksummed.value();
+    ASSERT_EQ(crc, scppl::crc32c(buffer.data()));
+
+    // The checksum itself is written, but starts a new one after reset
+    stream.write(crc);
+    checksummed.reset();
+    ASSERT_EQ(checksummed.value(), 0u);
+    ASSERT_EQ(buffer.data().size(), 6 + payload.size() + 4);
+}
+
+TEST(ChecksumStream, WriteLarge)
+{
+    std::string large(10000, 'l');
+
+    scppl::BufferStream<> buffer{};
+    scppl::ChecksumStream checksummed(buffer);
+    scppl::ChecksumBinaryStream<scppl::BufferStream<>,
+                                std::endian::little> stream(checksummed);
+
+    // Small values around writes larger than the collected bytes
+    for (std::uint32_t i = 0; i < 1000; ++i)
+    {
+        stream.write(i);
+        if (i % 300 == 0)
+            stream.writeRaw(std::span<char const>(large));
+    }
+
+    ASSERT_EQ(checksummed.value(), scppl::crc32c(buffer.data()));
+}
+
+TEST(ChecksumStream, ReadSpanSource)
+{
+    auto data = scppl::Binary<std::endian::little>::pack<
+        std::uint32_t, std::uint64_t, std::uint16_t>(7, 8, 9);
+
+    scppl::SpanStream<> span(data);
+    scppl::ChecksumStream<scppl::SpanStream<>, scppl::XxHash64> checksummed(
+        span);
+    scppl::ChecksumBinaryStream<scppl::SpanStream<>, std::endian::little,
+                                scppl::XxHash64> stream(checksummed);
+
+    // Only the consumed bytes are added
+    auto [a, b] = stream.read<std::uint32_t, std::uint64_t>();
+    ASSERT_EQ(a, 7u);
+    ASSERT_EQ(b, 8u);
+    ASSERT_EQ(checksummed.value(), scppl::xxHash64(
+                                       std::span<char const>(data).first(12)));
+
+    ASSERT_EQ(stream.readSingle<std::uint16_t>(), 9u);
+    ASSERT_EQ(checksummed.value(),
+              scppl::xxHash64(std::span<char const>(data)));
+}
+
+TEST(ChecksumStream, ReadStream)
+{
+    std::string data = "bytes read with an istream";
+    std::istringstream input(data);
+    scppl::ChecksumStream checksummed(input);
+
+    std::string read(data.size(), '\0');
+    ASSERT_EQ(checksummed.read(read.data(), 5), 5u);
+    ASSERT_EQ(checksummed.read(read.data() + 5, 100), data.size() - 5);
+    ASSERT_EQ(read, data);
+    ASSERT_EQ(checksummed.value(),
+              scppl::crc32c(std::span<char const>(data)));
+}
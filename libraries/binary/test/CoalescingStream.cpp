@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/CoalescingStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+static_assert(scppl::SpanSink<scppl::CoalescingStream<VectorSink>, char>);
+static_assert(!scppl::SeekableSink<scppl::CoalescingStream<VectorSink>>);
+static_assert(scppl::OutputStream<scppl::CoalescingStream<std::ostream>,
+                                  char>);
+
+TEST(CoalescingStream, FlushWhenFull)
+{
+    constexpr std::size_t length = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+
+    VectorSink sink{};
+    scppl::CoalescingStream<VectorSink> coalescing(sink,
+                                                   {.capacity = 4 * length});
+    scppl::CoalescingBinaryStream<VectorSink, std::endian::little>
+        stream(coalescing);
+
+    for (std::size_t i = 0; i < 10; ++i)
+        stream.write(A, B, C, D);
+
+    ASSERT_EQ(sink.writes(), 2);
+    ASSERT_EQ(coalescing.buffered(), 2 * length);
+
+    coalescing.flush();
+    ASSERT_EQ(sink.writes(), 3);
+    ASSERT_EQ(std::ranges::size(sink.data()), 10 * length);
+
+    auto expected = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    ASSERT_TRUE(std::ranges::equal(std::span(sink.data()).first(length),
+                                   expected));
+}
+
+TEST(CoalescingStream, Triggers)
+{
+    VectorSink sink{};
+
+    {
+        scppl::CoalescingStream<VectorSink> coalescing(sink, {.threshold = 16});
+        scppl::CoalescingBinaryStream<VectorSink> stream(coalescing);
+
+        // 8 bytes stay buffered, 16 bytes reach the threshold
+        stream.write(D);
+        ASSERT_EQ(sink.writes(), 0);
+        stream.write(D);
+        ASSERT_EQ(sink.writes(), 1);
+    }
+
+    {
+        scppl::CoalescingStream<VectorSink> coalescing(sink, {.records = 3});
+        scppl::CoalescingBinaryStream<VectorSink> stream(coalescing);
+
+        for (std::size_t i = 0; i < 7; ++i)
+            stream.write(A);
+        ASSERT_EQ(sink.writes(), 3);
+    }
+
+    // The last record is flushed on destruction
+    ASSERT_EQ(sink.writes(), 4);
+    ASSERT_EQ(std::ranges::size(sink.data()), 23);
+}
+
+TEST(CoalescingStream, NoFlushOnDestroy)
+{
+    VectorSink sink{};
+
+    {
+        scppl::CoalescingStream<VectorSink> coalescing(sink,
+                                                       {.flushOnDestroy =
+                                                            false});
+        scppl::CoalescingBinaryStream<VectorSink> stream(coalescing);
+        stream.write(C);
+    }
+
+    ASSERT_EQ(sink.writes(), 0);
+}
+
+TEST(CoalescingStream, LargeWrite)
+{
+    VectorSink sink{};
+    scppl::CoalescingStream<VectorSink> coalescing(sink, {.capacity = 16});
+
+    std::vector<char> data(64, 'x');
+    coalescing.write(std::ranges::data(data), 4);
+    coalescing.write(std::ranges::data(data), 64);
+
+    // The buffered bytes are written first, then the large write directly
+    ASSERT_EQ(sink.writes(), 2);
+    ASSERT_EQ(coalescing.buffered(), 0);
+    ASSERT_EQ(std::ranges::size(sink.data()), 68);
+}
+
+TEST(CoalescingStream, LargeWriteBinaryStream)
+{
+    VectorSink sink{};
+    scppl::CoalescingStream<VectorSink> coalescing(sink, {.capacity = 16});
+    scppl::CoalescingBinaryStream<VectorSink, std::endian::big>
+        stream(coalescing);
+
+    // Raw bytes bypass the buffer like a direct write
+    std::vector<char> data(1024, 'x');
+    stream.write(C);
+    stream.writeRaw(data);
+    ASSERT_EQ(sink.writes(), 2);
+    ASSERT_EQ(coalescing.buffered(), 0);
+    ASSERT_EQ(std::ranges::size(sink.data()), 4 + 1024);
+
+    // Converted values larger than the buffer are written right away
+    std::vector<std::uint32_t> values(64, 0x01020304);
+    stream.writeArray(std::span<std::uint32_t const>(values));
+    ASSERT_EQ(coalescing.buffered(), 0);
+    ASSERT_EQ(std::ranges::size(sink.data()), 4 + 1024 + 256);
+    ASSERT_EQ(sink.data().back(), 0x04);
+
+    stream.write(C);
+    ASSERT_EQ(coalescing.buffered(), 4);
+}
+
+TEST(CoalescingStream, Seek)
+{
+    std::stringstream stringstream{};
+    scppl::CoalescingStream<std::ostream> coalescing(stringstream);
+    scppl::CoalescingBinaryStream<std::ostream, std::endian::big>
+        stream(coalescing);
+
+    stream.write(D, D);
+    ASSERT_EQ(stream.tell(), 16);
+    ASSERT_TRUE(std::ranges::empty(stringstream.str()));
+
+    stream.toBegin(8);
+    stream.write(C);
+    coalescing.flush();
+
+    auto expected = combineArrays(DDataBE, CDataBE, std::array<char, 4>{});
+    std::copy_n(std::ranges::begin(DDataBE) + 4, 4,
+                std::ranges::begin(expected) + 12);
+    ASSERT_TRUE(std::ranges::equal(stringstream.str(), expected));
+}
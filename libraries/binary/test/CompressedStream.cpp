@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/CompressedStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+namespace {
+
+auto makeText(std::size_t length)
+    -> std::string
+{
+    std::string text{};
+    for (std::size_t i = 0; text.size() < length; ++i)
+        text += "line " + std::to_string(i % 113) + " of the text\n";
+
+    text.resize(length);
+
+    return text;
+}
+
+}
+
+TEST(CompressedStream, RoundTrip)
+{
+    std::string text = makeText(10000);
+
+    scppl::BufferStream<> buffer{};
+    {
+        scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(
+            buffer, {.blockSize = 1024});
+        writer.write(text.data(), text.size());
+        ASSERT_EQ(writer.tellp(), text.size());
+
+        writer.finish();
+        ASSERT_EQ(writer.blocks(), 10u);
+        ASSERT_LT(writer.written(), text.size() / 2);
+    }
+
+    scppl::SpanStream<> source(buffer.data().first(buffer.tellp()));
+    scppl::CompressedStreamReader<scppl::SpanStream<>> reader(source);
+    ASSERT_EQ(reader.size(), text.size());
+    ASSERT_EQ(reader.blocks(), 10u);
+
+    std::string read(text.size() + 10, '\0');
+    ASSERT_EQ(reader.read(read.data(), read.size()), text.size());
+    ASSERT_TRUE(reader.eof());
+    read.resize(text.size());
+    ASSERT_EQ(read, text);
+}
+
+TEST(CompressedStream, BinaryStream)
+{
+    scppl::BufferStream<> buffer{};
+    {
+        scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(
+            buffer, {.blockSize = 100});
+        scppl::CompressedBinaryOutputStream<scppl::BufferStream<>,
+                                            std::endian::little> stream(
+            writer);
+
+        // Values cross block boundaries
+        for (std::uint32_t i = 0; i < 1000; ++i)
+            stream.write(i, std::uint8_t{7}, std::uint64_t{i} * 3);
+    }
+
+    scppl::SpanStream<> source(buffer.data().first(buffer.tellp()));
+    scppl::CompressedStreamReader<scppl::SpanStream<>> reader(source);
+    scppl::CompressedBinaryInputStream<scppl::SpanStream<>,
+                                       std::endian::little> stream(reader);
+    for (std::uint32_t i = 0; i < 1000; ++i)
+    {
+        auto [a, b, c] = stream.read<std::uint32_t, std::uint8_t,
+                                     std::uint64_t>();
+        ASSERT_EQ(a, i);
+        ASSERT_EQ(b, 7u);
+        ASSERT_EQ(c, std::uint64_t{i} * 3);
+    }
+
+    // Seeking only decompresses the block at the new position
+    stream.toBegin(13 * 500);
+    ASSERT_EQ(stream.readSingle<std::uint32_t>(), 500u);
+
+    stream.toBegin(13 * 999);
+    ASSERT_EQ(stream.readSingle<std::uint32_t>(), 999u);
+}
+
+TEST(CompressedStream, AfterHeader)
+{
+    std::string text = makeText(5000);
+
+    // The offsets in the stream count from the start of the stream
+    scppl::BufferStream<> buffer{};
+    buffer.write("header", 6);
+    buffer.seekg(6);
+    {
+        scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(
+            buffer, {.blockSize = 1024});
+        writer.write(text.data(), text.size());
+        writer.finish();
+        ASSERT_EQ(writer.written() + 6, buffer.tellp());
+    }
+
+    ASSERT_EQ(std::string(buffer.data().begin(), buffer.data().begin() + 6),
+              "header");
+
+    scppl::SpanStream<> source(buffer.data().first(buffer.tellp()));
+    scppl::CompressedStreamReader<scppl::SpanStream<>> reader(source);
+    ASSERT_EQ(reader.size(), text.size());
+
+    std::string read(text.size(), '\0');
+    ASSERT_EQ(reader.read(read.data(), read.size()), text.size());
+    ASSERT_EQ(read, text);
+}
+
+TEST(CompressedStream, Incompressible)
+{
+    std::vector<char> data(5000);
+    std::uint64_t state = 7;
+    for (char& byte : data)
+    {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        byte = static_cast<char>(state >> 56);
+    }
+
+    scppl::BufferStream<> buffer{};
+    scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(
+        buffer, {.blockSize = 1000});
+    writer.write(data.data(), data.size());
+    writer.finish();
+
+    // Stored as is, plus the index and the footer
+    ASSERT_LE(writer.written(), data.size() + 4 + 5 * 21 +
+                                    scppl::compressedStreamFooterLength);
+
+    scppl::SpanStream<> source(buffer.data().first(buffer.tellp()));
+    scppl::CompressedStreamReader<scppl::SpanStream<>> reader(source);
+    reader.seekg(2500);
+
+    std::vector<char> read(100);
+    ASSERT_EQ(reader.read(read.data(), read.size()), read.size());
+    ASSERT_TRUE(std::ranges::equal(read, std::span(data).subspan(2500, 100)));
+}
+
+TEST(CompressedStream, Corrupt)
+{
+    std::string text = makeText(5000);
+
+    scppl::BufferStream<> buffer{};
+    {
+        scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(
+            buffer, {.blockSize = 1000});
+        writer.write(text.data(), text.size());
+    }
+
+    std::vector<char> data(buffer.data().begin(),
+                           buffer.data().begin() + buffer.tellp());
+
+    // A changed block is found when reading it
+    data[3] ^= 0x10;
+    scppl::SpanStream<> source(data);
+    scppl::CompressedStreamReader<scppl::SpanStream<>> reader(source);
+
+    std::string read(100, '\0');
+    ASSERT_THROW(reader.read(read.data(), read.size()), std::runtime_error);
+
+    // A changed footer is found when opening
+    data.back() ^= 0x10;
+    scppl::SpanStream<> other(data);
+    ASSERT_THROW(scppl::CompressedStreamReader<scppl::SpanStream<>>{other},
+                 std::runtime_error);
+}
+
+TEST(CompressedStream, InvalidOptions)
+{
+    scppl::BufferStream<> buffer{};
+    ASSERT_THROW(scppl::CompressedStreamWriter<scppl::BufferStream<>>(
+                     buffer, {.blockSize = 0}),
+                 std::invalid_argument);
+
+    scppl::CompressedStreamWriter<scppl::BufferStream<>> writer(buffer);
+    writer.finish();
+    ASSERT_THROW(writer.write("a", 1), std::invalid_argument);
+}
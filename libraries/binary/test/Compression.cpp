@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/Compression.hpp"
+
+namespace {
+
+auto roundTrip(std::span<char const> input)
+    -> std::size_t
+{
+    std::vector<std::uint32_t> table(scppl::lzHashLength);
+    std::vector<char> compressed(scppl::lzCompressBound(input.size()));
+    std::size_t length = scppl::lzCompress(input, std::span<char>(compressed),
+                                           std::span(table));
+
+    std::vector<char> output(input.size());
+    EXPECT_EQ(scppl::lzDecompress(std::span<char const>(compressed.data(),
+                                                        length),
+                                  std::span<char>(output)),
+              input.size());
+    EXPECT_TRUE(std::ranges::equal(output, input));
+
+    return length;
+}
+
+}
+
+TEST(Compression, LzRoundTrip)
+{
+    // Empty, shorter than a match, and overlapping matches
+    ASSERT_EQ(roundTrip({}), 1u);
+    roundTrip(std::string_view("abc"));
+    ASSERT_LT(roundTrip(std::string(1000, 'a')), 20u);
+
+    std::string text{};
+    for (int i = 0; i < 2000; ++i)
+        text += "record " + std::to_string(i % 37) + " value;";
+
+    ASSERT_LT(roundTrip(text), text.size() / 4);
+}
+
+TEST(Compression, LzIncompressible)
+{
+    std::vector<char> data(100000);
+    std::uint64_t state = 1;
+    for (char& byte : data)
+    {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        byte = static_cast<char>(state >> 56);
+    }
+
+    // At most the bound, and still decompresses
+    ASSERT_LE(roundTrip(data), scppl::lzCompressBound(data.size()));
+}
+
+TEST(Compression, LzCorrupt)
+{
+    std::string text(500, 'x');
+    std::vector<std::uint32_t> table(scppl::lzHashLength);
+    std::vector<char> compressed(scppl::lzCompressBound(text.size()));
+    std::size_t length = scppl::lzCompress(std::span<char const>(text),
+                                           std::span<char>(compressed),
+                                           std::span(table));
+
+    std::vector<char> output(text.size());
+
+    // Truncated, and an output that is too short
+    ASSERT_THROW(scppl::lzDecompress(std::span<char const>(compressed.data(),
+                                                           length - 1),
+                                     std::span<char>(output)),
+                 std::runtime_error);
+    ASSERT_THROW(scppl::lzDecompress(std::span<char const>(compressed.data(),
+                                                           length),
+                                     std::span<char>(output).first(100)),
+                 std::runtime_error);
+
+    // An offset before the start of the output
+    std::vector<char> invalid = {0x10, 'a', 0x05, 0x00};
+    ASSERT_THROW(scppl::lzDecompress(std::span<char const>(invalid),
+                                     std::span<char>(output)),
+                 std::runtime_error);
+}
+
+TEST(Compression, BlockCodec)
+{
+    std::string text{};
+    for (int i = 0; i < 1000; ++i)
+        text += "block " + std::to_string(i % 10);
+
+    scppl::BlockCodec codec{};
+    for (auto compression : {scppl::Compression::None, scppl::Compression::Lz,
+                             scppl::Compression::Zstd,
+                             scppl::Compression::Lz4})
+    {
+        if (!scppl::isCompressionAvailable(compression))
+        {
+            ASSERT_THROW(scppl::BlockCodec::compressBound(compression, 1),
+                         std::invalid_argument);
+
+            continue;
+        }
+
+        std::vector<char> compressed(scppl::BlockCodec::compressBound(
+            compression, text.size()));
+        std::size_t length = codec.compress(compression,
+                                            std::span<char const>(text),
+                                            std::span<char>(compressed));
+
+        std::string output(text.size(), '\0');
+        codec.decompress(compression, std::span<char const>(compressed.data(),
+                                                            length),
+                         std::span<char>(output));
+        ASSERT_EQ(output, text);
+
+        // The length of the block is checked
+        std::string longer(text.size() + 1, '\0');
+        ASSERT_THROW(codec.decompress(compression, std::span<char const>(
+                                          compressed.data(), length),
+                                      std::span<char>(longer)),
+                     std::runtime_error);
+    }
+}
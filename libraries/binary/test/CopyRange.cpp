@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/CopyRange.hpp"
+#include "scppl/binary/FileStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+namespace {
+
+auto makePayload(std::size_t length)
+    -> std::vector<char>
+{
+    std::vector<char> payload(length);
+    std::iota(std::ranges::begin(payload), std::ranges::end(payload), 0);
+
+    return payload;
+}
+
+}
+
+TEST(CopyRange, StringStream)
+{
+    auto payload = makePayload(3000);
+
+    std::stringstream input{};
+    scppl::BinaryStream<std::endian::big> source(input);
+    source.write(static_cast<uint32_t>(std::ranges::size(payload)));
+    source.writeRaw(payload);
+    source.toBegin();
+
+    std::stringstream output{};
+    scppl::BinaryStream<std::endian::little> destination(output);
+
+    auto length = source.readSingle<uint32_t>();
+    ASSERT_EQ(scppl::copyRange(source, destination, length), length);
+    ASSERT_EQ(source.tell(), 3004);
+    ASSERT_EQ(destination.tell(), 3000);
+    ASSERT_TRUE(std::ranges::equal(output.str(), payload));
+
+    // Copying past the end copies what is left
+    source.toBegin(3000);
+    ASSERT_EQ(scppl::copyRange(source, destination, 100), 4);
+}
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+TEST(CopyRange, FileStream)
+{
+    TemporaryFile inputFile("scppl_test_copy_range_input");
+    TemporaryFile outputFile("scppl_test_copy_range_output");
+
+    auto payload = makePayload(100'000);
+
+    scppl::FileStream<> input(inputFile.path(),
+                              std::ios::in | std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> source(input);
+    source.write(D);
+    source.writeRaw(payload);
+    source.toBegin(8);
+
+    scppl::FileStream<> output(outputFile.path(),
+                               std::ios::in | std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> destination(output);
+    destination.write(C);
+
+    // The pending writes of both streams are flushed before copying
+    ASSERT_EQ(scppl::copyRange(source, destination, 200'000), 100'000);
+    ASSERT_TRUE(source.eof());
+    ASSERT_EQ(destination.tell(), 100'004);
+
+    destination.write(B);
+    destination.toBegin();
+    ASSERT_EQ(destination.readSingle<C_t>(), C);
+    ASSERT_EQ(destination.readRaw(100'000), payload);
+    ASSERT_EQ(destination.readSingle<B_t>(), B);
+}
+
+TEST(CopyRange, FileStreamToStringStream)
+{
+    TemporaryFile inputFile("scppl_test_copy_range_mixed");
+
+    auto payload = makePayload(5000);
+
+    scppl::FileStream<> input(inputFile.path(),
+                              std::ios::in | std::ios::out | std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::little> source(input);
+    source.writeRaw(payload);
+    source.toBegin(1000);
+
+    std::stringstream output{};
+    scppl::BinaryStream<std::endian::little> destination(output);
+    ASSERT_EQ(scppl::copyRange(source, destination, 2000), 2000);
+    ASSERT_TRUE(std::ranges::equal(output.str(),
+                                   std::span(payload).subspan(1000, 2000)));
+}
+#endif
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/DynamicEndianBinaryStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+TEST(DynamicEndianBinaryStream, Read)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE,
+                              ADataLE, BDataLE, CDataLE, DDataLE);
+    std::stringstream stringstream(std::string(std::ranges::begin(data),
+                                               std::ranges::end(data)));
+    scppl::DynamicEndianBinaryStream<> stream(stringstream, std::endian::big);
+    ASSERT_EQ(stream.endian(), std::endian::big);
+
+    ASSERT_EQ(stream.peekSingle<A_t>(), A);
+    assertValuesEqual(stream.read<A_t, B_t>(), std::tuple{A, B});
+    ASSERT_EQ(stream.readSingle<C_t>(), C);
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+
+    stream.setEndian(std::endian::little);
+    assertValuesEqual(stream.peek<A_t, B_t>(), std::tuple{A, B});
+    assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                      std::tuple{A, B, C, D});
+}
+
+TEST(DynamicEndianBinaryStream, Write)
+{
+    std::stringstream stringstream{};
+    scppl::DynamicEndianBinaryStream<> stream(stringstream);
+
+    stream.setEndian(std::endian::big);
+    stream.write(A, B, C, D);
+    stream.setEndian(std::endian::little);
+    stream.write(A, B, C, D);
+
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE,
+                              ADataLE, BDataLE, CDataLE, DDataLE);
+    ASSERT_EQ(stringstream.str(), std::string(std::ranges::begin(data),
+                                              std::ranges::end(data)));
+}
+
+TEST(DynamicEndianBinaryStream, Arrays)
+{
+    std::array<D_t, 4> values{D, D, D, D};
+
+    for (std::endian endian : {std::endian::big, std::endian::little})
+    {
+        std::stringstream stringstream{};
+        scppl::DynamicEndianBinaryStream<> stream(stringstream, endian);
+        stream.writeArray<D_t>(values);
+
+        std::string expected = (endian == std::endian::big)
+            ? std::string(std::ranges::begin(DArrayDataBE),
+                          std::ranges::end(DArrayDataBE))
+            : std::string(std::ranges::begin(DArrayDataLE),
+                          std::ranges::end(DArrayDataLE));
+        ASSERT_EQ(stringstream.str(), expected);
+
+        stream.toBegin();
+        ASSERT_EQ(stream.readArray<D_t>(4), std::vector<D_t>(4, D));
+    }
+}
+
+TEST(DynamicEndianBinaryStream, SpanStream)
+{
+    auto data = combineArrays(CDataLE, CDataBE);
+    scppl::BufferStream<> bufferStream{};
+    scppl::DynamicEndianBinaryStream<true, scppl::BufferStream<>>
+        stream(bufferStream, std::endian::little);
+
+    // Packed straight into the buffer of the sink
+    stream.writeFrame<scppl::FramePrefix::U16>(data);
+    stream.setEndian(std::endian::big);
+    stream.write(C);
+    stream.writeFrame<scppl::FramePrefix::U16>(data);
+
+    auto bytes = bufferStream.release();
+    scppl::SpanStream<> spanStream{std::span<char const>(bytes)};
+    scppl::DynamicEndianBinaryStream<true, scppl::SpanStream<>>
+        reader(spanStream, std::endian::little);
+    ASSERT_EQ(std::get<0>(reader.readAt<C_t>(2)), C);
+    reader.setEndian(std::endian::big);
+    ASSERT_EQ(std::get<0>(reader.readAt<C_t>(2)), 0x67'45'23'01);
+
+    reader.setEndian(std::endian::little);
+    ASSERT_EQ(std::ranges::size(reader.readFrame<scppl::FramePrefix::U16>()),
+              8);
+    reader.setEndian(std::endian::big);
+    ASSERT_EQ(reader.readSingle<C_t>(), C);
+    ASSERT_EQ(std::ranges::size(reader.readFrame<scppl::FramePrefix::U16>()),
+              8);
+}
+
+TEST(DynamicEndianBinaryStream, InvalidEndian)
+{
+    std::stringstream stringstream{};
+    scppl::DynamicEndianBinaryStream<> stream(stringstream);
+    ASSERT_THROW(stream.setEndian(static_cast<std::endian>(-1)),
+                 std::invalid_argument);
+    ASSERT_EQ(stream.endian(), std::endian::native);
+}
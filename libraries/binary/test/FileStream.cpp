@@ -0,0 +1,293 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/FileStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+template<std::endian tEndian>
+void writeAndReadAndAssert(scppl::FileStreamOptions options)
+{
+    TemporaryFile file("scppl_test_file_stream");
+
+    {
+        scppl::FileStream<> fileStream(file.path(),
+                                       std::ios::out | std::ios::trunc,
+                                       options);
+        scppl::FileBinaryStream<tEndian> stream(fileStream);
+        for (std::size_t i = 0; i < 64; ++i)
+            stream.write(A, B, C, D);
+    }
+
+    constexpr std::size_t length = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+    ASSERT_EQ(std::filesystem::file_size(file.path()), 64 * length);
+
+    scppl::FileStream<> fileStream(file.path(), std::ios::in, options);
+    scppl::FileBinaryStream<tEndian> stream(fileStream);
+    for (std::size_t i = 0; i < 64; ++i)
+        assertValuesEqual(stream.template read<A_t, B_t, C_t, D_t>(),
+                          std::tuple{A, B, C, D});
+
+    stream.template read<A_t>();
+    ASSERT_TRUE(stream.eof());
+}
+
+TEST(FileStream, LittleEndianWriteRead)
+{
+    writeAndReadAndAssert<std::endian::little>({});
+}
+
+TEST(FileStream, BigEndianWriteRead)
+{
+    writeAndReadAndAssert<std::endian::big>({});
+}
+
+TEST(FileStream, SmallBufferWriteRead)
+{
+    writeAndReadAndAssert<std::endian::little>({.bufferSize = 16,
+                                                .alignment = 8});
+}
+
+TEST(FileStream, SynchronizedWriteRead)
+{
+    writeAndReadAndAssert<std::endian::little>({.sync =
+                                                    scppl::FileSync::OnFlush});
+    writeAndReadAndAssert<std::endian::little>({.sync =
+                                                    scppl::FileSync::OnClose});
+}
+
+TEST(FileStream, DirectWriteRead)
+{
+    TemporaryFile file("scppl_test_file_stream_direct");
+
+    try
+    {
+        scppl::FileStream<> fileStream(file.path(),
+                                       std::ios::out | std::ios::trunc,
+                                       {.direct = true});
+    }
+    catch (std::system_error const& error)
+    {
+        if (error.code() == std::errc::invalid_argument)
+            GTEST_SKIP() << "O_DIRECT is not supported on this file system";
+
+        throw;
+    }
+
+    writeAndReadAndAssert<std::endian::little>({.direct = true});
+}
+
+TEST(FileStream, LargeWriteRead)
+{
+    TemporaryFile file("scppl_test_file_stream_large");
+
+    std::vector<char> data(1000);
+    std::iota(std::ranges::begin(data), std::ranges::end(data), 0);
+
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 64, .alignment = 64});
+    fileStream.write(std::ranges::data(data), 10);
+    fileStream.write(std::ranges::data(data) + 10, 990);
+    ASSERT_EQ(fileStream.tellp(), 1000);
+    ASSERT_EQ(fileStream.size(), 1000);
+
+    std::vector<char> read(1000);
+    fileStream.seekg(0);
+    ASSERT_EQ(fileStream.read(std::ranges::data(read), 1000), 1000);
+    ASSERT_EQ(read, data);
+}
+
+TEST(FileStream, LargeAcquire)
+{
+    TemporaryFile file("scppl_test_file_stream_acquire");
+
+    std::vector<char> data(1000);
+    std::iota(std::ranges::begin(data), std::ranges::end(data), 0);
+
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc,
+                                   {.bufferSize = 64, .alignment = 64});
+    fileStream.write(std::ranges::data(data), 1000);
+
+    // The buffer grows for a large view, but not for good
+    fileStream.seekg(0);
+    std::span<char const> view = fileStream.acquire(500);
+    ASSERT_GE(std::ranges::size(view), 500);
+    ASSERT_TRUE(std::ranges::equal(view.first(500),
+                                   std::span(data).first(500)));
+    fileStream.commit(500);
+
+    view = fileStream.acquire(100);
+    ASSERT_GE(std::ranges::size(view), 100);
+    ASSERT_EQ(view[0], data[500]);
+    ASSERT_EQ(fileStream.capacity(), 64 * 3);
+    fileStream.commit(std::ranges::size(view));
+
+    // Refilled after the buffered bytes, back at the configured size
+    std::size_t position = fileStream.tellg();
+    view = fileStream.acquire(4);
+    ASSERT_EQ(view[0], data[position]);
+    ASSERT_EQ(fileStream.capacity(), 64);
+}
+
+TEST(FileStream, BeginEndSeek)
+{
+    TemporaryFile file("scppl_test_file_stream_seek");
+
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc);
+    scppl::FileBinaryStream<> stream(fileStream);
+
+    stream.write(D, D);
+    ASSERT_EQ(stream.tell(), 16);
+
+    stream.toBegin(8);
+    ASSERT_EQ(stream.tell(), 8);
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+
+    stream.toEnd(-8);
+    stream.write(C);
+    ASSERT_EQ(stream.tell(), 12);
+
+    stream.toBegin();
+    assertValuesEqual(stream.read<D_t, C_t>(), std::tuple{D, C});
+}
+
+TEST(FileStream, GatherScatter)
+{
+    TemporaryFile file("scppl_test_file_stream_gather");
+
+    std::vector<char> payload(200);
+    std::iota(std::ranges::begin(payload), std::ranges::end(payload), 0);
+
+    // Both through the buffer and with `pwritev`/`preadv`
+    for (std::size_t bufferSize : {4096, 64})
+    {
+        scppl::FileStream<> fileStream(file.path(),
+                                       std::ios::in | std::ios::out |
+                                       std::ios::trunc,
+                                       {.bufferSize = bufferSize,
+                                        .alignment = 64});
+        scppl::FileBinaryStream<std::endian::big> stream(fileStream);
+
+        auto header = scppl::Binary<std::endian::big>::pack(C, D);
+        auto trailer = scppl::Binary<std::endian::big>::pack(B);
+        stream.writeGather(header, payload, trailer);
+        ASSERT_EQ(stream.tell(), 214);
+        ASSERT_EQ(fileStream.size(), 214);
+
+        std::array<char, 12> readHeader{};
+        std::vector<char> readPayload(200);
+        std::array<char, 4> readTrailer{};
+        stream.toBegin();
+        ASSERT_EQ(stream.readScatter(readHeader, readPayload, readTrailer),
+                  214);
+        ASSERT_TRUE(stream.eof());
+
+        ASSERT_EQ(readHeader, header);
+        ASSERT_EQ(readPayload, payload);
+        ASSERT_TRUE(std::ranges::equal(std::span(readTrailer).first(2),
+                                       trailer));
+    }
+}
+
+TEST(FileStream, ConcurrentReadAt)
+{
+    TemporaryFile file("scppl_test_file_stream_read_at");
+
+    scppl::FileStream<> fileStream(file.path(),
+                                   std::ios::in | std::ios::out |
+                                   std::ios::trunc);
+    scppl::FileBinaryStream<std::endian::big> stream(fileStream);
+    for (uint32_t i = 0; i < 1024; ++i)
+        stream.write(i, D);
+    fileStream.flush();
+
+    // Every thread reads its own records, while the position stays at the end
+    constexpr std::size_t length = scppl::lengthOf<uint32_t, D_t>();
+    std::vector<std::thread> threads{};
+    std::vector<std::size_t> mismatches(8);
+    for (std::size_t t = 0; t < std::ranges::size(mismatches); ++t)
+    {
+        threads.emplace_back([&, t]() -> void
+        {
+            for (std::size_t i = t; i < 1024; i += 8)
+            {
+                auto [index, d] = stream.readAt<uint32_t, D_t>(i * length);
+                if (index != i || d != D)
+                    ++mismatches[t];
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    ASSERT_EQ(std::reduce(std::ranges::begin(mismatches),
+                          std::ranges::end(mismatches)), 0);
+    ASSERT_EQ(stream.tell(), 1024 * length);
+
+    ASSERT_EQ(std::ranges::size(stream.readRawAt(1020 * length, 10 * length)),
+              4 * length);
+    ASSERT_THROW(stream.readAt<uint32_t>(1024 * length), std::out_of_range);
+}
+
+TEST(FileStream, DirectReadAt)
+{
+    TemporaryFile file("scppl_test_file_stream_direct_read_at");
+
+    try
+    {
+        scppl::FileStream<> fileStream(file.path(),
+                                       std::ios::out | std::ios::trunc,
+                                       {.direct = true});
+        scppl::FileBinaryStream<std::endian::little> stream(fileStream);
+        stream.write(A, B, C, D);
+    }
+    catch (std::system_error const& error)
+    {
+        if (error.code() == std::errc::invalid_argument)
+            GTEST_SKIP() << "O_DIRECT is not supported on this file system";
+
+        throw;
+    }
+
+    scppl::FileStream<> fileStream(file.path(), std::ios::in,
+                                   {.direct = true});
+    scppl::FileBinaryStream<std::endian::little> stream(fileStream);
+    assertValuesEqual(stream.readAt<B_t, C_t, D_t>(1), std::tuple{B, C, D});
+}
+
+TEST(FileStream, OpenMissingFile)
+{
+    TemporaryFile file("scppl_test_file_stream_missing");
+
+    ASSERT_THROW(scppl::FileStream<>(file.path(), std::ios::in),
+                 std::system_error);
+}
+#endif
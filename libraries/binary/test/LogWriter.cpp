@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/LogReader.hpp"
+#include "scppl/binary/LogWriter.hpp"
+
+#include "Utility.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+using namespace std::chrono_literals;
+
+auto makeRecord(std::size_t index)
+    -> std::string
+{
+    return "record " + std::to_string(index) +
+           std::string(index % 37, static_cast<char>('a' + index % 26));
+}
+
+auto readAll(std::filesystem::path const& path)
+    -> std::vector<std::string>
+{
+    std::vector<std::string> records{};
+
+    scppl::LogReader<> reader(path);
+    while (auto record = reader.next())
+        records.emplace_back(std::ranges::begin(*record),
+                             std::ranges::end(*record));
+
+    EXPECT_FALSE(reader.torn());
+    EXPECT_EQ(reader.validLength(), std::filesystem::file_size(path));
+
+    return records;
+}
+
+TEST(LogWriter, AppendCommitRead)
+{
+    TemporaryFile file("scppl_test_log_writer");
+
+    {
+        scppl::LogWriter<> log(file.path());
+        for (std::size_t i = 0; i < 100; ++i)
+        {
+            std::string record = makeRecord(i);
+            std::uint64_t sequence = log.append(std::span<char const>(record));
+            if (i % 10 == 9)
+                log.commit(sequence);
+        }
+
+        ASSERT_EQ(log.committed(), log.appended());
+        ASSERT_EQ(log.committed(), std::filesystem::file_size(file.path()));
+    }
+
+    auto records = readAll(file.path());
+    ASSERT_EQ(records.size(), 100);
+    for (std::size_t i = 0; i < 100; ++i)
+        ASSERT_EQ(records[i], makeRecord(i));
+
+    // Reopening appends after the existing records
+    {
+        scppl::LogWriter<> log(file.path());
+        ASSERT_EQ(log.truncated(), 0);
+        ASSERT_EQ(log.appended(), std::filesystem::file_size(file.path()));
+
+        std::string record = makeRecord(100);
+        log.commit(log.append(std::span<char const>(record)));
+    }
+
+    records = readAll(file.path());
+    ASSERT_EQ(records.size(), 101);
+    ASSERT_EQ(records.back(), makeRecord(100));
+}
+
+TEST(LogWriter, ConcurrentGroupCommit)
+{
+    TemporaryFile file("scppl_test_log_writer");
+
+    constexpr std::size_t writers = 4;
+    constexpr std::size_t perWriter = 200;
+
+    for (auto window : {0us, 200us})
+    {
+        std::filesystem::remove(file.path());
+
+        {
+            scppl::LogWriter<> log(file.path(), {.commitWindow = window});
+
+            std::vector<std::thread> threads{};
+            for (std::size_t writer = 0; writer < writers; ++writer)
+            {
+                threads.emplace_back([&log, writer]() {
+                    for (std::size_t i = 0; i < perWriter; ++i)
+                    {
+                        std::string record = makeRecord(writer * perWriter +
+                                                        i);
+                        std::uint64_t sequence = log.append(
+                            std::span<char const>(record));
+                        log.commit(sequence);
+                        ASSERT_GE(log.committed(), sequence);
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            ASSERT_EQ(log.committed(), log.appended());
+        }
+
+        auto records = readAll(file.path());
+        ASSERT_EQ(records.size(), writers * perWriter);
+
+        // Records of one writer keep their order
+        std::vector<std::size_t> next(writers, 0);
+        for (auto const& record : records)
+        {
+            std::size_t index = std::stoul(record.substr(7));
+            std::size_t writer = index / perWriter;
+            ASSERT_EQ(index % perWriter, next[writer]++);
+            ASSERT_EQ(record, makeRecord(index));
+        }
+    }
+}
+
+TEST(LogWriter, TornTailRecovery)
+{
+    TemporaryFile file("scppl_test_log_writer");
+
+    std::size_t validLength = 0;
+    {
+        scppl::LogWriter<> log(file.path(), {.sync = false});
+        for (std::size_t i = 0; i < 10; ++i)
+        {
+            std::string record = makeRecord(i);
+            validLength = log.append(std::span<char const>(record));
+        }
+
+        log.sync();
+    }
+
+    // A crash halfway through the header or the payload of the next record
+    for (std::size_t tail : {3, 11})
+    {
+        std::filesystem::resize_file(file.path(), validLength);
+        {
+            std::ofstream stream(file.path(),
+                                 std::ios::binary | std::ios::app);
+            constexpr char torn[] = "\x20\x00\x00\x00\x40\x00\x00\x00"
+                                    "partial";
+            stream.write(torn, static_cast<std::streamsize>(tail));
+        }
+
+        {
+            scppl::LogReader<> reader(file.path());
+            std::size_t count = 0;
+            while (reader.next())
+                ++count;
+
+            ASSERT_EQ(count, 10);
+            ASSERT_TRUE(reader.torn());
+            ASSERT_EQ(reader.validLength(), validLength);
+        }
+
+        scppl::LogWriter<> log(file.path());
+        ASSERT_EQ(log.truncated(), tail);
+        ASSERT_EQ(log.appended(), validLength);
+        ASSERT_EQ(std::filesystem::file_size(file.path()), validLength);
+    }
+
+    {
+        scppl::LogWriter<> log(file.path());
+        std::string record = makeRecord(10);
+        log.commit(log.append(std::span<char const>(record)));
+    }
+
+    auto records = readAll(file.path());
+    ASSERT_EQ(records.size(), 11);
+    ASSERT_EQ(records.back(), makeRecord(10));
+}
+
+TEST(LogWriter, CorruptRecord)
+{
+    TemporaryFile file("scppl_test_log_writer");
+
+    std::uint64_t first = 0;
+    {
+        scppl::LogWriter<> log(file.path());
+        std::string record = makeRecord(0);
+        first = log.append(std::span<char const>(record));
+        log.append(std::span<char const>(record));
+        log.append(std::span<char const>(record));
+        log.sync();
+
+        // Flip a payload byte of the second record
+        std::fstream stream(file.path(),
+                            std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(static_cast<std::streamoff>(first +
+                                                 scppl::logHeaderLength));
+        stream.put('#');
+    }
+
+    scppl::LogReader<> reader(file.path());
+    ASSERT_TRUE(reader.next());
+    ASSERT_FALSE(reader.next());
+    ASSERT_TRUE(reader.torn());
+    ASSERT_EQ(reader.validLength(), first);
+
+    // A valid record longer than the maximum is not a torn tail
+    std::size_t length = std::filesystem::file_size(file.path());
+    scppl::LogReader<> limited(file.path(), 4);
+    ASSERT_THROW(limited.next(), std::length_error);
+    ASSERT_THROW(scppl::LogWriter<>(file.path(), {.maxRecordLength = 4}),
+                 std::length_error);
+    ASSERT_EQ(std::filesystem::file_size(file.path()), length);
+
+    // A corrupt length is not trusted
+    {
+        std::fstream stream(file.path(),
+                            std::ios::binary | std::ios::in | std::ios::out);
+        stream.seekp(static_cast<std::streamoff>(first + 7));
+        stream.put('\x7f');
+    }
+
+    scppl::LogReader<> corrupt(file.path());
+    ASSERT_TRUE(corrupt.next());
+    ASSERT_FALSE(corrupt.next());
+    ASSERT_TRUE(corrupt.torn());
+    ASSERT_EQ(corrupt.validLength(), first);
+}
+
+TEST(LogWriter, MaxRecordLength)
+{
+    TemporaryFile file("scppl_test_log_writer_limit");
+
+    scppl::LogWriter<> log(file.path(), {.maxRecordLength = 4});
+    std::string record = makeRecord(0);
+    ASSERT_THROW(log.append(std::span<char const>(record)), std::length_error);
+}
+#endif
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/FileStream.hpp"
+#include "scppl/binary/OffsetIndex.hpp"
+
+#include "Utility.hpp"
+
+#if SCPPL_CONFIG_BINARY_USE_POSIX
+namespace {
+
+auto makePayload(std::size_t index)
+    -> std::string
+{
+    return std::to_string(index) + std::string(index % 300, 'p');
+}
+
+template<scppl::FramePrefix tPrefix>
+void buildAndAssertFrames()
+{
+    TemporaryFile records("scppl_test_offset_index_records");
+    TemporaryFile sidecar("scppl_test_offset_index");
+
+    constexpr std::size_t count = 1000;
+    std::vector<std::uint64_t> offsets{};
+    {
+        scppl::FileStream<> file(records.path(),
+                                 std::ios::out | std::ios::trunc);
+        scppl::FileBinaryStream<std::endian::little> stream(file);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            offsets.push_back(stream.tell());
+
+            std::string payload = makePayload(i);
+            stream.template writeFrame<tPrefix>(
+                std::span<char const>(payload));
+        }
+    }
+
+    scppl::FileStream<> file(records.path(), std::ios::in);
+    scppl::FileBinaryStream<std::endian::little> stream(file);
+    ASSERT_EQ(scppl::buildOffsetIndex<tPrefix>(stream, sidecar.path(),
+                                               {.stride = 7}),
+              count);
+
+    scppl::OffsetIndex index(sidecar.path());
+    ASSERT_EQ(index.size(), count);
+    ASSERT_EQ(index.stride(), 7);
+    for (std::size_t i = 0; i < count; ++i)
+        ASSERT_EQ(index[i], offsets[i]);
+
+    // Random access straight to a record
+    for (std::size_t i : {999, 0, 500, 7, 6, 8})
+    {
+        stream.seek(index.at(i), std::ios::beg);
+        auto payload = stream.template readFrame<tPrefix>();
+        ASSERT_EQ(std::string(payload.begin(), payload.end()),
+                  makePayload(i));
+    }
+
+    ASSERT_THROW(index.at(count), std::out_of_range);
+}
+
+}
+
+TEST(OffsetIndex, U32Frames)
+{
+    buildAndAssertFrames<scppl::FramePrefix::U32>();
+}
+
+TEST(OffsetIndex, VarintFrames)
+{
+    buildAndAssertFrames<scppl::FramePrefix::Varint>();
+}
+
+TEST(OffsetIndex, DelimitedParallel)
+{
+    TemporaryFile records("scppl_test_offset_index_records");
+    TemporaryFile sidecar("scppl_test_offset_index");
+
+    for (bool trailing : {true, false})
+    {
+        // Lines of every length from empty up, so delimiters fall on and
+        // around every chunk boundary
+        std::string text{};
+        std::vector<std::uint64_t> offsets{};
+        for (std::size_t i = 0; i < 500; ++i)
+        {
+            offsets.push_back(text.size());
+            text += std::string(i % 41, 'x');
+            if (trailing || i + 1 < 500)
+                text += '\n';
+        }
+
+        {
+            std::ofstream file(records.path(),
+                               std::ios::binary | std::ios::trunc);
+            file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+        for (std::size_t threads : {1, 3})
+        {
+            ASSERT_EQ(scppl::buildDelimitedOffsetIndex(
+                          records.path(), '\n', sidecar.path(),
+                          {.stride = 5, .threads = threads, .chunkSize = 37}),
+                      offsets.size());
+
+            scppl::OffsetIndex index(sidecar.path());
+            ASSERT_EQ(index.size(), offsets.size());
+            for (std::size_t i = 0; i < offsets.size(); ++i)
+                ASSERT_EQ(index[i], offsets[i]);
+        }
+    }
+
+    {
+        std::ofstream file(records.path(), std::ios::binary | std::ios::trunc);
+    }
+
+    ASSERT_EQ(scppl::buildDelimitedOffsetIndex(records.path(), '\n',
+                                               sidecar.path()),
+              0);
+    ASSERT_EQ(scppl::OffsetIndex(sidecar.path()).size(), 0);
+}
+
+TEST(OffsetIndex, Errors)
+{
+    TemporaryFile sidecar("scppl_test_offset_index");
+
+    ASSERT_THROW(scppl::OffsetIndexWriter(sidecar.path(), {.stride = 0}),
+                 std::invalid_argument);
+
+    {
+        scppl::OffsetIndexWriter writer(sidecar.path());
+        writer.add(10);
+        writer.add(10);
+        ASSERT_THROW(writer.add(9), std::invalid_argument);
+    }
+
+    ASSERT_EQ(scppl::OffsetIndex(sidecar.path())[1], 10);
+
+    std::filesystem::resize_file(sidecar.path(),
+                                 std::filesystem::file_size(sidecar.path()) -
+                                     1);
+    ASSERT_THROW(scppl::OffsetIndex{sidecar.path()}, std::runtime_error);
+
+    std::filesystem::resize_file(sidecar.path(), 4);
+    ASSERT_THROW(scppl::OffsetIndex{sidecar.path()}, std::runtime_error);
+
+    std::filesystem::remove(sidecar.path());
+    ASSERT_THROW(scppl::OffsetIndex{sidecar.path()}, std::system_error);
+}
+#endif
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/ReadAheadStream.hpp"
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+static_assert(scppl::SpanSource<scppl::ReadAheadStream<scppl::SpanStream<>>,
+                                char>);
+static_assert(scppl::SeekableSource<
+              scppl::ReadAheadStream<scppl::SpanStream<>>>);
+
+namespace {
+
+// A source without positions that fails after a number of bytes
+class FailingSource
+{
+public:
+    explicit FailingSource(std::size_t length) :
+        mLength(length)
+    {
+        //
+    }
+
+    auto read(char* data, std::size_t length)
+        -> std::size_t
+    {
+        if (mPosition + length > mLength)
+            throw std::runtime_error("Read failed");
+
+        std::fill_n(data, length, 'x');
+        mPosition += length;
+
+        return length;
+    }
+
+private:
+    std::size_t mLength{};
+    std::size_t mPosition{};
+};
+
+auto makeIndices(std::size_t count)
+    -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> indices(count);
+    std::iota(std::ranges::begin(indices), std::ranges::end(indices), 0);
+
+    return indices;
+}
+
+}
+
+TEST(ReadAheadStream, ValuesAcrossBlocks)
+{
+    auto indices = makeIndices(1000);
+    auto bytes = std::as_bytes(std::span(indices));
+
+    // A block size that is not a multiple of the value size
+    scppl::SpanStream<std::byte> span(bytes);
+    scppl::ReadAheadStream<scppl::SpanStream<std::byte>> readAhead(
+        span, {.blockSize = 7, .depth = 3});
+    scppl::BinaryStream<std::endian::native, true,
+                        decltype(readAhead)> stream(readAhead);
+
+    for (uint32_t i = 0; i < 1000; ++i)
+        ASSERT_EQ(stream.readSingle<uint32_t>(), i);
+
+    ASSERT_EQ(stream.tell(), 4000);
+    ASSERT_FALSE(stream.eof());
+
+    stream.readSingle<uint32_t>();
+    ASSERT_TRUE(stream.eof());
+}
+
+TEST(ReadAheadStream, Records)
+{
+    std::stringstream stringstream{};
+    scppl::BinaryStream<std::endian::big> output(stringstream);
+    for (std::size_t i = 0; i < 100; ++i)
+        output.write(A, B, C, D);
+    output.toBegin();
+
+    scppl::ReadAheadStream<std::iostream> readAhead(stringstream,
+                                                    {.blockSize = 64});
+    scppl::ReadAheadBinaryStream<std::iostream, std::endian::big>
+        stream(readAhead);
+
+    std::size_t count = 0;
+    for (auto values : stream.records<A_t, B_t, C_t, D_t>())
+    {
+        assertValuesEqual(values, std::tuple(A, B, C, D));
+        ++count;
+    }
+
+    constexpr std::size_t length = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+    ASSERT_EQ(count, 100);
+    ASSERT_EQ(stream.tell(), 100 * length);
+}
+
+TEST(ReadAheadStream, Seek)
+{
+    auto indices = makeIndices(1000);
+    auto bytes = std::as_bytes(std::span(indices));
+
+    scppl::SpanStream<std::byte> span(bytes);
+    scppl::ReadAheadStream<scppl::SpanStream<std::byte>> readAhead(
+        span, {.blockSize = 64});
+    scppl::BinaryStream<std::endian::native, true,
+                        decltype(readAhead)> stream(readAhead);
+
+    stream.toBegin(400);
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 100);
+
+    stream.seek(392);
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 199);
+
+    stream.toBegin(3996);
+    ASSERT_EQ(stream.readSingle<uint32_t>(), 999);
+    ASSERT_EQ(stream.tell(), 4000);
+}
+
+TEST(ReadAheadStream, Error)
+{
+    // The blocks read before the error are still returned
+    FailingSource source(32);
+    scppl::ReadAheadStream<FailingSource> readAhead(source,
+                                                    {.blockSize = 16,
+                                                     .depth = 4});
+
+    std::vector<char> data(32);
+    ASSERT_EQ(readAhead.read(std::ranges::data(data), 32), 32);
+    ASSERT_THROW(readAhead.read(std::ranges::data(data), 1),
+                 std::runtime_error);
+}
+
+TEST(ReadAheadStream, Shutdown)
+{
+    // Destroying the stream while the worker waits for a free block
+    std::vector<char> data(1 << 16);
+    scppl::SpanStream<> span(data);
+
+    {
+        scppl::ReadAheadStream<scppl::SpanStream<>> readAhead(
+            span, {.blockSize = 256, .depth = 2});
+
+        std::array<char, 4> value{};
+        ASSERT_EQ(readAhead.read(std::ranges::data(value), 4), 4);
+    }
+
+    ASSERT_LT(span.tellg(), std::ranges::size(data));
+}
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/SpanStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+TEST(SpanStream, LittleEndianRead)
+{
+    auto data = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::little> stream(spanStream);
+
+    assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                      std::tuple{A, B, C, D});
+    ASSERT_EQ(spanStream.remaining(), 0);
+    ASSERT_FALSE(stream.eof());
+
+    stream.read<A_t>();
+    ASSERT_TRUE(stream.eof());
+}
+
+TEST(SpanStream, BigEndianRead)
+{
+    auto data = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::big> stream(spanStream);
+
+    assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                      std::tuple{A, B, C, D});
+}
+
+TEST(SpanStream, BeginEndSeek)
+{
+    auto data = combineArrays(DDataLE, CDataLE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::little> stream(spanStream);
+
+    stream.toEnd(-4);
+    ASSERT_EQ(stream.tell(), 8);
+    ASSERT_EQ(stream.readSingle<C_t>(), C);
+
+    stream.toBegin();
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+}
+
+TEST(SpanStream, ReadAt)
+{
+    auto data = combineArrays(DDataLE, CDataLE);
+    scppl::SpanStream<> spanStream(data);
+    scppl::SpanBinaryStream<std::endian::little> stream(spanStream);
+
+    assertValuesEqual(stream.readAt<C_t>(8), std::tuple{C});
+    ASSERT_EQ(stream.tell(), 0);
+
+    ASSERT_EQ(std::ranges::size(stream.readRawAt(10, 4)), 2);
+    ASSERT_TRUE(std::ranges::empty(stream.readRawAt(20, 4)));
+    ASSERT_THROW(stream.readAt<D_t>(8), std::out_of_range);
+}
+
+TEST(SpanStream, Empty)
+{
+    // An empty span has no data pointer to copy from
+    scppl::SpanStream<> spanStream{std::span<char const>{}};
+    std::array<char, 4> data{};
+
+    ASSERT_EQ(spanStream.read(std::ranges::data(data), 4), 0);
+    ASSERT_EQ(spanStream.readAt(std::ranges::data(data), 4, 0), 0);
+
+    scppl::BufferStream<> bufferStream{};
+    bufferStream.write(nullptr, 0);
+    ASSERT_EQ(bufferStream.read(std::ranges::data(data), 4), 0);
+    ASSERT_TRUE(std::ranges::empty(bufferStream.data()));
+}
+
+TEST(BufferStream, LittleEndianWrite)
+{
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::little> stream(bufferStream);
+
+    stream.write(A, B, C, D);
+
+    auto expected = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    ASSERT_TRUE(std::ranges::equal(bufferStream.data(), expected));
+}
+
+TEST(BufferStream, WriteRead)
+{
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::big> stream(bufferStream);
+
+    for (std::size_t i = 0; i < 64; ++i)
+        stream.write(A, B, C, D);
+
+    stream.toBegin();
+    for (std::size_t i = 0; i < 64; ++i)
+        assertValuesEqual(stream.read<A_t, B_t, C_t, D_t>(),
+                          std::tuple{A, B, C, D});
+
+    constexpr std::size_t length = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+    ASSERT_EQ(std::ranges::size(bufferStream.release()), 64 * length);
+    ASSERT_TRUE(std::ranges::empty(bufferStream.data()));
+}
+
+TEST(BufferStream, UnsynchronizedWriteRead)
+{
+    scppl::BufferStream<> bufferStream{};
+    scppl::BufferBinaryStream<std::endian::little, false> stream(bufferStream);
+
+    stream.write(D, C);
+    ASSERT_EQ(stream.tellInput(), 0);
+    ASSERT_EQ(stream.tellOutput(), 12);
+
+    ASSERT_EQ(stream.readSingle<D_t>(), D);
+    ASSERT_EQ(stream.tellInput(), 8);
+
+    stream.seekOutput(-4);
+    stream.write(B);
+    ASSERT_EQ(stream.tellOutput(), 10);
+    ASSERT_EQ(std::ranges::size(bufferStream.data()), 12);
+}
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/TeeStream.hpp"
+#include "scppl/binary/WriteBehindStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+static_assert(scppl::SpanSink<scppl::TeeStream<VectorSink, VectorSink>, char>);
+static_assert(!scppl::SeekableSink<scppl::TeeStream<VectorSink>>);
+
+namespace {
+
+constexpr std::size_t recordLength = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+
+// A sink that always fails
+class FailingSink
+{
+public:
+    void write(char const* /* data */, std::size_t /* length */)
+    {
+        throw std::runtime_error("Write failed");
+    }
+};
+
+auto expected(std::size_t count)
+    -> std::vector<char>
+{
+    auto record = combineArrays(ADataBE, BDataBE, CDataBE, DDataBE);
+
+    std::vector<char> data{};
+    for (std::size_t i = 0; i < count; ++i)
+        data.insert(std::ranges::end(data), std::ranges::begin(record),
+                    std::ranges::end(record));
+
+    return data;
+}
+
+}
+
+TEST(TeeStream, WritesToEverySink)
+{
+    VectorSink first{};
+    VectorSink second{};
+    std::stringstream third{};
+    {
+        scppl::TeeStream tee({.capacity = 64}, first, second, third);
+        scppl::TeeBinaryStream<std::endian::big, VectorSink, VectorSink,
+                               std::stringstream> stream(tee);
+
+        for (std::size_t i = 0; i < 100; ++i)
+            stream.write(A, B, C, D);
+
+        ASSERT_EQ(tee.tellp(), 100 * recordLength);
+    }
+
+    ASSERT_EQ(first.data(), expected(100));
+    ASSERT_EQ(second.data(), expected(100));
+
+    std::string data = third.str();
+    ASSERT_TRUE(std::ranges::equal(data, expected(100)));
+
+    // Every sink sees the same whole buffers, of four records each
+    ASSERT_EQ(first.writes(), 25);
+    ASSERT_EQ(second.writes(), 25);
+}
+
+TEST(TeeStream, LargeWrites)
+{
+    VectorSink first{};
+    VectorSink second{};
+    scppl::TeeStream tee({.capacity = 16}, first, second);
+
+    std::vector<char> data(100, 'x');
+    tee.write(std::ranges::data(data), 4);
+    tee.write(std::ranges::data(data), std::ranges::size(data));
+
+    // The buffered bytes are written first, then the large write directly
+    ASSERT_EQ(tee.buffered(), 0);
+    ASSERT_EQ(first.writes(), 2);
+    ASSERT_EQ(std::ranges::size(second.data()), 104);
+
+    // The same through a BinaryStream
+    scppl::TeeBinaryStream<std::endian::big, VectorSink, VectorSink>
+        stream(tee);
+    stream.write(C);
+    stream.writeRaw(data);
+    ASSERT_EQ(tee.buffered(), 0);
+    ASSERT_EQ(first.writes(), 4);
+    ASSERT_EQ(std::ranges::size(second.data()), 208);
+
+    // Converted values larger than the buffer are written right away
+    std::vector<std::uint32_t> values(64, 0x01020304);
+    stream.writeArray(std::span<std::uint32_t const>(values));
+    ASSERT_EQ(tee.buffered(), 0);
+    ASSERT_EQ(std::ranges::size(first.data()), 208 + 256);
+    ASSERT_EQ(second.data().back(), 0x04);
+}
+
+TEST(TeeStream, SinkError)
+{
+    FailingSink failing{};
+    VectorSink sink{};
+    scppl::TeeStream tee(failing, sink);
+    scppl::TeeBinaryStream<std::endian::big, FailingSink, VectorSink>
+        stream(tee);
+
+    stream.write(A, B, C, D);
+    ASSERT_THROW(tee.flush(), std::runtime_error);
+
+    // The other sink still has the data, and it is not written twice
+    ASSERT_EQ(sink.data(), expected(1));
+    tee.flush();
+    ASSERT_EQ(sink.data(), expected(1));
+}
+
+TEST(TeeStream, WriteBehind)
+{
+    VectorSink local{};
+    VectorSink remote{};
+    scppl::WriteBehindStream<VectorSink> writeBehind(remote,
+                                                     {.bufferSize = 32});
+    {
+        scppl::TeeStream tee({.capacity = 64}, local, writeBehind);
+        scppl::TeeBinaryStream<std::endian::big, VectorSink,
+                               scppl::WriteBehindStream<VectorSink>>
+            stream(tee);
+
+        for (std::size_t i = 0; i < 100; ++i)
+            stream.write(A, B, C, D);
+    }
+
+    writeBehind.sync();
+    ASSERT_EQ(local.data(), expected(100));
+    ASSERT_EQ(remote.data(), expected(100));
+}
@@ -7,8 +7,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
 #include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 #include <gtest/gtest.h>
 
@@ -80,4 +91,66 @@ void assertDataEqual(std::vector<char> data, ByteArray<N> expected)
         ASSERT_EQ(data.at(i), expected.at(i));
 }
 
+class TemporaryFile
+{
+public:
+    // The name gets the process id and a counter appended, so concurrent test
+    // runs on the same machine do not remove each other's files
+    explicit TemporaryFile(std::string_view name) :
+        mPath(std::filesystem::temp_directory_path() /
+              (std::string(name) + "_" + uniqueSuffix()))
+    {
+        std::filesystem::remove(mPath);
+    }
+
+    TemporaryFile(TemporaryFile const&) = delete;
+    TemporaryFile(TemporaryFile&&) = delete;
+
+    ~TemporaryFile()
+    {
+        std::error_code error{};
+        std::filesystem::remove(mPath, error);
+    }
+
+    auto operator=(TemporaryFile const&) -> TemporaryFile& = delete;
+    auto operator=(TemporaryFile&&) -> TemporaryFile& = delete;
+
+    auto path() const -> std::filesystem::path const& { return mPath; }
+
+private:
+    std::filesystem::path mPath{};
+
+    static auto uniqueSuffix()
+        -> std::string
+    {
+        static std::atomic<unsigned> counter{};
+
+#if defined(_WIN32)
+        auto process = _getpid();
+#else
+        auto process = getpid();
+#endif
+
+        return std::to_string(process) + "_" + std::to_string(counter++);
+    }
+};
+
+// A sink without positions, like a socket writer
+class VectorSink
+{
+public:
+    void write(char const* data, std::size_t length)
+    {
+        mData.insert(std::ranges::end(mData), data, data + length);
+        ++mWrites;
+    }
+
+    auto data() const -> std::vector<char> const& { return mData; }
+    auto writes() const -> std::size_t { return mWrites; }
+
+private:
+    std::vector<char> mData{};
+    std::size_t mWrites{};
+};
+
 #endif
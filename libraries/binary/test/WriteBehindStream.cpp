@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/WriteBehindStream.hpp"
+
+#include "Data.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+#include "Values.hpp"
+
+static_assert(scppl::SpanSink<scppl::WriteBehindStream<VectorSink>, char>);
+static_assert(!scppl::SeekableSink<scppl::WriteBehindStream<VectorSink>>);
+
+namespace {
+
+// A sink that waits in `write` until it is opened, like a stalled disk
+class GatedSink
+{
+public:
+    void write(char const* data, std::size_t length)
+    {
+        mOpen.wait(false);
+        mSink.write(data, length);
+    }
+
+    void open()
+    {
+        mOpen.store(true);
+        mOpen.notify_all();
+    }
+
+    auto data() const -> std::vector<char> const& { return mSink.data(); }
+
+private:
+    std::atomic<bool> mOpen{};
+    VectorSink mSink{};
+};
+
+// A sink that always fails
+class FailingSink
+{
+public:
+    void write(char const* /* data */, std::size_t /* length */)
+    {
+        throw std::runtime_error("Write failed");
+    }
+};
+
+}
+
+TEST(WriteBehindStream, WritesInOrder)
+{
+    constexpr std::size_t length = scppl::lengthOf<A_t, B_t, C_t, D_t>();
+
+    VectorSink sink{};
+    scppl::WriteBehindStream<VectorSink> writeBehind(sink,
+                                                     {.bufferSize = 64,
+                                                      .depth = 2});
+    scppl::WriteBehindBinaryStream<VectorSink, std::endian::little>
+        stream(writeBehind);
+
+    for (std::size_t i = 0; i < 1000; ++i)
+        stream.write(A, B, C, D);
+
+    writeBehind.sync();
+    ASSERT_EQ(writeBehind.pending(), 0);
+    ASSERT_EQ(writeBehind.tellp(), 1000 * length);
+    ASSERT_EQ(std::ranges::size(sink.data()), 1000 * length);
+
+    auto expected = combineArrays(ADataLE, BDataLE, CDataLE, DDataLE);
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(std::ranges::equal(std::span(sink.data())
+                                           .subspan(i * length, length),
+                                       expected));
+    }
+}
+
+TEST(WriteBehindStream, Drop)
+{
+    GatedSink sink{};
+    scppl::WriteBehindStream<GatedSink> writeBehind(
+        sink, {.bufferSize = 4, .depth = 1,
+               .backpressure = scppl::Backpressure::Drop});
+
+    // The first buffer waits for the sink, the second one is dropped
+    writeBehind.write("abcd", 4);
+    writeBehind.write("efgh", 4);
+    ASSERT_EQ(writeBehind.dropped(), 4);
+
+    sink.open();
+    writeBehind.sync();
+    ASSERT_TRUE(std::ranges::equal(sink.data(), std::string_view("abcd")));
+}
+
+TEST(WriteBehindStream, DropWholeWrites)
+{
+    GatedSink sink{};
+    scppl::WriteBehindStream<GatedSink> writeBehind(
+        sink, {.bufferSize = 4, .depth = 1,
+               .backpressure = scppl::Backpressure::Drop});
+
+    // The last write does not fit in the current buffer, but is not split
+    writeBehind.write("abcd", 4);
+    writeBehind.write("ef", 2);
+    writeBehind.write("ghij", 4);
+    ASSERT_EQ(writeBehind.dropped(), 6);
+    ASSERT_EQ(writeBehind.tellp(), 10);
+
+    sink.open();
+    writeBehind.sync();
+    ASSERT_TRUE(std::ranges::equal(sink.data(), std::string_view("abcd")));
+}
+
+TEST(WriteBehindStream, Grow)
+{
+    GatedSink sink{};
+    scppl::WriteBehindStream<GatedSink> writeBehind(
+        sink, {.bufferSize = 4, .depth = 1,
+               .backpressure = scppl::Backpressure::Grow});
+
+    // The second and third write stay in the current buffer
+    writeBehind.write("abcd", 4);
+    writeBehind.write("efgh", 4);
+    writeBehind.write("ijkl", 4);
+    ASSERT_EQ(writeBehind.dropped(), 0);
+
+    sink.open();
+    writeBehind.sync();
+    ASSERT_TRUE(std::ranges::equal(sink.data(),
+                                   std::string_view("abcdefghijkl")));
+}
+
+TEST(WriteBehindStream, Block)
+{
+    GatedSink sink{};
+
+    {
+        scppl::WriteBehindStream<GatedSink> writeBehind(sink,
+                                                        {.bufferSize = 4,
+                                                         .depth = 1});
+
+        std::thread opener([&sink]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            sink.open();
+        });
+
+        // The second write waits until the first buffer is written
+        writeBehind.write("abcd", 4);
+        writeBehind.write("efgh", 4);
+        writeBehind.write("ij", 2);
+
+        opener.join();
+    }
+
+    // The last buffer is written on destruction
+    ASSERT_TRUE(std::ranges::equal(sink.data(),
+                                   std::string_view("abcdefghij")));
+}
+
+TEST(WriteBehindStream, Error)
+{
+    FailingSink sink{};
+    scppl::WriteBehindStream<FailingSink, char> writeBehind(sink,
+                                                            {.bufferSize = 4});
+
+    writeBehind.write("abcd", 4);
+    ASSERT_THROW(writeBehind.sync(), std::runtime_error);
+    ASSERT_THROW(writeBehind.write("efgh", 4), std::runtime_error);
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2021-2022 SanderTheDragon <sanderthedragon@zoho.com>
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <ranges>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "scppl/binary/WriteBuffer.hpp"
+
+TEST(WriteBuffer, Buffer)
+{
+    scppl::WriteBuffer<char> buffer(8);
+    ASSERT_FALSE(buffer.bypasses(7));
+    ASSERT_TRUE(buffer.bypasses(8));
+
+    std::memcpy(std::ranges::data(buffer.acquire(5)), "hello", 5);
+    buffer.commit(5);
+    ASSERT_EQ(buffer.size(), 5);
+    ASSERT_TRUE(std::ranges::equal(buffer.data(), std::string_view("hello")));
+
+    ASSERT_TRUE(buffer.fits(3));
+    ASSERT_FALSE(buffer.fits(4));
+
+    buffer.clear();
+    ASSERT_EQ(buffer.size(), 0);
+    ASSERT_TRUE(std::ranges::empty(buffer.data()));
+}
+
+TEST(WriteBuffer, Oversized)
+{
+    scppl::WriteBuffer<char> buffer(8);
+
+    // Grows for a large acquire, until it is cleared
+    ASSERT_GE(std::ranges::size(buffer.acquire(100)), 100);
+    buffer.commit(100);
+    ASSERT_TRUE(buffer.oversized());
+    ASSERT_EQ(buffer.size(), 100);
+
+    buffer.clear();
+    ASSERT_FALSE(buffer.oversized());
+    ASSERT_EQ(std::ranges::size(buffer.acquire(1)), buffer.capacity());
+}